@@ -69,18 +69,38 @@ void print_graph(Graph* graph) {
     }
 }
 
-// DFS helper (recursive)
-void dfs_helper(Graph* graph, int vertex, int visited[]) {
-    visited[vertex] = 1;
-    printf("%d ", vertex);
-    
-    Node* current = graph->adj_lists[vertex];
-    while (current != NULL) {
-        if (!visited[current->vertex]) {
-            dfs_helper(graph, current->vertex, visited);
+// DFS helper (iterative). An explicit stack replaces recursion: each
+// entry is a vertex and the next neighbour to try, so the visiting
+// order matches the recursive version, but a long path can't overflow
+// the call stack. Stops early (returns 1) when target is reached;
+// pass -1 to visit everything reachable.
+int dfs_visit(Graph* graph, int start, int target, int visited[], int print) {
+    Node** stack = (Node**)malloc(graph->num_vertices * sizeof(Node*));
+    int top = 0;
+    int found = 0;
+    
+    visited[start] = 1;
+    if (print) printf("%d ", start);
+    stack[top++] = graph->adj_lists[start];
+    if (start == target) found = 1;
+    
+    while (top > 0 && !found) {
+        Node* next = stack[top - 1];
+        if (next == NULL) {
+            top--;  // No neighbours left: backtrack
+            continue;
+        }
+        stack[top - 1] = next->next;
+        if (!visited[next->vertex]) {
+            visited[next->vertex] = 1;
+            if (print) printf("%d ", next->vertex);
+            if (next->vertex == target) found = 1;
+            stack[top++] = graph->adj_lists[next->vertex];
         }
-        current = current->next;
     }
+    
+    free(stack);
+    return found;
 }
 
 // Depth-First Search
@@ -88,7 +108,7 @@ void dfs(Graph* graph, int start) {
     int* visited = (int*)calloc(graph->num_vertices, sizeof(int));
     
     printf("DFS starting from %d: ", start);
-    dfs_helper(graph, start, visited);
+    dfs_visit(graph, start, -1, visited, 1);
     printf("\n");
     
     free(visited);
@@ -154,51 +174,21 @@ void bfs(Graph* graph, int start) {
 }
 
 // Check if path exists (using DFS)
-int has_path_helper(Graph* graph, int current, int target, int visited[]) {
-    if (current == target) return 1;
-    
-    visited[current] = 1;
-    
-    Node* adj = graph->adj_lists[current];
-    while (adj != NULL) {
-        if (!visited[adj->vertex]) {
-            if (has_path_helper(graph, adj->vertex, target, visited)) {
-                return 1;
-            }
-        }
-        adj = adj->next;
-    }
-    
-    return 0;
-}
-
 int has_path(Graph* graph, int start, int end) {
     int* visited = (int*)calloc(graph->num_vertices, sizeof(int));
-    int result = has_path_helper(graph, start, end, visited);
+    int result = dfs_visit(graph, start, end, visited, 0);
     free(visited);
     return result;
 }
 
 // Count connected components
-void dfs_component(Graph* graph, int vertex, int visited[]) {
-    visited[vertex] = 1;
-    
-    Node* current = graph->adj_lists[vertex];
-    while (current != NULL) {
-        if (!visited[current->vertex]) {
-            dfs_component(graph, current->vertex, visited);
-        }
-        current = current->next;
-    }
-}
-
 int count_components(Graph* graph) {
     int* visited = (int*)calloc(graph->num_vertices, sizeof(int));
     int count = 0;
     
     for (int i = 0; i < graph->num_vertices; i++) {
         if (!visited[i]) {
-            dfs_component(graph, i, visited);
+            dfs_visit(graph, i, -1, visited, 0);
             count++;
         }
     }
@@ -366,7 +356,8 @@ int main(void) {
  * Traversals:
  * 
  * DFS (Depth-First Search):
- * - Use stack (or recursion)
+ * - Use stack (or recursion - but deep graphs overflow the call
+ *   stack, so dfs_visit keeps its own)
  * - Go deep before wide
  * - Uses: Path finding, cycle detection, topological sort
  * - Complexity: O(V + E)
@@ -423,6 +414,9 @@ int main(void) {
  * - Tarjan: Strongly connected components
  * - A*: Heuristic pathfinding
  * 
+ * For big graphs see 12_csr_graph.c: all edges in one array, built
+ * in bulk, and a parallel BFS.
+ * 
  * Try:
  * - Implement directed graph variant
  * - Add weighted edges
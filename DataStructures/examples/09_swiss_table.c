@@ -0,0 +1,403 @@
+/*
+ * 09_swiss_table.c
+ *
+ * Swiss table (swiss_map.h): the cache-friendly replacement for the
+ * chained HashTable in 06_hash_table.c.
+ * Demonstrates control bytes, SIMD group probing, small-string keys,
+ * tombstones, and a benchmark against chaining.
+ *
+ * Build: gcc -O2 09_swiss_table.c -o 09_swiss_table
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "swiss_map.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <time.h>
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+// Integer keys: the macro instantiates a second map type
+SWISS_MAP_DEFINE(IntMap, intmap, uint64_t, uint64_t, swiss_hash_u64, SWISS_EQ, SWISS_NO_COPY, SWISS_NO_FREE)
+
+// ===== 06's chained table, for comparison =====
+
+typedef struct HashNode {
+    char* key;
+    int value;
+    struct HashNode* next;
+} HashNode;
+
+typedef struct {
+    HashNode** buckets;
+    int size;
+    int count;
+} HashTable;
+
+unsigned int chain_hash(const char* key, int table_size) {
+    unsigned int hash = 5381;
+    while (*key) {
+        hash = ((hash << 5) + hash) + (*key);
+        key++;
+    }
+    return hash % table_size;
+}
+
+HashTable* chain_create(int size) {
+    HashTable* table = (HashTable*)malloc(sizeof(HashTable));
+    table->size = size;
+    table->count = 0;
+    table->buckets = (HashNode**)calloc(size, sizeof(HashNode*));
+    return table;
+}
+
+void chain_insert(HashTable* table, const char* key, int value) {
+    int index = chain_hash(key, table->size);
+    for (HashNode* n = table->buckets[index]; n != NULL; n = n->next) {
+        if (strcmp(n->key, key) == 0) {
+            n->value = value;
+            return;
+        }
+    }
+    HashNode* node = (HashNode*)malloc(sizeof(HashNode));
+    node->key = strdup(key);
+    node->value = value;
+    node->next = table->buckets[index];
+    table->buckets[index] = node;
+    table->count++;
+}
+
+int chain_search(HashTable* table, const char* key, int* value) {
+    int index = chain_hash(key, table->size);
+    for (HashNode* n = table->buckets[index]; n != NULL; n = n->next) {
+        if (strcmp(n->key, key) == 0) {
+            *value = n->value;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void chain_free(HashTable* table) {
+    for (int i = 0; i < table->size; i++) {
+        HashNode* n = table->buckets[i];
+        while (n != NULL) {
+            HashNode* next = n->next;
+            free(n->key);
+            free(n);
+            n = next;
+        }
+    }
+    free(table->buckets);
+    free(table);
+}
+
+// ===== Helpers =====
+
+static unsigned xorshift(unsigned* state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// One character per control byte: . empty, x deleted, else a letter
+void print_ctrl(const StrMap* m) {
+    printf("  ctrl: ");
+    for (size_t i = 0; i <= m->mask; i++) {
+        int8_t c = m->ctrl[i];
+        if (c == SWISS_EMPTY) printf(".");
+        else if (c == SWISS_DELETED) printf("x");
+        else printf("%c", 'A' + c % 26);
+        if (i % 16 == 15 && i != m->mask) printf(" ");
+    }
+    printf("\n");
+}
+
+// ===== Examples =====
+
+void example_basics(void) {
+    printf("Example 1: Control bytes\n");
+    printf("------------------------\n");
+    StrMap m;
+    strmap_init(&m, 0);
+    const char* fruits[] = { "apple", "banana", "cherry", "date", "elderberry", "fig", "grape" };
+    for (int i = 0; i < 7; i++) strmap_put(&m, smallkey(fruits[i]), (i + 1) * 100);
+
+    printf("Capacity %zu, %zu entries. One control byte per slot\n", m.mask + 1, m.count);
+    printf("(letter = full, from the hash's low 7 bits):\n");
+    print_ctrl(&m);
+
+    for (int i = 0; i < 7; i++) {
+        uint64_t h = smallkey_hash(smallkey(fruits[i]));
+        printf("  %-11s h1 -> slot %2zu, h2 = 0x%02x\n", fruits[i],
+               (size_t)(h >> 7) & m.mask, (unsigned)(h & 0x7f));
+    }
+
+    printf("\nLookups compare h2 against 16 control bytes at once:\n");
+    const char* keys[] = { "apple", "fig", "kiwi" };
+    for (int i = 0; i < 3; i++) {
+        int* v = strmap_get(&m, smallkey(keys[i]));
+        if (v) printf("  Found \"%s\": %d\n", keys[i], *v);
+        else printf("  \"%s\" not found (its group has an empty byte: stop)\n", keys[i]);
+    }
+
+    printf("\nRemoving \"banana\" and \"date\":\n");
+    strmap_remove(&m, smallkey("banana"));
+    strmap_remove(&m, smallkey("date"));
+    print_ctrl(&m);
+    printf("  (deleted slots go straight back to empty: no probe could have\n");
+    printf("   passed them while their group had empty bytes)\n");
+    strmap_free(&m);
+}
+
+void example_small_keys(void) {
+    printf("\n\nExample 2: Small-string keys\n");
+    printf("----------------------------\n");
+    printf("sizeof(SmallKey) = %zu: up to %d bytes stored inline\n\n",
+           sizeof(SmallKey), SMALLKEY_INLINE);
+    const char* words[] = { "id", "user_name", "fifteen_chars!!", "sixteen_chars!!!",
+                            "a_much_longer_configuration_key" };
+    for (int i = 0; i < 5; i++) {
+        SmallKey k = smallkey(words[i]);
+        printf("  %-34s %2zu bytes: %s\n", words[i], smallkey_len(&k),
+               smallkey_is_inline(&k) ? "inline, compared as two words" : "pointer to a heap copy");
+    }
+    printf("\nChaining (06) mallocs a node and strdup's the key for every\n");
+    printf("entry. Here short keys live in the slot itself.\n");
+}
+
+void example_word_frequency(void) {
+    printf("\n\nExample 3: Word frequency counter\n");
+    printf("---------------------------------\n");
+    const char* text = "the quick brown fox jumps over the lazy dog the fox";
+    printf("Text: \"%s\"\n\n", text);
+
+    StrMap freq;
+    strmap_init(&freq, 0);
+    const char* p = text;
+    while (*p) {
+        while (*p == ' ') p++;
+        const char* start = p;
+        while (*p && *p != ' ') p++;
+        if (p == start) break;
+        int inserted;
+        int* count = strmap_find_or_insert(&freq, smallkey_n(start, (size_t)(p - start)), &inserted);
+        if (inserted) *count = 0;
+        (*count)++;                     // One hash, one probe: no search-then-insert
+    }
+
+    printf("Word frequencies:\n");
+    size_t it = 0;
+    StrMapSlot* s;
+    while ((s = strmap_next(&freq, &it)) != NULL) {
+        printf("  \"%s\": %d times\n", smallkey_data(&s->key), s->value);
+    }
+    strmap_free(&freq);
+}
+
+void example_probing(void) {
+    printf("\n\nExample 4: Probe lengths near full\n");
+    printf("----------------------------------\n");
+    IntMap m;
+    intmap_init(&m, 0);
+    printf("  %10s %10s %8s %12s %12s\n", "entries", "capacity", "load", "groups/hit", "groups/miss");
+    uint64_t next = 1;
+    while (m.mask + 1 <= 262144) {
+        // Fill to 7/8, the fullest the table gets before doubling
+        size_t cap = m.mask + 1;
+        while (m.count < cap - cap / 8) intmap_put(&m, next++, 0);
+        if (cap >= 4096) {
+            long hit = 0, miss = 0;
+            for (uint64_t k = 1; k < next; k++) hit += intmap_probe_groups(&m, k);
+            for (uint64_t k = next; k < next + m.count; k++) miss += intmap_probe_groups(&m, k);
+            printf("  %10zu %10zu %8.3f %12.3f %12.3f\n", m.count, cap,
+                   (double)m.count / cap, (double)hit / m.count, (double)miss / m.count);
+        }
+        intmap_put(&m, next++, 0);      // Doubles
+    }
+    printf("\nEven at 7/8 full, most lookups read one group of 16 control\n");
+    printf("bytes. A miss stops at the first group with an empty byte.\n");
+    intmap_free(&m);
+}
+
+void example_tombstones(void) {
+    printf("\n\nExample 5: Deletes and tombstones\n");
+    printf("---------------------------------\n");
+    IntMap m;
+    intmap_init(&m, 100000);
+    size_t cap = m.mask + 1;
+    unsigned rng = 7;
+    uint64_t next_key = 1;
+    for (int i = 0; i < 100000; i++) intmap_put(&m, next_key++, 0);
+
+    // A sliding window: delete the oldest, insert a new one
+    printf("  100000 live keys, capacity %zu. Insert new, delete old:\n", cap);
+    printf("  %10s %10s %12s %10s\n", "churn", "count", "tombstones", "capacity");
+    uint64_t oldest = 1;
+    for (int round = 1; round <= 4; round++) {
+        for (int i = 0; i < 250000; i++) {
+            intmap_put(&m, next_key++, xorshift(&rng));
+            intmap_remove(&m, oldest++);
+        }
+        printf("  %10d %10zu %12zu %10zu\n", round * 250000, m.count, m.deleted, m.mask + 1);
+    }
+    printf("\nTombstones build up until the table runs out of empty slots,\n");
+    printf("then a rehash at the same capacity clears them: the capacity\n");
+    printf("doesn't grow while the live count stays the same.\n");
+    intmap_free(&m);
+}
+
+void example_benchmark(void) {
+    printf("\n\nExample 6: Benchmark vs chaining (06)\n");
+    printf("-------------------------------------\n");
+    const int n = 1000000;
+    char (*keys)[32] = malloc((size_t)n * 32);
+    char (*misses)[32] = malloc((size_t)n * 32);
+    int* order = malloc(n * sizeof(int));
+    unsigned rng = 12345;
+
+    for (int pass = 0; pass < 2; pass++) {
+        // Short keys fit inline; long keys make both sides chase a pointer
+        const char* fmt = pass == 0 ? "user:%u" : "session/%u/profile";
+        for (int i = 0; i < n; i++) {
+            snprintf(keys[i], 32, fmt, xorshift(&rng));
+            snprintf(misses[i], 32, fmt, xorshift(&rng) | 1u << 31);
+            order[i] = i;
+        }
+        for (int i = n - 1; i > 0; i--) {
+            int j = xorshift(&rng) % (i + 1);
+            int t = order[i];
+            order[i] = order[j];
+            order[j] = t;
+        }
+        printf("\n%d keys like \"%s\":\n", n, keys[0]);
+        printf("  %-22s %10s %10s %10s\n", "", "insert", "hit", "miss");
+
+        // 06 never resizes: give it one bucket per key (load 1.0), and
+        // give the swiss table its final capacity too
+        double t0 = get_time_ms();
+        HashTable* chain = chain_create(n);
+        for (int i = 0; i < n; i++) chain_insert(chain, keys[i], i);
+        double t1 = get_time_ms();
+        long found = 0;
+        int v;
+        for (int i = 0; i < n; i++) found += chain_search(chain, keys[order[i]], &v);
+        double t2 = get_time_ms();
+        for (int i = 0; i < n; i++) found += chain_search(chain, misses[i], &v);
+        double t3 = get_time_ms();
+        printf("  %-22s %8.1fns %8.1fns %8.1fns\n", "chained (06)",
+               (t1 - t0) * 1e6 / n, (t2 - t1) * 1e6 / n, (t3 - t2) * 1e6 / n);
+        chain_free(chain);
+
+        t0 = get_time_ms();
+        StrMap m;
+        strmap_init(&m, n);
+        for (int i = 0; i < n; i++) strmap_put(&m, smallkey(keys[i]), i);
+        t1 = get_time_ms();
+        long found2 = 0;
+        for (int i = 0; i < n; i++) found2 += strmap_get(&m, smallkey(keys[order[i]])) != NULL;
+        t2 = get_time_ms();
+        for (int i = 0; i < n; i++) found2 += strmap_get(&m, smallkey(misses[i])) != NULL;
+        t3 = get_time_ms();
+        printf("  %-22s %8.1fns %8.1fns %8.1fns\n", "swiss table",
+               (t1 - t0) * 1e6 / n, (t2 - t1) * 1e6 / n, (t3 - t2) * 1e6 / n);
+        if (found != found2) printf("  Mismatch: %ld vs %ld found\n", found, found2);
+        strmap_free(&m);
+    }
+
+    // Integer keys: no strings at all
+    IntMap im;
+    double t0 = get_time_ms();
+    intmap_init(&im, n);
+    for (int i = 0; i < n; i++) intmap_put(&im, (uint64_t)order[i] * 2654435761u, i);
+    double t1 = get_time_ms();
+    long found = 0;
+    for (int i = 0; i < n; i++) found += intmap_get(&im, (uint64_t)i * 2654435761u) != NULL;
+    double t2 = get_time_ms();
+    printf("\n%d uint64 keys:\n", n);
+    printf("  %-22s %8.1fns %8.1fns   (%ld found)\n", "swiss table (IntMap)",
+           (t1 - t0) * 1e6 / n, (t2 - t1) * 1e6 / n, found);
+    intmap_free(&im);
+
+    printf("\nOnce the table outgrows the cache, a hit costs a miss on the\n");
+    printf("control bytes and one on the slot - long keys add a third, for\n");
+    printf("the heap copy, like chaining's strdup. Misses rarely touch a\n");
+    printf("slot at all: one group of control bytes says \"not here\".\n");
+
+    free(keys);
+    free(misses);
+    free(order);
+}
+
+int main(void) {
+    printf("=== Swiss Table ===\n\n");
+
+    example_basics();
+    example_small_keys();
+    example_word_frequency();
+    example_probing();
+    example_tombstones();
+    example_benchmark();
+
+    printf("\n\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Why Open Addressing Wins Lookups:
+ *
+ * Chaining (06):
+ *   hash -> bucket array -> node (malloc'd somewhere) -> key (strdup'd
+ *   somewhere else) -> next node ...
+ *   Each arrow is a likely cache miss: ~100 ns each once the table is
+ *   bigger than the cache.
+ *
+ * Swiss table:
+ *   hash -> 16 control bytes (one load) -> matching slot -> key inline
+ *   Usually two cache lines per lookup, hit or miss.
+ *
+ * The hash is split in two:
+ *
+ *   64-bit hash = [ h1: 57 bits -> where to start ][ h2: 7 bits ]
+ *
+ *   h2 is stored in the control byte. Comparing it rules out 127/128
+ *   of the non-matching slots without touching the slot array.
+ *
+ * SSE2 group match (what swiss_match compiles to):
+ *
+ *   ctrl  = load 16 bytes             [5a 80 13 80 80 7f 13 ...]
+ *   eq    = compare each with h2=13   [00 00 ff 00 00 00 ff ...]
+ *   mask  = movemask(eq)              0b...1000100
+ *   for each set bit: compare keys
+ *
+ * Power-of-two capacity: slot = h1 & mask instead of h % size. That
+ * needs a hash whose low bits are good. DJB2 % prime hides a weak hash;
+ * wyhash mixes every input bit into every output bit.
+ *
+ * Deletion can't just empty a slot: a later key may have probed past
+ * it. Swiss tables mark it deleted (a tombstone) unless the slot's
+ * group neighbourhood shows no probe could have passed.
+ *
+ * Try:
+ * - Compile with -DSWISS_NO_SIMD and compare the portable loop
+ * - Replace wyhash with DJB2 and watch probe lengths
+ * - Raise the max load from 7/8 and measure misses
+ */
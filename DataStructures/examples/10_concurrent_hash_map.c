@@ -0,0 +1,614 @@
+/*
+ * 10_concurrent_hash_map.c
+ *
+ * Two things 06_hash_table.c can't do:
+ *   - grow without a pause: incremental rehashing moves a few buckets
+ *     per operation instead of the whole table at once (Redis' dict)
+ *   - be shared between threads: lock striping over swiss_map.h shards
+ * Ends with a multithreaded word-frequency benchmark over a large
+ * corpus (synthetic, or any text file given on the command line).
+ *
+ * Build: gcc -O2 10_concurrent_hash_map.c -o 10_concurrent_hash_map -pthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "swiss_map.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+    typedef CRITICAL_SECTION mutex_t;
+    #define mutex_init(m) InitializeCriticalSection(m)
+    #define mutex_destroy(m) DeleteCriticalSection(m)
+    #define mutex_lock(m) EnterCriticalSection(m)
+    #define mutex_unlock(m) LeaveCriticalSection(m)
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    }
+    void thread_join(thread_t t) {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <pthread.h>
+    #include <time.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+    typedef pthread_mutex_t mutex_t;
+    #define mutex_init(m) pthread_mutex_init(m, NULL)
+    #define mutex_destroy(m) pthread_mutex_destroy(m)
+    #define mutex_lock(m) pthread_mutex_lock(m)
+    #define mutex_unlock(m) pthread_mutex_unlock(m)
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        pthread_create(t, NULL, fn, arg);
+    }
+    void thread_join(thread_t t) {
+        pthread_join(t, NULL);
+    }
+
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+#define LOAD_FACTOR_THRESHOLD 0.75
+#define REHASH_STEP 2                   // Buckets moved per operation
+#define MAX_THREADS 8
+
+static unsigned xorshift(unsigned* state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// ===== Incremental rehashing (06's chained table, growing) =====
+
+typedef struct HashNode {
+    char* key;
+    int value;
+    struct HashNode* next;
+} HashNode;
+
+typedef struct {
+    HashNode** buckets;
+    size_t size;                        // Power of two
+    size_t count;
+} Buckets;
+
+/*
+ * While growing there are two tables: buckets below rehash_index have
+ * moved to the new one. Every operation moves REHASH_STEP more, and
+ * lookups check both. 2 per operation finishes the move well before
+ * the new table itself reaches the threshold (0.75 * size inserts
+ * away, size / 2 operations needed).
+ */
+typedef struct {
+    Buckets table[2];
+    long rehash_index;                  // -1: not rehashing
+    int incremental;                    // 0: move everything at once, like 06 would
+} IncHashTable;
+
+static size_t bucket_of(const char* key, size_t size) {
+    return (size_t)wyhash(key, strlen(key), 0) & (size - 1);
+}
+
+static void buckets_init(Buckets* b, size_t size) {
+    b->buckets = (HashNode**)calloc(size, sizeof(HashNode*));
+    b->size = size;
+    b->count = 0;
+}
+
+IncHashTable* inc_create(size_t size, int incremental) {
+    IncHashTable* t = (IncHashTable*)calloc(1, sizeof(IncHashTable));
+    buckets_init(&t->table[0], size);
+    t->rehash_index = -1;
+    t->incremental = incremental;
+    return t;
+}
+
+// Move up to n buckets to the new table; visits at most 10n empty ones
+void inc_rehash_step(IncHashTable* t, size_t n) {
+    if (t->rehash_index < 0) return;
+    Buckets* from = &t->table[0];
+    Buckets* to = &t->table[1];
+    size_t empty_visits = n * 10;
+    while (n > 0 && from->count > 0) {
+        while (from->buckets[t->rehash_index] == NULL) {
+            t->rehash_index++;
+            if (--empty_visits == 0) return;
+        }
+        HashNode* node = from->buckets[t->rehash_index];
+        while (node) {
+            HashNode* next = node->next;
+            size_t i = bucket_of(node->key, to->size);
+            node->next = to->buckets[i];
+            to->buckets[i] = node;
+            from->count--;
+            to->count++;
+            node = next;
+        }
+        from->buckets[t->rehash_index++] = NULL;
+        n--;
+    }
+    if (from->count == 0) {
+        free(from->buckets);
+        *from = *to;
+        memset(to, 0, sizeof(*to));
+        t->rehash_index = -1;
+    }
+}
+
+static HashNode* inc_find(IncHashTable* t, const char* key) {
+    for (int k = 0; k < 2; k++) {
+        Buckets* b = &t->table[k];
+        if (b->size == 0) continue;
+        for (HashNode* n = b->buckets[bucket_of(key, b->size)]; n; n = n->next) {
+            if (strcmp(n->key, key) == 0) return n;
+        }
+        if (t->rehash_index < 0) break;
+    }
+    return NULL;
+}
+
+size_t inc_count(IncHashTable* t) {
+    return t->table[0].count + t->table[1].count;
+}
+
+void inc_insert(IncHashTable* t, const char* key, int value) {
+    inc_rehash_step(t, REHASH_STEP);
+    HashNode* found = inc_find(t, key);
+    if (found) {
+        found->value = value;
+        return;
+    }
+    // New keys go to the new table while rehashing
+    Buckets* b = &t->table[t->rehash_index >= 0 ? 1 : 0];
+    HashNode* node = (HashNode*)malloc(sizeof(HashNode));
+    node->key = strdup(key);
+    node->value = value;
+    size_t i = bucket_of(key, b->size);
+    node->next = b->buckets[i];
+    b->buckets[i] = node;
+    b->count++;
+
+    if (t->rehash_index < 0 && (double)b->count / b->size > LOAD_FACTOR_THRESHOLD) {
+        buckets_init(&t->table[1], b->size * 2);
+        t->rehash_index = 0;
+        if (!t->incremental) inc_rehash_step(t, b->size);
+    }
+}
+
+int inc_search(IncHashTable* t, const char* key, int* value) {
+    inc_rehash_step(t, REHASH_STEP);
+    HashNode* n = inc_find(t, key);
+    if (n) *value = n->value;
+    return n != NULL;
+}
+
+void inc_free(IncHashTable* t) {
+    for (int k = 0; k < 2; k++) {
+        for (size_t i = 0; i < t->table[k].size; i++) {
+            HashNode* n = t->table[k].buckets[i];
+            while (n) {
+                HashNode* next = n->next;
+                free(n->key);
+                free(n);
+                n = next;
+            }
+        }
+        free(t->table[k].buckets);
+    }
+    free(t);
+}
+
+// ===== Concurrent map: lock striping =====
+
+/*
+ * The key's hash picks one of CMAP_SHARDS independent swiss tables,
+ * each with its own lock. Threads only contend when they touch the
+ * same shard at the same moment, and a shard's resize stalls only
+ * that shard (1/64 of the data).
+ */
+#define CMAP_SHARDS 64
+
+typedef struct {
+    mutex_t lock;
+    StrMap map;
+    char pad[64];                       // Keep neighbouring locks off one cache line
+} Shard;
+
+typedef struct {
+    Shard shards[CMAP_SHARDS];
+} ConcurrentMap;
+
+void cmap_init(ConcurrentMap* m) {
+    for (int i = 0; i < CMAP_SHARDS; i++) {
+        mutex_init(&m->shards[i].lock);
+        strmap_init(&m->shards[i].map, 0);
+    }
+}
+
+void cmap_free(ConcurrentMap* m) {
+    for (int i = 0; i < CMAP_SHARDS; i++) {
+        strmap_free(&m->shards[i].map);
+        mutex_destroy(&m->shards[i].lock);
+    }
+}
+
+// The top bits pick the shard; the table inside uses the low ones
+static inline Shard* cmap_shard(ConcurrentMap* m, SmallKey key) {
+    return &m->shards[smallkey_hash(key) >> 58];
+}
+
+void cmap_add(ConcurrentMap* m, SmallKey key, int delta) {
+    Shard* s = cmap_shard(m, key);
+    mutex_lock(&s->lock);
+    int inserted;
+    int* v = strmap_find_or_insert(&s->map, key, &inserted);
+    *v = (inserted ? 0 : *v) + delta;
+    mutex_unlock(&s->lock);
+}
+
+int cmap_get(ConcurrentMap* m, SmallKey key, int* value) {
+    Shard* s = cmap_shard(m, key);
+    mutex_lock(&s->lock);
+    int* v = strmap_get(&s->map, key);
+    if (v) *value = *v;
+    mutex_unlock(&s->lock);
+    return v != NULL;
+}
+
+size_t cmap_count(ConcurrentMap* m) {
+    size_t n = 0;
+    for (int i = 0; i < CMAP_SHARDS; i++) {
+        mutex_lock(&m->shards[i].lock);
+        n += m->shards[i].map.count;
+        mutex_unlock(&m->shards[i].lock);
+    }
+    return n;
+}
+
+// ===== Example 1: Resize pauses =====
+
+void example_incremental(void) {
+    printf("Example 1: Incremental rehashing\n");
+    printf("--------------------------------\n");
+    const int n = 1000000;
+    IncHashTable* tables[2];
+    char key[32];
+    printf("Inserting %d keys from 16 buckets, doubling at load %.2f:\n\n", n, LOAD_FACTOR_THRESHOLD);
+    printf("  %-16s %10s %14s %14s\n", "resize", "total ms", "slowest insert", "inserts > 1ms");
+
+    for (int incremental = 0; incremental <= 1; incremental++) {
+        IncHashTable* t = inc_create(16, incremental);
+        double worst = 0, start = get_time_ms();
+        int slow = 0;
+        for (int i = 0; i < n; i++) {
+            snprintf(key, sizeof(key), "key%d", i);
+            double t0 = get_time_ms();
+            inc_insert(t, key, i);
+            double dt = get_time_ms() - t0;
+            if (dt > worst) worst = dt;
+            if (dt > 1.0) slow++;
+        }
+        double total = get_time_ms() - start;
+
+        int value, missing = 0;
+        for (int i = 0; i < n; i += 7) {
+            snprintf(key, sizeof(key), "key%d", i);
+            if (!inc_search(t, key, &value) || value != i) missing++;
+        }
+        printf("  %-16s %10.0f %12.2fms %14d%s\n", incremental ? "incremental" : "all at once",
+               total, worst, slow, missing ? "  (lookups failed!)" : "");
+        tables[incremental] = t;
+    }
+    // Freed only now: glibc tidies up a million freed nodes on a later
+    // malloc, which would land on one insert of the second run
+    inc_free(tables[0]);
+    inc_free(tables[1]);
+    printf("\nAll at once, the insert that crosses the threshold rehashes the\n");
+    printf("whole table: the last one moves 786432 nodes at once. Moving %d\n", REHASH_STEP);
+    printf("buckets per operation spreads that work over the next inserts.\n");
+}
+
+// ===== Example 2: Word frequency, multithreaded =====
+
+typedef struct {
+    char* text;
+    size_t size;
+    long words;
+} Corpus;
+
+// Zipf-distributed words from a synthetic vocabulary: a few very
+// common words, a long tail of rare ones, like real text
+Corpus make_corpus(long words, int vocabulary) {
+    Corpus c;
+    char (*vocab)[16] = malloc((size_t)vocabulary * 16);
+    double* cdf = malloc(vocabulary * sizeof(double));
+    unsigned rng = 2024;
+    double sum = 0;
+    for (int i = 0; i < vocabulary; i++) {
+        int len = 2 + (int)(xorshift(&rng) % 10);
+        for (int j = 0; j < len; j++) vocab[i][j] = (char)('a' + xorshift(&rng) % 26);
+        vocab[i][len] = '\0';
+        sum += 1.0 / (i + 1);
+        cdf[i] = sum;
+    }
+    c.text = malloc((size_t)words * 13 + 1);
+    char* p = c.text;
+    for (long w = 0; w < words; w++) {
+        double u = (xorshift(&rng) / 4294967296.0) * sum;
+        int lo = 0, hi = vocabulary - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (cdf[mid] < u) lo = mid + 1;
+            else hi = mid;
+        }
+        size_t len = strlen(vocab[lo]);
+        memcpy(p, vocab[lo], len);
+        p += len;
+        *p++ = (w % 12 == 11) ? '\n' : ' ';
+    }
+    *p = '\0';
+    c.size = (size_t)(p - c.text);
+    c.words = words;
+    free(vocab);
+    free(cdf);
+    return c;
+}
+
+int load_corpus(const char* path, Corpus* c) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    c->text = malloc((size_t)size + 1);
+    c->size = fread(c->text, 1, (size_t)size, f);
+    c->text[c->size] = '\0';
+    fclose(f);
+    // Lowercase letters only; everything else separates words
+    c->words = 0;
+    int in_word = 0;
+    for (size_t i = 0; i < c->size; i++) {
+        unsigned char ch = (unsigned char)c->text[i];
+        if (isalpha(ch)) {
+            c->text[i] = (char)tolower(ch);
+            if (!in_word) c->words++;
+            in_word = 1;
+        } else {
+            c->text[i] = ' ';
+            in_word = 0;
+        }
+    }
+    return 1;
+}
+
+enum { MODE_GLOBAL_LOCK, MODE_STRIPED, MODE_LOCAL };
+
+typedef struct {
+    const char* begin;
+    const char* end;
+    int mode;
+    mutex_t* global_lock;
+    StrMap* global_map;
+    ConcurrentMap* cmap;
+    StrMap local;
+    long words;
+} CountJob;
+
+static inline int is_word_char(char c) {
+    return c >= 'a' && c <= 'z';
+}
+
+THREAD_FUNC count_words(void* arg) {
+    CountJob* job = (CountJob*)arg;
+    const char* p = job->begin;
+    if (job->mode == MODE_LOCAL) strmap_init(&job->local, 0);
+    while (p < job->end) {
+        while (p < job->end && !is_word_char(*p)) p++;
+        const char* start = p;
+        while (p < job->end && is_word_char(*p)) p++;
+        if (p == start) break;
+        SmallKey key = smallkey_n(start, (size_t)(p - start));
+        job->words++;
+        if (job->mode == MODE_GLOBAL_LOCK) {
+            mutex_lock(job->global_lock);
+            int inserted;
+            int* v = strmap_find_or_insert(job->global_map, key, &inserted);
+            *v = (inserted ? 0 : *v) + 1;
+            mutex_unlock(job->global_lock);
+        } else if (job->mode == MODE_STRIPED) {
+            cmap_add(job->cmap, key, 1);
+        } else {
+            int inserted;
+            int* v = strmap_find_or_insert(&job->local, key, &inserted);
+            *v = (inserted ? 0 : *v) + 1;
+        }
+    }
+    THREAD_RETURN;
+}
+
+// Splits the text at word boundaries, counts, and returns the ms taken
+double run_count(Corpus* c, int threads, int mode, size_t* distinct, long* words, int* top_count) {
+    CountJob jobs[MAX_THREADS];
+    thread_t tids[MAX_THREADS];
+    mutex_t global_lock;
+    StrMap global_map;
+    ConcurrentMap* cmap = NULL;
+    mutex_init(&global_lock);
+    strmap_init(&global_map, 0);
+    if (mode == MODE_STRIPED) {
+        cmap = malloc(sizeof(ConcurrentMap));
+        cmap_init(cmap);
+    }
+
+    double start = get_time_ms();
+    const char* begin = c->text;
+    for (int i = 0; i < threads; i++) {
+        const char* end = i == threads - 1 ? c->text + c->size : c->text + c->size * (i + 1) / threads;
+        while (end < c->text + c->size && is_word_char(*end)) end++;
+        memset(&jobs[i], 0, sizeof(CountJob));
+        jobs[i].begin = begin;
+        jobs[i].end = end;
+        jobs[i].mode = mode;
+        jobs[i].global_lock = &global_lock;
+        jobs[i].global_map = &global_map;
+        jobs[i].cmap = cmap;
+        thread_create(&tids[i], count_words, &jobs[i]);
+        begin = end;
+    }
+    for (int i = 0; i < threads; i++) thread_join(tids[i]);
+
+    // Thread-local maps: merge into one at the end
+    if (mode == MODE_LOCAL) {
+        for (int i = 0; i < threads; i++) {
+            size_t it = 0;
+            StrMapSlot* s;
+            while ((s = strmap_next(&jobs[i].local, &it)) != NULL) {
+                int inserted;
+                int* v = strmap_find_or_insert(&global_map, s->key, &inserted);
+                *v = (inserted ? 0 : *v) + s->value;
+            }
+            strmap_free(&jobs[i].local);
+        }
+    }
+    double ms = get_time_ms() - start;
+
+    *words = 0;
+    for (int i = 0; i < threads; i++) *words += jobs[i].words;
+    *top_count = 0;
+    if (mode == MODE_STRIPED) {
+        *distinct = cmap_count(cmap);
+        for (int i = 0; i < CMAP_SHARDS; i++) {
+            size_t it = 0;
+            StrMapSlot* s;
+            while ((s = strmap_next(&cmap->shards[i].map, &it)) != NULL) {
+                if (s->value > *top_count) *top_count = s->value;
+            }
+        }
+        cmap_free(cmap);
+        free(cmap);
+    } else {
+        *distinct = global_map.count;
+        size_t it = 0;
+        StrMapSlot* s;
+        while ((s = strmap_next(&global_map, &it)) != NULL) {
+            if (s->value > *top_count) *top_count = s->value;
+        }
+    }
+    strmap_free(&global_map);
+    mutex_destroy(&global_lock);
+    return ms;
+}
+
+void example_word_frequency(Corpus* c) {
+    printf("\n\nExample 2: Word frequency, multithreaded\n");
+    printf("----------------------------------------\n");
+    printf("Corpus: %.1f MB, %ld words\n\n", c->size / 1048576.0, c->words);
+
+    const char* names[] = { "one global lock", "64 striped locks", "per-thread + merge" };
+    int thread_counts[] = { 1, 2, 4, 8 };
+    printf("  %-20s %7s %10s %12s %10s\n", "map", "threads", "ms", "Mwords/s", "distinct");
+
+    size_t expect_distinct = 0;
+    int expect_top = 0;
+    for (int mode = 0; mode < 3; mode++) {
+        for (int t = 0; t < 4; t++) {
+            size_t distinct;
+            long words;
+            int top;
+            double ms = run_count(c, thread_counts[t], mode, &distinct, &words, &top);
+            printf("  %-20s %7d %10.0f %12.1f %10zu\n", names[mode], thread_counts[t], ms,
+                   words / (ms * 1000.0), distinct);
+            if (mode == 0 && t == 0) {
+                expect_distinct = distinct;
+                expect_top = top;
+            } else if (distinct != expect_distinct || top != expect_top) {
+                printf("  ^ counts differ from the single-threaded run!\n");
+            }
+        }
+    }
+    printf("\nMost common word: %d occurrences (every run agrees)\n", expect_top);
+    printf("\nOne lock serializes every word. Striping lets threads update\n");
+    printf("different shards at once, but each word still takes a lock.\n");
+    printf("When the job is \"count, then read\", per-thread maps merged at\n");
+    printf("the end need no locks at all - merging %zu entries is cheap\n", expect_distinct);
+    printf("next to %ld lookups. (Threads beyond your core count only\n", c->words);
+    printf("add switching, so expect no speedup there.)\n");
+}
+
+int main(int argc, char** argv) {
+    printf("=== Growing and Sharing Hash Tables ===\n\n");
+
+    example_incremental();
+
+    Corpus corpus;
+    if (argc > 1) {
+        if (!load_corpus(argv[1], &corpus)) {
+            printf("Could not read %s\n", argv[1]);
+            return 1;
+        }
+    } else {
+        corpus = make_corpus(8000000, 200000);
+    }
+    example_word_frequency(&corpus);
+    free(corpus.text);
+
+    printf("\n\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Incremental Rehashing:
+ *
+ * Growing a hash table means rehashing every entry: O(n) work that one
+ * unlucky insert pays for. Amortized it's O(1) per insert, but a
+ * server answering that request sees a pause of n * (cost per move).
+ *
+ * Instead keep both tables for a while:
+ *
+ *   old: [0][1][2][3][4][5][6][7]       new: [0] ... [15]
+ *         ^^^^^^^^^ moved   ^ rehash_index
+ *
+ *   insert: move 2 buckets, then insert into new
+ *   lookup: move 2 buckets, check old, then new
+ *
+ * The move finishes long before the new table fills, so there are
+ * never more than two tables. Redis' dict works this way.
+ *
+ * Sharing Across Threads:
+ *
+ *   One mutex:      simple, and every operation waits in one line
+ *   Lock striping:  hash -> one of 64 shards, each with a lock and
+ *                   its own table; contention drops ~64x
+ *   No sharing:     each thread counts into its own map, then merge.
+ *                   The fastest option whenever results are only
+ *                   needed at the end (map-reduce)
+ *
+ * Lock-free readers (split-ordered lists, concurrent open addressing)
+ * remove the lock from lookups too, but need safe memory reclamation
+ * for resized tables - see Multithreading's hazard pointers and
+ * epochs.
+ */
@@ -0,0 +1,526 @@
+/*
+ * 11_bplus_tree.c
+ *
+ * B+ tree (bplus_tree.h): the ordered index that replaces the BST in
+ * 05_binary_tree.c once there are millions of keys.
+ * Demonstrates wide nodes, sorted input, bulk loading, range scans
+ * over linked leaves, rebalancing deletes, and a benchmark against
+ * the BST.
+ *
+ * Build: gcc -O2 11_bplus_tree.c -o 11_bplus_tree
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bplus_tree.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <time.h>
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+// ===== 05's BST, for comparison (iterative: sorted input is deep) =====
+
+typedef struct TreeNode {
+    int data;
+    struct TreeNode* left;
+    struct TreeNode* right;
+} TreeNode;
+
+TreeNode* bst_insert(TreeNode* root, int data) {
+    TreeNode* node = (TreeNode*)malloc(sizeof(TreeNode));
+    node->data = data;
+    node->left = node->right = NULL;
+    if (root == NULL) return node;
+    TreeNode* cur = root;
+    for (;;) {
+        TreeNode** next = data < cur->data ? &cur->left : &cur->right;
+        if (data == cur->data) {
+            free(node);
+            return root;
+        }
+        if (*next == NULL) {
+            *next = node;
+            return root;
+        }
+        cur = *next;
+    }
+}
+
+TreeNode* bst_search(TreeNode* root, int target) {
+    while (root != NULL && root->data != target) {
+        root = target < root->data ? root->left : root->right;
+    }
+    return root;
+}
+
+int bst_height(TreeNode* root) {
+    // Iterative BFS: recursion would overflow on a skewed tree
+    if (!root) return 0;
+    size_t cap = 1024, head = 0, tail = 0;
+    TreeNode** queue = malloc(cap * sizeof(TreeNode*));
+    int* depth = malloc(cap * sizeof(int));
+    int height = 0;
+    queue[tail] = root;
+    depth[tail++] = 1;
+    while (head < tail) {
+        TreeNode* n = queue[head];
+        int d = depth[head++];
+        if (d > height) height = d;
+        TreeNode* kids[2] = { n->left, n->right };
+        for (int k = 0; k < 2; k++) {
+            if (!kids[k]) continue;
+            if (tail == cap) {
+                cap *= 2;
+                queue = realloc(queue, cap * sizeof(TreeNode*));
+                depth = realloc(depth, cap * sizeof(int));
+            }
+            queue[tail] = kids[k];
+            depth[tail++] = d + 1;
+        }
+    }
+    free(queue);
+    free(depth);
+    return height;
+}
+
+// Sum of keys in [lo, hi): the inorder walk, pruned
+long long bst_range_sum(TreeNode* root, int lo, int hi) {
+    if (root == NULL) return 0;
+    long long sum = 0;
+    if (lo < root->data) sum += bst_range_sum(root->left, lo, hi);
+    if (root->data >= lo && root->data < hi) sum += root->data;
+    if (root->data < hi) sum += bst_range_sum(root->right, lo, hi);
+    return sum;
+}
+
+void bst_free(TreeNode* root) {
+    // Rotate left children up instead of recursing 20000 deep
+    while (root != NULL) {
+        if (root->left) {
+            TreeNode* left = root->left;
+            root->left = left->right;
+            left->right = root;
+            root = left;
+        } else {
+            TreeNode* right = root->right;
+            free(root);
+            root = right;
+        }
+    }
+}
+
+// ===== Helpers =====
+
+static unsigned xorshift(unsigned* state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+void shuffle(int* a, int n, unsigned seed) {
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(xorshift(&seed) % (unsigned)(i + 1));
+        int t = a[i];
+        a[i] = a[j];
+        a[j] = t;
+    }
+}
+
+// Checks every B+ tree invariant; returns the number of keys, -1 if broken
+long check_node(void* node, int level, int is_root, BptKey lo, BptKey hi, int has_lo, int has_hi) {
+    if (level == 0) {
+        BptLeaf* leaf = (BptLeaf*)node;
+        if (!is_root && leaf->count < BPT_MIN_LEAF) return -1;
+        for (int i = 0; i < leaf->count; i++) {
+            if (i > 0 && leaf->keys[i - 1] >= leaf->keys[i]) return -1;
+            if ((has_lo && leaf->keys[i] < lo) || (has_hi && leaf->keys[i] >= hi)) return -1;
+        }
+        return leaf->count;
+    }
+    BptInner* inner = (BptInner*)node;
+    if (!is_root && inner->count < BPT_MIN_INNER) return -1;
+    long total = 0;
+    for (int i = 0; i <= inner->count; i++) {
+        if (i < inner->count - 1 && inner->keys[i] >= inner->keys[i + 1]) return -1;
+        long n = check_node(inner->children[i], level - 1, 0,
+                            i > 0 ? inner->keys[i - 1] : lo, i < inner->count ? inner->keys[i] : hi,
+                            i > 0 || has_lo, i < inner->count || has_hi);
+        if (n < 0) return -1;
+        total += n;
+    }
+    return total;
+}
+
+int check_tree(const BPlusTree* t) {
+    long n = check_node(t->root, t->height, 1, 0, 0, 0, 0);
+    if (n != (long)t->count) return 0;
+    // The leaf chain visits every key once, in order
+    long seen = 0;
+    BptKey prev = 0;
+    for (BptIter it = bpt_first(t); bpt_iter_valid(&it); bpt_iter_next(&it)) {
+        if (seen > 0 && bpt_iter_key(&it) <= prev) return 0;
+        prev = bpt_iter_key(&it);
+        seen++;
+    }
+    return seen == n;
+}
+
+void print_stats(const char* label, const BPlusTree* t) {
+    printf("  %-22s height %d, %zu leaves, %zu inner, %4.0f%% full\n", label, t->height + 1,
+           t->leaves, t->inners, bpt_fill(t) * 100);
+}
+
+// ===== Examples =====
+
+void example_structure(void) {
+    printf("Example 1: Wide nodes\n");
+    printf("---------------------\n");
+    printf("Node size: leaf %zu bytes, inner %zu bytes, %d keys each\n\n",
+           sizeof(BptLeaf), sizeof(BptInner), BPT_MAX);
+
+    BPlusTree t;
+    bpt_init(&t);
+    for (int i = 1; i <= 300; i++) bpt_insert(&t, i * 10, i);
+
+    BptInner* root = (BptInner*)t.root;
+    printf("300 keys (10, 20, ... 3000):\n");
+    printf("  root separators:");
+    for (int i = 0; i < root->count; i++) printf(" %d", root->keys[i]);
+    printf("\n  leaves:");
+    for (BptLeaf* leaf = (BptLeaf*)root->children[0]; leaf; leaf = leaf->next) {
+        printf(" [%d..%d]", leaf->keys[0], leaf->keys[leaf->count - 1]);
+    }
+    printf("\n\n");
+
+    BptValue v = 0;
+    int found = bpt_find(&t, 1230, &v);
+    printf("find 1230: %s (value %lld)\n", found ? "found" : "missing", (long long)v);
+    printf("find 1235: %s\n", bpt_find(&t, 1235, &v) ? "found" : "missing");
+    printf("\nOne root and a handful of leaves. Two million keys need just\n");
+    printf("four levels (Example 6).\n");
+    bpt_free(&t);
+}
+
+void example_sorted_input(void) {
+    printf("\n\nExample 2: Sorted input\n");
+    printf("-----------------------\n");
+    const int n = 20000;
+    TreeNode* bst = NULL;
+    BPlusTree t;
+    bpt_init(&t);
+    for (int i = 0; i < n; i++) {
+        bst = bst_insert(bst, i);
+        bpt_insert(&t, i, i);
+    }
+    printf("Inserting 0..%d in order:\n", n - 1);
+    printf("  %-22s height %d\n", "BST", bst_height(bst));
+    print_stats("B+ tree", &t);
+
+    double start = get_time_ms();
+    long bst_found = 0, bpt_found = 0;
+    for (int i = 0; i < n; i += 10) bst_found += bst_search(bst, i) != NULL;
+    double bst_ms = get_time_ms() - start;
+    start = get_time_ms();
+    for (int i = 0; i < n; i += 10) bpt_found += bpt_find(&t, i, NULL);
+    double bpt_ms = get_time_ms() - start;
+    printf("\n%d searches: BST %.1f ms, B+ tree %.2f ms (found %ld / %ld)\n", n / 10, bst_ms, bpt_ms,
+           bst_found, bpt_found);
+    printf("\nThe BST is a linked list. The B+ tree stays balanced, but each\n");
+    printf("split leaves the left half behind for good: nodes end up half full.\n");
+    bst_free(bst);
+    bpt_free(&t);
+}
+
+void example_bulk_load(void) {
+    printf("\n\nExample 3: Bulk loading\n");
+    printf("-----------------------\n");
+    const int n = 2000000;
+    BptKey* keys = malloc(n * sizeof(BptKey));
+    BptValue* values = malloc(n * sizeof(BptValue));
+    for (int i = 0; i < n; i++) {
+        keys[i] = i * 2;
+        values[i] = i;
+    }
+
+    BPlusTree t;
+    bpt_init(&t);
+    double start = get_time_ms();
+    for (int i = 0; i < n; i++) bpt_insert(&t, keys[i], values[i]);
+    double insert_ms = get_time_ms() - start;
+    printf("%d sorted keys:\n", n);
+    print_stats("one insert at a time", &t);
+
+    start = get_time_ms();
+    bpt_bulk_load(&t, keys, values, n);
+    double bulk_ms = get_time_ms() - start;
+    print_stats("bulk load", &t);
+    printf("\n  inserts %.0f ms, bulk load %.0f ms, tree %s\n", insert_ms, bulk_ms,
+           check_tree(&t) ? "valid" : "BROKEN");
+    printf("\nBulk loading copies whole runs into leaves and builds each level\n");
+    printf("from the one below: no searches, no splits, half the memory.\n");
+
+    bpt_free(&t);
+    free(keys);
+    free(values);
+}
+
+void example_range_scan(void) {
+    printf("\n\nExample 4: Range scans over linked leaves\n");
+    printf("-----------------------------------------\n");
+    const int n = 1000000;
+    int* order = malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) order[i] = i;
+    shuffle(order, n, 7);
+
+    TreeNode* bst = NULL;
+    BPlusTree t;
+    bpt_init(&t);
+    for (int i = 0; i < n; i++) {
+        bst = bst_insert(bst, order[i]);
+        bpt_insert(&t, order[i], order[i]);
+    }
+
+    printf("Sum of keys in [lo, lo + width), 1M random keys:\n\n");
+    printf("  %8s %14s %14s %12s\n", "width", "BST ms", "B+ tree ms", "sums match");
+    int widths[] = { 100, 10000, 1000000 };
+    for (int w = 0; w < 3; w++) {
+        int queries = 25000000 / (widths[w] + 1000);
+        unsigned rng = 99;
+        long long bst_sum = 0, bpt_sum = 0;
+        double start = get_time_ms();
+        for (int q = 0; q < queries; q++) {
+            int lo = (int)(xorshift(&rng) % n);
+            bst_sum += bst_range_sum(bst, lo, lo + widths[w]);
+        }
+        double bst_ms = get_time_ms() - start;
+
+        rng = 99;
+        start = get_time_ms();
+        for (int q = 0; q < queries; q++) {
+            int lo = (int)(xorshift(&rng) % n);
+            for (BptIter it = bpt_lower_bound(&t, lo); bpt_iter_valid(&it) && bpt_iter_key(&it) < lo + widths[w];
+                 bpt_iter_next(&it)) {
+                bpt_sum += bpt_iter_key(&it);
+            }
+        }
+        double bpt_ms = get_time_ms() - start;
+        printf("  %8d %14.1f %14.1f %12s   (%d queries)\n", widths[w], bst_ms, bpt_ms,
+               bst_sum == bpt_sum ? "yes" : "NO", queries);
+    }
+    printf("\nOne descent finds the first key; after that it's an array walk,\n");
+    printf("hopping to the next leaf every %d keys. The BST's inorder walk\n", BPT_MAX);
+    printf("chases a pointer per key.\n");
+
+    bst_free(bst);
+    bpt_free(&t);
+    free(order);
+}
+
+void example_delete(void) {
+    printf("\n\nExample 5: Deletes rebalance\n");
+    printf("----------------------------\n");
+    const int n = 500000;
+    int* order = malloc(n * sizeof(int));
+    unsigned char* present = calloc(n, 1);
+    for (int i = 0; i < n; i++) order[i] = i;
+    shuffle(order, n, 11);
+
+    BPlusTree t;
+    bpt_init(&t);
+    for (int i = 0; i < n; i++) {
+        bpt_insert(&t, order[i], i);
+        present[order[i]] = 1;
+    }
+    print_stats("500000 keys", &t);
+
+    // Delete 90% in random order, mixing in some re-inserts
+    shuffle(order, n, 12);
+    unsigned rng = 5;
+    for (int i = 0; i < n * 9 / 10; i++) {
+        if (bpt_remove(&t, order[i]) != present[order[i]]) printf("  remove %d: wrong result\n", order[i]);
+        present[order[i]] = 0;
+        if (i % 8 == 0) {
+            int k = (int)(xorshift(&rng) % n);
+            if (bpt_insert(&t, k, k) == present[k]) printf("  insert %d: wrong result\n", k);
+            present[k] = 1;
+        }
+    }
+    size_t expect = 0;
+    int mismatches = 0;
+    for (int i = 0; i < n; i++) {
+        expect += present[i];
+        if (bpt_find(&t, i, NULL) != present[i]) mismatches++;
+    }
+    print_stats("after deleting 90%", &t);
+    printf("\n  %zu keys (expected %zu), %d lookup mismatches, tree %s\n", t.count, expect,
+           mismatches, check_tree(&t) ? "valid" : "BROKEN");
+
+    for (int i = 0; i < n; i++) bpt_remove(&t, i);
+    print_stats("after deleting all", &t);
+    printf("\nAn underfull node borrows a key from a sibling, or merges with\n");
+    printf("it; a root with one child is removed. Nodes never drop below\n");
+    printf("half full, so the tree shrinks as it empties.\n");
+
+    bpt_free(&t);
+    free(order);
+    free(present);
+}
+
+// What bpt_count_less replaces: a branchy binary search
+static int binary_count_less(const BptKey* keys, int n, BptKey target) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (keys[mid] < target) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+void example_benchmark(void) {
+    printf("\n\nExample 6: Benchmark\n");
+    printf("--------------------\n");
+
+    // In-node search alone: 64 sorted keys, random targets
+    BptKey node_keys[BPT_MAX];
+    for (int i = 0; i < BPT_MAX; i++) node_keys[i] = i * 4;
+    const int searches = 20000000;
+    unsigned rng = 3;
+    volatile int sink = 0;
+    double start = get_time_ms();
+    for (int i = 0; i < searches; i++) {
+        sink += binary_count_less(node_keys, BPT_MAX, (BptKey)(xorshift(&rng) % (BPT_MAX * 4)));
+    }
+    double binary_ms = get_time_ms() - start;
+    rng = 3;
+    start = get_time_ms();
+    for (int i = 0; i < searches; i++) {
+        sink += bpt_count_less(node_keys, BPT_MAX, (BptKey)(xorshift(&rng) % (BPT_MAX * 4)));
+    }
+    double simd_ms = get_time_ms() - start;
+    printf("Searching one %d-key node: binary search %.1f ns, %s %.1f ns\n\n", BPT_MAX,
+           binary_ms * 1e6 / searches,
+#ifdef BPT_SSE2
+           "SSE2 count",
+#else
+           "bpt_count_less",
+#endif
+           simd_ms * 1e6 / searches);
+
+    const int n = 2000000;
+    int* keys = malloc(n * sizeof(int));
+    int* probes = malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) keys[i] = i * 3;
+    shuffle(keys, n, 21);
+    rng = 77;
+    for (int i = 0; i < n; i++) probes[i] = (int)(xorshift(&rng) % (unsigned)(n * 3));
+
+    printf("%d random keys:\n\n", n);
+    printf("  %-10s %12s %14s %10s\n", "", "insert ns", "lookup ns", "MB");
+
+    start = get_time_ms();
+    TreeNode* bst = NULL;
+    for (int i = 0; i < n; i++) bst = bst_insert(bst, keys[i]);
+    double bst_insert_ms = get_time_ms() - start;
+    long found = 0;
+    start = get_time_ms();
+    for (int i = 0; i < n; i++) found += bst_search(bst, probes[i]) != NULL;
+    double bst_lookup_ms = get_time_ms() - start;
+    printf("  %-10s %12.0f %14.0f %10.0f   (height %d)\n", "BST", bst_insert_ms * 1e6 / n,
+           bst_lookup_ms * 1e6 / n, n * 32.0 / 1048576, bst_height(bst));
+    bst_free(bst);
+
+    BPlusTree t;
+    bpt_init(&t);
+    start = get_time_ms();
+    for (int i = 0; i < n; i++) bpt_insert(&t, keys[i], i);
+    double bpt_insert_ms = get_time_ms() - start;
+    long found2 = 0;
+    start = get_time_ms();
+    for (int i = 0; i < n; i++) found2 += bpt_find(&t, probes[i], NULL);
+    double bpt_lookup_ms = get_time_ms() - start;
+    printf("  %-10s %12.0f %14.0f %10.0f   (height %d)\n", "B+ tree", bpt_insert_ms * 1e6 / n,
+           bpt_lookup_ms * 1e6 / n,
+           (t.leaves * sizeof(BptLeaf) + t.inners * sizeof(BptInner)) / 1048576.0, t.height + 1);
+    printf("\n  Both found %ld of %d (%s)\n", found, n, found == found2 ? "agree" : "DISAGREE");
+    printf("\nThe BST with random keys is balanced enough (height ~2.5 log n),\n");
+    printf("but every level is another cache miss. The B+ tree touches %d\n", t.height + 1);
+    printf("nodes, reading a few adjacent cache lines in each. (The BST's MB\n");
+    printf("counts 24 bytes + malloc's 8-byte header per node.)\n");
+    bpt_free(&t);
+    free(keys);
+    free(probes);
+}
+
+int main(void) {
+    printf("=== B+ Tree ===\n\n");
+
+    example_structure();
+    example_sorted_input();
+    example_bulk_load();
+    example_range_scan();
+    example_delete();
+    example_benchmark();
+
+    printf("\n\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Why Wide Nodes:
+ *
+ * A search costs one memory access per level. Main memory answers in
+ * ~100 ns; once there, the next few cache lines are nearly free.
+ *
+ *   BST, 1M keys:      ~50 levels x 1 key     = ~50 misses
+ *   B+ tree, 64 keys:   4 levels x 4 lines    = ~4 misses (+ prefetched lines)
+ *
+ * Node size is the tuning knob. Bigger nodes mean fewer levels but
+ * more keys to search per node:
+ *   - in memory: a few cache lines (here 64 x 4-byte keys = 256 bytes)
+ *   - on disk: a page (4-16 KB), since one read fetches the whole page
+ *
+ * B+ vs B tree: a B tree keeps values in inner nodes too. A B+ tree
+ * keeps them only in leaves, so inner nodes fit more keys (more fan-
+ * out, fewer levels) and the leaves form one sorted linked list - a
+ * range scan is a search followed by an array walk.
+ *
+ * Searching a node: binary search on 64 keys is 6 unpredictable
+ * branches (~half mispredicted, ~15 cycles each). Comparing all 64
+ * with SSE2 and counting the keys < target is 16 instructions, no
+ * branches:
+ *
+ *   keys   [ 3  8 12 17 ]   target 10
+ *   k < t  [ -1 -1  0  0 ]  subtract from accumulator -> 2 keys < 10
+ *
+ * Keeping it balanced:
+ *   insert into a full node  -> split in two, push a key up
+ *   delete from a half node  -> borrow from a sibling, or merge
+ *   root splits              -> tree grows a level on top
+ *   root down to one child   -> tree loses a level
+ * All leaves stay at the same depth: height is log_32(n) to log_64(n).
+ *
+ * Try:
+ * - Compile with -DBPT_MAX=16 or -DBPT_MAX=256 and rerun the benchmark
+ * - Compile with -DBPT_NO_SIMD (binary search in nodes)
+ * - Split 90/10 instead of 50/50 when inserting at the end of the
+ *   rightmost leaf, and rerun Example 2
+ */
@@ -0,0 +1,385 @@
+/*
+ * 12_csr_graph.c
+ *
+ * CSR graph (csr_graph.h): the bulk-built, cache-friendly replacement
+ * for the linked adjacency lists in 07_graph.c.
+ * Demonstrates the CSR layout, iterative DFS on a million-vertex path,
+ * a BFS comparison against 07's lists, and direction-optimizing BFS on
+ * multiple threads.
+ *
+ * Build: gcc -O2 12_csr_graph.c csr_graph.c -o 12_csr_graph -pthread
+ * Run:   12_csr_graph [scale]   (RMAT graph with 2^scale vertices, default 20)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "csr_graph.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <time.h>
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+// ===== 07's adjacency lists, for comparison =====
+
+typedef struct Node {
+    int vertex;
+    struct Node* next;
+} Node;
+
+typedef struct Graph {
+    int num_vertices;
+    Node** adj_lists;
+} Graph;
+
+Graph* list_graph_from_edges(int n, const CsrEdge* edges, int64_t m) {
+    Graph* graph = (Graph*)malloc(sizeof(Graph));
+    graph->num_vertices = n;
+    graph->adj_lists = (Node**)calloc(n, sizeof(Node*));
+    for (int64_t i = 0; i < m; i++) {
+        int ends[2] = { edges[i].src, edges[i].dst };
+        for (int k = 0; k < 2; k++) {
+            Node* node = (Node*)malloc(sizeof(Node));
+            node->vertex = ends[1 - k];
+            node->next = graph->adj_lists[ends[k]];
+            graph->adj_lists[ends[k]] = node;
+        }
+    }
+    return graph;
+}
+
+int list_bfs(Graph* graph, int start, int* depth) {
+    int* queue = (int*)malloc(graph->num_vertices * sizeof(int));
+    int head = 0, tail = 0;
+    for (int i = 0; i < graph->num_vertices; i++) depth[i] = -1;
+    depth[start] = 0;
+    queue[tail++] = start;
+    while (head < tail) {
+        int v = queue[head++];
+        for (Node* cur = graph->adj_lists[v]; cur != NULL; cur = cur->next) {
+            if (depth[cur->vertex] < 0) {
+                depth[cur->vertex] = depth[v] + 1;
+                queue[tail++] = cur->vertex;
+            }
+        }
+    }
+    free(queue);
+    return tail;
+}
+
+void free_list_graph(Graph* graph) {
+    for (int i = 0; i < graph->num_vertices; i++) {
+        Node* cur = graph->adj_lists[i];
+        while (cur != NULL) {
+            Node* next = cur->next;
+            free(cur);
+            cur = next;
+        }
+    }
+    free(graph->adj_lists);
+    free(graph);
+}
+
+// ===== Graph generators =====
+
+static unsigned long long rng_state = 88172645463325252ull;
+
+static unsigned long long next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+/*
+ * RMAT (Graph500): each edge picks a quadrant of the adjacency matrix
+ * per bit of the vertex id, with probabilities a=0.57, b=c=0.19,
+ * d=0.05. The result has a power-law degree distribution and a small
+ * diameter, like social and web graphs. Vertex ids are shuffled so
+ * the hubs aren't all at low ids.
+ */
+CsrEdge* make_rmat(int scale, int edge_factor, int64_t* m_out) {
+    int n = 1 << scale;
+    int64_t m = (int64_t)n * edge_factor;
+    CsrEdge* edges = (CsrEdge*)malloc((size_t)m * sizeof(CsrEdge));
+    int* perm = (int*)malloc((size_t)n * sizeof(int));
+    for (int i = 0; i < n; i++) perm[i] = i;
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(next_random() % (unsigned long long)(i + 1));
+        int t = perm[i];
+        perm[i] = perm[j];
+        perm[j] = t;
+    }
+    for (int64_t i = 0; i < m; i++) {
+        int src = 0, dst = 0;
+        for (int bit = 0; bit < scale; bit++) {
+            unsigned r = (unsigned)(next_random() % 100);
+            int down = r >= 57 + 19;    // Quadrants c, d
+            int right = (r >= 57 && r < 57 + 19) || r >= 57 + 19 + 19;  // b, d
+            src |= down << bit;
+            dst |= right << bit;
+        }
+        edges[i].src = perm[src];
+        edges[i].dst = perm[dst];
+    }
+    free(perm);
+    *m_out = m;
+    return edges;
+}
+
+// side x side grid: every vertex linked to its right and lower neighbour
+CsrEdge* make_grid(int side, int64_t* m_out) {
+    CsrEdge* edges = (CsrEdge*)malloc((size_t)side * side * 2 * sizeof(CsrEdge));
+    int64_t m = 0;
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            int v = r * side + c;
+            if (c + 1 < side) edges[m++] = (CsrEdge){ v, v + 1 };
+            if (r + 1 < side) edges[m++] = (CsrEdge){ v, v + side };
+        }
+    }
+    *m_out = m;
+    return edges;
+}
+
+int max_degree_vertex(const CsrGraph* g) {
+    int best = 0;
+    for (int v = 1; v < g->num_vertices; v++) {
+        if (csr_degree(g, v) > csr_degree(g, best)) best = v;
+    }
+    return best;
+}
+
+// ===== Examples =====
+
+void example_layout(void) {
+    printf("Example 1: CSR layout\n");
+    printf("---------------------\n");
+    printf("07's graph, built from an edge list:\n\n");
+    printf("     0 --- 1\n");
+    printf("     |     |\n");
+    printf("     2 --- 3\n");
+    printf("     |\n");
+    printf("     4 --- 5\n\n");
+
+    CsrEdge edges[] = { {0, 1}, {0, 2}, {1, 3}, {2, 3}, {2, 4}, {4, 5} };
+    CsrGraph g;
+    csr_build(&g, 6, edges, 6, 1);
+
+    printf("  offsets:  ");
+    for (int v = 0; v <= g.num_vertices; v++) printf("%lld ", (long long)g.offsets[v]);
+    printf("\n  neighbors:");
+    for (int v = 0; v < g.num_vertices; v++) {
+        printf(" |");
+        for (int64_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) printf(" %d", g.neighbors[e]);
+    }
+    printf("\n\n");
+
+    int order[6], depth[6];
+    int count = csr_dfs(&g, 0, order);
+    printf("DFS from 0: ");
+    for (int i = 0; i < count; i++) printf("%d ", order[i]);
+    csr_bfs(&g, 0, depth, 1, CSR_BFS_AUTO, NULL);
+    printf("\nBFS depth from 0: ");
+    for (int v = 0; v < 6; v++) printf("%d:%d ", v, depth[v]);
+    printf("\nPath 1 -> 5: %s\n", csr_has_path(&g, 1, 5) ? "yes" : "no");
+    csr_free(&g);
+
+    CsrEdge split[] = { {0, 1}, {2, 3} };
+    int label[5];
+    csr_build(&g, 5, split, 2, 1);
+    printf("\n0 --- 1     2 --- 3     4:  %d components, ", csr_components(&g, label));
+    printf("path 0 -> 3: %s\n", csr_has_path(&g, 0, 3) ? "yes" : "no");
+    csr_free(&g);
+}
+
+void example_deep_path(void) {
+    printf("\n\nExample 2: No recursion\n");
+    printf("-----------------------\n");
+    const int n = 2000000;
+    CsrEdge* edges = (CsrEdge*)malloc((n - 1) * sizeof(CsrEdge));
+    for (int i = 0; i < n - 1; i++) edges[i] = (CsrEdge){ i, i + 1 };
+    CsrGraph g;
+    csr_build(&g, n, edges, n - 1, 1);
+    free(edges);
+
+    int* order = (int*)malloc(n * sizeof(int));
+    int* label = (int*)malloc(n * sizeof(int));
+    printf("A path of %d vertices: 0 - 1 - 2 - ... - %d\n\n", n, n - 1);
+    printf("  DFS visited %d vertices\n", csr_dfs(&g, 0, order));
+    printf("  has_path(0, %d): %s\n", n - 1, csr_has_path(&g, 0, n - 1) ? "yes" : "no");
+    printf("  components: %d\n", csr_components(&g, label));
+    printf("\n07's recursive dfs_helper would need %d nested calls here and\n", n);
+    printf("crash with a stack overflow. An explicit stack lives on the heap.\n");
+    free(order);
+    free(label);
+    csr_free(&g);
+}
+
+void example_vs_lists(void) {
+    printf("\n\nExample 3: CSR vs linked adjacency lists\n");
+    printf("----------------------------------------\n");
+    int64_t m;
+    CsrEdge* edges = make_rmat(18, 16, &m);
+    int n = 1 << 18;
+
+    double start = get_time_ms();
+    Graph* lists = list_graph_from_edges(n, edges, m);
+    double list_build = get_time_ms() - start;
+    start = get_time_ms();
+    CsrGraph g;
+    csr_build(&g, n, edges, m, 1);
+    double csr_build_ms = get_time_ms() - start;
+    free(edges);
+
+    int source = max_degree_vertex(&g);
+    int* depth_list = (int*)malloc(n * sizeof(int));
+    int* depth_csr = (int*)malloc(n * sizeof(int));
+    start = get_time_ms();
+    int reached = list_bfs(lists, source, depth_list);
+    double list_ms = get_time_ms() - start;
+    start = get_time_ms();
+    csr_bfs(&g, source, depth_csr, 1, CSR_BFS_TOP_DOWN, NULL);
+    double csr_ms = get_time_ms() - start;
+
+    printf("RMAT graph: %d vertices, %lld edges, BFS reaches %d\n\n", n, (long long)m, reached);
+    printf("  %-16s %10s %10s %10s\n", "", "build ms", "BFS ms", "MB");
+    printf("  %-16s %10.0f %10.1f %10.0f\n", "linked lists", list_build, list_ms,
+           (2.0 * m * (sizeof(Node) + 8) + n * sizeof(Node*)) / 1048576);
+    printf("  %-16s %10.0f %10.1f %10.0f\n", "CSR", csr_build_ms, csr_ms,
+           ((double)g.num_edges * sizeof(int) + (n + 1) * sizeof(int64_t)) / 1048576);
+    printf("\n  Depths agree: %s\n", memcmp(depth_list, depth_csr, n * sizeof(int)) == 0 ? "yes" : "NO");
+    printf("\nBoth are the same top-down BFS on one thread. The lists chase a\n");
+    printf("pointer per edge (each Node plus malloc's header); CSR reads each\n");
+    printf("vertex's neighbours as one run of ints. CSR's build also sorts and\n");
+    printf("de-duplicates, which the lists skip (they keep %lld duplicates).\n",
+           (long long)(2 * m - g.num_edges));
+
+    free(depth_list);
+    free(depth_csr);
+    free_list_graph(lists);
+    csr_free(&g);
+}
+
+void run_bfs_table(const CsrGraph* g, int source) {
+    int n = g->num_vertices;
+    int* reference = (int*)malloc(n * sizeof(int));
+    int* depth = (int*)malloc(n * sizeof(int));
+    csr_bfs(g, source, reference, 1, CSR_BFS_TOP_DOWN, NULL);
+
+    int cpus = csr_cpu_count();
+    int thread_counts[] = { 1, 2, 4, 8 };
+    printf("  %-18s %7s %9s %12s %8s %10s\n", "mode", "threads", "ms", "edges read", "levels", "bottom-up");
+    for (int mode = 0; mode < 2; mode++) {
+        for (int t = 0; t < 4; t++) {
+            if (thread_counts[t] > 1 && thread_counts[t] > cpus * 2) break;
+            CsrBfsStats stats;
+            double start = get_time_ms();
+            csr_bfs(g, source, depth, thread_counts[t], mode == 0 ? CSR_BFS_TOP_DOWN : CSR_BFS_AUTO, &stats);
+            double ms = get_time_ms() - start;
+            printf("  %-18s %7d %9.1f %12lld %8d %10d%s\n", mode == 0 ? "top-down" : "direction-optimizing",
+                   thread_counts[t], ms, (long long)stats.edges_checked, stats.levels, stats.bottom_up_levels,
+                   memcmp(depth, reference, n * sizeof(int)) == 0 ? "" : "  (depths differ!)");
+        }
+    }
+    free(reference);
+    free(depth);
+}
+
+void example_direction_optimizing(int scale) {
+    printf("\n\nExample 4: Direction-optimizing parallel BFS\n");
+    printf("--------------------------------------------\n");
+    int64_t m;
+    CsrEdge* edges = make_rmat(scale, 16, &m);
+    CsrGraph g;
+    csr_build(&g, 1 << scale, edges, m, 1);
+    free(edges);
+    printf("RMAT scale %d: %d vertices, %lld adjacency entries, %d CPUs\n\n", scale, g.num_vertices,
+           (long long)g.num_edges, csr_cpu_count());
+    run_bfs_table(&g, max_degree_vertex(&g));
+    csr_free(&g);
+
+    int side = 1000;
+    edges = make_grid(side, &m);
+    csr_build(&g, side * side, edges, m, 1);
+    free(edges);
+    printf("\n%dx%d grid: every frontier is small, so it stays top-down\n\n", side, side);
+    run_bfs_table(&g, 0);
+    csr_free(&g);
+
+    printf("\nOn the RMAT graph two or three middle levels hold most vertices.\n");
+    printf("Bottom-up, an unvisited vertex stops at its first neighbour in the\n");
+    printf("frontier, so most edges are never read. On the grid the frontier is\n");
+    printf("a thin diagonal for %d levels; each level is too little work to\n", 2 * side - 2);
+    printf("split well, and threads mostly wait at the barrier.\n");
+}
+
+int main(int argc, char** argv) {
+    printf("=== CSR Graph ===\n\n");
+    int scale = argc > 1 ? atoi(argv[1]) : 20;
+    if (scale < 10 || scale > 28) scale = 20;
+
+    example_layout();
+    example_deep_path();
+    example_vs_lists();
+    example_direction_optimizing(scale);
+
+    printf("\n\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Compressed Sparse Row:
+ *
+ * Adjacency lists, without the lists. Vertex v's neighbours are
+ * neighbors[offsets[v]] up to neighbors[offsets[v + 1]]:
+ *
+ *   offsets:   0     2     4        7     9     11 12
+ *   neighbors: 1  2  0  3  0  3  4  1  2  2  5  4
+ *              --0-- --1-- ---2---  --3-- --4-- -5-
+ *
+ * Building from an edge list is two passes, like a counting sort:
+ *   1. count each vertex's degree; prefix sums give offsets
+ *   2. write each edge at its source's next free position
+ * O(V + E) with no per-edge malloc. The price: the graph is read-only.
+ * Adding edges means rebuilding (or batching changes).
+ *
+ * Direction-Optimizing BFS:
+ *
+ *   top-down:   for u in frontier: for v in nbrs(u): if !visited(v) claim v
+ *   bottom-up:  for v not visited: for u in nbrs(v): if u in frontier
+ *                                                   { claim v; break; }
+ *
+ * Top-down reads every edge of the frontier. Bottom-up reads the edges
+ * of unvisited vertices, but stops early. Switch to bottom-up when the
+ * frontier's edges exceed 1/15 of the unexplored edges; switch back
+ * once the frontier drops under 1/18 of the vertices.
+ *
+ * In parallel: threads grab chunks of the frontier (top-down) and claim
+ * vertices with an atomic OR on the visited bitmap. Bottom-up, each
+ * thread owns whole 64-vertex bitmap words, so no atomics are needed.
+ * A barrier separates levels.
+ *
+ * Iterative DFS: push (vertex, next edge) instead of recursing. The
+ * order is exactly what the recursive version prints.
+ *
+ * Try:
+ * - Change BFS_ALPHA / BFS_BETA in csr_graph.c and watch edges read
+ * - Run with scale 22 or 24 (4M-16M vertices) on a multi-core machine
+ * - Return parents instead of depths (a BFS tree)
+ */
@@ -0,0 +1,389 @@
+/*
+ * 13_shortest_paths.c
+ *
+ * Weighted shortest paths and incremental connectivity on CSR graphs
+ * (graph_algos.h). Demonstrates Dijkstra with three priority queues,
+ * parallel delta-stepping, A* point-to-point queries against plain
+ * Dijkstra, and union-find against recomputing components.
+ *
+ * Build: gcc -O2 13_shortest_paths.c graph_algos.c csr_graph.c -o 13_shortest_paths -pthread
+ * Run:   13_shortest_paths [scale]   (RMAT graph with 2^scale vertices, default 18)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph_algos.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <time.h>
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+// ===== Graph generators =====
+
+static unsigned long long rng_state = 88172645463325252ull;
+
+static unsigned long long next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// RMAT as in 12_csr_graph.c, with weights 1..255
+CsrWeightedEdge* make_rmat(int scale, int edge_factor, int64_t* m_out) {
+    int n = 1 << scale;
+    int64_t m = (int64_t)n * edge_factor;
+    CsrWeightedEdge* edges = (CsrWeightedEdge*)malloc((size_t)m * sizeof(CsrWeightedEdge));
+    int* perm = (int*)malloc((size_t)n * sizeof(int));
+    for (int i = 0; i < n; i++) perm[i] = i;
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(next_random() % (unsigned long long)(i + 1));
+        int t = perm[i];
+        perm[i] = perm[j];
+        perm[j] = t;
+    }
+    for (int64_t i = 0; i < m; i++) {
+        int src = 0, dst = 0;
+        for (int bit = 0; bit < scale; bit++) {
+            unsigned r = (unsigned)(next_random() % 100);
+            int down = r >= 57 + 19;
+            int right = (r >= 57 && r < 57 + 19) || r >= 57 + 19 + 19;
+            src |= down << bit;
+            dst |= right << bit;
+        }
+        edges[i].src = perm[src];
+        edges[i].dst = perm[dst];
+        edges[i].weight = 1 + (uint32_t)(next_random() % 255);
+    }
+    free(perm);
+    *m_out = m;
+    return edges;
+}
+
+/*
+ * side x side grid, weights 10..19: a road-map stand-in. Every step
+ * costs at least 10, so 10 x (Manhattan distance) never overestimates
+ * and is a valid A* heuristic.
+ */
+CsrWeightedEdge* make_grid(int side, int64_t* m_out) {
+    CsrWeightedEdge* edges = (CsrWeightedEdge*)malloc((size_t)side * side * 2 * sizeof(CsrWeightedEdge));
+    int64_t m = 0;
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            int v = r * side + c;
+            if (c + 1 < side) edges[m++] = (CsrWeightedEdge){ v, v + 1, 10 + (uint32_t)(next_random() % 10) };
+            if (r + 1 < side) edges[m++] = (CsrWeightedEdge){ v, v + side, 10 + (uint32_t)(next_random() % 10) };
+        }
+    }
+    *m_out = m;
+    return edges;
+}
+
+int max_degree_vertex(const CsrGraph* g) {
+    int best = 0;
+    for (int v = 1; v < g->num_vertices; v++) {
+        if (csr_degree(g, v) > csr_degree(g, best)) best = v;
+    }
+    return best;
+}
+
+uint64_t manhattan(int v, int target, void* ctx) {
+    int side = *(int*)ctx;
+    int dr = v / side - target / side;
+    int dc = v % side - target % side;
+    return 10 * (uint64_t)((dr < 0 ? -dr : dr) + (dc < 0 ? -dc : dc));
+}
+
+// ===== Examples =====
+
+void example_basic(void) {
+    printf("Example 1: Dijkstra and A* on a small graph\n");
+    printf("-------------------------------------------\n");
+    printf("     0 --4-- 1\n");
+    printf("     |       |\n");
+    printf("     1       1\n");
+    printf("     |       |\n");
+    printf("     2 --1-- 3 --7-- 4\n");
+    printf("     |               |\n");
+    printf("     8               2\n");
+    printf("     |               |\n");
+    printf("     +------ 5 ------+\n\n");
+
+    CsrWeightedEdge edges[] = { {0, 1, 4}, {0, 2, 1}, {1, 3, 1}, {2, 3, 1}, {3, 4, 7}, {2, 5, 8}, {4, 5, 2} };
+    CsrGraph g;
+    csr_build_weighted(&g, 6, edges, 7, 1);
+
+    uint64_t dist[6];
+    sssp_dijkstra(&g, 0, dist, SSSP_BINARY_HEAP, NULL);
+    printf("Distances from 0: ");
+    for (int v = 0; v < 6; v++) printf("%d:%llu ", v, (unsigned long long)dist[v]);
+
+    AstarSearch* s = astar_create(&g);
+    int path[6];
+    uint64_t d = astar_search(s, 0, 4, NULL, NULL, NULL);
+    int len = astar_path(s, 4, path, 6);
+    printf("\nShortest 0 -> 4 (length %llu): ", (unsigned long long)d);
+    for (int i = 0; i < len; i++) printf("%d%s", path[i], i + 1 < len ? " -> " : "\n");
+    astar_destroy(s);
+    csr_free(&g);
+}
+
+typedef struct {
+    const char* name;
+    CsrGraph g;
+    int source;
+} NamedGraph;
+
+void example_queues(NamedGraph* graphs, int count) {
+    printf("\n\nExample 2: Priority queues for Dijkstra\n");
+    printf("---------------------------------------\n");
+    const char* names[] = { "binary heap", "4-ary heap", "radix heap" };
+
+    for (int i = 0; i < count; i++) {
+        const CsrGraph* g = &graphs[i].g;
+        uint64_t* reference = (uint64_t*)malloc(g->num_vertices * sizeof(uint64_t));
+        uint64_t* dist = (uint64_t*)malloc(g->num_vertices * sizeof(uint64_t));
+        printf("%s: %d vertices, %lld adjacency entries\n\n", graphs[i].name, g->num_vertices,
+               (long long)g->num_edges);
+        printf("  %-12s %9s %10s %10s\n", "queue", "ms", "settled", "pushes");
+        for (int q = 0; q < 3; q++) {
+            SsspStats stats;
+            double start = get_time_ms();
+            sssp_dijkstra(g, graphs[i].source, q == 0 ? reference : dist, (SsspQueue)q, &stats);
+            double ms = get_time_ms() - start;
+            int same = q == 0 || memcmp(dist, reference, g->num_vertices * sizeof(uint64_t)) == 0;
+            printf("  %-12s %9.1f %10lld %10lld%s\n", names[q], ms, (long long)stats.settled,
+                   (long long)stats.relaxed, same ? "" : "  (distances differ!)");
+        }
+        printf("\n");
+        free(reference);
+        free(dist);
+    }
+    printf("Each improvement pushes a new entry; the old one is skipped when\n");
+    printf("popped, so pushes exceed settled vertices. The 4-ary heap is half\n");
+    printf("as deep, and a node's 4 children (64 bytes) share a cache line.\n");
+    printf("The radix heap never compares entries: it files each key by its\n");
+    printf("highest bit differing from the last key popped.\n");
+}
+
+void example_delta_stepping(NamedGraph* graphs, int count) {
+    printf("\n\nExample 3: Parallel delta-stepping\n");
+    printf("----------------------------------\n");
+    int cpus = csr_cpu_count();
+    int thread_counts[] = { 1, 2, 4, 8 };
+    printf("%d CPUs\n\n", cpus);
+
+    for (int i = 0; i < count; i++) {
+        const CsrGraph* g = &graphs[i].g;
+        uint64_t* reference = (uint64_t*)malloc(g->num_vertices * sizeof(uint64_t));
+        uint64_t* dist = (uint64_t*)malloc(g->num_vertices * sizeof(uint64_t));
+        double start = get_time_ms();
+        sssp_dijkstra(g, graphs[i].source, reference, SSSP_RADIX_HEAP, NULL);
+        printf("%s (Dijkstra, radix heap: %.1f ms)\n\n", graphs[i].name, get_time_ms() - start);
+        printf("  %7s %9s %10s %10s %8s\n", "threads", "ms", "processed", "relaxed", "rounds");
+        for (int t = 0; t < 4; t++) {
+            if (thread_counts[t] > 1 && thread_counts[t] > cpus * 2) break;
+            SsspStats stats;
+            start = get_time_ms();
+            sssp_delta_stepping(g, graphs[i].source, dist, 0, thread_counts[t], &stats);
+            double ms = get_time_ms() - start;
+            printf("  %7d %9.1f %10lld %10lld %8lld%s\n", thread_counts[t], ms, (long long)stats.settled,
+                   (long long)stats.relaxed, (long long)stats.rounds,
+                   memcmp(dist, reference, g->num_vertices * sizeof(uint64_t)) == 0 ? "" : "  (distances differ!)");
+        }
+        printf("\n");
+        free(reference);
+        free(dist);
+    }
+    printf("A bucket holds all vertices whose tentative distance is within\n");
+    printf("one delta (here mean weight / mean degree); it is relaxed by all\n");
+    printf("threads at once, and re-run until nothing lands in it again.\n");
+    printf("Some vertices are processed more than once (a later relaxation\n");
+    printf("lowers them): that is the extra work traded for parallelism.\n");
+    printf("The grid needs thousands of rounds with a barrier each; the\n");
+    printf("RMAT graph's small diameter needs far fewer, with more work each.\n");
+}
+
+void example_astar(const CsrGraph* grid, int side) {
+    printf("\n\nExample 4: A* point-to-point queries\n");
+    printf("------------------------------------\n");
+    const int queries = 30;
+    int* pairs = (int*)malloc(queries * 2 * sizeof(int));
+    for (int i = 0; i < queries * 2; i++) pairs[i] = (int)(next_random() % (unsigned)grid->num_vertices);
+
+    AstarSearch* s = astar_create(grid);
+    uint64_t* answers = (uint64_t*)malloc(queries * sizeof(uint64_t));
+    const char* names[] = { "Dijkstra (early exit)", "A* (10 x Manhattan)" };
+    printf("%d random pairs on the %dx%d grid\n\n", queries, side, side);
+    printf("  %-22s %12s %16s\n", "", "ms / query", "settled / query");
+    for (int mode = 0; mode < 2; mode++) {
+        int64_t settled = 0;
+        int mismatches = 0;
+        double start = get_time_ms();
+        for (int i = 0; i < queries; i++) {
+            SsspStats stats;
+            uint64_t d = astar_search(s, pairs[2 * i], pairs[2 * i + 1], mode ? manhattan : NULL, &side, &stats);
+            if (mode == 0) answers[i] = d;
+            else if (d != answers[i]) mismatches++;
+            settled += stats.settled;
+        }
+        double ms = get_time_ms() - start;
+        printf("  %-22s %12.1f %16lld%s\n", names[mode], ms / queries, (long long)(settled / queries),
+               mismatches ? "  (distances differ!)" : "");
+    }
+
+    uint64_t* dist = (uint64_t*)malloc(grid->num_vertices * sizeof(uint64_t));
+    double start = get_time_ms();
+    for (int i = 0; i < 10; i++) sssp_dijkstra(grid, pairs[2 * i], dist, SSSP_QUAD_HEAP, NULL);
+    printf("  %-22s %12.1f %16d\n", "full sssp_dijkstra", (get_time_ms() - start) / 10, grid->num_vertices);
+
+    printf("\nEarly exit alone settles every vertex closer than the target: a\n");
+    printf("disc around the source. The heuristic makes vertices away from\n");
+    printf("the target look farther, so A* settles a narrow band along the\n");
+    printf("route. Both reuse their arrays between queries: a per-query epoch\n");
+    printf("marks which entries are current, so nothing O(V) is cleared.\n");
+    free(dist);
+    free(answers);
+    free(pairs);
+    astar_destroy(s);
+}
+
+void example_union_find(void) {
+    printf("\n\nExample 5: Components while edges arrive\n");
+    printf("----------------------------------------\n");
+    const int n = 1000000;
+    const int batches = 10;
+    const int per_batch = 100000;
+    CsrEdge* edges = (CsrEdge*)malloc((size_t)batches * per_batch * sizeof(CsrEdge));
+    for (int i = 0; i < batches * per_batch; i++) {
+        edges[i].src = (int)(next_random() % n);
+        edges[i].dst = (int)(next_random() % n);
+    }
+    printf("%d vertices, %d random edges in batches of %d;\n", n, batches * per_batch, per_batch);
+    printf("component count after each batch\n\n");
+
+    UnionFind uf;
+    uf_init(&uf, n);
+    int* label = (int*)malloc(n * sizeof(int));
+    int* uf_counts = (int*)malloc(batches * sizeof(int));
+    double uf_ms = 0, rebuild_ms = 0;
+    int mismatches = 0;
+    for (int b = 0; b < batches; b++) {
+        double start = get_time_ms();
+        for (int i = b * per_batch; i < (b + 1) * per_batch; i++) uf_union(&uf, edges[i].src, edges[i].dst);
+        uf_counts[b] = uf.components;
+        uf_ms += get_time_ms() - start;
+
+        start = get_time_ms();
+        CsrGraph g;
+        csr_build(&g, n, edges, (int64_t)(b + 1) * per_batch, 1);
+        int components = csr_components(&g, label);
+        csr_free(&g);
+        rebuild_ms += get_time_ms() - start;
+        if (components != uf_counts[b]) mismatches++;
+    }
+    printf("  components:");
+    for (int b = 0; b < batches; b++) printf(" %d", uf_counts[b]);
+    printf("\n\n  %-28s %9.1f ms\n", "union-find, edges as they come", uf_ms);
+    printf("  %-28s %9.1f ms\n", "rebuild CSR + components", rebuild_ms);
+    printf("  Counts agree: %s\n", mismatches ? "NO" : "yes");
+    printf("\nUnion-find touches only the new edges; the rebuild reads all edges\n");
+    printf("so far, every time. uf_connected answers \"same component?\" without\n");
+    printf("any graph at all.\n");
+    free(uf_counts);
+    free(label);
+    free(edges);
+    uf_free(&uf);
+}
+
+int main(int argc, char** argv) {
+    printf("=== Shortest Paths ===\n\n");
+    int scale = argc > 1 ? atoi(argv[1]) : 18;
+    if (scale < 10 || scale > 26) scale = 18;
+
+    example_basic();
+
+    int side = 1000;
+    int64_t m;
+    NamedGraph graphs[2];
+    CsrWeightedEdge* edges = make_grid(side, &m);
+    graphs[0].name = "1000x1000 grid, weights 10-19";
+    csr_build_weighted(&graphs[0].g, side * side, edges, m, 1);
+    graphs[0].source = 0;
+    free(edges);
+
+    char rmat_name[64];
+    snprintf(rmat_name, sizeof(rmat_name), "RMAT scale %d, weights 1-255", scale);
+    edges = make_rmat(scale, 16, &m);
+    graphs[1].name = rmat_name;
+    csr_build_weighted(&graphs[1].g, 1 << scale, edges, m, 1);
+    graphs[1].source = max_degree_vertex(&graphs[1].g);
+    free(edges);
+
+    example_queues(graphs, 2);
+    example_delta_stepping(graphs, 2);
+    example_astar(&graphs[0].g, side);
+    example_union_find();
+
+    csr_free(&graphs[0].g);
+    csr_free(&graphs[1].g);
+
+    printf("\n\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Dijkstra:
+ *
+ * Settle vertices in order of distance. The closest unsettled vertex
+ * can't be improved (weights are >= 0), so it is final; relax its
+ * edges and repeat. O((V + E) log V) with a binary heap.
+ *
+ * Lazy deletion: instead of a decrease-key (which needs each vertex's
+ * position in the heap), push the new distance and skip entries whose
+ * key no longer matches dist[] when they come out.
+ *
+ * Radix heap: works because Dijkstra's pops never decrease. Keys live
+ * in 65 buckets by the highest bit where they differ from the last
+ * popped key. Pop redistributes the lowest bucket around its minimum;
+ * every entry only moves to lower buckets, so at most 64 moves each.
+ *
+ * Delta-stepping:
+ *
+ *   bucket i = vertices with tentative distance in [i*delta, (i+1)*delta)
+ *   repeat: take the lowest non-empty bucket, relax all its vertices in
+ *           parallel (atomic min on dist), until it stays empty
+ *
+ * delta -> 0: Dijkstra (one vertex at a time). delta -> infinity:
+ * Bellman-Ford (everything at once, lots of re-relaxation). The default,
+ * mean weight / mean degree, sits in between.
+ *
+ * A*: Dijkstra ordered by g(v) + h(v), where h is a lower bound on the
+ * distance left. With h = 0 it is Dijkstra with early exit.
+ *
+ * Union-find: each set is a tree; find walks to the root (halving the
+ * path on the way), union hangs the smaller tree under the larger.
+ * Nearly O(1) amortized (inverse Ackermann).
+ *
+ * Try:
+ * - Vary delta in sssp_delta_stepping: 1, the default, the mean weight
+ * - An inadmissible heuristic (20 x Manhattan, above the 10-19 weights):
+ *   faster, but paths come out too long
+ * - Kruskal's minimum spanning tree: sort edges, keep those uf_union accepts
+ */
@@ -0,0 +1,574 @@
+/*
+ * 14_priority_queues.c
+ *
+ * Generic priority queues (pqueue.h): the growable, payload-carrying
+ * replacement for the int MinHeap in 08_heap.c.
+ * Demonstrates a d-ary heap of structs, an indexed heap with update
+ * and cancel by handle, a pairing heap with decrease-key, and
+ * benchmarks against 08's binary heap.
+ *
+ * Build: gcc -O2 14_priority_queues.c -o 14_priority_queues
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "pqueue.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <time.h>
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+static unsigned long long rng_state = 88172645463325252ull;
+
+static unsigned long long next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// ===== Queue instances =====
+
+typedef struct {
+    uint64_t when;
+    const char* job;
+} Event;
+
+#define EVENT_LESS(a, b) ((a).when < (b).when)
+#define INT_LESS(a, b) ((a) < (b))
+
+DARY_HEAP_DEFINE(EventQueue, eventq, Event, EVENT_LESS, 4)
+INDEXED_HEAP_DEFINE(TaskQueue, taskq, Event, EVENT_LESS, 4)
+PAIRING_HEAP_DEFINE(EventPairing, eventp, Event, EVENT_LESS)
+
+DARY_HEAP_DEFINE(IntHeap2, iheap2, int, INT_LESS, 2)
+DARY_HEAP_DEFINE(IntHeap4, iheap4, int, INT_LESS, 4)
+DARY_HEAP_DEFINE(IntHeap8, iheap8, int, INT_LESS, 8)
+INDEXED_HEAP_DEFINE(IntIndexed, iindexed, int, INT_LESS, 4)
+PAIRING_HEAP_DEFINE(IntPairing, ipairing, int, INT_LESS)
+
+// (distance, vertex) for Dijkstra
+typedef struct {
+    uint64_t dist;
+    int vertex;
+} DistEntry;
+
+#define DIST_LESS(a, b) ((a).dist < (b).dist)
+
+DARY_HEAP_DEFINE(DistHeap, distheap, DistEntry, DIST_LESS, 4)
+INDEXED_HEAP_DEFINE(DistIndexed, distindexed, DistEntry, DIST_LESS, 4)
+PAIRING_HEAP_DEFINE(DistPairing, distpairing, DistEntry, DIST_LESS)
+
+// A timer and the slot that owns it
+typedef struct {
+    uint64_t when;
+    int slot;
+} Timer;
+
+// Ties broken by slot, so every queue fires timers in the same order
+#define TIMER_LESS(a, b) ((a).when < (b).when || ((a).when == (b).when && (a).slot < (b).slot))
+
+INDEXED_HEAP_DEFINE(TimerIndexed, timeri, Timer, TIMER_LESS, 4)
+PAIRING_HEAP_DEFINE(TimerPairing, timerp, Timer, TIMER_LESS)
+
+// ===== 08's MinHeap, for comparison =====
+
+typedef struct MinHeap {
+    int* array;
+    int capacity;
+    int size;
+} MinHeap;
+
+MinHeap* create_heap(int capacity) {
+    MinHeap* heap = (MinHeap*)malloc(sizeof(MinHeap));
+    heap->capacity = capacity;
+    heap->size = 0;
+    heap->array = (int*)malloc(capacity * sizeof(int));
+    return heap;
+}
+
+void swap(int* a, int* b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+void heapify_down(MinHeap* heap, int index) {
+    int smallest = index;
+    int left = 2 * index + 1;
+    int right = 2 * index + 2;
+    if (left < heap->size && heap->array[left] < heap->array[smallest]) smallest = left;
+    if (right < heap->size && heap->array[right] < heap->array[smallest]) smallest = right;
+    if (smallest != index) {
+        swap(&heap->array[index], &heap->array[smallest]);
+        heapify_down(heap, smallest);
+    }
+}
+
+void insert(MinHeap* heap, int value) {
+    if (heap->size == heap->capacity) return;
+    int index = heap->size++;
+    heap->array[index] = value;
+    while (index > 0 && heap->array[(index - 1) / 2] > heap->array[index]) {
+        swap(&heap->array[(index - 1) / 2], &heap->array[index]);
+        index = (index - 1) / 2;
+    }
+}
+
+int extract_min(MinHeap* heap) {
+    int root = heap->array[0];
+    heap->array[0] = heap->array[--heap->size];
+    heapify_down(heap, 0);
+    return root;
+}
+
+void free_heap(MinHeap* heap) {
+    free(heap->array);
+    free(heap);
+}
+
+// ===== Examples =====
+
+void example_events(void) {
+    printf("Example 1: A 4-ary heap of events\n");
+    printf("---------------------------------\n");
+    Event events[] = { {30, "send report"}, {5, "rotate logs"}, {20, "flush cache"},
+                       {5, "ping peers"}, {60, "compact db"}, {1, "start up"} };
+    EventQueue q;
+    eventq_init(&q, 0);
+    for (int i = 0; i < 6; i++) eventq_push(&q, events[i]);
+    printf("Pushed 6 events; the queue grows itself (no capacity to pick)\n\n");
+    while (q.size > 0) {
+        Event e = eventq_pop(&q);
+        printf("  t=%-3llu %s\n", (unsigned long long)e.when, e.job);
+    }
+    eventq_free(&q);
+}
+
+void example_indexed(void) {
+    printf("\n\nExample 2: Indexed heap - reschedule and cancel\n");
+    printf("-----------------------------------------------\n");
+    TaskQueue q;
+    taskq_init(&q, 0);
+    int backup = taskq_push(&q, (Event){ 50, "backup" });
+    int email = taskq_push(&q, (Event){ 10, "send email" });
+    int report = taskq_push(&q, (Event){ 30, "build report" });
+    taskq_push(&q, (Event){ 40, "clean tmp" });
+    printf("Queued: backup@50, send email@10, build report@30, clean tmp@40\n");
+
+    taskq_update(&q, backup, (Event){ 5, "backup" });
+    printf("Backup moved up to t=5 (decrease-key)\n");
+    taskq_update(&q, email, (Event){ 45, "send email" });
+    printf("Email pushed back to t=45 (increase-key)\n");
+    Event cancelled = taskq_remove(&q, report);
+    printf("Cancelled \"%s\"; handle %d still queued: %s\n\n", cancelled.job, report,
+           taskq_contains(&q, report) ? "yes" : "no");
+
+    while (q.size > 0) {
+        int handle;
+        Event e = taskq_pop(&q, &handle);
+        printf("  t=%-3llu %-12s (handle %d)\n", (unsigned long long)e.when, e.job, handle);
+    }
+    taskq_free(&q);
+}
+
+void example_pairing(void) {
+    printf("\n\nExample 3: Pairing heap\n");
+    printf("-----------------------\n");
+    EventPairing q;
+    eventp_init(&q);
+    EventPairingNode* nodes[5];
+    const char* jobs[] = { "a", "b", "c", "d", "e" };
+    for (int i = 0; i < 5; i++) nodes[i] = eventp_push(&q, (Event){ (uint64_t)(10 * (i + 1)), jobs[i] });
+    printf("Pushed a@10 b@20 c@30 d@40 e@50: each push is one comparison\n");
+    printf("with the root, and the loser becomes its child.\n\n");
+    eventp_decrease(&q, nodes[3], (Event){ 1, "d" });
+    printf("Decrease d to 1: cut d out, link it with the root. Root: %s\n",
+           eventp_peek(&q)->job);
+    eventp_remove(&q, nodes[1]);
+    printf("Remove b\n\n");
+    printf("  Pops:");
+    while (q.size > 0) {
+        Event e = eventp_pop(&q);
+        printf(" %s@%llu", e.job, (unsigned long long)e.when);
+    }
+    printf("\n");
+    eventp_free(&q);
+}
+
+// Pushes n random ints then pops them all; returns ms, or -1 if out of order
+typedef enum { Q_MINHEAP, Q_BINARY, Q_QUAD, Q_OCT, Q_INDEXED, Q_PAIRING } QueueKind;
+
+double push_pop(QueueKind kind, const int* values, int n) {
+    long long inversions = 0;
+    int last = -1;
+    double start = get_time_ms();
+
+#define DRAIN(pop_expr)                                         \
+    for (int i = 0; i < n; i++) {                               \
+        int v = (pop_expr);                                     \
+        inversions += v < last;                                 \
+        last = v;                                               \
+    }
+
+    switch (kind) {
+    case Q_MINHEAP: {
+        MinHeap* h = create_heap(n);
+        for (int i = 0; i < n; i++) insert(h, values[i]);
+        DRAIN(extract_min(h))
+        free_heap(h);
+        break;
+    }
+    case Q_BINARY: {
+        IntHeap2 h;
+        iheap2_init(&h, n);
+        for (int i = 0; i < n; i++) iheap2_push(&h, values[i]);
+        DRAIN(iheap2_pop(&h))
+        iheap2_free(&h);
+        break;
+    }
+    case Q_QUAD: {
+        IntHeap4 h;
+        iheap4_init(&h, n);
+        for (int i = 0; i < n; i++) iheap4_push(&h, values[i]);
+        DRAIN(iheap4_pop(&h))
+        iheap4_free(&h);
+        break;
+    }
+    case Q_OCT: {
+        IntHeap8 h;
+        iheap8_init(&h, n);
+        for (int i = 0; i < n; i++) iheap8_push(&h, values[i]);
+        DRAIN(iheap8_pop(&h))
+        iheap8_free(&h);
+        break;
+    }
+    case Q_INDEXED: {
+        IntIndexed h;
+        iindexed_init(&h, n);
+        for (int i = 0; i < n; i++) iindexed_push(&h, values[i]);
+        DRAIN(iindexed_pop(&h, NULL))
+        iindexed_free(&h);
+        break;
+    }
+    case Q_PAIRING: {
+        IntPairing h;
+        ipairing_init(&h);
+        for (int i = 0; i < n; i++) ipairing_push(&h, values[i]);
+        DRAIN(ipairing_pop(&h))
+        ipairing_free(&h);
+        break;
+    }
+    }
+#undef DRAIN
+
+    double ms = get_time_ms() - start;
+    return inversions ? -1 : ms;
+}
+
+void example_push_pop(void) {
+    printf("\n\nExample 4: Push n random ints, pop them all\n");
+    printf("-------------------------------------------\n");
+    const char* names[] = { "08 MinHeap", "binary (D=2)", "4-ary", "8-ary", "indexed 4-ary", "pairing" };
+    int sizes[] = { 100000, 4000000 };
+    int* values = (int*)malloc(sizes[1] * sizeof(int));
+    for (int i = 0; i < sizes[1]; i++) values[i] = (int)(next_random() % 1000000000);
+
+    printf("  %-16s %14s %14s\n", "queue", "n = 100K (ms)", "n = 4M (ms)");
+    for (int k = 0; k <= Q_PAIRING; k++) {
+        printf("  %-16s", names[k]);
+        for (int s = 0; s < 2; s++) {
+            // The small case is quick: best of 5 runs
+            double ms = push_pop((QueueKind)k, values, sizes[s]);
+            for (int run = 1; s == 0 && run < 5 && ms >= 0; run++) {
+                double again = push_pop((QueueKind)k, values, sizes[s]);
+                if (again < ms) ms = again;
+            }
+            if (ms < 0) printf(" %14s", "OUT OF ORDER");
+            else printf(" %14.1f", ms);
+        }
+        printf("\n");
+    }
+    printf("\nThe generic binary heap moves a hole instead of swapping and\n");
+    printf("picks the smaller child without a branch; 08's heap swaps and\n");
+    printf("recurses. The bigger win is D = 4: half the levels, and the 4\n");
+    printf("children (16 bytes) share a cache line. Once the heap outgrows\n");
+    printf("the cache (4M ints = 16 MB) every level is a miss, so fewer levels\n");
+    printf("pays most. D = 8 adds more comparisons than it saves levels. The\n");
+    printf("indexed heap also updates pos[] on every move; the pairing heap\n");
+    printf("is 32 bytes per node and a pointer chase per link.\n");
+    free(values);
+}
+
+// Implicit side x side grid, weights 10..19 on right[] and down[] edges
+typedef struct {
+    int side;
+    uint8_t* right;
+    uint8_t* down;
+} Grid;
+
+static inline int grid_neighbors(const Grid* g, int v, int* nbr, uint32_t* w) {
+    int r = v / g->side, c = v % g->side, k = 0;
+    if (c + 1 < g->side) { nbr[k] = v + 1; w[k++] = g->right[v]; }
+    if (c > 0) { nbr[k] = v - 1; w[k++] = g->right[v - 1]; }
+    if (r + 1 < g->side) { nbr[k] = v + g->side; w[k++] = g->down[v]; }
+    if (r > 0) { nbr[k] = v - g->side; w[k++] = g->down[v - g->side]; }
+    return k;
+}
+
+// Lazy deletion: push duplicates, skip stale entries
+size_t dijkstra_lazy(const Grid* g, uint64_t* dist) {
+    int n = g->side * g->side, nbr[4];
+    uint32_t w[4];
+    size_t max_size = 0;
+    for (int v = 0; v < n; v++) dist[v] = UINT64_MAX;
+    DistHeap h;
+    distheap_init(&h, 0);
+    dist[0] = 0;
+    distheap_push(&h, (DistEntry){ 0, 0 });
+    while (h.size > 0) {
+        if (h.size > max_size) max_size = h.size;
+        DistEntry e = distheap_pop(&h);
+        if (e.dist != dist[e.vertex]) continue;
+        int k = grid_neighbors(g, e.vertex, nbr, w);
+        for (int i = 0; i < k; i++) {
+            uint64_t nd = e.dist + w[i];
+            if (nd < dist[nbr[i]]) {
+                dist[nbr[i]] = nd;
+                distheap_push(&h, (DistEntry){ nd, nbr[i] });
+            }
+        }
+    }
+    distheap_free(&h);
+    return max_size;
+}
+
+// Decrease-key: at most one entry per vertex
+size_t dijkstra_indexed(const Grid* g, uint64_t* dist) {
+    int n = g->side * g->side, nbr[4];
+    uint32_t w[4];
+    size_t max_size = 0;
+    int* handle = (int*)malloc(n * sizeof(int));
+    for (int v = 0; v < n; v++) {
+        dist[v] = UINT64_MAX;
+        handle[v] = -1;
+    }
+    DistIndexed h;
+    distindexed_init(&h, 0);
+    dist[0] = 0;
+    handle[0] = distindexed_push(&h, (DistEntry){ 0, 0 });
+    while (h.size > 0) {
+        if (h.size > max_size) max_size = h.size;
+        DistEntry e = distindexed_pop(&h, NULL);
+        handle[e.vertex] = -1;
+        int k = grid_neighbors(g, e.vertex, nbr, w);
+        for (int i = 0; i < k; i++) {
+            uint64_t nd = e.dist + w[i];
+            int v = nbr[i];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                if (handle[v] >= 0) distindexed_update(&h, handle[v], (DistEntry){ nd, v });
+                else handle[v] = distindexed_push(&h, (DistEntry){ nd, v });
+            }
+        }
+    }
+    distindexed_free(&h);
+    free(handle);
+    return max_size;
+}
+
+size_t dijkstra_pairing(const Grid* g, uint64_t* dist) {
+    int n = g->side * g->side, nbr[4];
+    uint32_t w[4];
+    size_t max_size = 0;
+    DistPairingNode** node = (DistPairingNode**)calloc(n, sizeof(DistPairingNode*));
+    for (int v = 0; v < n; v++) dist[v] = UINT64_MAX;
+    DistPairing h;
+    distpairing_init(&h);
+    dist[0] = 0;
+    node[0] = distpairing_push(&h, (DistEntry){ 0, 0 });
+    while (h.size > 0) {
+        if (h.size > max_size) max_size = h.size;
+        DistEntry e = distpairing_pop(&h);
+        node[e.vertex] = NULL;
+        int k = grid_neighbors(g, e.vertex, nbr, w);
+        for (int i = 0; i < k; i++) {
+            uint64_t nd = e.dist + w[i];
+            int v = nbr[i];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                if (node[v]) distpairing_decrease(&h, node[v], (DistEntry){ nd, v });
+                else node[v] = distpairing_push(&h, (DistEntry){ nd, v });
+            }
+        }
+    }
+    distpairing_free(&h);
+    free(node);
+    return max_size;
+}
+
+void example_dijkstra(void) {
+    printf("\n\nExample 5: Decrease-key in Dijkstra\n");
+    printf("-----------------------------------\n");
+    Grid g;
+    g.side = 1000;
+    int n = g.side * g.side;
+    g.right = (uint8_t*)malloc(n);
+    g.down = (uint8_t*)malloc(n);
+    for (int v = 0; v < n; v++) {
+        g.right[v] = (uint8_t)(10 + next_random() % 10);
+        g.down[v] = (uint8_t)(10 + next_random() % 10);
+    }
+    uint64_t* reference = (uint64_t*)malloc(n * sizeof(uint64_t));
+    uint64_t* dist = (uint64_t*)malloc(n * sizeof(uint64_t));
+
+    printf("1000x1000 grid, weights 10-19, from corner 0\n\n");
+    printf("  %-30s %9s %12s\n", "queue", "ms", "max queued");
+    const char* names[] = { "4-ary, lazy (push duplicates)", "indexed 4-ary, decrease-key",
+                            "pairing, decrease-key" };
+    for (int k = 0; k < 3; k++) {
+        double start = get_time_ms();
+        size_t max_size = k == 0 ? dijkstra_lazy(&g, reference)
+                        : k == 1 ? dijkstra_indexed(&g, dist)
+                                 : dijkstra_pairing(&g, dist);
+        double ms = get_time_ms() - start;
+        int same = k == 0 || memcmp(dist, reference, n * sizeof(uint64_t)) == 0;
+        printf("  %-30s %9.1f %12zu%s\n", names[k], ms, max_size, same ? "" : "  (distances differ!)");
+    }
+    printf("\nDecrease-key keeps one entry per vertex, so the queue stays\n");
+    printf("smaller; lazy deletion does less bookkeeping per operation.\n");
+    printf("Which wins depends on how often distances improve: on graphs\n");
+    printf("with many paths of similar length, duplicates pile up.\n");
+    free(reference);
+    free(dist);
+    free(g.right);
+    free(g.down);
+}
+
+void example_scheduler(void) {
+    printf("\n\nExample 6: Scheduler churn - cancel and reschedule\n");
+    printf("--------------------------------------------------\n");
+    const int pending = 100000;
+    const int rounds = 1000000;
+    printf("%d pending timers; each round cancels a random one, schedules\n", pending);
+    printf("a replacement, fires the earliest and reschedules it (%d rounds)\n\n", rounds);
+    printf("  %-16s %9s %14s\n", "queue", "ms", "checksum");
+
+    int* handle = (int*)malloc(pending * sizeof(int));
+    TimerIndexed ih;
+    timeri_init(&ih, pending);
+    uint64_t clock = 0, checksum = 0;
+    unsigned long long saved = rng_state;
+    for (int i = 0; i < pending; i++) handle[i] = timeri_push(&ih, (Timer){ next_random() % 1000000, i });
+    double start = get_time_ms();
+    for (int r = 0; r < rounds; r++) {
+        int slot = (int)(next_random() % pending);
+        timeri_remove(&ih, handle[slot]);
+        handle[slot] = timeri_push(&ih, (Timer){ clock + next_random() % 1000000, slot });
+        Timer fired = timeri_pop(&ih, NULL);
+        clock = fired.when;
+        checksum += clock;
+        handle[fired.slot] = timeri_push(&ih, (Timer){ clock + next_random() % 1000000, fired.slot });
+    }
+    printf("  %-16s %9.1f %14llu\n", "indexed 4-ary", get_time_ms() - start, (unsigned long long)checksum);
+    timeri_free(&ih);
+    free(handle);
+
+    TimerPairingNode** node = (TimerPairingNode**)malloc(pending * sizeof(TimerPairingNode*));
+    TimerPairing ph;
+    timerp_init(&ph);
+    clock = 0;
+    checksum = 0;
+    rng_state = saved;
+    for (int i = 0; i < pending; i++) node[i] = timerp_push(&ph, (Timer){ next_random() % 1000000, i });
+    start = get_time_ms();
+    for (int r = 0; r < rounds; r++) {
+        int slot = (int)(next_random() % pending);
+        timerp_remove(&ph, node[slot]);
+        node[slot] = timerp_push(&ph, (Timer){ clock + next_random() % 1000000, slot });
+        Timer fired = timerp_pop(&ph);
+        clock = fired.when;
+        checksum += clock;
+        node[fired.slot] = timerp_push(&ph, (Timer){ clock + next_random() % 1000000, fired.slot });
+    }
+    printf("  %-16s %9.1f %14llu\n", "pairing", get_time_ms() - start, (unsigned long long)checksum);
+    timerp_free(&ph);
+    free(node);
+
+    printf("\nSame random stream, so the checksums (sum of firing times) must\n");
+    printf("match. 08's MinHeap can't do this at all: it has no way to find a\n");
+    printf("queued timer, so cancelling one means scanning the array.\n");
+}
+
+int main(void) {
+    printf("=== Priority Queues ===\n\n");
+
+    example_events();
+    example_indexed();
+    example_pairing();
+    example_push_pop();
+    example_dijkstra();
+    example_scheduler();
+
+    printf("\n\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * d-ary Heap:
+ *
+ * A binary heap with D children per node, stored level by level:
+ *
+ *   children of i:  D*i + 1 .. D*i + D        parent of i: (i - 1) / D
+ *
+ *   push: log_D n levels up, 1 comparison each
+ *   pop:  log_D n levels down, D comparisons each
+ *
+ * More children = shallower tree, more comparisons per level. The
+ * comparisons are in one cache line; the levels are cache misses.
+ * D = 4 is the usual sweet spot; pushes (and decrease-keys) get
+ * cheaper as D grows, pops don't.
+ *
+ * Indexed Heap:
+ *
+ *   entries: [ (item, handle) ... ]      the heap
+ *   pos:     [ handle -> index ]         kept current on every move
+ *
+ * Finding a queued item is pos[handle]; from there update sifts it up
+ * or down, and remove fills its hole with the last entry. Freed
+ * handles go on a free list threaded through pos.
+ *
+ * Pairing Heap:
+ *
+ *        1              Each node: first child, next sibling, and a
+ *      / | \            back pointer (previous sibling or parent).
+ *     4  2  9           link(a, b): the larger root becomes the
+ *     |    / \          smaller's first child. O(1).
+ *     7   12  10
+ *
+ * Pop removes the root and must merge its children: pair them up left
+ * to right, then fold right to left. Amortized O(log n), and in
+ * practice among the fastest heaps when decrease-key is common.
+ *
+ * Try:
+ * - D = 16 in example 4: where do pops start to slow down?
+ * - A max-heap: swap the LESS arguments
+ * - Replace the lazy heap in graph_algos.c with the indexed one
+ */
@@ -0,0 +1,480 @@
+/*
+ * 15_timer_wheel.c
+ *
+ * Hierarchical timing wheel (timer_wheel.h): O(1) timeouts, against
+ * heap-based timers built on 08_heap.c's MinHeap.
+ * Demonstrates levels and cascading, an event loop that sleeps until
+ * the next deadline, per-connection idle timeouts for 100K connections,
+ * and a million one-shot timers.
+ *
+ * Build: gcc -O2 15_timer_wheel.c -o 15_timer_wheel
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "timer_wheel.h"
+#include "pqueue.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+    // Stands in for epoll_wait/poll with no events to deliver
+    void wait_ms(int ms) { Sleep(ms); }
+#else
+    #include <time.h>
+    #include <poll.h>
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+    void wait_ms(int ms) { poll(NULL, 0, ms); }
+#endif
+
+static unsigned long long rng_state = 88172645463325252ull;
+
+static unsigned long long next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// ===== 08's MinHeap, with 64-bit keys for (deadline, id) =====
+
+typedef struct MinHeap {
+    uint64_t* array;
+    int capacity;
+    int size;
+} MinHeap;
+
+MinHeap* create_heap(int capacity) {
+    MinHeap* heap = (MinHeap*)malloc(sizeof(MinHeap));
+    heap->capacity = capacity;
+    heap->size = 0;
+    heap->array = (uint64_t*)malloc(capacity * sizeof(uint64_t));
+    return heap;
+}
+
+void swap(uint64_t* a, uint64_t* b) {
+    uint64_t temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+void heapify_down(MinHeap* heap, int index) {
+    int smallest = index;
+    int left = 2 * index + 1;
+    int right = 2 * index + 2;
+    if (left < heap->size && heap->array[left] < heap->array[smallest]) smallest = left;
+    if (right < heap->size && heap->array[right] < heap->array[smallest]) smallest = right;
+    if (smallest != index) {
+        swap(&heap->array[index], &heap->array[smallest]);
+        heapify_down(heap, smallest);
+    }
+}
+
+void insert(MinHeap* heap, uint64_t value) {
+    if (heap->size == heap->capacity) {
+        printf("Heap is full!\n");
+        return;
+    }
+    int index = heap->size++;
+    heap->array[index] = value;
+    while (index > 0 && heap->array[(index - 1) / 2] > heap->array[index]) {
+        swap(&heap->array[(index - 1) / 2], &heap->array[index]);
+        index = (index - 1) / 2;
+    }
+}
+
+uint64_t extract_min(MinHeap* heap) {
+    uint64_t root = heap->array[0];
+    heap->array[0] = heap->array[--heap->size];
+    heapify_down(heap, 0);
+    return root;
+}
+
+void free_heap(MinHeap* heap) {
+    free(heap->array);
+    free(heap);
+}
+
+// Deadline in the high bits, id in the low 20: heap order is deadline order
+#define ID_BITS 20
+#define HEAP_KEY(deadline, id) (((uint64_t)(deadline) << ID_BITS) | (uint64_t)(id))
+#define KEY_DEADLINE(key) ((key) >> ID_BITS)
+#define KEY_ID(key) ((int)((key) & ((1u << ID_BITS) - 1)))
+
+// ===== Examples =====
+
+typedef struct {
+    const char* name;
+    TwTimer timer;
+} NamedTimer;
+
+static TimerWheel* demo_wheel;
+
+void print_fired(TwTimer* t) {
+    NamedTimer* nt = TW_CONTAINER_OF(t, NamedTimer, timer);
+    printf("    tick %-6llu %s\n", (unsigned long long)(demo_wheel->now - 1), nt->name);
+}
+
+void print_levels(const TimerWheel* tw) {
+    printf("  now=%llu, pending=%zu, occupied slots per level:", (unsigned long long)tw->now, tw->count);
+    for (int k = 0; k < TW_LEVELS; k++) {
+        int n = 0;
+        for (uint64_t bits = tw->occupied[k]; bits; bits &= bits - 1) n++;
+        printf(" %d", n);
+    }
+    uint64_t next = tw_next_expiry(tw);
+    if (next == TW_NEVER) printf(", next: none\n");
+    else printf(", next: %llu\n", (unsigned long long)next);
+}
+
+void example_levels(void) {
+    printf("Example 1: Levels and cascading\n");
+    printf("-------------------------------\n");
+    TimerWheel tw;
+    tw_init(&tw, 0);
+    demo_wheel = &tw;
+    const char* names[] = { "A (tick 3)", "B (tick 70)", "C (tick 300)", "D (tick 5000)", "E (tick 5000)" };
+    uint64_t when[] = { 3, 70, 300, 5000, 5000 };
+    NamedTimer timers[5];
+    for (int i = 0; i < 5; i++) {
+        timers[i].name = names[i];
+        tw_timer_init(&timers[i].timer, print_fired);
+        tw_add(&tw, &timers[i].timer, when[i]);
+    }
+    printf("A is < 64 ticks away: level 0. B and C: level 1 (64-tick slots).\n");
+    printf("D and E: level 2 (4096-tick slots).\n\n");
+    print_levels(&tw);
+    tw_cancel(&tw, &timers[2].timer);
+    printf("Cancel C: unlink from its slot, O(1)\n");
+    print_levels(&tw);
+
+    uint64_t steps[] = { 10, 100, 4095, 6000 };
+    for (int i = 0; i < 4; i++) {
+        printf("\nAdvance to %llu:\n", (unsigned long long)steps[i]);
+        tw_advance(&tw, steps[i]);
+        print_levels(&tw);
+    }
+    printf("\n\"next\" is exact for level 0. For higher levels it is when the\n");
+    printf("slot cascades (tick 4096 for D and E, whose slot covers 4096-8191):\n");
+    printf("waking then is early but safe, and the next query is exact.\n");
+    printf("%llu timers moved down a level in total.\n", (unsigned long long)tw.cascaded);
+}
+
+typedef struct {
+    TwTimer timer;
+    const char* name;
+    uint64_t period;                    // 0: one-shot
+    double start;
+    int* running;
+} LoopTimer;
+
+static TimerWheel* loop_wheel;
+
+void loop_fired(TwTimer* t) {
+    LoopTimer* lt = TW_CONTAINER_OF(t, LoopTimer, timer);
+    double now = get_time_ms() - lt->start;
+    printf("  %6.1f ms  %-10s (due %llu, %.1f ms late)\n", now, lt->name, (unsigned long long)t->expires,
+           now - (double)t->expires);
+    if (lt->period) tw_add(loop_wheel, t, t->expires + lt->period);
+    else if (lt->running) *lt->running = 0;
+}
+
+void example_event_loop(void) {
+    printf("\n\nExample 2: An event loop that sleeps until the next deadline\n");
+    printf("------------------------------------------------------------\n");
+    TimerWheel tw;
+    double start = get_time_ms();
+    tw_init(&tw, 0);
+    loop_wheel = &tw;
+    int running = 1;
+    LoopTimer timers[3] = { { .name = "heartbeat", .period = 25 }, { .name = "flush" },
+                            { .name = "stop", .running = &running } };
+    uint64_t first[3] = { 25, 60, 110 };
+    for (int i = 0; i < 3; i++) {
+        timers[i].start = start;
+        tw_timer_init(&timers[i].timer, loop_fired);
+        tw_add(&tw, &timers[i].timer, first[i]);
+    }
+
+    int wakeups = 0, fired = 0;
+    while (running) {
+        uint64_t now = (uint64_t)(get_time_ms() - start);
+        int timeout = tw_timeout(&tw, now, 1000);
+        wait_ms(timeout);               // epoll_wait(epfd, events, n, timeout)
+        wakeups++;
+        fired += tw_advance(&tw, (uint64_t)(get_time_ms() - start));
+    }
+    printf("\n%d wakeups for %d timer events: the loop sleeps in poll()\n", wakeups, fired);
+    printf("until the next deadline instead of ticking every millisecond.\n");
+}
+
+// ----- 100K connections with idle timeouts -----
+
+typedef struct {
+    TwTimer idle;
+    uint64_t deadline;                  // For the heaps: the live deadline
+    int handle;                         // For the indexed heap
+} Conn;
+
+typedef struct {
+    int conns;
+    int idle_conns;                     // The last ones never send: they time out
+    int packets_per_tick;
+    uint64_t timeout;
+    uint64_t ticks;
+} Workload;
+
+typedef struct {
+    double ms;
+    long long expirations;
+    long long max_queued;
+} RunResult;
+
+static long long wheel_expirations;
+static TimerWheel* idle_wheel;
+static uint64_t idle_timeout;
+
+void conn_idle(TwTimer* t) {
+    // Disconnect and let the client reconnect: a fresh timeout
+    wheel_expirations++;
+    tw_add(idle_wheel, t, idle_wheel->now - 1 + idle_timeout);
+}
+
+RunResult run_wheel(const Workload* w) {
+    Conn* conns = (Conn*)calloc(w->conns, sizeof(Conn));
+    TimerWheel* tw = (TimerWheel*)malloc(sizeof(TimerWheel));
+    tw_init(tw, 0);
+    idle_wheel = tw;
+    idle_timeout = w->timeout;
+    wheel_expirations = 0;
+    rng_state = 88172645463325252ull;
+    int active = w->conns - w->idle_conns;
+
+    double start = get_time_ms();
+    for (int i = 0; i < w->conns; i++) {
+        tw_timer_init(&conns[i].idle, conn_idle);
+        tw_add(tw, &conns[i].idle, w->timeout);
+    }
+    for (uint64_t now = 1; now <= w->ticks; now++) {
+        for (int p = 0; p < w->packets_per_tick; p++) {
+            Conn* c = &conns[next_random() % active];
+            tw_add(tw, &c->idle, now + w->timeout);  // Unlink + link
+        }
+        tw_advance(tw, now);
+    }
+    RunResult r = { get_time_ms() - start, wheel_expirations, w->conns };
+    free(tw);
+    free(conns);
+    return r;
+}
+
+// 08's heap can't move an entry: push a new one per packet, and skip
+// entries that no longer match the connection's deadline
+RunResult run_minheap(const Workload* w) {
+    Conn* conns = (Conn*)calloc(w->conns, sizeof(Conn));
+    int capacity = w->conns + w->packets_per_tick * (int)(w->timeout + 1) + w->conns;
+    MinHeap* heap = create_heap(capacity);
+    RunResult r = { 0, 0, 0 };
+    rng_state = 88172645463325252ull;
+    int active = w->conns - w->idle_conns;
+
+    double start = get_time_ms();
+    for (int i = 0; i < w->conns; i++) {
+        conns[i].deadline = w->timeout;
+        insert(heap, HEAP_KEY(w->timeout, i));
+    }
+    for (uint64_t now = 1; now <= w->ticks; now++) {
+        for (int p = 0; p < w->packets_per_tick; p++) {
+            int id = (int)(next_random() % active);
+            conns[id].deadline = now + w->timeout;
+            insert(heap, HEAP_KEY(now + w->timeout, id));
+        }
+        if (heap->size > r.max_queued) r.max_queued = heap->size;
+        while (heap->size > 0 && KEY_DEADLINE(heap->array[0]) <= now) {
+            uint64_t key = extract_min(heap);
+            int id = KEY_ID(key);
+            if (conns[id].deadline != KEY_DEADLINE(key)) continue;  // Stale
+            r.expirations++;
+            conns[id].deadline = now + w->timeout;
+            insert(heap, HEAP_KEY(now + w->timeout, id));
+        }
+    }
+    r.ms = get_time_ms() - start;
+    free_heap(heap);
+    free(conns);
+    return r;
+}
+
+#define KEY_LESS(a, b) ((a) < (b))
+INDEXED_HEAP_DEFINE(KeyHeap, keyheap, uint64_t, KEY_LESS, 4)
+
+// Indexed heap: one entry per connection, moved (sifted) per packet
+RunResult run_indexed(const Workload* w) {
+    Conn* conns = (Conn*)calloc(w->conns, sizeof(Conn));
+    KeyHeap heap;
+    keyheap_init(&heap, w->conns);
+    RunResult r = { 0, 0, w->conns };
+    rng_state = 88172645463325252ull;
+    int active = w->conns - w->idle_conns;
+
+    double start = get_time_ms();
+    for (int i = 0; i < w->conns; i++) conns[i].handle = keyheap_push(&heap, HEAP_KEY(w->timeout, i));
+    for (uint64_t now = 1; now <= w->ticks; now++) {
+        for (int p = 0; p < w->packets_per_tick; p++) {
+            int id = (int)(next_random() % active);
+            keyheap_update(&heap, conns[id].handle, HEAP_KEY(now + w->timeout, id));
+        }
+        while (heap.size > 0 && KEY_DEADLINE(*keyheap_peek(&heap)) <= now) {
+            int id = KEY_ID(*keyheap_peek(&heap));
+            r.expirations++;
+            keyheap_update(&heap, conns[id].handle, HEAP_KEY(now + w->timeout, id));
+        }
+    }
+    r.ms = get_time_ms() - start;
+    keyheap_free(&heap);
+    free(conns);
+    return r;
+}
+
+void example_idle_timeouts(void) {
+    printf("\n\nExample 3: Idle timeouts for 100K connections\n");
+    printf("---------------------------------------------\n");
+    Workload w = { 100000, 1000, 1000, 5000, 20000 };
+    long long packets = (long long)w.packets_per_tick * (long long)w.ticks;
+    printf("%d connections, %d of them idle; a packet pushes its connection's\n", w.conns, w.idle_conns);
+    printf("timeout %llu ticks (ms) ahead. %d packets per tick, %llu ticks:\n",
+           (unsigned long long)w.timeout, w.packets_per_tick, (unsigned long long)w.ticks);
+    printf("%lld timer updates. An expired connection reconnects.\n\n", packets);
+
+    printf("  %-32s %9s %10s %12s %12s\n", "timers", "ms", "ns/packet", "expirations", "max queued");
+    const char* names[] = { "08 MinHeap, push per packet", "indexed 4-ary heap, sift", "timer wheel" };
+    for (int k = 0; k < 3; k++) {
+        RunResult r = k == 0 ? run_minheap(&w) : k == 1 ? run_indexed(&w) : run_wheel(&w);
+        printf("  %-32s %9.1f %10.1f %12lld %12lld\n", names[k], r.ms, r.ms * 1e6 / packets, r.expirations,
+               r.max_queued);
+    }
+    printf("\n08's heap can't find an entry to move it, so every packet adds\n");
+    printf("one, and the heap holds a timeout's worth of packets (mostly\n");
+    printf("stale). The indexed heap keeps one entry per connection but sifts\n");
+    printf("it down O(log n) levels per packet. The wheel unlinks the timer\n");
+    printf("and links it into another slot: a few pointer writes.\n");
+}
+
+// ----- A million one-shot timers -----
+
+static long long oneshot_fired;
+
+void oneshot(TwTimer* t) {
+    (void)t;
+    oneshot_fired++;
+}
+
+void example_one_shot(void) {
+    printf("\n\nExample 4: A million one-shot timers\n");
+    printf("------------------------------------\n");
+    const int n = 1000000;
+    const uint64_t span = 600000;
+    uint64_t* deadlines = (uint64_t*)malloc(n * sizeof(uint64_t));
+    for (int i = 0; i < n; i++) deadlines[i] = 1 + next_random() % span;
+    printf("Deadlines spread over %llu ticks (10 minutes of ms); add them\n", (unsigned long long)span);
+    printf("all, then run time forward one tick at a time until all fire\n\n");
+    printf("  %-14s %10s %10s %10s\n", "timers", "add ms", "run ms", "fired");
+
+    MinHeap* heap = create_heap(n);
+    double start = get_time_ms();
+    for (int i = 0; i < n; i++) insert(heap, HEAP_KEY(deadlines[i], i));
+    double add_ms = get_time_ms() - start;
+    long long fired = 0;
+    start = get_time_ms();
+    for (uint64_t now = 1; now <= span; now++) {
+        while (heap->size > 0 && KEY_DEADLINE(heap->array[0]) <= now) {
+            extract_min(heap);
+            fired++;
+        }
+    }
+    printf("  %-14s %10.1f %10.1f %10lld\n", "08 MinHeap", add_ms, get_time_ms() - start, fired);
+    free_heap(heap);
+
+    TwTimer* timers = (TwTimer*)malloc(n * sizeof(TwTimer));
+    TimerWheel* tw = (TimerWheel*)malloc(sizeof(TimerWheel));
+    tw_init(tw, 0);
+    oneshot_fired = 0;
+    start = get_time_ms();
+    for (int i = 0; i < n; i++) {
+        tw_timer_init(&timers[i], oneshot);
+        tw_add(tw, &timers[i], deadlines[i]);
+    }
+    add_ms = get_time_ms() - start;
+    start = get_time_ms();
+    for (uint64_t now = 1; now <= span; now++) tw_advance(tw, now);
+    printf("  %-14s %10.1f %10.1f %10lld\n", "timer wheel", add_ms, get_time_ms() - start, oneshot_fired);
+    printf("\n  Wheel: %llu cascades (%.1f per timer)\n", (unsigned long long)tw->cascaded,
+           (double)tw->cascaded / n);
+    printf("\nAbout even. Each timer starts on level 2 or 3 and moves down\n");
+    printf("once per level, but those moves chase list links through 40 MB\n");
+    printf("of timers scattered in memory, while the heap sifts a compact\n");
+    printf("8 MB array. The wheel wins on churn (Example 3): timers that are\n");
+    printf("moved or cancelled long before they fire.\n");
+    free(tw);
+    free(timers);
+    free(deadlines);
+}
+
+int main(void) {
+    printf("=== Timer Wheel ===\n\n");
+
+    example_levels();
+    example_event_loop();
+    example_idle_timeouts();
+    example_one_shot();
+
+    printf("\n\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Hierarchical Timing Wheel:
+ *
+ * Like a clock: the seconds hand (level 0) sweeps 64 one-tick slots;
+ * each time it wraps, the minutes hand (level 1) moves one 64-tick
+ * slot and that slot's timers are spread over the seconds dial.
+ *
+ *   level 0  [0][1][2] ... [63]       timers due in the next 64 ticks
+ *   level 1  [0][1][2] ... [63]       64 ticks per slot
+ *   level 2  [0][1][2] ... [63]       4096 ticks per slot
+ *
+ *   add:     level = how far away (in powers of 64); slot = bits of the
+ *            expiry tick at that level. List append, set a bitmap bit
+ *   cancel:  list unlink, maybe clear the bit
+ *   tick:    if the tick is a multiple of 64, cascade level 1's slot
+ *            (and of 4096, level 2's first). Then fire level 0's slot
+ *   next:    per level, the first set bit after the current slot
+ *
+ * vs a heap:
+ *   add/cancel/re-arm   O(1)  vs  O(log n)
+ *   find next expiry    O(levels) vs O(1)
+ *   expire k timers     O(k) + cascades  vs  O(k log n)
+ *
+ * Wheels give up ordering within a slot and need a tick. Timers far
+ * out are placed coarsely, and refined as they cascade: a timer that is
+ * cancelled before it fires, like most idle timeouts, never cascades.
+ *
+ * Try:
+ * - The lazy trick for the heap: on a packet, only update deadline;
+ *   when the stale entry reaches the top, re-push the real deadline
+ * - 8 bits for level 0 (256 slots), as the Linux kernel used
+ * - Add idle timeouts to ../../Networking/examples/11_chat_fanout.c
+ */
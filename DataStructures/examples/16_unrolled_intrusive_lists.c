@@ -0,0 +1,582 @@
+/*
+ * 16_unrolled_intrusive_lists.c
+ *
+ * Two linked lists that fix what 01 and 02 cost in memory traffic:
+ * an unrolled list (unrolled_list.h), with many ints per cache-line
+ * node, and an intrusive list (intrusive_list.h), with the links
+ * embedded in your own structs.
+ * Demonstrates node splits and merges, an LRU cache and a job queue
+ * that allocate nothing, and traversal benchmarks against 01's and
+ * 02's lists at 10^6 and 10^7 elements.
+ *
+ * Build: gcc -O2 16_unrolled_intrusive_lists.c -o 16_unrolled_intrusive_lists
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unrolled_list.h"
+#include "intrusive_list.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <time.h>
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+static unsigned long long rng_state = 88172645463325252ull;
+
+static unsigned long long next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// ===== 01's singly linked list =====
+
+typedef struct Node {
+    int data;
+    struct Node* next;
+} Node;
+
+Node* create_node(int data) {
+    Node* new_node = (Node*)malloc(sizeof(Node));
+    if (new_node == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    new_node->data = data;
+    new_node->next = NULL;
+    return new_node;
+}
+
+void insert_at_tail(Node** head, int data) {
+    Node* new_node = create_node(data);
+    if (*head == NULL) {
+        *head = new_node;
+        return;
+    }
+    Node* current = *head;
+    while (current->next != NULL) {
+        current = current->next;
+    }
+    current->next = new_node;
+}
+
+int search(Node* head, int data) {
+    Node* current = head;
+    int position = 0;
+    while (current != NULL) {
+        if (current->data == data) {
+            return position;
+        }
+        current = current->next;
+        position++;
+    }
+    return -1;
+}
+
+void free_list(Node* head) {
+    Node* current = head;
+    while (current != NULL) {
+        Node* temp = current;
+        current = current->next;
+        free(temp);
+    }
+}
+
+// ===== 02's doubly linked list (create_node renamed) =====
+
+typedef struct DNode {
+    int data;
+    struct DNode* prev;
+    struct DNode* next;
+} DNode;
+
+DNode* create_dnode(int data) {
+    DNode* new_node = (DNode*)malloc(sizeof(DNode));
+    if (new_node == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    new_node->data = data;
+    new_node->prev = NULL;
+    new_node->next = NULL;
+    return new_node;
+}
+
+void dlist_insert_at_head(DNode** head, int data) {
+    DNode* new_node = create_dnode(data);
+    if (*head != NULL) {
+        (*head)->prev = new_node;
+    }
+    new_node->next = *head;
+    *head = new_node;
+}
+
+void dlist_delete_node(DNode** head, DNode* node) {
+    if (node == NULL) return;
+    if (node->prev != NULL) {
+        node->prev->next = node->next;
+    } else {
+        *head = node->next;
+    }
+    if (node->next != NULL) {
+        node->next->prev = node->prev;
+    }
+    free(node);
+}
+
+DNode* dlist_search(DNode* head, int data) {
+    DNode* current = head;
+    while (current != NULL) {
+        if (current->data == data) {
+            return current;
+        }
+        current = current->next;
+    }
+    return NULL;
+}
+
+void dlist_free(DNode* head) {
+    DNode* current = head;
+    while (current != NULL) {
+        DNode* temp = current;
+        current = current->next;
+        free(temp);
+    }
+}
+
+// ===== Examples =====
+
+void print_unrolled(const UnrolledList* l) {
+    printf("  ");
+    for (const UlNode* n = l->head; n; n = n->next) {
+        printf("[");
+        for (int i = 0; i < n->count; i++) printf(i ? " %d" : "%d", n->items[i]);
+        printf("] -> ");
+    }
+    printf("NULL   (%zu items, %zu nodes)\n", ul_length(l), l->num_nodes);
+}
+
+void example_unrolled(void) {
+    printf("Example 1: Unrolled list\n");
+    printf("------------------------\n");
+    UnrolledList l;
+    ul_init(&l);
+    for (int i = 1; i <= 20; i++) ul_push_back(&l, i);
+    printf("push_back 1..20: each 64-byte node holds %d ints\n", (int)UL_NODE_ITEMS);
+    print_unrolled(&l);
+
+    ul_insert_at(&l, 4, 99);
+    printf("insert 99 at position 4: the full node splits in half\n");
+    print_unrolled(&l);
+
+    for (int i = 0; i < 4; i++) ul_remove_at(&l, 0, NULL);
+    printf("remove 4 from the front: the first node is below half full,\n");
+    printf("and merges with the next one\n");
+    print_unrolled(&l);
+
+    printf("get(10) = %d, find(17) = %ld, find(42) = %ld\n", *ul_get(&l, 10), ul_find(&l, 17), ul_find(&l, 42));
+    printf("length and tail are kept: O(1), not a walk like 01's length()\n");
+    ul_free(&l);
+}
+
+typedef struct {
+    int key;
+    int value;
+    IListNode lru;                      // On the LRU list, or the free list
+} CacheEntry;
+
+#define CACHE_KEYS 100
+
+typedef struct {
+    CacheEntry entries[4];              // All the memory the cache will use
+    CacheEntry* by_key[CACHE_KEYS];     // Stands in for a hash table
+    IListNode lru;                      // Most recently used first
+    IListNode free_entries;
+} LruCache;
+
+void cache_init(LruCache* c) {
+    memset(c->by_key, 0, sizeof(c->by_key));
+    ilist_init(&c->lru);
+    ilist_init(&c->free_entries);
+    for (int i = 0; i < 4; i++) ilist_push_back(&c->free_entries, &c->entries[i].lru);
+}
+
+int* cache_get(LruCache* c, int key) {
+    CacheEntry* e = c->by_key[key];
+    if (!e) return NULL;
+    ilist_move_to_front(&c->lru, &e->lru);
+    return &e->value;
+}
+
+void cache_put(LruCache* c, int key, int value) {
+    CacheEntry* e = c->by_key[key];
+    if (!e) {
+        IListNode* node = ilist_pop_front(&c->free_entries);
+        if (!node) {
+            node = ilist_pop_back(&c->lru);         // Evict the least recent
+            CacheEntry* victim = ILIST_ENTRY(node, CacheEntry, lru);
+            printf("    evict %d\n", victim->key);
+            c->by_key[victim->key] = NULL;
+        }
+        e = ILIST_ENTRY(node, CacheEntry, lru);
+        e->key = key;
+        c->by_key[key] = e;
+        ilist_push_front(&c->lru, &e->lru);
+    } else {
+        ilist_move_to_front(&c->lru, &e->lru);
+    }
+    e->value = value;
+}
+
+void print_cache(const LruCache* c) {
+    IListNode* it;
+    printf("    LRU: ");
+    ILIST_FOR_EACH(it, &c->lru) {
+        CacheEntry* e = ILIST_ENTRY(it, CacheEntry, lru);
+        printf("%d=%d ", e->key, e->value);
+    }
+    printf("\n");
+}
+
+void example_lru(void) {
+    printf("\n\nExample 2: LRU cache on an intrusive list\n");
+    printf("-----------------------------------------\n");
+    printf("4 entries, preallocated. Each embeds its list links, so a hit,\n");
+    printf("an insert and an eviction relink pointers and never allocate.\n\n");
+    LruCache cache;
+    cache_init(&cache);
+    for (int k = 1; k <= 4; k++) cache_put(&cache, k, k * 10);
+    printf("  put 1..4\n");
+    print_cache(&cache);
+    cache_get(&cache, 2);
+    printf("  get 2\n");
+    print_cache(&cache);
+    printf("  put 5\n");
+    cache_put(&cache, 5, 50);
+    print_cache(&cache);
+    printf("  get 1: %s\n", cache_get(&cache, 1) ? "hit" : "miss (evicted)");
+}
+
+typedef struct {
+    int id;
+    IListNode all;                      // Every job
+    IListNode state;                    // The ready or the waiting queue
+} Job;
+
+void print_queue(const char* name, const IListNode* head, size_t offset) {
+    IListNode* it;
+    printf("    %-8s", name);
+    ILIST_FOR_EACH(it, head) printf(" %d", ((Job*)((char*)it - offset))->id);
+    printf("\n");
+}
+
+void example_jobs(void) {
+    printf("\n\nExample 3: One object, two lists\n");
+    printf("--------------------------------\n");
+    Job jobs[6];
+    IListNode all, ready, waiting;
+    ilist_init(&all);
+    ilist_init(&ready);
+    ilist_init(&waiting);
+    for (int i = 0; i < 6; i++) {
+        jobs[i].id = i + 1;
+        ilist_push_back(&all, &jobs[i].all);
+        ilist_push_back(i % 2 ? &waiting : &ready, &jobs[i].state);
+    }
+    printf("  6 jobs on the all list, and each on the ready or waiting queue\n");
+    print_queue("all", &all, offsetof(Job, all));
+    print_queue("ready", &ready, offsetof(Job, state));
+    print_queue("waiting", &waiting, offsetof(Job, state));
+
+    ilist_move_to_back(&ready, &jobs[3].state);
+    ilist_remove(&jobs[2].state);
+    ilist_remove(&jobs[2].all);
+    printf("  job 4 wakes up, job 3 is cancelled: O(1) each, no search,\n");
+    printf("  because the job knows its own links\n");
+    print_queue("all", &all, offsetof(Job, all));
+    print_queue("ready", &ready, offsetof(Job, state));
+    print_queue("waiting", &waiting, offsetof(Job, state));
+
+    ilist_splice_back(&ready, &waiting);
+    printf("  everything waiting becomes ready: one O(1) splice\n");
+    print_queue("ready", &ready, offsetof(Job, state));
+    print_queue("waiting", &waiting, offsetof(Job, state));
+}
+
+// ----- Traversal benchmark -----
+
+typedef struct {
+    int data;
+    IListNode link;
+} Item;
+
+// Visit order for building: 0..n-1, or a random permutation. Shuffled
+// is what a list looks like after a while: its nodes' addresses no
+// longer follow the list order
+int* visit_order(int n, int shuffled) {
+    int* order = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) order[i] = i;
+    for (int i = n - 1; shuffled && i > 0; i--) {
+        int j = (int)(next_random() % (unsigned long long)(i + 1));
+        int t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+    return order;
+}
+
+// Best of reps searches for a value that isn't there: a full walk
+#define TIME_SEARCH(result, expr)                                                      \
+    do {                                                                               \
+        result = 1e30;                                                                 \
+        for (int rep = 0; rep < reps; rep++) {                                         \
+            double t0 = get_time_ms();                                                 \
+            if ((expr) != -1) printf("unexpected hit\n");                              \
+            double t = get_time_ms() - t0;                                             \
+            if (t < result) result = t;                                                \
+        }                                                                              \
+    } while (0)
+
+long search_array(const int* a, int n, int value) {
+    for (int i = 0; i < n; i++) {
+        if (a[i] == value) return i;
+    }
+    return -1;
+}
+
+long search_items(const IListNode* head, int value) {
+    long position = 0;
+    IListNode* it;
+    ILIST_FOR_EACH(it, head) {
+        if (ILIST_ENTRY(it, Item, link)->data == value) return position;
+        position++;
+    }
+    return -1;
+}
+
+// Time a search of each list, built in allocation order or shuffled
+void bench_traversal(int n, int shuffled, double* ms) {
+    int* order = visit_order(n, shuffled);
+    const int missing = -1;
+    int reps = n > 1000000 ? 1 : 3;
+
+    // Nodes are allocated in index order, then linked in visit order
+    int* a = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) a[i] = i;
+    TIME_SEARCH(ms[0], search_array(a, n, missing));
+    free(a);
+
+    Node** nodes = (Node**)malloc(n * sizeof(Node*));
+    for (int i = 0; i < n; i++) nodes[i] = create_node(i);
+    for (int i = 0; i + 1 < n; i++) nodes[order[i]]->next = nodes[order[i + 1]];
+    Node* head = nodes[order[0]];
+    free(nodes);
+    TIME_SEARCH(ms[1], search(head, missing));
+    free_list(head);
+
+    DNode** dnodes = (DNode**)malloc(n * sizeof(DNode*));
+    for (int i = 0; i < n; i++) dnodes[i] = create_dnode(i);
+    for (int i = 0; i + 1 < n; i++) {
+        dnodes[order[i]]->next = dnodes[order[i + 1]];
+        dnodes[order[i + 1]]->prev = dnodes[order[i]];
+    }
+    DNode* dhead = dnodes[order[0]];
+    free(dnodes);
+    TIME_SEARCH(ms[2], (dlist_search(dhead, missing) ? 0 : -1));
+    dlist_free(dhead);
+
+    Item** items = (Item**)malloc(n * sizeof(Item*));
+    for (int i = 0; i < n; i++) {
+        items[i] = (Item*)malloc(sizeof(Item));
+        items[i]->data = i;
+    }
+    IListNode list;
+    ilist_init(&list);
+    for (int i = 0; i < n; i++) ilist_push_back(&list, &items[order[i]]->link);
+    TIME_SEARCH(ms[3], search_items(&list, missing));
+    for (int i = 0; i < n; i++) free(items[i]);
+    free(items);
+
+    // Unrolled: shuffle whole nodes, the way its nodes scatter
+    UnrolledList l;
+    ul_init(&l);
+    for (int i = 0; i < n; i++) ul_push_back(&l, i);
+    if (shuffled) {
+        size_t count = l.num_nodes;
+        UlNode** un = (UlNode**)malloc(count * sizeof(UlNode*));
+        size_t k = 0;
+        for (UlNode* node = l.head; node; node = node->next) un[k++] = node;
+        for (size_t i = count - 1; i > 0; i--) {
+            size_t j = (size_t)(next_random() % (i + 1));
+            UlNode* t = un[i];
+            un[i] = un[j];
+            un[j] = t;
+        }
+        for (size_t i = 0; i + 1 < count; i++) un[i]->next = un[i + 1];
+        un[count - 1]->next = NULL;
+        l.head = un[0];
+        l.tail = un[count - 1];
+        free(un);
+    }
+    TIME_SEARCH(ms[4], ul_find(&l, missing));
+    ul_free(&l);
+    free(order);
+}
+
+void example_traversal(void) {
+    printf("\n\nExample 4: Traversal, 10^6 and 10^7 elements\n");
+    printf("--------------------------------------------\n");
+    printf("Search for a missing value: a walk over every element.\n");
+    printf("\"in order\": nodes linked in the order they were allocated.\n");
+    printf("\"shuffled\": linked in random order, as after a while of use.\n");
+    printf("Times are ns per element.\n\n");
+    const char* names[] = { "int array", "01 Node", "02 DNode", "intrusive Item", "unrolled list" };
+    double bytes[] = { sizeof(int), sizeof(Node), sizeof(DNode), sizeof(Item),
+                       (double)UL_NODE_BYTES / UL_NODE_ITEMS };
+    int sizes[] = { 1000000, 10000000 };
+    for (int s = 0; s < 2; s++) {
+        double in_order[5], shuffled[5];
+        bench_traversal(sizes[s], 0, in_order);
+        bench_traversal(sizes[s], 1, shuffled);
+        printf("  n = %-12d %14s %10s %10s\n", sizes[s], "bytes/item", "in order", "shuffled");
+        for (int k = 0; k < 5; k++) {
+            printf("  %-16s %14.1f %10.2f %10.2f\n", names[k], bytes[k], in_order[k] * 1e6 / sizes[s],
+                   shuffled[k] * 1e6 / sizes[s]);
+        }
+        printf("\n");
+    }
+    printf("bytes/item is the struct alone; malloc adds 8-16 bytes per node,\n");
+    printf("so 01's 16-byte nodes take 32 each. In order, the prefetcher\n");
+    printf("hides most of the pointer chase. Shuffled, every node is a cache\n");
+    printf("miss, and the unrolled list takes one per %d elements.\n", (int)UL_NODE_ITEMS);
+}
+
+// ----- Append and LRU churn -----
+
+void example_churn(void) {
+    printf("\n\nExample 5: Appending, and an LRU cache under load\n");
+    printf("-------------------------------------------------\n");
+    const int appends = 20000;
+    double start = get_time_ms();
+    Node* head = NULL;
+    for (int i = 0; i < appends; i++) insert_at_tail(&head, i);
+    double list_ms = get_time_ms() - start;
+    free_list(head);
+    UnrolledList l;
+    ul_init(&l);
+    start = get_time_ms();
+    for (int i = 0; i < appends; i++) ul_push_back(&l, i);
+    double ul_ms = get_time_ms() - start;
+    ul_free(&l);
+    printf("Append %d ints:\n", appends);
+    printf("  01 insert_at_tail  %9.2f ms   walks to the tail: O(n) each\n", list_ms);
+    printf("  ul_push_back       %9.2f ms   keeps a tail pointer\n\n", ul_ms);
+
+    // A cache of 1M entries; each access moves the entry to the front
+    const int entries = 1000000, accesses = 5000000;
+    int* keys = (int*)malloc(accesses * sizeof(int));
+    for (int i = 0; i < accesses; i++) keys[i] = (int)(next_random() % entries);
+
+    // With 02's API: a DNode per entry, freed and allocated to move it
+    DNode** where = (DNode**)malloc(entries * sizeof(DNode*));
+    DNode* dhead = NULL;
+    for (int i = 0; i < entries; i++) {
+        dlist_insert_at_head(&dhead, i);
+        where[i] = dhead;
+    }
+    start = get_time_ms();
+    for (int i = 0; i < accesses; i++) {
+        dlist_delete_node(&dhead, where[keys[i]]);
+        dlist_insert_at_head(&dhead, keys[i]);
+        where[keys[i]] = dhead;
+    }
+    double dlist_ms = get_time_ms() - start;
+    int dlist_last = dhead->data;
+    dlist_free(dhead);
+    free(where);
+
+    Item* items = (Item*)malloc(entries * sizeof(Item));
+    IListNode lru;
+    ilist_init(&lru);
+    for (int i = 0; i < entries; i++) {
+        items[i].data = i;
+        ilist_push_front(&lru, &items[i].link);
+    }
+    start = get_time_ms();
+    for (int i = 0; i < accesses; i++) ilist_move_to_front(&lru, &items[keys[i]].link);
+    double ilist_ms = get_time_ms() - start;
+    int ilist_last = ILIST_ENTRY(ilist_first(&lru), Item, link)->data;
+    free(items);
+    free(keys);
+
+    printf("LRU order for %d entries, %d random accesses:\n", entries, accesses);
+    printf("  02 delete_node + insert_at_head  %8.1f ms  (most recent: %d)\n", dlist_ms, dlist_last);
+    printf("  intrusive move_to_front          %8.1f ms  (most recent: %d)\n", ilist_ms, ilist_last);
+    printf("\nBoth are O(1), but 02's API frees and mallocs a node per access.\n");
+    printf("The intrusive entry relinks itself, and its links sit next to\n");
+    printf("its data: one cache line to touch instead of two.\n");
+}
+
+int main(void) {
+    printf("=== Unrolled and Intrusive Lists ===\n\n");
+
+    example_unrolled();
+    example_lru();
+    example_jobs();
+    example_traversal();
+    example_churn();
+
+    printf("\n\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Unrolled and Intrusive Lists:
+ *
+ * Unrolled linked list:
+ *   [next|count| 13 ints ]  ->  [next|count| 13 ints ]  ->  NULL
+ *   - Memory: ~5 bytes per int when full, vs 32 for 01 (16 + malloc)
+ *   - Traversal: a cache miss per node, not per element
+ *   - Insert/remove in the middle: find the node, memmove within it,
+ *     split or merge with a neighbour
+ *   - Keeps what lists are good at (cheap insert at a position, no
+ *     big reallocation) while behaving much more like an array
+ *
+ * Intrusive list:
+ *   struct Entry { key; value; IListNode lru; }
+ *                                  ^ the list links this, and
+ *   ILIST_ENTRY(node, Entry, lru)  <- gets back to the Entry
+ *   - No allocation: the object already exists
+ *   - Remove is O(1) from the object itself, no search
+ *   - One object can be on many lists (one IListNode each)
+ *   - The owner decides where objects live (an array, a pool)
+ *   - Used by the Linux kernel, game engines, and caches
+ *
+ * Pick:
+ *   Sequence of values, mostly scanned    -> array, or unrolled list
+ *   Objects that move between queues      -> intrusive list
+ *   Teaching pointers                     -> 01 and 02
+ *
+ * Try:
+ * - UL_NODE_BYTES 256: fewer misses, longer memmoves
+ * - A doubly linked unrolled list, for backward iteration
+ * - Add a dirty list to the LRU cache: entries on both lists
+ * - The timer wheel (timer_wheel.h) is built the same intrusive way
+ */
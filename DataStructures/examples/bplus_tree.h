@@ -0,0 +1,518 @@
+#ifndef BPLUS_TREE_H
+#define BPLUS_TREE_H
+
+/*
+ * B+ tree: ordered index with wide, cache-friendly nodes
+ *
+ * The BST in 05_binary_tree.c stores one key per malloc'd node. Every
+ * level of a search is a cache miss, a million keys is 20+ levels even
+ * when balanced, and sorted input makes it a linked list. A B+ tree
+ * stores up to BPT_MAX keys per node, so a million keys is 4 levels:
+ *
+ *                      [ 40 | 80 ]                    inner: keys + children
+ *                     /     |     \
+ *     [ 5 12 27 33 ] -> [ 40 51 63 ] -> [ 80 92 ]     leaves: keys + values,
+ *                                                     linked for range scans
+ *
+ *   - every key/value lives in a leaf; inner nodes only route.
+ *     Child i holds keys in [keys[i-1], keys[i])
+ *   - a node's keys are one array: 64 x 4 bytes = 4 cache lines, and
+ *     searching them is branch-free SSE2 (count the keys < target);
+ *     the hardware prefetcher streams them in
+ *   - all leaves are at the same depth; inserts split full nodes and
+ *     deletes borrow from or merge with a sibling, so nodes stay at
+ *     least half full and height is O(log_32 n)
+ *   - bpt_bulk_load builds from sorted data bottom-up with full
+ *     nodes, instead of n inserts that leave nodes half empty
+ *
+ *   BPlusTree t;
+ *   bpt_init(&t);
+ *   bpt_insert(&t, 42, 4200);
+ *   BptValue v;
+ *   if (bpt_find(&t, 42, &v)) ...
+ *   for (BptIter it = bpt_lower_bound(&t, 10); bpt_iter_valid(&it) &&
+ *        bpt_iter_key(&it) < 20; bpt_iter_next(&it)) ...
+ *   bpt_free(&t);
+ *
+ * Header-only: include it. BPT_MAX (keys per node, a multiple of 4)
+ * can be set before including; 64 suits the cache, disk-based trees
+ * use a page (4 KB) per node. -DBPT_NO_SIMD uses binary search.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__SSE2__) || defined(_M_X64)) && !defined(BPT_NO_SIMD)
+    #include <emmintrin.h>
+    #define BPT_SSE2 1
+#endif
+
+#ifndef BPT_MAX
+#define BPT_MAX 64
+#endif
+#define BPT_MIN_LEAF (BPT_MAX / 2)
+#define BPT_MIN_INNER (BPT_MAX / 2 - 1)
+#define BPT_MAX_HEIGHT 32
+
+typedef int32_t BptKey;
+typedef int64_t BptValue;
+
+typedef struct BptLeaf {
+    BptKey keys[BPT_MAX];
+    BptValue values[BPT_MAX];
+    int count;
+    struct BptLeaf* prev;
+    struct BptLeaf* next;
+} BptLeaf;
+
+typedef struct BptInner {
+    BptKey keys[BPT_MAX];               // keys[i]: smallest key under children[i + 1]
+    void* children[BPT_MAX + 1];
+    int count;                          // Keys; there are count + 1 children
+} BptInner;
+
+typedef struct {
+    void* root;
+    int height;                         // Inner levels above the leaves
+    size_t count;
+    size_t leaves;
+    size_t inners;
+} BPlusTree;
+
+typedef struct {
+    BptLeaf* leaf;
+    int index;
+} BptIter;
+
+// ===== In-node search =====
+
+#ifdef BPT_SSE2
+// Keys < target: compare 4 at a time and add up the -1s, no branches
+static inline int bpt_count_less(const BptKey* keys, int n, BptKey target) {
+    __m128i t = _mm_set1_epi32(target);
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i k = _mm_loadu_si128((const __m128i*)(keys + i));
+        acc = _mm_sub_epi32(acc, _mm_cmplt_epi32(k, t));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    int count = _mm_cvtsi128_si32(acc);
+    for (; i < n; i++) count += keys[i] < target;
+    return count;
+}
+
+// Keys <= target: n minus the keys > target
+static inline int bpt_count_less_equal(const BptKey* keys, int n, BptKey target) {
+    __m128i t = _mm_set1_epi32(target);
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i k = _mm_loadu_si128((const __m128i*)(keys + i));
+        acc = _mm_sub_epi32(acc, _mm_cmpgt_epi32(k, t));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    int greater = _mm_cvtsi128_si32(acc);
+    for (; i < n; i++) greater += keys[i] > target;
+    return n - greater;
+}
+#else
+static inline int bpt_count_less(const BptKey* keys, int n, BptKey target) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (keys[mid] < target) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static inline int bpt_count_less_equal(const BptKey* keys, int n, BptKey target) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (keys[mid] <= target) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+#endif
+
+// ===== Nodes =====
+
+static inline BptLeaf* bpt_new_leaf(BPlusTree* t) {
+    BptLeaf* leaf = (BptLeaf*)calloc(1, sizeof(BptLeaf));
+    t->leaves++;
+    return leaf;
+}
+
+static inline BptInner* bpt_new_inner(BPlusTree* t) {
+    BptInner* inner = (BptInner*)calloc(1, sizeof(BptInner));
+    t->inners++;
+    return inner;
+}
+
+static inline void bpt_init(BPlusTree* t) {
+    memset(t, 0, sizeof(*t));
+    t->root = bpt_new_leaf(t);
+}
+
+static void bpt_free_node(void* node, int level) {
+    if (level > 0) {
+        BptInner* inner = (BptInner*)node;
+        for (int i = 0; i <= inner->count; i++) bpt_free_node(inner->children[i], level - 1);
+    }
+    free(node);
+}
+
+static inline void bpt_free(BPlusTree* t) {
+    bpt_free_node(t->root, t->height);
+    memset(t, 0, sizeof(*t));
+}
+
+static inline BptLeaf* bpt_find_leaf(const BPlusTree* t, BptKey key) {
+    void* node = t->root;
+    for (int level = t->height; level > 0; level--) {
+        BptInner* inner = (BptInner*)node;
+        node = inner->children[bpt_count_less_equal(inner->keys, inner->count, key)];
+    }
+    return (BptLeaf*)node;
+}
+
+static inline int bpt_find(const BPlusTree* t, BptKey key, BptValue* value) {
+    BptLeaf* leaf = bpt_find_leaf(t, key);
+    int i = bpt_count_less(leaf->keys, leaf->count, key);
+    if (i < leaf->count && leaf->keys[i] == key) {
+        if (value) *value = leaf->values[i];
+        return 1;
+    }
+    return 0;
+}
+
+// ===== Range scans =====
+
+// First key >= key
+static inline BptIter bpt_lower_bound(const BPlusTree* t, BptKey key) {
+    BptIter it;
+    it.leaf = bpt_find_leaf(t, key);
+    it.index = bpt_count_less(it.leaf->keys, it.leaf->count, key);
+    if (it.index == it.leaf->count) {
+        it.leaf = it.leaf->next;
+        it.index = 0;
+    }
+    return it;
+}
+
+static inline BptIter bpt_first(const BPlusTree* t) {
+    void* node = t->root;
+    for (int level = t->height; level > 0; level--) node = ((BptInner*)node)->children[0];
+    BptIter it = { (BptLeaf*)node, 0 };
+    if (it.leaf->count == 0) it.leaf = NULL;
+    return it;
+}
+
+static inline int bpt_iter_valid(const BptIter* it) { return it->leaf != NULL; }
+static inline BptKey bpt_iter_key(const BptIter* it) { return it->leaf->keys[it->index]; }
+static inline BptValue bpt_iter_value(const BptIter* it) { return it->leaf->values[it->index]; }
+
+static inline void bpt_iter_next(BptIter* it) {
+    if (++it->index == it->leaf->count) {
+        it->leaf = it->leaf->next;
+        it->index = 0;
+    }
+}
+
+// ===== Insert =====
+
+/*
+ * Returns 1 if the key was new. A full node splits in half and hands
+ * its parent a separator key and the new right node; a split of the
+ * root adds a level on top.
+ */
+static int bpt_insert_rec(BPlusTree* t, void* node, int level, BptKey key, BptValue value,
+                          BptKey* split_key, void** split_node) {
+    *split_node = NULL;
+    if (level == 0) {
+        BptLeaf* leaf = (BptLeaf*)node;
+        int i = bpt_count_less(leaf->keys, leaf->count, key);
+        if (i < leaf->count && leaf->keys[i] == key) {
+            leaf->values[i] = value;
+            return 0;
+        }
+        if (leaf->count == BPT_MAX) {
+            BptLeaf* right = bpt_new_leaf(t);
+            int half = BPT_MAX / 2;
+            right->count = BPT_MAX - half;
+            memcpy(right->keys, leaf->keys + half, right->count * sizeof(BptKey));
+            memcpy(right->values, leaf->values + half, right->count * sizeof(BptValue));
+            leaf->count = half;
+            right->next = leaf->next;
+            right->prev = leaf;
+            if (leaf->next) leaf->next->prev = right;
+            leaf->next = right;
+            *split_key = right->keys[0];
+            *split_node = right;
+            if (i > half) {
+                leaf = right;
+                i -= half;
+            }
+        }
+        memmove(leaf->keys + i + 1, leaf->keys + i, (leaf->count - i) * sizeof(BptKey));
+        memmove(leaf->values + i + 1, leaf->values + i, (leaf->count - i) * sizeof(BptValue));
+        leaf->keys[i] = key;
+        leaf->values[i] = value;
+        leaf->count++;
+        return 1;
+    }
+
+    BptInner* inner = (BptInner*)node;
+    int c = bpt_count_less_equal(inner->keys, inner->count, key);
+    BptKey child_key;
+    void* child_node;
+    int inserted = bpt_insert_rec(t, inner->children[c], level - 1, key, value, &child_key, &child_node);
+    if (!child_node) return inserted;
+
+    if (inner->count < BPT_MAX) {
+        memmove(inner->keys + c + 1, inner->keys + c, (inner->count - c) * sizeof(BptKey));
+        memmove(inner->children + c + 2, inner->children + c + 1, (inner->count - c) * sizeof(void*));
+        inner->keys[c] = child_key;
+        inner->children[c + 1] = child_node;
+        inner->count++;
+        return inserted;
+    }
+
+    // Full: lay out all BPT_MAX + 1 keys, keep half, push the middle one up
+    BptKey keys[BPT_MAX + 1];
+    void* children[BPT_MAX + 2];
+    memcpy(keys, inner->keys, c * sizeof(BptKey));
+    keys[c] = child_key;
+    memcpy(keys + c + 1, inner->keys + c, (BPT_MAX - c) * sizeof(BptKey));
+    memcpy(children, inner->children, (c + 1) * sizeof(void*));
+    children[c + 1] = child_node;
+    memcpy(children + c + 2, inner->children + c + 1, (BPT_MAX - c) * sizeof(void*));
+
+    int half = BPT_MAX / 2;
+    BptInner* right = bpt_new_inner(t);
+    inner->count = half;
+    memcpy(inner->keys, keys, half * sizeof(BptKey));
+    memcpy(inner->children, children, (half + 1) * sizeof(void*));
+    right->count = BPT_MAX - half;
+    memcpy(right->keys, keys + half + 1, right->count * sizeof(BptKey));
+    memcpy(right->children, children + half + 1, (right->count + 1) * sizeof(void*));
+    *split_key = keys[half];
+    *split_node = right;
+    return inserted;
+}
+
+static inline int bpt_insert(BPlusTree* t, BptKey key, BptValue value) {
+    BptKey split_key;
+    void* split_node;
+    int inserted = bpt_insert_rec(t, t->root, t->height, key, value, &split_key, &split_node);
+    if (split_node) {
+        BptInner* root = bpt_new_inner(t);
+        root->count = 1;
+        root->keys[0] = split_key;
+        root->children[0] = t->root;
+        root->children[1] = split_node;
+        t->root = root;
+        t->height++;
+    }
+    t->count += inserted;
+    return inserted;
+}
+
+// ===== Delete =====
+
+// Child c of parent is below its minimum: borrow from a sibling with
+// keys to spare, otherwise merge with one (the parent loses a key)
+static void bpt_fix_underflow(BPlusTree* t, BptInner* parent, int c, int child_level) {
+    if (child_level == 0) {
+        BptLeaf* child = (BptLeaf*)parent->children[c];
+        BptLeaf* left = c > 0 ? (BptLeaf*)parent->children[c - 1] : NULL;
+        BptLeaf* right = c < parent->count ? (BptLeaf*)parent->children[c + 1] : NULL;
+        if (left && left->count > BPT_MIN_LEAF) {
+            memmove(child->keys + 1, child->keys, child->count * sizeof(BptKey));
+            memmove(child->values + 1, child->values, child->count * sizeof(BptValue));
+            left->count--;
+            child->keys[0] = left->keys[left->count];
+            child->values[0] = left->values[left->count];
+            child->count++;
+            parent->keys[c - 1] = child->keys[0];
+            return;
+        }
+        if (right && right->count > BPT_MIN_LEAF) {
+            child->keys[child->count] = right->keys[0];
+            child->values[child->count] = right->values[0];
+            child->count++;
+            right->count--;
+            memmove(right->keys, right->keys + 1, right->count * sizeof(BptKey));
+            memmove(right->values, right->values + 1, right->count * sizeof(BptValue));
+            parent->keys[c] = right->keys[0];
+            return;
+        }
+        // Merge the right one of the pair into the left one
+        if (!left) {
+            left = child;
+            child = right;
+            c++;
+        }
+        memcpy(left->keys + left->count, child->keys, child->count * sizeof(BptKey));
+        memcpy(left->values + left->count, child->values, child->count * sizeof(BptValue));
+        left->count += child->count;
+        left->next = child->next;
+        if (child->next) child->next->prev = left;
+        free(child);
+        t->leaves--;
+    } else {
+        BptInner* child = (BptInner*)parent->children[c];
+        BptInner* left = c > 0 ? (BptInner*)parent->children[c - 1] : NULL;
+        BptInner* right = c < parent->count ? (BptInner*)parent->children[c + 1] : NULL;
+        // Inner nodes rotate through the parent: its separator comes
+        // down, the sibling's edge key goes up
+        if (left && left->count > BPT_MIN_INNER) {
+            memmove(child->keys + 1, child->keys, child->count * sizeof(BptKey));
+            memmove(child->children + 1, child->children, (child->count + 1) * sizeof(void*));
+            child->keys[0] = parent->keys[c - 1];
+            child->children[0] = left->children[left->count];
+            child->count++;
+            parent->keys[c - 1] = left->keys[left->count - 1];
+            left->count--;
+            return;
+        }
+        if (right && right->count > BPT_MIN_INNER) {
+            child->keys[child->count] = parent->keys[c];
+            child->children[child->count + 1] = right->children[0];
+            child->count++;
+            parent->keys[c] = right->keys[0];
+            memmove(right->keys, right->keys + 1, (right->count - 1) * sizeof(BptKey));
+            memmove(right->children, right->children + 1, right->count * sizeof(void*));
+            right->count--;
+            return;
+        }
+        if (!left) {
+            left = child;
+            child = right;
+            c++;
+        }
+        left->keys[left->count] = parent->keys[c - 1];
+        memcpy(left->keys + left->count + 1, child->keys, child->count * sizeof(BptKey));
+        memcpy(left->children + left->count + 1, child->children, (child->count + 1) * sizeof(void*));
+        left->count += child->count + 1;
+        free(child);
+        t->inners--;
+    }
+    // Drop separator c - 1 and child c from the parent
+    memmove(parent->keys + c - 1, parent->keys + c, (parent->count - c) * sizeof(BptKey));
+    memmove(parent->children + c, parent->children + c + 1, (parent->count - c) * sizeof(void*));
+    parent->count--;
+}
+
+static int bpt_remove_rec(BPlusTree* t, void* node, int level, BptKey key) {
+    if (level == 0) {
+        BptLeaf* leaf = (BptLeaf*)node;
+        int i = bpt_count_less(leaf->keys, leaf->count, key);
+        if (i == leaf->count || leaf->keys[i] != key) return 0;
+        leaf->count--;
+        memmove(leaf->keys + i, leaf->keys + i + 1, (leaf->count - i) * sizeof(BptKey));
+        memmove(leaf->values + i, leaf->values + i + 1, (leaf->count - i) * sizeof(BptValue));
+        return 1;
+    }
+    BptInner* inner = (BptInner*)node;
+    int c = bpt_count_less_equal(inner->keys, inner->count, key);
+    if (!bpt_remove_rec(t, inner->children[c], level - 1, key)) return 0;
+    int child_count = level == 1 ? ((BptLeaf*)inner->children[c])->count
+                                 : ((BptInner*)inner->children[c])->count;
+    if (child_count < (level == 1 ? BPT_MIN_LEAF : BPT_MIN_INNER)) {
+        bpt_fix_underflow(t, inner, c, level - 1);
+    }
+    return 1;
+}
+
+static inline int bpt_remove(BPlusTree* t, BptKey key) {
+    if (!bpt_remove_rec(t, t->root, t->height, key)) return 0;
+    t->count--;
+    // A root left with one child steps down: the tree gets shorter
+    if (t->height > 0 && ((BptInner*)t->root)->count == 0) {
+        BptInner* old = (BptInner*)t->root;
+        t->root = old->children[0];
+        t->height--;
+        free(old);
+        t->inners--;
+    }
+    return 1;
+}
+
+// ===== Bulk loading =====
+
+/*
+ * Builds a tree from n strictly increasing keys in O(n): fill leaves
+ * left to right, then each level of inner nodes from the one below.
+ * Entries are spread evenly so every node is nearly full and none is
+ * below its minimum. Replaces any existing contents. Returns 0 (and
+ * leaves an empty tree) if the keys aren't sorted.
+ */
+static inline int bpt_bulk_load(BPlusTree* t, const BptKey* keys, const BptValue* values, size_t n) {
+    bpt_free(t);
+    bpt_init(t);
+    for (size_t i = 1; i < n; i++) {
+        if (keys[i - 1] >= keys[i]) return 0;
+    }
+    if (n == 0) return 1;
+
+    size_t nodes = (n + BPT_MAX - 1) / BPT_MAX;
+    void** level = (void**)malloc(nodes * sizeof(void*));
+    BptKey* low = (BptKey*)malloc(nodes * sizeof(BptKey));  // Smallest key under each node
+    BptLeaf* prev = NULL;
+    size_t pos = 0;
+    free(t->root);
+    t->leaves = 0;
+    for (size_t i = 0; i < nodes; i++) {
+        BptLeaf* leaf = bpt_new_leaf(t);
+        leaf->count = (int)(n * (i + 1) / nodes - n * i / nodes);
+        memcpy(leaf->keys, keys + pos, leaf->count * sizeof(BptKey));
+        memcpy(leaf->values, values + pos, leaf->count * sizeof(BptValue));
+        pos += leaf->count;
+        leaf->prev = prev;
+        if (prev) prev->next = leaf;
+        prev = leaf;
+        level[i] = leaf;
+        low[i] = leaf->keys[0];
+    }
+
+    while (nodes > 1) {
+        size_t parents = (nodes + BPT_MAX) / (BPT_MAX + 1);
+        size_t child = 0;
+        for (size_t i = 0; i < parents; i++) {
+            BptInner* inner = bpt_new_inner(t);
+            size_t end = nodes * (i + 1) / parents;
+            BptKey first = low[child];
+            inner->children[0] = level[child++];
+            while (child < end) {
+                inner->keys[inner->count] = low[child];
+                inner->children[++inner->count] = level[child++];
+            }
+            level[i] = inner;
+            low[i] = first;
+        }
+        nodes = parents;
+        t->height++;
+    }
+    t->root = level[0];
+    t->count = n;
+    free(level);
+    free(low);
+    return 1;
+}
+
+// Fraction of key slots in use
+static inline double bpt_fill(const BPlusTree* t) {
+    size_t inner_keys = t->leaves > 0 ? t->leaves - 1 : 0;
+    size_t slots = (t->leaves + t->inners) * BPT_MAX;
+    return slots ? (double)(t->count + inner_keys) / slots : 0;
+}
+
+#endif
@@ -37,6 +37,38 @@ echo Building 08_heap...
 gcc 08_heap.c -o bin\08_heap.exe
 if %ERRORLEVEL% NEQ 0 goto error
 
+echo Building 09_swiss_table...
+gcc -O2 09_swiss_table.c -o bin\09_swiss_table.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 10_concurrent_hash_map...
+gcc -O2 10_concurrent_hash_map.c -o bin\10_concurrent_hash_map.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 11_bplus_tree...
+gcc -O2 11_bplus_tree.c -o bin\11_bplus_tree.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 12_csr_graph...
+gcc -O2 12_csr_graph.c csr_graph.c -o bin\12_csr_graph.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 13_shortest_paths...
+gcc -O2 13_shortest_paths.c graph_algos.c csr_graph.c -o bin\13_shortest_paths.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 14_priority_queues...
+gcc -O2 14_priority_queues.c -o bin\14_priority_queues.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 15_timer_wheel...
+gcc -O2 15_timer_wheel.c -o bin\15_timer_wheel.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 16_unrolled_intrusive_lists...
+gcc -O2 16_unrolled_intrusive_lists.c -o bin\16_unrolled_intrusive_lists.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
 echo.
 echo All examples built successfully!
 echo Run them from bin\
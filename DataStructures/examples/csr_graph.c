@@ -0,0 +1,558 @@
+/*
+ * CSR graph - implementation
+ *
+ * See csr_graph.h for the API. The BFS switching rule and its
+ * constants (alpha = 15, beta = 18) are from Beamer, Asanovic and
+ * Patterson, "Direction-Optimizing Breadth-First Search" (SC'12).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "csr_graph.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+    typedef CRITICAL_SECTION mutex_t;
+    typedef CONDITION_VARIABLE cond_t;
+
+    static void mutex_init(mutex_t* m) { InitializeCriticalSection(m); }
+    static void mutex_lock(mutex_t* m) { EnterCriticalSection(m); }
+    static void mutex_unlock(mutex_t* m) { LeaveCriticalSection(m); }
+    static void mutex_destroy(mutex_t* m) { DeleteCriticalSection(m); }
+
+    static void cond_init(cond_t* c) { InitializeConditionVariable(c); }
+    static void cond_wait(cond_t* c, mutex_t* m) { SleepConditionVariableCS(c, m, INFINITE); }
+    static void cond_broadcast(cond_t* c) { WakeAllConditionVariable(c); }
+    static void cond_destroy(cond_t* c) { (void)c; }
+
+    static void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    }
+    static void thread_join(thread_t t) {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+    int csr_cpu_count(void) {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return (int)info.dwNumberOfProcessors;
+    }
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+    typedef pthread_mutex_t mutex_t;
+    typedef pthread_cond_t cond_t;
+
+    static void mutex_init(mutex_t* m) { pthread_mutex_init(m, NULL); }
+    static void mutex_lock(mutex_t* m) { pthread_mutex_lock(m); }
+    static void mutex_unlock(mutex_t* m) { pthread_mutex_unlock(m); }
+    static void mutex_destroy(mutex_t* m) { pthread_mutex_destroy(m); }
+
+    static void cond_init(cond_t* c) { pthread_cond_init(c, NULL); }
+    static void cond_wait(cond_t* c, mutex_t* m) { pthread_cond_wait(c, m); }
+    static void cond_broadcast(cond_t* c) { pthread_cond_broadcast(c); }
+    static void cond_destroy(cond_t* c) { pthread_cond_destroy(c); }
+
+    static void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        pthread_create(t, NULL, fn, arg);
+    }
+    static void thread_join(thread_t t) {
+        pthread_join(t, NULL);
+    }
+    int csr_cpu_count(void) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n > 0 ? (int)n : 1;
+    }
+#endif
+
+#define BFS_ALPHA 15                    // Go bottom-up when frontier edges > unexplored / alpha
+#define BFS_BETA 18                     // Back to top-down when frontier < vertices / beta
+#define BFS_MAX_THREADS 64
+#define TOP_DOWN_CHUNK 64               // Frontier vertices per grab
+#define BOTTOM_UP_CHUNK 16              // Bitmap words (x64 vertices) per grab
+#define LOCAL_QUEUE 1024
+
+// ===== Building =====
+
+/*
+ * Reverses every edge. Walking the sources in increasing order appends
+ * each one to its targets' lists, so every output list comes out
+ * sorted: one O(E) scatter instead of a sort per list.
+ */
+static int transpose(int n, const int64_t* offsets, const int* neighbors, const uint32_t* weights,
+                     int64_t** offsets_out, int** neighbors_out, uint32_t** weights_out) {
+    int64_t m = offsets[n];
+    int64_t* t_offsets = (int64_t*)calloc((size_t)n + 1, sizeof(int64_t));
+    int* t_neighbors = (int*)malloc((size_t)(m > 0 ? m : 1) * sizeof(int));
+    uint32_t* t_weights = weights ? (uint32_t*)malloc((size_t)(m > 0 ? m : 1) * sizeof(uint32_t)) : NULL;
+    int64_t* fill = (int64_t*)malloc((size_t)n * sizeof(int64_t));
+    if (!t_offsets || !t_neighbors || (weights && !t_weights) || !fill) {
+        free(t_offsets);
+        free(t_neighbors);
+        free(t_weights);
+        free(fill);
+        return 0;
+    }
+    for (int64_t e = 0; e < m; e++) t_offsets[neighbors[e] + 1]++;
+    for (int v = 0; v < n; v++) t_offsets[v + 1] += t_offsets[v];
+    memcpy(fill, t_offsets, (size_t)n * sizeof(int64_t));
+    for (int v = 0; v < n; v++) {
+        for (int64_t e = offsets[v]; e < offsets[v + 1]; e++) {
+            int64_t pos = fill[neighbors[e]]++;
+            t_neighbors[pos] = v;
+            if (weights) t_weights[pos] = weights[e];
+        }
+    }
+    free(fill);
+    *offsets_out = t_offsets;
+    *neighbors_out = t_neighbors;
+    *weights_out = t_weights;
+    return 1;
+}
+
+// CsrEdge and CsrWeightedEdge start with the same src and dst fields
+#define EDGE_AT(edges, stride, i) ((const CsrEdge*)((const char*)(edges) + (size_t)(i) * (stride)))
+#define WEIGHT_AT(edges, stride, i) (((const CsrWeightedEdge*)EDGE_AT(edges, stride, i))->weight)
+
+static int build(CsrGraph* g, int n, const void* edges, size_t stride, int weighted, int64_t m, int undirected) {
+    memset(g, 0, sizeof(*g));
+    for (int64_t i = 0; i < m; i++) {
+        const CsrEdge* e = EDGE_AT(edges, stride, i);
+        if (e->src < 0 || e->src >= n || e->dst < 0 || e->dst >= n) return 0;
+    }
+    g->num_vertices = n;
+    g->symmetric = undirected;
+
+    // Pass 1: degrees, then prefix sums turn them into start positions.
+    // Lists are built reversed (dst -> src); the transpose below flips
+    // them back and sorts them in one go
+    int64_t* offsets = (int64_t*)calloc((size_t)n + 1, sizeof(int64_t));
+    if (!offsets) return 0;
+    for (int64_t i = 0; i < m; i++) {
+        const CsrEdge* e = EDGE_AT(edges, stride, i);
+        if (e->src == e->dst) continue;
+        offsets[e->dst + 1]++;
+        if (undirected) offsets[e->src + 1]++;
+    }
+    for (int v = 0; v < n; v++) offsets[v + 1] += offsets[v];
+
+    // Pass 2: drop each edge into place
+    size_t entries = (size_t)(offsets[n] > 0 ? offsets[n] : 1);
+    int* neighbors = (int*)malloc(entries * sizeof(int));
+    uint32_t* weights = weighted ? (uint32_t*)malloc(entries * sizeof(uint32_t)) : NULL;
+    int64_t* fill = (int64_t*)malloc((size_t)n * sizeof(int64_t));
+    if (!neighbors || (weighted && !weights) || !fill) {
+        free(offsets);
+        free(neighbors);
+        free(weights);
+        free(fill);
+        return 0;
+    }
+    memcpy(fill, offsets, (size_t)n * sizeof(int64_t));
+    for (int64_t i = 0; i < m; i++) {
+        const CsrEdge* e = EDGE_AT(edges, stride, i);
+        int s = e->src, d = e->dst;
+        if (s == d) continue;
+        int64_t pos = fill[d]++;
+        neighbors[pos] = s;
+        if (weighted) weights[pos] = WEIGHT_AT(edges, stride, i);
+        if (undirected) {
+            pos = fill[s]++;
+            neighbors[pos] = d;
+            if (weighted) weights[pos] = WEIGHT_AT(edges, stride, i);
+        }
+    }
+    free(fill);
+
+    int ok = transpose(n, offsets, neighbors, weights, &g->offsets, &g->neighbors, &g->weights);
+    free(offsets);
+    free(neighbors);
+    free(weights);
+    if (!ok) return 0;
+
+    // Squeeze out duplicates (now adjacent), moving lists down
+    int64_t out = 0;
+    for (int v = 0; v < n; v++) {
+        int64_t begin = g->offsets[v], end = g->offsets[v + 1];
+        g->offsets[v] = out;
+        for (int64_t e = begin; e < end; e++) {
+            if (e > begin && g->neighbors[e] == g->neighbors[e - 1]) {
+                if (g->weights && g->weights[e] < g->weights[out - 1]) g->weights[out - 1] = g->weights[e];
+                continue;
+            }
+            if (g->weights) g->weights[out] = g->weights[e];
+            g->neighbors[out++] = g->neighbors[e];
+        }
+    }
+    g->offsets[n] = out;
+    g->num_edges = out;
+    return 1;
+}
+
+int csr_build(CsrGraph* g, int n, const CsrEdge* edges, int64_t m, int undirected) {
+    return build(g, n, edges, sizeof(CsrEdge), 0, m, undirected);
+}
+
+int csr_build_weighted(CsrGraph* g, int n, const CsrWeightedEdge* edges, int64_t m, int undirected) {
+    return build(g, n, edges, sizeof(CsrWeightedEdge), 1, m, undirected);
+}
+
+void csr_free(CsrGraph* g) {
+    free(g->offsets);
+    free(g->neighbors);
+    free(g->weights);
+    memset(g, 0, sizeof(*g));
+}
+
+// ===== Parallel BFS =====
+
+typedef struct {
+    mutex_t lock;
+    cond_t cond;
+    int waiting;
+    int total;
+    unsigned generation;
+} Barrier;
+
+static void barrier_wait(Barrier* b) {
+    mutex_lock(&b->lock);
+    unsigned generation = b->generation;
+    if (++b->waiting == b->total) {
+        b->waiting = 0;
+        b->generation++;
+        cond_broadcast(&b->cond);
+    } else {
+        while (generation == b->generation) cond_wait(&b->cond, &b->lock);
+    }
+    mutex_unlock(&b->lock);
+}
+
+typedef struct {
+    const CsrGraph* g;
+    int* depth;
+    int threads;
+    CsrBfsMode mode;
+    Barrier barrier;
+
+    // Set by thread 0 between levels
+    int level;                          // Depth of the current frontier
+    int bottom_up;
+    int done;
+    int64_t unexplored_edges;
+    int64_t frontier_size;
+
+    // Top-down frontier: a queue
+    int* queue;
+    int* next_queue;
+    _Atomic int64_t next_size;
+
+    // Bottom-up frontier: a bitmap
+    _Atomic uint64_t* frontier_bits;
+    _Atomic uint64_t* next_bits;
+    _Atomic uint64_t* visited;
+    int64_t words;
+
+    _Atomic int64_t cursor;             // Next chunk of work
+    _Atomic int64_t next_edges;         // Sum of degrees of the next frontier
+    _Atomic int64_t next_count;
+    _Atomic int64_t edges_checked;
+    int bottom_up_levels;
+} Bfs;
+
+typedef struct {
+    Bfs* bfs;
+    int id;
+} BfsWorker;
+
+static void top_down_step(Bfs* b) {
+    const CsrGraph* g = b->g;
+    int local[LOCAL_QUEUE];
+    int count = 0;
+    int64_t edges = 0, checked = 0;
+    int next_depth = b->level + 1;
+
+    for (;;) {
+        int64_t start = atomic_fetch_add_explicit(&b->cursor, TOP_DOWN_CHUNK, memory_order_relaxed);
+        if (start >= b->frontier_size) break;
+        int64_t end = start + TOP_DOWN_CHUNK < b->frontier_size ? start + TOP_DOWN_CHUNK : b->frontier_size;
+        for (int64_t i = start; i < end; i++) {
+            int u = b->queue[i];
+            for (int64_t e = g->offsets[u]; e < g->offsets[u + 1]; e++) {
+                int v = g->neighbors[e];
+                uint64_t bit = 1ull << (v & 63);
+                checked++;
+                // Cheap read first; the atomic OR decides who claims v
+                if (atomic_load_explicit(&b->visited[v >> 6], memory_order_relaxed) & bit) continue;
+                if (atomic_fetch_or_explicit(&b->visited[v >> 6], bit, memory_order_relaxed) & bit) continue;
+                b->depth[v] = next_depth;
+                edges += csr_degree(g, v);
+                local[count++] = v;
+                if (count == LOCAL_QUEUE) {
+                    int64_t pos = atomic_fetch_add_explicit(&b->next_size, count, memory_order_relaxed);
+                    memcpy(b->next_queue + pos, local, count * sizeof(int));
+                    count = 0;
+                }
+            }
+        }
+    }
+    int64_t pos = atomic_fetch_add_explicit(&b->next_size, count, memory_order_relaxed);
+    memcpy(b->next_queue + pos, local, count * sizeof(int));
+    atomic_fetch_add_explicit(&b->next_edges, edges, memory_order_relaxed);
+    atomic_fetch_add_explicit(&b->edges_checked, checked, memory_order_relaxed);
+}
+
+// Each thread owns whole bitmap words, so visited and next_bits need
+// no atomic read-modify-write here
+static void bottom_up_step(Bfs* b) {
+    const CsrGraph* g = b->g;
+    int n = g->num_vertices;
+    int64_t edges = 0, checked = 0, found = 0;
+    int next_depth = b->level + 1;
+
+    for (;;) {
+        int64_t start = atomic_fetch_add_explicit(&b->cursor, BOTTOM_UP_CHUNK, memory_order_relaxed);
+        if (start >= b->words) break;
+        int64_t end = start + BOTTOM_UP_CHUNK < b->words ? start + BOTTOM_UP_CHUNK : b->words;
+        for (int64_t w = start; w < end; w++) {
+            uint64_t seen = atomic_load_explicit(&b->visited[w], memory_order_relaxed);
+            uint64_t fresh = 0;
+            int last = (w + 1) * 64 < n ? (int)((w + 1) * 64) : n;
+            for (int v = (int)(w * 64); v < last; v++) {
+                if (seen & (1ull << (v & 63))) continue;
+                for (int64_t e = g->offsets[v]; e < g->offsets[v + 1]; e++) {
+                    int u = g->neighbors[e];
+                    checked++;
+                    if (atomic_load_explicit(&b->frontier_bits[u >> 6], memory_order_relaxed) & (1ull << (u & 63))) {
+                        b->depth[v] = next_depth;
+                        fresh |= 1ull << (v & 63);
+                        edges += csr_degree(g, v);
+                        found++;
+                        break;          // One parent is enough
+                    }
+                }
+            }
+            atomic_store_explicit(&b->next_bits[w], fresh, memory_order_relaxed);
+            atomic_store_explicit(&b->visited[w], seen | fresh, memory_order_relaxed);
+        }
+    }
+    atomic_fetch_add_explicit(&b->next_edges, edges, memory_order_relaxed);
+    atomic_fetch_add_explicit(&b->next_count, found, memory_order_relaxed);
+    atomic_fetch_add_explicit(&b->edges_checked, checked, memory_order_relaxed);
+}
+
+// Thread 0, between levels: adopt the next frontier, pick a direction
+static void finish_level(Bfs* b) {
+    int n = b->g->num_vertices;
+    int64_t frontier_edges = atomic_load(&b->next_edges);
+    int64_t prev_size = b->frontier_size;
+
+    if (b->bottom_up) {
+        _Atomic uint64_t* t = b->frontier_bits;
+        b->frontier_bits = b->next_bits;
+        b->next_bits = t;
+        b->frontier_size = atomic_load(&b->next_count);
+    } else {
+        int* t = b->queue;
+        b->queue = b->next_queue;
+        b->next_queue = t;
+        b->frontier_size = atomic_load(&b->next_size);
+    }
+    b->unexplored_edges -= frontier_edges;
+    b->level++;
+    if (b->frontier_size == 0) {
+        b->done = 1;
+        return;
+    }
+
+    if (!b->bottom_up) {
+        if (b->mode == CSR_BFS_AUTO && b->g->symmetric && frontier_edges > b->unexplored_edges / BFS_ALPHA) {
+            memset((void*)b->frontier_bits, 0, b->words * sizeof(uint64_t));
+            for (int64_t i = 0; i < b->frontier_size; i++) {
+                int v = b->queue[i];
+                b->frontier_bits[v >> 6] |= 1ull << (v & 63);
+            }
+            b->bottom_up = 1;
+        }
+    } else if (b->frontier_size < n / BFS_BETA && b->frontier_size < prev_size) {
+        int64_t size = 0;
+        for (int64_t w = 0; w < b->words; w++) {
+            uint64_t bits = b->frontier_bits[w];
+            while (bits) {
+                int bit = __builtin_ctzll(bits);
+                b->queue[size++] = (int)(w * 64 + bit);
+                bits &= bits - 1;
+            }
+        }
+        b->bottom_up = 0;
+    }
+    b->bottom_up_levels += b->bottom_up;
+    atomic_store(&b->cursor, 0);
+    atomic_store(&b->next_size, 0);
+    atomic_store(&b->next_edges, 0);
+    atomic_store(&b->next_count, 0);
+}
+
+static THREAD_FUNC bfs_worker(void* arg) {
+    BfsWorker* w = (BfsWorker*)arg;
+    Bfs* b = w->bfs;
+    for (;;) {
+        barrier_wait(&b->barrier);
+        if (b->done) break;
+        if (b->bottom_up) bottom_up_step(b);
+        else top_down_step(b);
+        barrier_wait(&b->barrier);
+        if (w->id == 0) finish_level(b);
+    }
+    THREAD_RETURN;
+}
+
+int csr_bfs(const CsrGraph* g, int source, int* depth, int threads, CsrBfsMode mode, CsrBfsStats* stats) {
+    int n = g->num_vertices;
+    if (threads <= 0) threads = csr_cpu_count();
+    if (threads > BFS_MAX_THREADS) threads = BFS_MAX_THREADS;
+
+    Bfs b;
+    memset(&b, 0, sizeof(b));
+    b.g = g;
+    b.depth = depth;
+    b.threads = threads;
+    b.mode = mode;
+    b.words = (n + 63) / 64;
+    b.queue = (int*)malloc((size_t)n * sizeof(int));
+    b.next_queue = (int*)malloc((size_t)n * sizeof(int));
+    b.frontier_bits = (_Atomic uint64_t*)calloc((size_t)b.words, sizeof(uint64_t));
+    b.next_bits = (_Atomic uint64_t*)calloc((size_t)b.words, sizeof(uint64_t));
+    b.visited = (_Atomic uint64_t*)calloc((size_t)b.words, sizeof(uint64_t));
+    mutex_init(&b.barrier.lock);
+    cond_init(&b.barrier.cond);
+    b.barrier.total = threads;
+
+    for (int v = 0; v < n; v++) depth[v] = -1;
+    depth[source] = 0;
+    b.visited[source >> 6] = 1ull << (source & 63);
+    b.queue[0] = source;
+    b.frontier_size = 1;
+    b.unexplored_edges = g->num_edges - csr_degree(g, source);
+
+    BfsWorker workers[BFS_MAX_THREADS];
+    thread_t tids[BFS_MAX_THREADS];
+    for (int i = 0; i < threads; i++) {
+        workers[i].bfs = &b;
+        workers[i].id = i;
+    }
+    for (int i = 1; i < threads; i++) thread_create(&tids[i], bfs_worker, &workers[i]);
+    bfs_worker(&workers[0]);
+    for (int i = 1; i < threads; i++) thread_join(tids[i]);
+
+    int reached = 0;
+    for (int64_t w = 0; w < b.words; w++) reached += __builtin_popcountll(b.visited[w]);
+    if (stats) {
+        stats->levels = b.level;
+        stats->bottom_up_levels = b.bottom_up_levels;
+        stats->edges_checked = b.edges_checked;
+    }
+
+    mutex_destroy(&b.barrier.lock);
+    cond_destroy(&b.barrier.cond);
+    free(b.queue);
+    free(b.next_queue);
+    free((void*)b.frontier_bits);
+    free((void*)b.next_bits);
+    free((void*)b.visited);
+    return reached;
+}
+
+// ===== Iterative traversals =====
+
+int csr_dfs(const CsrGraph* g, int start, int* order) {
+    int n = g->num_vertices;
+    unsigned char* visited = (unsigned char*)calloc((size_t)n, 1);
+    int* stack = (int*)malloc((size_t)n * sizeof(int));
+    int64_t* next_edge = (int64_t*)malloc((size_t)n * sizeof(int64_t));  // Per stack entry
+    int top = 0, count = 0;
+
+    visited[start] = 1;
+    order[count++] = start;
+    stack[top] = start;
+    next_edge[top++] = g->offsets[start];
+    while (top > 0) {
+        int v = stack[top - 1];
+        if (next_edge[top - 1] == g->offsets[v + 1]) {
+            top--;                      // All neighbours done: backtrack
+            continue;
+        }
+        int w = g->neighbors[next_edge[top - 1]++];
+        if (!visited[w]) {
+            visited[w] = 1;
+            order[count++] = w;
+            stack[top] = w;
+            next_edge[top++] = g->offsets[w];
+        }
+    }
+    free(visited);
+    free(stack);
+    free(next_edge);
+    return count;
+}
+
+int csr_has_path(const CsrGraph* g, int from, int to) {
+    if (from == to) return 1;
+    int n = g->num_vertices;
+    unsigned char* visited = (unsigned char*)calloc((size_t)n, 1);
+    int* queue = (int*)malloc((size_t)n * sizeof(int));
+    int head = 0, tail = 0, found = 0;
+    visited[from] = 1;
+    queue[tail++] = from;
+    while (head < tail && !found) {
+        int v = queue[head++];
+        for (int64_t e = g->offsets[v]; e < g->offsets[v + 1]; e++) {
+            int w = g->neighbors[e];
+            if (w == to) {
+                found = 1;
+                break;
+            }
+            if (!visited[w]) {
+                visited[w] = 1;
+                queue[tail++] = w;
+            }
+        }
+    }
+    free(visited);
+    free(queue);
+    return found;
+}
+
+int csr_components(const CsrGraph* g, int* label) {
+    int n = g->num_vertices;
+    int* queue = (int*)malloc((size_t)n * sizeof(int));
+    int count = 0;
+    for (int v = 0; v < n; v++) label[v] = -1;
+    for (int s = 0; s < n; s++) {
+        if (label[s] >= 0) continue;
+        int head = 0, tail = 0;
+        label[s] = count;
+        queue[tail++] = s;
+        while (head < tail) {
+            int v = queue[head++];
+            for (int64_t e = g->offsets[v]; e < g->offsets[v + 1]; e++) {
+                int w = g->neighbors[e];
+                if (label[w] < 0) {
+                    label[w] = count;
+                    queue[tail++] = w;
+                }
+            }
+        }
+        count++;
+    }
+    free(queue);
+    return count;
+}
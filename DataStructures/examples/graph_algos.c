@@ -0,0 +1,595 @@
+/*
+ * Shortest paths and connectivity - implementation
+ *
+ * See graph_algos.h for the API. Delta-stepping follows Meyer and
+ * Sanders, "Delta-stepping: a parallelizable shortest path algorithm"
+ * (2003), in the simplified form of the GAP benchmark suite: every
+ * edge of a vertex is relaxed together (no light/heavy split), and each
+ * thread keeps its own buckets.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "graph_algos.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+    typedef CRITICAL_SECTION mutex_t;
+    typedef CONDITION_VARIABLE cond_t;
+
+    static void mutex_init(mutex_t* m) { InitializeCriticalSection(m); }
+    static void mutex_lock(mutex_t* m) { EnterCriticalSection(m); }
+    static void mutex_unlock(mutex_t* m) { LeaveCriticalSection(m); }
+    static void mutex_destroy(mutex_t* m) { DeleteCriticalSection(m); }
+
+    static void cond_init(cond_t* c) { InitializeConditionVariable(c); }
+    static void cond_wait(cond_t* c, mutex_t* m) { SleepConditionVariableCS(c, m, INFINITE); }
+    static void cond_broadcast(cond_t* c) { WakeAllConditionVariable(c); }
+    static void cond_destroy(cond_t* c) { (void)c; }
+
+    static void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    }
+    static void thread_join(thread_t t) {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+#else
+    #include <pthread.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+    typedef pthread_mutex_t mutex_t;
+    typedef pthread_cond_t cond_t;
+
+    static void mutex_init(mutex_t* m) { pthread_mutex_init(m, NULL); }
+    static void mutex_lock(mutex_t* m) { pthread_mutex_lock(m); }
+    static void mutex_unlock(mutex_t* m) { pthread_mutex_unlock(m); }
+    static void mutex_destroy(mutex_t* m) { pthread_mutex_destroy(m); }
+
+    static void cond_init(cond_t* c) { pthread_cond_init(c, NULL); }
+    static void cond_wait(cond_t* c, mutex_t* m) { pthread_cond_wait(c, m); }
+    static void cond_broadcast(cond_t* c) { pthread_cond_broadcast(c); }
+    static void cond_destroy(cond_t* c) { pthread_cond_destroy(c); }
+
+    static void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        pthread_create(t, NULL, fn, arg);
+    }
+    static void thread_join(thread_t t) {
+        pthread_join(t, NULL);
+    }
+#endif
+
+#define MAX_THREADS 64
+#define RELAX_CHUNK 64                  // Frontier vertices per grab
+
+// ===== Priority queues =====
+
+/*
+ * Both queues hold (distance, vertex) and never update an entry: a
+ * shorter distance is pushed again, and the stale entry is skipped when
+ * it comes out (its key no longer matches dist[]). That costs a few
+ * extra pushes but no position tracking.
+ */
+typedef struct {
+    uint64_t key;
+    int vertex;
+} QueueEntry;
+
+typedef struct {
+    QueueEntry* items;
+    size_t size;
+    size_t capacity;
+} DHeap;
+
+static void dheap_init(DHeap* h) {
+    h->capacity = 1024;
+    h->size = 0;
+    h->items = (QueueEntry*)malloc(h->capacity * sizeof(QueueEntry));
+}
+
+// d is a constant at every call site, so the divisions become shifts
+static inline void dheap_push(DHeap* h, uint64_t key, int vertex, const int d) {
+    if (h->size == h->capacity) {
+        h->capacity *= 2;
+        h->items = (QueueEntry*)realloc(h->items, h->capacity * sizeof(QueueEntry));
+    }
+    size_t i = h->size++;
+    while (i > 0) {
+        size_t parent = (i - 1) / d;
+        if (h->items[parent].key <= key) break;
+        h->items[i] = h->items[parent];
+        i = parent;
+    }
+    h->items[i].key = key;
+    h->items[i].vertex = vertex;
+}
+
+static inline QueueEntry dheap_pop(DHeap* h, const int d) {
+    QueueEntry top = h->items[0];
+    QueueEntry last = h->items[--h->size];
+    size_t i = 0;
+    for (;;) {
+        size_t first = i * d + 1;
+        if (first >= h->size) break;
+        size_t end = first + d < h->size ? first + d : h->size;
+        size_t best = first;
+        for (size_t c = first + 1; c < end; c++) {
+            if (h->items[c].key < h->items[best].key) best = c;
+        }
+        if (h->items[best].key >= last.key) break;
+        h->items[i] = h->items[best];
+        i = best;
+    }
+    h->items[i] = last;
+    return top;
+}
+
+/*
+ * Radix heap (Ahuja et al. 1990). Dijkstra pops keys in increasing
+ * order, so every key still queued is >= the last one popped. Bucket b
+ * holds keys whose highest bit differing from `last` is bit b - 1
+ * (bucket 0: equal to last). Popping empties the lowest non-empty
+ * bucket into smaller ones around its minimum; each entry only ever
+ * moves down, at most 64 times.
+ */
+typedef struct {
+    QueueEntry* items;
+    size_t size;
+    size_t capacity;
+} Bucket;
+
+typedef struct {
+    Bucket buckets[65];
+    uint64_t last;
+    size_t size;
+} RadixHeap;
+
+static inline int radix_bucket(uint64_t key, uint64_t last) {
+    return key == last ? 0 : 64 - __builtin_clzll(key ^ last);
+}
+
+static inline void bucket_push(Bucket* b, QueueEntry e) {
+    if (b->size == b->capacity) {
+        b->capacity = b->capacity ? b->capacity * 2 : 64;
+        b->items = (QueueEntry*)realloc(b->items, b->capacity * sizeof(QueueEntry));
+    }
+    b->items[b->size++] = e;
+}
+
+static inline void radix_push(RadixHeap* h, uint64_t key, int vertex) {
+    QueueEntry e = { key, vertex };
+    bucket_push(&h->buckets[radix_bucket(key, h->last)], e);
+    h->size++;
+}
+
+static QueueEntry radix_pop(RadixHeap* h) {
+    if (h->buckets[0].size == 0) {
+        int b = 1;
+        while (h->buckets[b].size == 0) b++;
+        Bucket* from = &h->buckets[b];
+        uint64_t min = from->items[0].key;
+        for (size_t i = 1; i < from->size; i++) {
+            if (from->items[i].key < min) min = from->items[i].key;
+        }
+        h->last = min;
+        for (size_t i = 0; i < from->size; i++) {
+            bucket_push(&h->buckets[radix_bucket(from->items[i].key, min)], from->items[i]);
+        }
+        from->size = 0;
+    }
+    h->size--;
+    return h->buckets[0].items[--h->buckets[0].size];
+}
+
+static void radix_free(RadixHeap* h) {
+    for (int b = 0; b < 65; b++) free(h->buckets[b].items);
+}
+
+// ===== Dijkstra =====
+
+static void dijkstra_dheap(const CsrGraph* g, int source, uint64_t* dist, const int d, SsspStats* st) {
+    DHeap heap;
+    dheap_init(&heap);
+    dist[source] = 0;
+    dheap_push(&heap, 0, source, d);
+    while (heap.size > 0) {
+        QueueEntry top = dheap_pop(&heap, d);
+        int u = top.vertex;
+        if (top.key != dist[u]) continue;  // Stale: u was reached cheaper since
+        st->settled++;
+        for (int64_t e = g->offsets[u]; e < g->offsets[u + 1]; e++) {
+            int v = g->neighbors[e];
+            uint64_t nd = top.key + g->weights[e];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                st->relaxed++;
+                dheap_push(&heap, nd, v, d);
+            }
+        }
+    }
+    free(heap.items);
+}
+
+static void dijkstra_radix(const CsrGraph* g, int source, uint64_t* dist, SsspStats* st) {
+    RadixHeap heap;
+    memset(&heap, 0, sizeof(heap));
+    dist[source] = 0;
+    radix_push(&heap, 0, source);
+    while (heap.size > 0) {
+        QueueEntry top = radix_pop(&heap);
+        int u = top.vertex;
+        if (top.key != dist[u]) continue;
+        st->settled++;
+        for (int64_t e = g->offsets[u]; e < g->offsets[u + 1]; e++) {
+            int v = g->neighbors[e];
+            uint64_t nd = top.key + g->weights[e];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                st->relaxed++;
+                radix_push(&heap, nd, v);
+            }
+        }
+    }
+    radix_free(&heap);
+}
+
+void sssp_dijkstra(const CsrGraph* g, int source, uint64_t* dist, SsspQueue queue, SsspStats* stats) {
+    SsspStats st = { 0, 0, 0 };
+    for (int v = 0; v < g->num_vertices; v++) dist[v] = SSSP_INF;
+    if (queue == SSSP_RADIX_HEAP) dijkstra_radix(g, source, dist, &st);
+    else if (queue == SSSP_QUAD_HEAP) dijkstra_dheap(g, source, dist, 4, &st);
+    else dijkstra_dheap(g, source, dist, 2, &st);
+    if (stats) *stats = st;
+}
+
+// ===== Delta-stepping =====
+
+typedef struct {
+    int* items;
+    size_t size;
+    size_t capacity;
+} IntVec;
+
+static inline void intvec_push(IntVec* v, int x) {
+    if (v->size == v->capacity) {
+        v->capacity = v->capacity ? v->capacity * 2 : 64;
+        v->items = (int*)realloc(v->items, v->capacity * sizeof(int));
+    }
+    v->items[v->size++] = x;
+}
+
+typedef struct {
+    mutex_t lock;
+    cond_t cond;
+    int waiting;
+    int total;
+    unsigned generation;
+} Barrier;
+
+static void barrier_wait(Barrier* b) {
+    mutex_lock(&b->lock);
+    unsigned generation = b->generation;
+    if (++b->waiting == b->total) {
+        b->waiting = 0;
+        b->generation++;
+        cond_broadcast(&b->cond);
+    } else {
+        while (generation == b->generation) cond_wait(&b->cond, &b->lock);
+    }
+    mutex_unlock(&b->lock);
+}
+
+#define NO_BUCKET SIZE_MAX
+
+typedef struct {
+    const CsrGraph* g;
+    _Atomic uint64_t* dist;
+    uint64_t delta;
+    Barrier barrier;
+
+    struct DeltaWorker* workers;
+    int threads;
+    int* frontier;                      // Vertices of the current bucket
+    size_t frontier_capacity;
+    _Atomic int64_t frontier_size;
+    _Atomic int64_t cursor;
+    size_t bucket;                      // Index of the current bucket
+    _Atomic size_t next_bucket;         // Lowest non-empty bucket over all threads
+    int done;
+
+    _Atomic int64_t settled;
+    _Atomic int64_t relaxed;
+    int64_t rounds;
+} DeltaStep;
+
+typedef struct DeltaWorker {
+    DeltaStep* ds;
+    int id;
+    IntVec* buckets;                    // This thread's buckets, indexed by dist / delta
+    size_t num_buckets;
+} DeltaWorker;
+
+static void worker_push(DeltaWorker* w, size_t bucket, int v) {
+    if (bucket >= w->num_buckets) {
+        size_t n = w->num_buckets ? w->num_buckets : 64;
+        while (n <= bucket) n *= 2;
+        w->buckets = (IntVec*)realloc(w->buckets, n * sizeof(IntVec));
+        memset(w->buckets + w->num_buckets, 0, (n - w->num_buckets) * sizeof(IntVec));
+        w->num_buckets = n;
+    }
+    intvec_push(&w->buckets[bucket], v);
+}
+
+static THREAD_FUNC delta_worker(void* arg) {
+    DeltaWorker* w = (DeltaWorker*)arg;
+    DeltaStep* ds = w->ds;
+    const CsrGraph* g = ds->g;
+    int64_t settled = 0, relaxed = 0;
+
+    for (;;) {
+        // Relax every edge of every vertex still in the current bucket.
+        // A vertex that improved since it was queued has moved on
+        uint64_t bucket_start = ds->bucket * ds->delta;
+        int64_t size = atomic_load(&ds->frontier_size);
+        for (;;) {
+            int64_t start = atomic_fetch_add_explicit(&ds->cursor, RELAX_CHUNK, memory_order_relaxed);
+            if (start >= size) break;
+            int64_t end = start + RELAX_CHUNK < size ? start + RELAX_CHUNK : size;
+            for (int64_t i = start; i < end; i++) {
+                int u = ds->frontier[i];
+                uint64_t du = atomic_load_explicit(&ds->dist[u], memory_order_relaxed);
+                if (du < bucket_start) continue;
+                settled++;
+                for (int64_t e = g->offsets[u]; e < g->offsets[u + 1]; e++) {
+                    int v = g->neighbors[e];
+                    uint64_t nd = du + g->weights[e];
+                    uint64_t old = atomic_load_explicit(&ds->dist[v], memory_order_relaxed);
+                    // Atomic min: retry while we'd still improve it
+                    while (nd < old) {
+                        if (atomic_compare_exchange_weak_explicit(&ds->dist[v], &old, nd,
+                                                                  memory_order_relaxed, memory_order_relaxed)) {
+                            worker_push(w, nd / ds->delta, v);
+                            relaxed++;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (size_t b = ds->bucket; b < w->num_buckets; b++) {
+            if (w->buckets[b].size == 0) continue;
+            size_t cur = atomic_load(&ds->next_bucket);
+            while (b < cur && !atomic_compare_exchange_weak(&ds->next_bucket, &cur, b)) {}
+            break;
+        }
+        barrier_wait(&ds->barrier);
+
+        if (w->id == 0) {
+            ds->bucket = atomic_load(&ds->next_bucket);
+            ds->done = ds->bucket == NO_BUCKET;
+            // The others are parked at the barrier, so their buckets hold still
+            size_t needed = 0;
+            for (int i = 0; !ds->done && i < ds->threads; i++) {
+                if (ds->bucket < ds->workers[i].num_buckets) needed += ds->workers[i].buckets[ds->bucket].size;
+            }
+            if (needed > ds->frontier_capacity) {
+                while (ds->frontier_capacity < needed) ds->frontier_capacity *= 2;
+                free(ds->frontier);
+                ds->frontier = (int*)malloc(ds->frontier_capacity * sizeof(int));
+            }
+            atomic_store(&ds->next_bucket, NO_BUCKET);
+            atomic_store(&ds->frontier_size, 0);
+            atomic_store(&ds->cursor, 0);
+            ds->rounds++;
+        }
+        barrier_wait(&ds->barrier);
+        if (ds->done) break;
+
+        // Everyone moves their share of the next bucket into the frontier
+        if (ds->bucket < w->num_buckets && w->buckets[ds->bucket].size > 0) {
+            IntVec* b = &w->buckets[ds->bucket];
+            int64_t pos = atomic_fetch_add(&ds->frontier_size, (int64_t)b->size);
+            memcpy(ds->frontier + pos, b->items, b->size * sizeof(int));
+            b->size = 0;
+        }
+        barrier_wait(&ds->barrier);
+    }
+    atomic_fetch_add(&ds->settled, settled);
+    atomic_fetch_add(&ds->relaxed, relaxed);
+    THREAD_RETURN;
+}
+
+void sssp_delta_stepping(const CsrGraph* g, int source, uint64_t* dist, uint32_t delta, int threads,
+                         SsspStats* stats) {
+    int n = g->num_vertices;
+    if (threads <= 0) threads = csr_cpu_count();
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    if (delta == 0) {
+        // Meyer and Sanders: delta ~ max weight / degree. The mean weight
+        // over the mean degree is the same idea, less thrown by outliers
+        uint64_t total = 0;
+        for (int64_t e = 0; e < g->num_edges; e++) total += g->weights[e];
+        delta = g->num_edges ? (uint32_t)(total / g->num_edges * n / g->num_edges) : 1;
+        if (delta == 0) delta = 1;
+    }
+
+    DeltaStep ds;
+    memset(&ds, 0, sizeof(ds));
+    ds.g = g;
+    ds.dist = (_Atomic uint64_t*)dist;  // Same layout; updated with CAS while running
+    ds.delta = delta;
+    ds.frontier_capacity = 1024;
+    ds.frontier = (int*)malloc(ds.frontier_capacity * sizeof(int));
+    mutex_init(&ds.barrier.lock);
+    cond_init(&ds.barrier.cond);
+    ds.barrier.total = threads;
+
+    for (int v = 0; v < n; v++) dist[v] = SSSP_INF;
+    dist[source] = 0;
+    ds.frontier[0] = source;
+    atomic_store(&ds.frontier_size, 1);
+    atomic_store(&ds.next_bucket, NO_BUCKET);
+
+    DeltaWorker workers[MAX_THREADS];
+    thread_t tids[MAX_THREADS];
+    memset(workers, 0, sizeof(DeltaWorker) * threads);
+    ds.workers = workers;
+    ds.threads = threads;
+    for (int i = 0; i < threads; i++) {
+        workers[i].ds = &ds;
+        workers[i].id = i;
+    }
+    for (int i = 1; i < threads; i++) thread_create(&tids[i], delta_worker, &workers[i]);
+    delta_worker(&workers[0]);
+    for (int i = 1; i < threads; i++) thread_join(tids[i]);
+
+    for (int i = 0; i < threads; i++) {
+        for (size_t b = 0; b < workers[i].num_buckets; b++) free(workers[i].buckets[b].items);
+        free(workers[i].buckets);
+    }
+    if (stats) {
+        stats->settled = ds.settled;
+        stats->relaxed = ds.relaxed;
+        stats->rounds = ds.rounds;
+    }
+    mutex_destroy(&ds.barrier.lock);
+    cond_destroy(&ds.barrier.cond);
+    free(ds.frontier);
+}
+
+// ===== A* =====
+
+/*
+ * g-scores and predecessors are only valid where stamp[v] == epoch, so
+ * a new query bumps the epoch instead of clearing O(V) arrays.
+ */
+struct AstarSearch {
+    const CsrGraph* g;
+    uint64_t* cost;
+    int* pred;
+    uint32_t* stamp;
+    uint32_t epoch;
+    int source;
+    DHeap heap;
+};
+
+AstarSearch* astar_create(const CsrGraph* g) {
+    AstarSearch* s = (AstarSearch*)calloc(1, sizeof(AstarSearch));
+    s->g = g;
+    s->cost = (uint64_t*)malloc((size_t)g->num_vertices * sizeof(uint64_t));
+    s->pred = (int*)malloc((size_t)g->num_vertices * sizeof(int));
+    s->stamp = (uint32_t*)calloc((size_t)g->num_vertices, sizeof(uint32_t));
+    dheap_init(&s->heap);
+    return s;
+}
+
+void astar_destroy(AstarSearch* s) {
+    free(s->cost);
+    free(s->pred);
+    free(s->stamp);
+    free(s->heap.items);
+    free(s);
+}
+
+static inline uint64_t astar_cost(const AstarSearch* s, int v) {
+    return s->stamp[v] == s->epoch ? s->cost[v] : SSSP_INF;
+}
+
+uint64_t astar_search(AstarSearch* s, int source, int target, AstarHeuristic h, void* ctx, SsspStats* stats) {
+    const CsrGraph* g = s->g;
+    SsspStats st = { 0, 0, 0 };
+    if (++s->epoch == 0) {              // Wrapped: stamps from 2^32 queries ago would look fresh
+        memset(s->stamp, 0, (size_t)g->num_vertices * sizeof(uint32_t));
+        s->epoch = 1;
+    }
+    s->source = source;
+    s->heap.size = 0;
+    s->stamp[source] = s->epoch;
+    s->cost[source] = 0;
+    s->pred[source] = -1;
+    dheap_push(&s->heap, h ? h(source, target, ctx) : 0, source, 4);
+
+    uint64_t result = SSSP_INF;
+    while (s->heap.size > 0) {
+        QueueEntry top = dheap_pop(&s->heap, 4);
+        int u = top.vertex;
+        uint64_t gu = s->cost[u];
+        if (top.key != gu + (h ? h(u, target, ctx) : 0)) continue;  // Stale
+        st.settled++;
+        if (u == target) {
+            result = gu;
+            break;
+        }
+        for (int64_t e = g->offsets[u]; e < g->offsets[u + 1]; e++) {
+            int v = g->neighbors[e];
+            uint64_t nd = gu + g->weights[e];
+            if (nd < astar_cost(s, v)) {
+                s->stamp[v] = s->epoch;
+                s->cost[v] = nd;
+                s->pred[v] = u;
+                st.relaxed++;
+                dheap_push(&s->heap, nd + (h ? h(v, target, ctx) : 0), v, 4);
+            }
+        }
+    }
+    if (stats) *stats = st;
+    return result;
+}
+
+int astar_path(const AstarSearch* s, int target, int* path, int max_len) {
+    if (astar_cost(s, target) == SSSP_INF) return 0;
+    int len = 0;
+    for (int v = target; v != -1; v = s->pred[v]) len++;
+    if (len > max_len) return 0;
+    int i = len;
+    for (int v = target; v != -1; v = s->pred[v]) path[--i] = v;
+    return len;
+}
+
+// ===== Union-find =====
+
+int uf_init(UnionFind* uf, int n) {
+    uf->parent = (int*)malloc((size_t)n * sizeof(int));
+    uf->size = (int*)malloc((size_t)n * sizeof(int));
+    if (!uf->parent || !uf->size) {
+        free(uf->parent);
+        free(uf->size);
+        return 0;
+    }
+    for (int v = 0; v < n; v++) {
+        uf->parent[v] = v;
+        uf->size[v] = 1;
+    }
+    uf->n = n;
+    uf->components = n;
+    return 1;
+}
+
+void uf_free(UnionFind* uf) {
+    free(uf->parent);
+    free(uf->size);
+    memset(uf, 0, sizeof(*uf));
+}
+
+int uf_union(UnionFind* uf, int a, int b) {
+    a = uf_find(uf, a);
+    b = uf_find(uf, b);
+    if (a == b) return 0;
+    if (uf->size[a] < uf->size[b]) {
+        int t = a;
+        a = b;
+        b = t;
+    }
+    uf->parent[b] = a;
+    uf->size[a] += uf->size[b];
+    uf->components--;
+    return 1;
+}
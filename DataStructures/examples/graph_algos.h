@@ -0,0 +1,104 @@
+#ifndef GRAPH_ALGOS_H
+#define GRAPH_ALGOS_H
+
+/*
+ * Shortest paths and connectivity on CSR graphs
+ *
+ * Built on csr_graph.h (weights from csr_build_weighted):
+ *
+ *   sssp_dijkstra        one source to every vertex. The priority queue
+ *                        is pluggable: binary heap, 4-ary heap (half the
+ *                        levels, and a node's children share a cache
+ *                        line), or radix heap (integer keys only,
+ *                        amortized O(log C) with no comparisons between
+ *                        entries)
+ *   sssp_delta_stepping  the same, in parallel. Vertices are grouped in
+ *                        buckets of width delta and a whole bucket is
+ *                        relaxed at once, across threads
+ *   astar_search         one source to one target. A heuristic that never
+ *                        overestimates steers the search toward the target;
+ *                        the search state is reused between queries, so a
+ *                        query costs what it touches, not O(V)
+ *   UnionFind            connected components that stay current as edges
+ *                        are added, in near-O(1) per edge
+ *
+ * Weights are unsigned 32-bit, distances 64-bit; SSSP_INF means no path.
+ *
+ * Build: add graph_algos.c and csr_graph.c to the compile line
+ * (-pthread on Linux).
+ */
+
+#include <stdint.h>
+
+#include "csr_graph.h"
+
+#define SSSP_INF UINT64_MAX
+
+typedef enum {
+    SSSP_BINARY_HEAP,
+    SSSP_QUAD_HEAP,
+    SSSP_RADIX_HEAP
+} SsspQueue;
+
+typedef struct {
+    int64_t settled;                    // Vertices taken from the queue for good
+    int64_t relaxed;                    // Edges that improved a distance
+    int64_t rounds;                     // Delta-stepping: bucket passes
+} SsspStats;
+
+// dist[v] = shortest distance from source. stats may be NULL.
+void sssp_dijkstra(const CsrGraph* g, int source, uint64_t* dist, SsspQueue queue, SsspStats* stats);
+
+// delta = 0 picks mean weight / mean degree. threads <= 0 uses one per CPU.
+void sssp_delta_stepping(const CsrGraph* g, int source, uint64_t* dist, uint32_t delta, int threads,
+                         SsspStats* stats);
+
+// ===== A* =====
+
+// Lower bound on the distance from v to target. NULL: plain Dijkstra
+// that stops at the target.
+typedef uint64_t (*AstarHeuristic)(int v, int target, void* ctx);
+
+typedef struct AstarSearch AstarSearch;
+
+AstarSearch* astar_create(const CsrGraph* g);
+void astar_destroy(AstarSearch* s);
+
+// Distance from source to target, SSSP_INF if unreachable
+uint64_t astar_search(AstarSearch* s, int source, int target, AstarHeuristic h, void* ctx, SsspStats* stats);
+
+// After a search: the path source..target into path (room for the
+// number of vertices on it). Returns its length, 0 if none.
+int astar_path(const AstarSearch* s, int target, int* path, int max_len);
+
+// ===== Union-find =====
+
+typedef struct {
+    int* parent;
+    int* size;
+    int n;
+    int components;
+} UnionFind;
+
+int uf_init(UnionFind* uf, int n);
+void uf_free(UnionFind* uf);
+
+// Root of v's set. Path halving: each visited node skips to its
+// grandparent, so paths stay short without recursion.
+static inline int uf_find(UnionFind* uf, int v) {
+    while (uf->parent[v] != v) {
+        uf->parent[v] = uf->parent[uf->parent[v]];
+        v = uf->parent[v];
+    }
+    return v;
+}
+
+// Joins the sets of a and b (smaller under larger). Returns 1 if they
+// were separate.
+int uf_union(UnionFind* uf, int a, int b);
+
+static inline int uf_connected(UnionFind* uf, int a, int b) {
+    return uf_find(uf, a) == uf_find(uf, b);
+}
+
+#endif
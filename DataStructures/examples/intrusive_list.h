@@ -0,0 +1,139 @@
+#ifndef INTRUSIVE_LIST_H
+#define INTRUSIVE_LIST_H
+
+/*
+ * Intrusive doubly linked list: the links live in your struct
+ *
+ * 02_doubly_linked_list.c allocates a DNode that holds the data. An
+ * intrusive list turns that around: the object embeds an IListNode,
+ * and the list only links those. Nothing is allocated, the object and
+ * its links share a cache line, and an object can sit on several lists
+ * at once through several embedded nodes:
+ *
+ *   typedef struct {
+ *       int key, value;
+ *       IListNode lru;                  // On the cache's LRU list
+ *       IListNode dirty;                // And, maybe, the dirty list
+ *   } Entry;
+ *
+ *   IListNode lru;                      // The list: a sentinel node
+ *   ilist_init(&lru);
+ *   ilist_push_front(&lru, &e->lru);
+ *   ilist_move_to_front(&lru, &e->lru); // On a hit: O(1)
+ *   Entry* victim = ILIST_ENTRY(ilist_last(&lru), Entry, lru);
+ *   ilist_remove(&victim->lru);         // O(1), no search
+ *
+ *   IListNode* it;
+ *   ILIST_FOR_EACH(it, &lru) { Entry* e = ILIST_ENTRY(it, Entry, lru); ... }
+ *
+ * The list is circular through its sentinel, so insert and remove
+ * have no NULL cases. This is the Linux kernel's list_head; the
+ * timer wheel (timer_wheel.h) links its timers the same way.
+ *
+ * Header-only: include it.
+ */
+
+#include <stddef.h>
+
+typedef struct IListNode {
+    struct IListNode* next;
+    struct IListNode* prev;
+} IListNode;
+
+#define ILIST_ENTRY(ptr, type, member) ((type*)((char*)(ptr) - offsetof(type, member)))
+
+// Iterate over the nodes of head. Don't remove it in the body
+#define ILIST_FOR_EACH(it, head) for ((it) = (head)->next; (it) != (head); (it) = (it)->next)
+
+// Same, but it may be removed (tmp holds the next node)
+#define ILIST_FOR_EACH_SAFE(it, tmp, head)                                             \
+    for ((it) = (head)->next, (tmp) = (it)->next; (it) != (head);                      \
+         (it) = (tmp), (tmp) = (it)->next)
+
+// An empty list: the sentinel points to itself
+static inline void ilist_init(IListNode* head) {
+    head->next = head->prev = head;
+}
+
+// A node on no list
+static inline void ilist_node_init(IListNode* node) {
+    node->next = node->prev = NULL;
+}
+
+static inline int ilist_empty(const IListNode* head) {
+    return head->next == head;
+}
+
+static inline int ilist_linked(const IListNode* node) {
+    return node->next != NULL;
+}
+
+static inline void ilist_insert_after(IListNode* pos, IListNode* node) {
+    node->prev = pos;
+    node->next = pos->next;
+    pos->next->prev = node;
+    pos->next = node;
+}
+
+static inline void ilist_insert_before(IListNode* pos, IListNode* node) {
+    ilist_insert_after(pos->prev, node);
+}
+
+static inline void ilist_push_front(IListNode* head, IListNode* node) {
+    ilist_insert_after(head, node);
+}
+
+static inline void ilist_push_back(IListNode* head, IListNode* node) {
+    ilist_insert_after(head->prev, node);
+}
+
+// Unlink node from whatever list it is on. O(1)
+static inline void ilist_remove(IListNode* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = node->prev = NULL;
+}
+
+static inline IListNode* ilist_first(const IListNode* head) {
+    return head->next == head ? NULL : head->next;
+}
+
+static inline IListNode* ilist_last(const IListNode* head) {
+    return head->prev == head ? NULL : head->prev;
+}
+
+static inline IListNode* ilist_pop_front(IListNode* head) {
+    IListNode* node = ilist_first(head);
+    if (node) ilist_remove(node);
+    return node;
+}
+
+static inline IListNode* ilist_pop_back(IListNode* head) {
+    IListNode* node = ilist_last(head);
+    if (node) ilist_remove(node);
+    return node;
+}
+
+static inline void ilist_move_to_front(IListNode* head, IListNode* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    ilist_insert_after(head, node);
+}
+
+static inline void ilist_move_to_back(IListNode* head, IListNode* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    ilist_insert_after(head->prev, node);
+}
+
+// Move all of src's nodes to the end of dst; src ends up empty. O(1)
+static inline void ilist_splice_back(IListNode* dst, IListNode* src) {
+    if (ilist_empty(src)) return;
+    src->next->prev = dst->prev;
+    dst->prev->next = src->next;
+    src->prev->next = dst;
+    dst->prev = src->prev;
+    ilist_init(src);
+}
+
+#endif
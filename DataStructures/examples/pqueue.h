@@ -0,0 +1,492 @@
+#ifndef PQUEUE_H
+#define PQUEUE_H
+
+/*
+ * Generic priority queues: d-ary heap, indexed heap, pairing heap
+ *
+ * The MinHeap in 08_heap.c holds ints in a fixed array and can only
+ * push and pop. Schedulers and graph searches also need to carry a
+ * payload, change a queued item's priority, and cancel one. Three
+ * queues, each generic by macro over the item type and its order:
+ *
+ *   DARY_HEAP_DEFINE      array heap with D children per node. D = 4
+ *                         halves the depth of a binary heap, and the
+ *                         children of a node sit next to each other
+ *                         (one cache line for 4 x 16-byte items).
+ *                         Push/pop only; grows as needed
+ *   INDEXED_HEAP_DEFINE   the same, plus a handle per item: update
+ *                         (decrease or increase) and remove any item
+ *                         in O(log n)
+ *   PAIRING_HEAP_DEFINE   a tree of nodes: O(1) push and decrease-key
+ *                         (amortized, in practice), O(log n) amortized
+ *                         pop. Handles are node pointers
+ *
+ *   typedef struct { uint64_t when; int job; } Event;
+ *   #define EVENT_LESS(a, b) ((a).when < (b).when)
+ *   DARY_HEAP_DEFINE(EventQueue, eventq, Event, EVENT_LESS, 4)
+ *
+ *   EventQueue q;
+ *   eventq_init(&q, 0);
+ *   eventq_push(&q, (Event){ 30, 1 });
+ *   while (q.size > 0) { Event e = eventq_pop(&q); ... }
+ *   eventq_free(&q);
+ *
+ * LESS(a, b) is a strict order: "a comes out before b". Equal items
+ * come out in no particular order.
+ *
+ * Header-only: include it.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#define PQUEUE_MIN_CAPACITY 16
+#define PQUEUE_NODE_CHUNK 1024          // Pairing heap nodes per allocation
+
+// ===== d-ary heap =====
+
+/*
+ * DARY_HEAP_DEFINE(Name, prefix, T, LESS, D)
+ *
+ * Defines Name { T* items; size_t size; size_t capacity; } and:
+ *   prefix_init(h, capacity)           capacity 0 for the default
+ *   prefix_free(h)
+ *   prefix_push(h, item)               0 if out of memory
+ *   prefix_pop(h)                      the first item (size must be > 0)
+ *   prefix_peek(h)                     pointer to it, NULL if empty
+ *   prefix_build(h, items, n)          replace the contents, O(n)
+ *
+ * Sifting moves a hole instead of swapping: one write per level.
+ * Picking the smallest child uses a mask, not a branch: which child
+ * wins is random, so a branch would mispredict half the time.
+ */
+#define DARY_HEAP_DEFINE(Name, prefix, T, LESS, D)                                     \
+                                                                                       \
+typedef struct {                                                                       \
+    T* items;                                                                          \
+    size_t size;                                                                       \
+    size_t capacity;                                                                   \
+} Name;                                                                                \
+                                                                                       \
+static inline void prefix##_init(Name* h, size_t capacity) {                           \
+    h->capacity = capacity > PQUEUE_MIN_CAPACITY ? capacity : PQUEUE_MIN_CAPACITY;     \
+    h->items = (T*)malloc(h->capacity * sizeof(T));                                    \
+    h->size = 0;                                                                       \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_free(Name* h) {                                            \
+    free(h->items);                                                                    \
+    h->items = NULL;                                                                   \
+    h->size = h->capacity = 0;                                                         \
+}                                                                                      \
+                                                                                       \
+static inline int prefix##_reserve(Name* h, size_t n) {                                \
+    if (n <= h->capacity) return 1;                                                    \
+    size_t cap = h->capacity ? h->capacity : PQUEUE_MIN_CAPACITY;                      \
+    while (cap < n) cap *= 2;                                                          \
+    T* items = (T*)realloc(h->items, cap * sizeof(T));                                 \
+    if (!items) return 0;                                                              \
+    h->items = items;                                                                  \
+    h->capacity = cap;                                                                 \
+    return 1;                                                                          \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_sift_down(Name* h, size_t i, T item) {                     \
+    for (;;) {                                                                         \
+        size_t first = i * (D) + 1;                                                    \
+        if (first >= h->size) break;                                                   \
+        size_t end = first + (D) < h->size ? first + (D) : h->size;                    \
+        size_t best = first;                                                           \
+        for (size_t c = first + 1; c < end; c++) {                                     \
+            int better = LESS(h->items[c], h->items[best]) != 0;                       \
+            best ^= (best ^ c) & (0 - (size_t)better);                                 \
+        }                                                                              \
+        if (!LESS(h->items[best], item)) break;                                        \
+        h->items[i] = h->items[best];                                                  \
+        i = best;                                                                      \
+    }                                                                                  \
+    h->items[i] = item;                                                                \
+}                                                                                      \
+                                                                                       \
+static inline int prefix##_push(Name* h, T item) {                                     \
+    if (h->size == h->capacity && !prefix##_reserve(h, h->size + 1)) return 0;         \
+    size_t i = h->size++;                                                              \
+    while (i > 0) {                                                                    \
+        size_t parent = (i - 1) / (D);                                                 \
+        if (!LESS(item, h->items[parent])) break;                                      \
+        h->items[i] = h->items[parent];                                                \
+        i = parent;                                                                    \
+    }                                                                                  \
+    h->items[i] = item;                                                                \
+    return 1;                                                                          \
+}                                                                                      \
+                                                                                       \
+/* Floyd's pop: walk the hole down to a leaf along the smaller child, */               \
+/* then sift the last item up from there. The last item nearly always */               \
+/* belongs near the bottom, so this saves a comparison per level */                    \
+static inline T prefix##_pop(Name* h) {                                                \
+    T top = h->items[0];                                                               \
+    T last = h->items[--h->size];                                                      \
+    if (h->size == 0) return top;                                                      \
+    size_t i = 0;                                                                      \
+    for (;;) {                                                                         \
+        size_t first = i * (D) + 1;                                                    \
+        if (first >= h->size) break;                                                   \
+        size_t end = first + (D) < h->size ? first + (D) : h->size;                    \
+        size_t best = first;                                                           \
+        for (size_t c = first + 1; c < end; c++) {                                     \
+            int better = LESS(h->items[c], h->items[best]) != 0;                       \
+            best ^= (best ^ c) & (0 - (size_t)better);                                 \
+        }                                                                              \
+        h->items[i] = h->items[best];                                                  \
+        i = best;                                                                      \
+    }                                                                                  \
+    while (i > 0) {                                                                    \
+        size_t parent = (i - 1) / (D);                                                 \
+        if (!LESS(last, h->items[parent])) break;                                      \
+        h->items[i] = h->items[parent];                                                \
+        i = parent;                                                                    \
+    }                                                                                  \
+    h->items[i] = last;                                                                \
+    return top;                                                                        \
+}                                                                                      \
+                                                                                       \
+static inline T* prefix##_peek(const Name* h) {                                        \
+    return h->size > 0 ? &h->items[0] : NULL;                                          \
+}                                                                                      \
+                                                                                       \
+static inline int prefix##_build(Name* h, const T* items, size_t n) {                  \
+    if (!prefix##_reserve(h, n)) return 0;                                             \
+    for (size_t i = 0; i < n; i++) h->items[i] = items[i];                             \
+    h->size = n;                                                                       \
+    for (size_t i = n > 1 ? (n - 2) / (D) + 1 : 0; i-- > 0;) {                         \
+        prefix##_sift_down(h, i, h->items[i]);                                         \
+    }                                                                                  \
+    return 1;                                                                          \
+}
+
+// ===== Indexed heap =====
+
+/*
+ * INDEXED_HEAP_DEFINE(Name, prefix, T, LESS, D)
+ *
+ * A d-ary heap whose push returns a handle (a small int, reused after
+ * the item leaves). pos[handle] tracks where the item is in the heap,
+ * and every move updates it.
+ *   prefix_init(h, capacity) / prefix_free(h)
+ *   prefix_push(h, item)               handle, -1 if out of memory
+ *   prefix_pop(h, &handle)             the first item; handle may be NULL
+ *   prefix_peek(h)                     pointer to it, NULL if empty
+ *   prefix_get(h, handle)              pointer to a queued item (read only:
+ *                                      use update to change its order)
+ *   prefix_update(h, handle, item)     replace and move up or down
+ *   prefix_remove(h, handle)           take it out; returns the item
+ *   prefix_contains(h, handle)
+ */
+#define INDEXED_HEAP_DEFINE(Name, prefix, T, LESS, D)                                  \
+                                                                                       \
+typedef struct {                                                                       \
+    T item;                                                                            \
+    int handle;                                                                        \
+} Name##Entry;                                                                         \
+                                                                                       \
+typedef struct {                                                                       \
+    Name##Entry* entries;                                                              \
+    size_t size;                                                                       \
+    size_t capacity;                                                                   \
+    /* pos[handle]: index in entries; free handles hold -2 - next free */              \
+    int* pos;                                                                          \
+    int handles;                        /* Handles ever given out */                   \
+    int free_handle;                    /* -1: none */                                 \
+} Name;                                                                                \
+                                                                                       \
+static inline void prefix##_init(Name* h, size_t capacity) {                           \
+    h->capacity = capacity > PQUEUE_MIN_CAPACITY ? capacity : PQUEUE_MIN_CAPACITY;     \
+    h->entries = (Name##Entry*)malloc(h->capacity * sizeof(Name##Entry));              \
+    h->pos = (int*)malloc(h->capacity * sizeof(int));                                  \
+    h->size = 0;                                                                       \
+    h->handles = 0;                                                                    \
+    h->free_handle = -1;                                                               \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_free(Name* h) {                                            \
+    free(h->entries);                                                                  \
+    free(h->pos);                                                                      \
+    h->entries = NULL;                                                                 \
+    h->pos = NULL;                                                                     \
+    h->size = h->capacity = 0;                                                         \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_sift_up(Name* h, size_t i, Name##Entry e) {                \
+    while (i > 0) {                                                                    \
+        size_t parent = (i - 1) / (D);                                                 \
+        if (!LESS(e.item, h->entries[parent].item)) break;                             \
+        h->entries[i] = h->entries[parent];                                            \
+        h->pos[h->entries[i].handle] = (int)i;                                         \
+        i = parent;                                                                    \
+    }                                                                                  \
+    h->entries[i] = e;                                                                 \
+    h->pos[e.handle] = (int)i;                                                         \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_sift_down(Name* h, size_t i, Name##Entry e) {              \
+    for (;;) {                                                                         \
+        size_t first = i * (D) + 1;                                                    \
+        if (first >= h->size) break;                                                   \
+        size_t end = first + (D) < h->size ? first + (D) : h->size;                    \
+        size_t best = first;                                                           \
+        for (size_t c = first + 1; c < end; c++) {                                     \
+            int better = LESS(h->entries[c].item, h->entries[best].item) != 0;         \
+            best ^= (best ^ c) & (0 - (size_t)better);                                 \
+        }                                                                              \
+        if (!LESS(h->entries[best].item, e.item)) break;                               \
+        h->entries[i] = h->entries[best];                                              \
+        h->pos[h->entries[i].handle] = (int)i;                                         \
+        i = best;                                                                      \
+    }                                                                                  \
+    h->entries[i] = e;                                                                 \
+    h->pos[e.handle] = (int)i;                                                         \
+}                                                                                      \
+                                                                                       \
+/* Put e at i, which was just vacated, moving whichever way it must */                 \
+static inline void prefix##_place(Name* h, size_t i, Name##Entry e) {                  \
+    if (i > 0 && LESS(e.item, h->entries[(i - 1) / (D)].item)) {                       \
+        prefix##_sift_up(h, i, e);                                                     \
+    } else {                                                                           \
+        prefix##_sift_down(h, i, e);                                                   \
+    }                                                                                  \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_release(Name* h, int handle) {                             \
+    h->pos[handle] = -2 - h->free_handle;                                              \
+    h->free_handle = handle;                                                           \
+}                                                                                      \
+                                                                                       \
+static inline int prefix##_push(Name* h, T item) {                                     \
+    /* Handles in use never exceed queued items, so pos fits in capacity */            \
+    if (h->size == h->capacity) {                                                      \
+        size_t cap = h->capacity * 2;                                                  \
+        Name##Entry* entries = (Name##Entry*)realloc(h->entries,                       \
+                                                      cap * sizeof(Name##Entry));      \
+        if (!entries) return -1;                                                       \
+        h->entries = entries;                                                          \
+        int* pos = (int*)realloc(h->pos, cap * sizeof(int));                           \
+        if (!pos) return -1;                                                           \
+        h->pos = pos;                                                                  \
+        h->capacity = cap;                                                             \
+    }                                                                                  \
+    int handle;                                                                        \
+    if (h->free_handle >= 0) {                                                         \
+        handle = h->free_handle;                                                       \
+        h->free_handle = -2 - h->pos[handle];                                          \
+    } else {                                                                           \
+        handle = h->handles++;                                                         \
+    }                                                                                  \
+    Name##Entry e = { item, handle };                                                  \
+    prefix##_sift_up(h, h->size++, e);                                                 \
+    return handle;                                                                     \
+}                                                                                      \
+                                                                                       \
+static inline T prefix##_pop(Name* h, int* handle) {                                   \
+    Name##Entry top = h->entries[0];                                                   \
+    Name##Entry last = h->entries[--h->size];                                          \
+    if (h->size > 0) prefix##_sift_down(h, 0, last);                                   \
+    prefix##_release(h, top.handle);                                                   \
+    if (handle) *handle = top.handle;                                                  \
+    return top.item;                                                                   \
+}                                                                                      \
+                                                                                       \
+static inline T* prefix##_peek(const Name* h) {                                        \
+    return h->size > 0 ? &h->entries[0].item : NULL;                                   \
+}                                                                                      \
+                                                                                       \
+static inline int prefix##_contains(const Name* h, int handle) {                       \
+    return handle >= 0 && handle < h->handles && h->pos[handle] >= 0;                  \
+}                                                                                      \
+                                                                                       \
+static inline const T* prefix##_get(const Name* h, int handle) {                       \
+    return &h->entries[h->pos[handle]].item;                                           \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_update(Name* h, int handle, T item) {                      \
+    Name##Entry e = { item, handle };                                                  \
+    prefix##_place(h, (size_t)h->pos[handle], e);                                      \
+}                                                                                      \
+                                                                                       \
+static inline T prefix##_remove(Name* h, int handle) {                                 \
+    size_t i = (size_t)h->pos[handle];                                                 \
+    T item = h->entries[i].item;                                                       \
+    Name##Entry last = h->entries[--h->size];                                          \
+    if (i < h->size) prefix##_place(h, i, last);                                       \
+    prefix##_release(h, handle);                                                       \
+    return item;                                                                       \
+}
+
+// ===== Pairing heap =====
+
+/*
+ * PAIRING_HEAP_DEFINE(Name, prefix, T, LESS)
+ *
+ * A heap-ordered tree where each node keeps its first child and its
+ * siblings in a list. Push and decrease-key link a node under the root
+ * (or the root under it): one comparison. Pop merges the root's
+ * children in pairs, left to right, then folds the pairs right to left
+ * into one tree. Nodes come from a pool, not one malloc each.
+ *   prefix_init(h) / prefix_free(h)
+ *   prefix_push(h, item)               node (the handle), NULL if out of memory
+ *   prefix_pop(h)                      the first item (size must be > 0)
+ *   prefix_peek(h)                     pointer to it, NULL if empty
+ *   prefix_decrease(h, node, item)     item must not come after the old one
+ *   prefix_remove(h, node)             take it out; returns the item
+ * A node is valid until it is popped or removed.
+ */
+#define PAIRING_HEAP_DEFINE(Name, prefix, T, LESS)                                     \
+                                                                                       \
+typedef struct Name##Node {                                                            \
+    T item;                                                                            \
+    struct Name##Node* child;           /* First child */                              \
+    struct Name##Node* next;            /* Next sibling */                             \
+    struct Name##Node* prev;            /* Previous sibling, or parent if first */     \
+} Name##Node;                                                                          \
+                                                                                       \
+typedef struct {                                                                       \
+    Name##Node* root;                                                                  \
+    size_t size;                                                                       \
+    Name##Node* free_nodes;             /* Linked through next */                      \
+    Name##Node** chunks;                                                               \
+    size_t num_chunks;                                                                 \
+} Name;                                                                                \
+                                                                                       \
+static inline void prefix##_init(Name* h) {                                            \
+    h->root = NULL;                                                                    \
+    h->size = 0;                                                                       \
+    h->free_nodes = NULL;                                                              \
+    h->chunks = NULL;                                                                  \
+    h->num_chunks = 0;                                                                 \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_free(Name* h) {                                            \
+    for (size_t i = 0; i < h->num_chunks; i++) free(h->chunks[i]);                     \
+    free(h->chunks);                                                                   \
+    prefix##_init(h);                                                                  \
+}                                                                                      \
+                                                                                       \
+static inline Name##Node* prefix##_alloc_node(Name* h) {                               \
+    if (!h->free_nodes) {                                                              \
+        size_t bytes = (h->num_chunks + 1) * sizeof(Name##Node*);                      \
+        Name##Node** chunks = (Name##Node**)realloc(h->chunks, bytes);                 \
+        if (!chunks) return NULL;                                                      \
+        h->chunks = chunks;                                                            \
+        Name##Node* chunk = (Name##Node*)malloc(PQUEUE_NODE_CHUNK * sizeof(*chunk));   \
+        if (!chunk) return NULL;                                                       \
+        h->chunks[h->num_chunks++] = chunk;                                            \
+        for (size_t i = 0; i < PQUEUE_NODE_CHUNK; i++) {                               \
+            chunk[i].next = h->free_nodes;                                             \
+            h->free_nodes = &chunk[i];                                                 \
+        }                                                                              \
+    }                                                                                  \
+    Name##Node* node = h->free_nodes;                                                  \
+    h->free_nodes = node->next;                                                        \
+    return node;                                                                       \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_release(Name* h, Name##Node* node) {                       \
+    node->next = h->free_nodes;                                                        \
+    h->free_nodes = node;                                                              \
+}                                                                                      \
+                                                                                       \
+/* Two roots -> one: the later becomes the earlier's first child */                    \
+static inline Name##Node* prefix##_link(Name##Node* a, Name##Node* b) {                \
+    if (LESS(b->item, a->item)) {                                                      \
+        Name##Node* t = a;                                                             \
+        a = b;                                                                         \
+        b = t;                                                                         \
+    }                                                                                  \
+    b->prev = a;                                                                       \
+    b->next = a->child;                                                                \
+    if (a->child) a->child->prev = b;                                                  \
+    a->child = b;                                                                      \
+    a->next = a->prev = NULL;                                                          \
+    return a;                                                                          \
+}                                                                                      \
+                                                                                       \
+/* Two-pass merge of a sibling list, without recursion: pairs are */                   \
+/* stacked through next, so the second pass runs right to left */                      \
+static inline Name##Node* prefix##_merge_pairs(Name##Node* first) {                    \
+    Name##Node* pairs = NULL;                                                          \
+    while (first) {                                                                    \
+        Name##Node* a = first;                                                         \
+        Name##Node* b = a->next;                                                       \
+        if (!b) {                                                                      \
+            a->prev = NULL;                                                            \
+            a->next = pairs;                                                           \
+            pairs = a;                                                                 \
+            break;                                                                     \
+        }                                                                              \
+        first = b->next;                                                               \
+        Name##Node* m = prefix##_link(a, b);                                           \
+        m->next = pairs;                                                               \
+        pairs = m;                                                                     \
+    }                                                                                  \
+    if (!pairs) return NULL;                                                           \
+    Name##Node* result = pairs;                                                        \
+    pairs = pairs->next;                                                               \
+    while (pairs) {                                                                    \
+        Name##Node* next = pairs->next;                                                \
+        result = prefix##_link(result, pairs);                                         \
+        pairs = next;                                                                  \
+    }                                                                                  \
+    result->next = result->prev = NULL;                                                \
+    return result;                                                                     \
+}                                                                                      \
+                                                                                       \
+/* Cut a non-root node (with its subtree) out of its sibling list */                   \
+static inline void prefix##_detach(Name##Node* node) {                                 \
+    if (node->prev->child == node) node->prev->child = node->next;                     \
+    else node->prev->next = node->next;                                                \
+    if (node->next) node->next->prev = node->prev;                                     \
+    node->next = node->prev = NULL;                                                    \
+}                                                                                      \
+                                                                                       \
+static inline Name##Node* prefix##_push(Name* h, T item) {                             \
+    Name##Node* node = prefix##_alloc_node(h);                                         \
+    if (!node) return NULL;                                                            \
+    node->item = item;                                                                 \
+    node->child = node->next = node->prev = NULL;                                      \
+    h->root = h->root ? prefix##_link(h->root, node) : node;                           \
+    h->size++;                                                                         \
+    return node;                                                                       \
+}                                                                                      \
+                                                                                       \
+static inline T prefix##_pop(Name* h) {                                                \
+    Name##Node* root = h->root;                                                        \
+    T item = root->item;                                                               \
+    h->root = prefix##_merge_pairs(root->child);                                       \
+    h->size--;                                                                         \
+    prefix##_release(h, root);                                                         \
+    return item;                                                                       \
+}                                                                                      \
+                                                                                       \
+static inline T* prefix##_peek(const Name* h) {                                        \
+    return h->root ? &h->root->item : NULL;                                            \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_decrease(Name* h, Name##Node* node, T item) {              \
+    node->item = item;                                                                 \
+    if (node == h->root) return;                                                       \
+    prefix##_detach(node);                                                             \
+    h->root = prefix##_link(h->root, node);                                            \
+}                                                                                      \
+                                                                                       \
+static inline T prefix##_remove(Name* h, Name##Node* node) {                           \
+    if (node == h->root) return prefix##_pop(h);                                       \
+    T item = node->item;                                                               \
+    prefix##_detach(node);                                                             \
+    Name##Node* rest = prefix##_merge_pairs(node->child);                              \
+    if (rest) h->root = prefix##_link(h->root, rest);                                  \
+    h->size--;                                                                         \
+    prefix##_release(h, node);                                                         \
+    return item;                                                                       \
+}
+
+#endif
@@ -0,0 +1,473 @@
+#ifndef SWISS_MAP_H
+#define SWISS_MAP_H
+
+/*
+ * Swiss table: open-addressing hash map with SIMD-probed control bytes
+ *
+ * The HashTable in 06_hash_table.c chains: every entry is its own
+ * malloc, every key another (strdup), and a lookup follows pointers
+ * to memory that is anywhere. A Swiss table (Abseil, hashbrown) keeps
+ * everything in two flat arrays:
+ *
+ *   ctrl:   [ 5a 80 13 80 80 7f fe 80 | 80 22 ... ] + copy of first 16
+ *   slots:  [ k,v  -- k,v  --  -- k,v  ×  --  | --  k,v ... ]
+ *
+ *   80 = empty, fe = deleted, 00-7f = full: low 7 bits of the hash (h2)
+ *
+ * A lookup hashes once, starts at slot (hash >> 7) & mask, and compares
+ * h2 against 16 control bytes with one SSE2 instruction. Only slots
+ * whose byte matches (1 in 128 false positives) compare keys. A group
+ * with an empty byte ends the search. Typically: one cache line of
+ * control bytes, one of slots, zero pointer chasing.
+ *
+ *   - capacity is a power of two: the index is a mask, not a modulo
+ *   - the table grows at 7/8 full
+ *   - deleting leaves a tombstone only when a probe could have passed
+ *     over the slot; tombstones are cleared by rehashing in place
+ *
+ * Generic over key and value types by macro, like a C++ template:
+ *
+ *   SWISS_MAP_DEFINE(IntMap, intmap, uint64_t, int, swiss_hash_u64,
+ *                    SWISS_EQ, SWISS_NO_COPY, SWISS_NO_FREE)
+ *
+ *   IntMap m;
+ *   intmap_init(&m, 0);
+ *   intmap_put(&m, 42, 7);
+ *   int* v = intmap_get(&m, 42);        // NULL if absent
+ *   intmap_free(&m);
+ *
+ * SmallKey is a 16-byte string key that stores strings up to 15 bytes
+ * inline (no malloc, compared as two words) and longer ones by pointer.
+ * StrMap below maps SmallKey to int.
+ *
+ * Header-only: include it. Uses SSE2 on x86, a plain loop elsewhere
+ * (or with -DSWISS_NO_SIMD).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__SSE2__) || defined(_M_X64)) && !defined(SWISS_NO_SIMD)
+    #include <emmintrin.h>
+    #define SWISS_SSE2 1
+#endif
+
+// ===== Hashing (wyhash) =====
+
+#define WY_S0 0x2d358dccaa6c78a5ull
+#define WY_S1 0x8bb84b93962eacc9ull
+#define WY_S2 0x4b33a62ed433d4a3ull
+#define WY_S3 0x4d5a2da51de1aa47ull
+
+// 64x64 -> 128-bit multiply, folded: the core of wyhash
+static inline uint64_t wymix(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    return lo ^ hi;
+#endif
+}
+
+static inline uint64_t wy_read8(const uint8_t* p) { uint64_t v; memcpy(&v, p, 8); return v; }
+static inline uint64_t wy_read4(const uint8_t* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+// wyhash (final version): 8-16 bytes per multiply, good enough for
+// hash tables and SMHasher, not for anything cryptographic
+static inline uint64_t wyhash(const void* key, size_t len, uint64_t seed) {
+    const uint8_t* p = (const uint8_t*)key;
+    uint64_t a, b;
+    seed ^= wymix(seed ^ WY_S0, WY_S1);
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (wy_read4(p) << 32) | wy_read4(p + ((len >> 3) << 2));
+            b = (wy_read4(p + len - 4) << 32) | wy_read4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = wymix(wy_read8(p) ^ WY_S1, wy_read8(p + 8) ^ seed);
+                see1 = wymix(wy_read8(p + 16) ^ WY_S2, wy_read8(p + 24) ^ see1);
+                see2 = wymix(wy_read8(p + 32) ^ WY_S3, wy_read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = wymix(wy_read8(p) ^ WY_S1, wy_read8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = wy_read8(p + i - 16);
+        b = wy_read8(p + i - 8);
+    }
+    return wymix(WY_S1 ^ len, wymix(a ^ WY_S1, b ^ seed));
+}
+
+static inline uint64_t swiss_hash_u64(uint64_t x) {
+    return wymix(x ^ WY_S0, WY_S1);
+}
+
+// ===== Small-string keys =====
+
+#define SMALLKEY_INLINE 15
+
+// Inline: the bytes, zero padded; byte 15 = 15 - length, so a 15-byte
+// key's terminator is that byte. Otherwise: pointer, length, byte 15 = 0xff.
+typedef struct {
+    char bytes[16];
+} SmallKey;
+
+static inline int smallkey_is_inline(const SmallKey* k) {
+    return (unsigned char)k->bytes[15] != 0xff;
+}
+
+static inline size_t smallkey_len(const SmallKey* k) {
+    if (smallkey_is_inline(k)) return SMALLKEY_INLINE - (unsigned char)k->bytes[15];
+    uint32_t len;
+    memcpy(&len, k->bytes + 8, 4);
+    return len;
+}
+
+static inline const char* smallkey_data(const SmallKey* k) {
+    if (smallkey_is_inline(k)) return k->bytes;
+    const char* p;
+    memcpy(&p, k->bytes, sizeof(p));
+    return p;
+}
+
+// Long strings are borrowed, not copied: fine for lookups
+static inline SmallKey smallkey_n(const char* s, size_t len) {
+    SmallKey k;
+    memset(&k, 0, sizeof(k));
+    if (len <= SMALLKEY_INLINE) {
+        memcpy(k.bytes, s, len);
+        k.bytes[15] = (char)(SMALLKEY_INLINE - len);
+    } else {
+        uint32_t n = (uint32_t)len;
+        memcpy(k.bytes, &s, sizeof(s));
+        memcpy(k.bytes + 8, &n, 4);
+        k.bytes[15] = (char)0xff;
+    }
+    return k;
+}
+
+static inline SmallKey smallkey(const char* s) {
+    return smallkey_n(s, strlen(s));
+}
+
+// For keys stored in a map: long strings get their own copy
+static inline SmallKey smallkey_own(SmallKey k) {
+    if (smallkey_is_inline(&k)) return k;
+    size_t len = smallkey_len(&k);
+    char* copy = (char*)malloc(len + 1);
+    memcpy(copy, smallkey_data(&k), len);
+    copy[len] = '\0';
+    memcpy(k.bytes, &copy, sizeof(copy));
+    return k;
+}
+
+static inline void smallkey_free(SmallKey k) {
+    if (!smallkey_is_inline(&k)) free((void*)smallkey_data(&k));
+}
+
+static inline uint64_t smallkey_hash(SmallKey k) {
+    if (smallkey_is_inline(&k)) {
+        // Both words at once; an inline key never equals a long one
+        return wymix(wy_read8((const uint8_t*)k.bytes) ^ WY_S0,
+                     wy_read8((const uint8_t*)k.bytes + 8) ^ WY_S1);
+    }
+    return wyhash(smallkey_data(&k), smallkey_len(&k), 0);
+}
+
+static inline int smallkey_eq(SmallKey a, SmallKey b) {
+    if (a.bytes[15] != b.bytes[15]) return 0;
+    if (smallkey_is_inline(&a)) return memcmp(a.bytes, b.bytes, 16) == 0;
+    size_t len = smallkey_len(&a);
+    return len == smallkey_len(&b) && memcmp(smallkey_data(&a), smallkey_data(&b), len) == 0;
+}
+
+// ===== Control bytes =====
+
+#define SWISS_GROUP 16
+#define SWISS_EMPTY ((int8_t)-128)
+#define SWISS_DELETED ((int8_t)-2)
+#define SWISS_MIN_CAPACITY 16
+
+typedef uint32_t SwissMask;             // Bit i: slot i of the group
+
+static inline int swiss_ctz(SwissMask m) {
+#if defined(__GNUC__)
+    return __builtin_ctz(m);
+#else
+    int n = 0;
+    while (!(m & 1)) { m >>= 1; n++; }
+    return n;
+#endif
+}
+
+// Zero bits above the highest set bit, counted from bit 15
+static inline int swiss_clz16(SwissMask m) {
+    int n = 0;
+    for (SwissMask bit = 1u << 15; bit && !(m & bit); bit >>= 1) n++;
+    return n;
+}
+
+#ifdef SWISS_SSE2
+static inline SwissMask swiss_match(const int8_t* g, int8_t h2) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)g);
+    return (SwissMask)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+}
+
+static inline SwissMask swiss_match_empty(const int8_t* g) {
+    return swiss_match(g, SWISS_EMPTY);
+}
+
+// Empty or deleted: the only bytes with the top bit set
+static inline SwissMask swiss_match_free(const int8_t* g) {
+    return (SwissMask)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)g));
+}
+#else
+static inline SwissMask swiss_match(const int8_t* g, int8_t h2) {
+    SwissMask m = 0;
+    for (int i = 0; i < SWISS_GROUP; i++) m |= (SwissMask)(g[i] == h2) << i;
+    return m;
+}
+
+static inline SwissMask swiss_match_empty(const int8_t* g) {
+    return swiss_match(g, SWISS_EMPTY);
+}
+
+static inline SwissMask swiss_match_free(const int8_t* g) {
+    SwissMask m = 0;
+    for (int i = 0; i < SWISS_GROUP; i++) m |= (SwissMask)(g[i] < 0) << i;
+    return m;
+}
+#endif
+
+// The first SWISS_GROUP control bytes are repeated after the last, so
+// a group can be loaded at any slot without wrapping
+static inline void swiss_set_ctrl(int8_t* ctrl, size_t mask, size_t i, int8_t c) {
+    ctrl[i] = c;
+    if (i < SWISS_GROUP) ctrl[mask + 1 + i] = c;
+}
+
+// First empty or deleted slot on hash's probe sequence. Groups are
+// visited at triangular offsets (16, 48, 96, ...), which covers the
+// whole table when the capacity is a power of two.
+static inline size_t swiss_find_free(const int8_t* ctrl, size_t mask, uint64_t hash) {
+    size_t pos = (size_t)(hash >> 7) & mask, step = 0;
+    for (;;) {
+        SwissMask m = swiss_match_free(ctrl + pos);
+        if (m) return (pos + swiss_ctz(m)) & mask;
+        step += SWISS_GROUP;
+        pos = (pos + step) & mask;
+    }
+}
+
+// Can a deleted slot go straight back to empty? Only if no probe ever
+// passed it: every 16-wide window holding it also holds an empty byte.
+static inline int swiss_can_empty(const int8_t* ctrl, size_t mask, size_t i) {
+    SwissMask after = swiss_match_empty(ctrl + i);
+    SwissMask before = swiss_match_empty(ctrl + ((i - SWISS_GROUP) & mask));
+    return after && before && swiss_ctz(after) + swiss_clz16(before) < SWISS_GROUP;
+}
+
+static inline size_t swiss_capacity_for(size_t count) {
+    size_t cap = SWISS_MIN_CAPACITY;
+    while (cap - cap / 8 < count) cap *= 2;
+    return cap;
+}
+
+// Key hooks for SWISS_MAP_DEFINE
+#define SWISS_EQ(a, b) ((a) == (b))
+#define SWISS_NO_COPY(k) (k)
+#define SWISS_NO_FREE(k) ((void)0)
+
+// ===== The map =====
+
+/*
+ * SWISS_MAP_DEFINE(Name, prefix, K, V, HASH, EQ, KEY_COPY, KEY_FREE)
+ *
+ *   HASH(K) -> uint64_t     EQ(K, K) -> int
+ *   KEY_COPY(K) -> K        on insert of a new key (e.g. smallkey_own)
+ *   KEY_FREE(K)             on remove and prefix_free
+ *
+ * Defines Name, Name##Slot { K key; V value; } and:
+ *   prefix_init(m, expected)           reserve room for expected entries
+ *   prefix_free(m)
+ *   prefix_get(m, key)                 value pointer, NULL if absent
+ *   prefix_put(m, key, value)          insert or overwrite
+ *   prefix_find_or_insert(m, key, &inserted)
+ *                                      value pointer; a new value is
+ *                                      uninitialized (set it when *inserted)
+ *   prefix_remove(m, key)              1 if it was there
+ *   prefix_next(m, &iter)              slots in table order; iter starts at 0
+ *   prefix_probe_groups(m, key)        groups a lookup visits (for demos)
+ * Value pointers stay valid until the next insert.
+ */
+#define SWISS_MAP_DEFINE(Name, prefix, K, V, HASH, EQ, KEY_COPY, KEY_FREE)              \
+                                                                                       \
+typedef struct {                                                                       \
+    K key;                                                                             \
+    V value;                                                                           \
+} Name##Slot;                                                                          \
+                                                                                       \
+typedef struct {                                                                       \
+    int8_t* ctrl;                       /* capacity + SWISS_GROUP bytes */             \
+    Name##Slot* slots;                                                                 \
+    size_t mask;                        /* capacity - 1 */                             \
+    size_t count;                                                                      \
+    size_t deleted;                     /* Tombstones */                               \
+    size_t growth_left;                 /* Inserts into empty slots before a rehash */ \
+} Name;                                                                                \
+                                                                                       \
+static inline void prefix##_alloc(Name* m, size_t cap) {                               \
+    m->ctrl = (int8_t*)malloc(cap + SWISS_GROUP);                                      \
+    memset(m->ctrl, SWISS_EMPTY, cap + SWISS_GROUP);                                   \
+    m->slots = (Name##Slot*)malloc(cap * sizeof(Name##Slot));                          \
+    m->mask = cap - 1;                                                                 \
+    m->count = 0;                                                                      \
+    m->deleted = 0;                                                                    \
+    m->growth_left = cap - cap / 8;                                                    \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_init(Name* m, size_t expected) {                           \
+    prefix##_alloc(m, swiss_capacity_for(expected));                                   \
+}                                                                                      \
+                                                                                       \
+static inline void prefix##_free(Name* m) {                                            \
+    for (size_t i = 0; i <= m->mask; i++) {                                            \
+        if (m->ctrl[i] >= 0) KEY_FREE(m->slots[i].key);                                \
+    }                                                                                  \
+    free(m->ctrl);                                                                     \
+    free(m->slots);                                                                    \
+    m->ctrl = NULL;                                                                    \
+    m->slots = NULL;                                                                   \
+}                                                                                      \
+                                                                                       \
+static inline Name##Slot* prefix##_find(const Name* m, K key, uint64_t hash) {         \
+    int8_t h2 = (int8_t)(hash & 0x7f);                                                 \
+    size_t pos = (size_t)(hash >> 7) & m->mask, step = 0;                              \
+    for (;;) {                                                                         \
+        const int8_t* group = m->ctrl + pos;                                           \
+        for (SwissMask hit = swiss_match(group, h2); hit; hit &= hit - 1) {            \
+            size_t i = (pos + swiss_ctz(hit)) & m->mask;                               \
+            if (EQ(m->slots[i].key, key)) return &m->slots[i];                         \
+        }                                                                              \
+        if (swiss_match_empty(group)) return NULL;                                     \
+        step += SWISS_GROUP;                                                           \
+        pos = (pos + step) & m->mask;                                                  \
+    }                                                                                  \
+}                                                                                      \
+                                                                                       \
+static inline V* prefix##_get(const Name* m, K key) {                                  \
+    Name##Slot* s = prefix##_find(m, key, HASH(key));                                  \
+    return s ? &s->value : NULL;                                                       \
+}                                                                                      \
+                                                                                       \
+/* Moves every entry to a table of cap slots (no KEY_COPY: keys move) */               \
+static inline void prefix##_rehash(Name* m, size_t cap) {                              \
+    Name old = *m;                                                                     \
+    prefix##_alloc(m, cap);                                                            \
+    for (size_t i = 0; i <= old.mask; i++) {                                           \
+        if (old.ctrl[i] < 0) continue;                                                 \
+        uint64_t hash = HASH(old.slots[i].key);                                        \
+        size_t j = swiss_find_free(m->ctrl, m->mask, hash);                            \
+        swiss_set_ctrl(m->ctrl, m->mask, j, (int8_t)(hash & 0x7f));                    \
+        m->slots[j] = old.slots[i];                                                    \
+    }                                                                                  \
+    m->count = old.count;                                                              \
+    m->growth_left -= old.count;                                                       \
+    free(old.ctrl);                                                                    \
+    free(old.slots);                                                                   \
+}                                                                                      \
+                                                                                       \
+static inline V* prefix##_find_or_insert(Name* m, K key, int* inserted) {              \
+    uint64_t hash = HASH(key);                                                         \
+    Name##Slot* s = prefix##_find(m, key, hash);                                       \
+    if (s) {                                                                           \
+        *inserted = 0;                                                                 \
+        return &s->value;                                                              \
+    }                                                                                  \
+    size_t i = swiss_find_free(m->ctrl, m->mask, hash);                                \
+    if (m->growth_left == 0 && m->ctrl[i] == SWISS_EMPTY) {                            \
+        /* Mostly tombstones: clean up in place. Otherwise double. */                  \
+        size_t cap = m->mask + 1;                                                      \
+        prefix##_rehash(m, m->count * 32 <= cap * 25 ? cap : cap * 2);              \
+        i = swiss_find_free(m->ctrl, m->mask, hash);                                   \
+    }                                                                                  \
+    if (m->ctrl[i] == SWISS_DELETED) m->deleted--;                                     \
+    else m->growth_left--;                                                             \
+    swiss_set_ctrl(m->ctrl, m->mask, i, (int8_t)(hash & 0x7f));                        \
+    m->slots[i].key = KEY_COPY(key);                                                   \
+    m->count++;                                                                        \
+    *inserted = 1;                                                                     \
+    return &m->slots[i].value;                                                         \
+}                                                                                      \
+                                                                                       \
+static inline V* prefix##_put(Name* m, K key, V value) {                               \
+    int inserted;                                                                      \
+    V* v = prefix##_find_or_insert(m, key, &inserted);                                 \
+    *v = value;                                                                        \
+    return v;                                                                          \
+}                                                                                      \
+                                                                                       \
+static inline int prefix##_remove(Name* m, K key) {                                    \
+    Name##Slot* s = prefix##_find(m, key, HASH(key));                                  \
+    if (!s) return 0;                                                                  \
+    size_t i = (size_t)(s - m->slots);                                                 \
+    KEY_FREE(s->key);                                                                  \
+    if (swiss_can_empty(m->ctrl, m->mask, i)) {                                        \
+        swiss_set_ctrl(m->ctrl, m->mask, i, SWISS_EMPTY);                              \
+        m->growth_left++;                                                              \
+    } else {                                                                           \
+        swiss_set_ctrl(m->ctrl, m->mask, i, SWISS_DELETED);                            \
+        m->deleted++;                                                                  \
+    }                                                                                  \
+    m->count--;                                                                        \
+    return 1;                                                                          \
+}                                                                                      \
+                                                                                       \
+static inline Name##Slot* prefix##_next(const Name* m, size_t* iter) {                 \
+    for (; *iter <= m->mask; (*iter)++) {                                              \
+        if (m->ctrl[*iter] >= 0) return &m->slots[(*iter)++];                          \
+    }                                                                                  \
+    return NULL;                                                                       \
+}                                                                                      \
+                                                                                       \
+static inline int prefix##_probe_groups(const Name* m, K key) {                        \
+    uint64_t hash = HASH(key);                                                         \
+    int8_t h2 = (int8_t)(hash & 0x7f);                                                 \
+    size_t pos = (size_t)(hash >> 7) & m->mask, step = 0;                              \
+    for (int groups = 1;; groups++) {                                                  \
+        const int8_t* group = m->ctrl + pos;                                           \
+        for (SwissMask hit = swiss_match(group, h2); hit; hit &= hit - 1) {            \
+            if (EQ(m->slots[(pos + swiss_ctz(hit)) & m->mask].key, key)) return groups; \
+        }                                                                              \
+        if (swiss_match_empty(group)) return groups;                                   \
+        step += SWISS_GROUP;                                                           \
+        pos = (pos + step) & m->mask;                                                  \
+    }                                                                                  \
+}
+
+// String -> int, the same job as 06's HashTable
+SWISS_MAP_DEFINE(StrMap, strmap, SmallKey, int, smallkey_hash, smallkey_eq, smallkey_own, smallkey_free)
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+/*
+ * Hierarchical timing wheel: O(1) timeouts for event loops
+ *
+ * A heap of timers (08_heap.c) costs O(log n) to add and cancel, and
+ * a server that pushes back a connection's idle timeout on every packet
+ * sifts the heap on every packet. A timing wheel (Varghese and Lauck,
+ * 1987; the Linux kernel's timers) is an array of slots indexed by
+ * expiry tick, each a list of timers:
+ *
+ *   level 0: 64 slots x 1 tick         fires from here
+ *   level 1: 64 slots x 64 ticks       moved ("cascaded") down a level
+ *   level 2: 64 slots x 4096 ticks     when the wheel below wraps
+ *   ...                                5 levels: 2^30 ticks ahead
+ *
+ * A timer goes in the level whose span covers its distance from now,
+ * at the slot of its expiry tick: a shift and a mask. Add and cancel
+ * are a list insert and unlink. Each tick runs level 0's slot as one
+ * batch; every 64 ticks a level-1 slot is redistributed below, and so
+ * on up. Each timer cascades at most once per level.
+ *
+ * Timers are intrusive: embed a TwTimer in your own struct (one per
+ * connection, say) and get back to it with TW_CONTAINER_OF. The wheel
+ * never allocates.
+ *
+ *   typedef struct { int fd; TwTimer idle; } Conn;
+ *   void on_idle(TwTimer* t) { Conn* c = TW_CONTAINER_OF(t, Conn, idle); ... }
+ *
+ *   tw_init(&wheel, now_ms);
+ *   tw_timer_init(&conn->idle, on_idle);
+ *   tw_add(&wheel, &conn->idle, now_ms + 30000);   // Also re-arms
+ *   ...
+ *   int timeout = tw_timeout(&wheel, now_ms, 1000);  // For poll/epoll_wait
+ *   epoll_wait(epfd, events, max, timeout);
+ *   tw_advance(&wheel, now_ms);                       // Fire what's due
+ *
+ * A tick is whatever unit you pass in: milliseconds above. Timers fire
+ * exactly at their tick, never early; late only by how long the caller
+ * waits between tw_advance calls.
+ *
+ * Header-only: include it.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TW_LEVELS 5
+#define TW_SLOT_BITS 6
+#define TW_SLOTS (1 << TW_SLOT_BITS)
+#define TW_SLOT_MASK (TW_SLOTS - 1)
+#define TW_MAX_DELTA ((1ull << (TW_LEVELS * TW_SLOT_BITS)) - 1)
+
+#define TW_NEVER UINT64_MAX
+
+#define TW_CONTAINER_OF(ptr, type, member) ((type*)((char*)(ptr) - offsetof(type, member)))
+
+typedef struct TwLink {
+    struct TwLink* next;
+    struct TwLink* prev;
+} TwLink;
+
+typedef struct TwTimer TwTimer;
+typedef void (*TwCallback)(TwTimer* timer);
+
+struct TwTimer {
+    TwLink link;                        // First: a slot's list head is a bare TwLink
+    uint64_t expires;
+    TwCallback callback;
+    int slot;                           // level * TW_SLOTS + index; -1 when not pending
+};
+
+typedef struct {
+    TwLink slots[TW_LEVELS * TW_SLOTS]; // Circular lists with sentinel heads
+    uint64_t occupied[TW_LEVELS];       // Bit i: slot i of that level is non-empty
+    uint64_t now;                       // Next tick to run
+    size_t count;
+    uint64_t cascaded;                  // Timers moved down a level (for demos)
+} TimerWheel;
+
+static inline void tw_init(TimerWheel* tw, uint64_t now) {
+    for (int i = 0; i < TW_LEVELS * TW_SLOTS; i++) {
+        tw->slots[i].next = tw->slots[i].prev = &tw->slots[i];
+    }
+    for (int k = 0; k < TW_LEVELS; k++) tw->occupied[k] = 0;
+    tw->now = now;
+    tw->count = 0;
+    tw->cascaded = 0;
+}
+
+static inline void tw_timer_init(TwTimer* t, TwCallback callback) {
+    t->link.next = t->link.prev = NULL;
+    t->expires = 0;
+    t->callback = callback;
+    t->slot = -1;
+}
+
+static inline int tw_pending(const TwTimer* t) {
+    return t->slot >= 0;
+}
+
+// Link t into the slot for t->expires, relative to tw->now
+static inline void tw_place(TimerWheel* tw, TwTimer* t) {
+    uint64_t when = t->expires < tw->now ? tw->now : t->expires;
+    uint64_t delta = when - tw->now;
+    if (delta > TW_MAX_DELTA) {
+        when = tw->now + TW_MAX_DELTA;  // Parked at the top; re-placed on each cascade
+        delta = TW_MAX_DELTA;
+    }
+    int level = 0;
+    while (delta >> (TW_SLOT_BITS * (level + 1))) level++;
+    int index = (int)((when >> (TW_SLOT_BITS * level)) & TW_SLOT_MASK);
+
+    t->slot = level * TW_SLOTS + index;
+    TwLink* head = &tw->slots[t->slot];
+    t->link.prev = head->prev;
+    t->link.next = head;
+    head->prev->next = &t->link;
+    head->prev = &t->link;
+    tw->occupied[level] |= 1ull << index;
+}
+
+static inline void tw_unlink(TimerWheel* tw, TwTimer* t) {
+    t->link.prev->next = t->link.next;
+    t->link.next->prev = t->link.prev;
+    TwLink* head = &tw->slots[t->slot];
+    if (head->next == head) {
+        tw->occupied[t->slot / TW_SLOTS] &= ~(1ull << (t->slot % TW_SLOTS));
+    }
+    t->link.next = t->link.prev = NULL;
+    t->slot = -1;
+}
+
+// Schedule t to fire at tick expires (now or earlier: on the next
+// tw_advance). A pending timer is moved. O(1).
+static inline void tw_add(TimerWheel* tw, TwTimer* t, uint64_t expires) {
+    if (tw_pending(t)) tw_unlink(tw, t);
+    else tw->count++;
+    t->expires = expires;
+    tw_place(tw, t);
+}
+
+// Returns 1 if t was pending. O(1).
+static inline int tw_cancel(TimerWheel* tw, TwTimer* t) {
+    if (!tw_pending(t)) return 0;
+    tw_unlink(tw, t);
+    tw->count--;
+    return 1;
+}
+
+static inline uint64_t tw_rotr(uint64_t x, int r) {
+    return r ? (x >> r) | (x << (64 - r)) : x;
+}
+
+static inline int tw_ctz(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+/*
+ * Earliest tick at which tw_advance has work: a level-0 timer firing
+ * (exact) or a higher slot cascading (at or before its timers expire).
+ * Never later than the next expiry, so sleeping until then is safe.
+ * TW_NEVER if no timers are pending. O(levels): one bitmap per level.
+ */
+static inline uint64_t tw_next_expiry(const TimerWheel* tw) {
+    uint64_t best = TW_NEVER;
+    if (tw->occupied[0]) {
+        int cur = (int)(tw->now & TW_SLOT_MASK);
+        best = tw->now + (uint64_t)tw_ctz(tw_rotr(tw->occupied[0], cur));
+    }
+    for (int level = 1; level < TW_LEVELS; level++) {
+        if (!tw->occupied[level]) continue;
+        int shift = TW_SLOT_BITS * level;
+        // The current slot cascades at the start of its block. Once past
+        // that, anything in it belongs to the next time around
+        int cur = (int)((tw->now >> shift) & TW_SLOT_MASK);
+        int from = (tw->now & ((1ull << shift) - 1)) == 0 ? 0 : 1;
+        uint64_t ahead = (uint64_t)tw_ctz(tw_rotr(tw->occupied[level], (cur + from) & TW_SLOT_MASK)) + from;
+        uint64_t when = ((tw->now >> shift) + ahead) << shift;
+        if (when < best) best = when;
+    }
+    return best;
+}
+
+// Milliseconds to wait for poll/epoll_wait when ticks are milliseconds:
+// 0 if something is due, at most max_wait (-1 = no limit).
+static inline int tw_timeout(const TimerWheel* tw, uint64_t now, int max_wait) {
+    uint64_t next = tw_next_expiry(tw);
+    if (next == TW_NEVER) return max_wait;
+    if (next <= now) return 0;
+    uint64_t wait = next - now;
+    if (max_wait >= 0 && wait > (uint64_t)max_wait) return max_wait;
+    return wait > INT32_MAX ? INT32_MAX : (int)wait;
+}
+
+// Re-place every timer of one slot, one level or more down
+static inline void tw_cascade(TimerWheel* tw, int level, int index) {
+    TwLink* head = &tw->slots[level * TW_SLOTS + index];
+    TwLink list = *head;
+    if (list.next == head) return;
+    list.next->prev = &list;            // Move the chain onto a local head
+    list.prev->next = &list;
+    head->next = head->prev = head;
+    tw->occupied[level] &= ~(1ull << index);
+    while (list.next != &list) {
+        TwTimer* t = (TwTimer*)list.next;
+        list.next = t->link.next;
+        t->link.next->prev = &list;
+        tw_place(tw, t);
+        tw->cascaded++;
+    }
+}
+
+/*
+ * Run every timer that expires at or before tick now, in tick order.
+ * Callbacks may add or cancel any timer, including re-arming their
+ * own; one added for a tick already run fires on the next tick. Idle
+ * stretches are skipped, not stepped through. Returns the number fired.
+ */
+static inline int tw_advance(TimerWheel* tw, uint64_t now) {
+    int fired = 0;
+    while (tw->now <= now) {
+        uint64_t next = tw_next_expiry(tw);
+        if (next > now) {
+            tw->now = now + 1;
+            break;
+        }
+        tw->now = next;
+
+        for (int level = 1; level < TW_LEVELS; level++) {
+            int shift = TW_SLOT_BITS * level;
+            if (tw->now & ((1ull << shift) - 1)) break;
+            tw_cascade(tw, level, (int)((tw->now >> shift) & TW_SLOT_MASK));
+        }
+
+        // Detach the due slot and move on to the next tick before any
+        // callback runs, so timers they add are placed after this one
+        int index = (int)(tw->now & TW_SLOT_MASK);
+        TwLink* head = &tw->slots[index];
+        TwLink due;
+        due.next = due.prev = &due;
+        if (head->next != head) {
+            due = *head;
+            due.next->prev = &due;
+            due.prev->next = &due;
+            head->next = head->prev = head;
+            tw->occupied[0] &= ~(1ull << index);
+        }
+        tw->now++;
+        while (due.next != &due) {
+            TwTimer* t = (TwTimer*)due.next;
+            due.next = t->link.next;
+            t->link.next->prev = &due;
+            t->link.next = t->link.prev = NULL;
+            t->slot = -1;
+            tw->count--;
+            fired++;
+            t->callback(t);
+        }
+    }
+    return fired;
+}
+
+#endif
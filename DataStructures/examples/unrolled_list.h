@@ -0,0 +1,239 @@
+#ifndef UNROLLED_LIST_H
+#define UNROLLED_LIST_H
+
+/*
+ * Unrolled linked list: a linked list of small arrays
+ *
+ * 01_linked_list.c allocates a 16-byte node per int, so a traversal is
+ * one dependent load (and, once the nodes are scattered, one cache
+ * miss) per element, and a quarter of each node is payload. An
+ * unrolled list packs several elements into each node, sized to one
+ * cache line:
+ *
+ *   [next|3| 1 2 3 4 5 6 7 8 9 . . . .] -> [next|9| ...] -> NULL
+ *
+ *   - a 64-byte node holds 13 ints (14 on 32-bit): a miss per 13
+ *     elements, and the scan inside a node is over an array
+ *   - nodes come from 64-byte-aligned chunks, so a node is exactly
+ *     one cache line, and nodes built in order sit next to each other
+ *   - inserting into a full node splits it in half; removing from a
+ *     node that falls below half full merges in the next one when they
+ *     fit, so nodes stay about half full or better
+ *   - push_back fills each node completely before starting the next;
+ *     size and tail are kept, so length and append are O(1)
+ *
+ *   UnrolledList l;
+ *   ul_init(&l);
+ *   ul_push_back(&l, 42);
+ *   ul_insert_at(&l, 0, 7);
+ *   for (UlNode* n = l.head; n; n = n->next)
+ *       for (int i = 0; i < n->count; i++) use(n->items[i]);
+ *   ul_free(&l);
+ *
+ * Positional access skips whole nodes: O(n / items per node).
+ *
+ * Header-only: include it. UL_NODE_BYTES (a power of two, at least
+ * 32) can be set before including: bigger nodes mean fewer misses but
+ * longer memmoves on insert and remove.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef UL_NODE_BYTES
+#define UL_NODE_BYTES 64
+#endif
+#define UL_NODE_ITEMS ((UL_NODE_BYTES - sizeof(void*) - sizeof(int)) / sizeof(int))
+#define UL_MIN_ITEMS (UL_NODE_ITEMS / 2)
+#define UL_CHUNK_NODES 1024
+
+typedef struct UlNode {
+    struct UlNode* next;
+    int count;
+    int items[UL_NODE_ITEMS];
+} UlNode;
+
+typedef struct {
+    UlNode* head;
+    UlNode* tail;
+    size_t size;
+    size_t num_nodes;
+    UlNode* free_nodes;                 // Linked through next
+    void** chunks;                      // As malloc'd, before aligning
+    size_t num_chunks;
+} UnrolledList;
+
+static inline void ul_init(UnrolledList* l) {
+    l->head = l->tail = NULL;
+    l->size = 0;
+    l->num_nodes = 0;
+    l->free_nodes = NULL;
+    l->chunks = NULL;
+    l->num_chunks = 0;
+}
+
+static inline void ul_free(UnrolledList* l) {
+    for (size_t i = 0; i < l->num_chunks; i++) free(l->chunks[i]);
+    free(l->chunks);
+    ul_init(l);
+}
+
+static inline size_t ul_length(const UnrolledList* l) {
+    return l->size;
+}
+
+static inline UlNode* ul_alloc_node(UnrolledList* l) {
+    if (!l->free_nodes) {
+        void** chunks = (void**)realloc(l->chunks, (l->num_chunks + 1) * sizeof(void*));
+        if (!chunks) return NULL;
+        l->chunks = chunks;
+        char* raw = (char*)malloc(UL_CHUNK_NODES * sizeof(UlNode) + UL_NODE_BYTES);
+        if (!raw) return NULL;
+        l->chunks[l->num_chunks++] = raw;
+        uintptr_t aligned = ((uintptr_t)raw + UL_NODE_BYTES - 1) & ~(uintptr_t)(UL_NODE_BYTES - 1);
+        UlNode* chunk = (UlNode*)aligned;
+        // Pushed in reverse, so nodes are handed out in address order
+        for (size_t i = UL_CHUNK_NODES; i-- > 0;) {
+            chunk[i].next = l->free_nodes;
+            l->free_nodes = &chunk[i];
+        }
+    }
+    UlNode* node = l->free_nodes;
+    l->free_nodes = node->next;
+    node->next = NULL;
+    node->count = 0;
+    l->num_nodes++;
+    return node;
+}
+
+static inline void ul_release_node(UnrolledList* l, UlNode* node) {
+    node->next = l->free_nodes;
+    l->free_nodes = node;
+    l->num_nodes--;
+}
+
+// Append: O(1). Returns 0 if out of memory
+static inline int ul_push_back(UnrolledList* l, int value) {
+    UlNode* tail = l->tail;
+    if (!tail || tail->count == (int)UL_NODE_ITEMS) {
+        UlNode* node = ul_alloc_node(l);
+        if (!node) return 0;
+        if (tail) tail->next = node;
+        else l->head = node;
+        l->tail = tail = node;
+    }
+    tail->items[tail->count++] = value;
+    l->size++;
+    return 1;
+}
+
+static inline int ul_push_front(UnrolledList* l, int value) {
+    UlNode* head = l->head;
+    if (!head || head->count == (int)UL_NODE_ITEMS) {
+        UlNode* node = ul_alloc_node(l);
+        if (!node) return 0;
+        node->next = head;
+        l->head = head = node;
+        if (!l->tail) l->tail = node;
+    }
+    memmove(&head->items[1], &head->items[0], head->count * sizeof(int));
+    head->items[0] = value;
+    head->count++;
+    l->size++;
+    return 1;
+}
+
+// Node holding position index (< size), and the offset within it
+static inline UlNode* ul_locate(const UnrolledList* l, size_t index, UlNode** prev, int* offset) {
+    UlNode* p = NULL;
+    UlNode* n = l->head;
+    while (index >= (size_t)n->count) {
+        index -= n->count;
+        p = n;
+        n = n->next;
+    }
+    if (prev) *prev = p;
+    *offset = (int)index;
+    return n;
+}
+
+static inline int* ul_get(const UnrolledList* l, size_t index) {
+    if (index >= l->size) return NULL;
+    int offset;
+    UlNode* n = ul_locate(l, index, NULL, &offset);
+    return &n->items[offset];
+}
+
+// Position of the first element equal to value, or -1
+static inline long ul_find(const UnrolledList* l, int value) {
+    long base = 0;
+    for (const UlNode* n = l->head; n; n = n->next) {
+        for (int i = 0; i < n->count; i++) {
+            if (n->items[i] == value) return base + i;
+        }
+        base += n->count;
+    }
+    return -1;
+}
+
+// Insert before position index (index == size appends). Returns 0 if
+// out of memory or out of range
+static inline int ul_insert_at(UnrolledList* l, size_t index, int value) {
+    if (index > l->size) return 0;
+    if (index == l->size) return ul_push_back(l, value);
+    int offset;
+    UlNode* n = ul_locate(l, index, NULL, &offset);
+    if (n->count == (int)UL_NODE_ITEMS) {
+        // Split: the upper half moves to a new node after n
+        UlNode* right = ul_alloc_node(l);
+        if (!right) return 0;
+        int keep = n->count / 2;
+        right->count = n->count - keep;
+        memcpy(right->items, &n->items[keep], right->count * sizeof(int));
+        n->count = keep;
+        right->next = n->next;
+        n->next = right;
+        if (l->tail == n) l->tail = right;
+        if (offset > keep) {
+            offset -= keep;
+            n = right;
+        }
+    }
+    memmove(&n->items[offset + 1], &n->items[offset], (n->count - offset) * sizeof(int));
+    n->items[offset] = value;
+    n->count++;
+    l->size++;
+    return 1;
+}
+
+// Remove the element at position index. Returns 0 if out of range
+static inline int ul_remove_at(UnrolledList* l, size_t index, int* out) {
+    if (index >= l->size) return 0;
+    UlNode* prev;
+    int offset;
+    UlNode* n = ul_locate(l, index, &prev, &offset);
+    if (out) *out = n->items[offset];
+    n->count--;
+    memmove(&n->items[offset], &n->items[offset + 1], (n->count - offset) * sizeof(int));
+    l->size--;
+
+    if (n->count == 0) {
+        if (prev) prev->next = n->next;
+        else l->head = n->next;
+        if (l->tail == n) l->tail = prev;
+        ul_release_node(l, n);
+    } else if (n->count < (int)UL_MIN_ITEMS && n->next &&
+               n->count + n->next->count <= (int)UL_NODE_ITEMS) {
+        UlNode* next = n->next;
+        memcpy(&n->items[n->count], next->items, next->count * sizeof(int));
+        n->count += next->count;
+        n->next = next->next;
+        if (l->tail == next) l->tail = n;
+        ul_release_node(l, next);
+    }
+    return 1;
+}
+
+#endif
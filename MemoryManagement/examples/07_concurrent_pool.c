@@ -0,0 +1,385 @@
+/*
+ * 07_concurrent_pool.c
+ *
+ * Thread-safe object pool (objpool.h / objpool.c) - the multi-threaded
+ * version of 03_memory_pool.c:
+ *   - grows by whole slabs instead of returning NULL
+ *   - per-thread magazines: alloc/free without locks or atomics
+ *   - objects freed on another thread flow back through a global depot
+ *   - checked builds catch double frees and writes after free
+ *
+ * Build: gcc -O2 -DNDEBUG 07_concurrent_pool.c objpool.c -o 07_concurrent_pool -pthread
+ *        (without -DNDEBUG every pool runs with checks on)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "objpool.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    }
+    void thread_join(thread_t t) {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+    void thread_yield(void) { SwitchToThread(); }
+
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <time.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        pthread_create(t, NULL, fn, arg);
+    }
+    void thread_join(thread_t t) {
+        pthread_join(t, NULL);
+    }
+    void thread_yield(void) { sched_yield(); }
+
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+#define MAX_THREADS 16
+
+void print_stats(ObjPool* p) {
+    ObjPoolStats s;
+    objpool_get_stats(p, &s);
+    printf("  %s: %ld slabs, %ld objects carved, %ld magazines, depot %ld out / %ld in",
+           p->name, s.slabs, s.capacity, s.magazines, s.depot_gets, s.depot_puts);
+    if (s.live >= 0) printf(", %ld live", s.live);
+    printf("\n");
+}
+
+// ===== Example 1: Growth =====
+
+typedef struct {
+    float x, y;
+    float vx, vy;
+    int active;
+    int damage;
+} Bullet;
+
+void growth_example(void) {
+    printf("\n=== Example 1: A Pool That Grows ===\n");
+    ObjPool* pool = objpool_create("bullets", sizeof(Bullet), 0);
+
+    static Bullet* bullets[100000];
+    for (int i = 0; i < 100000; i++) {
+        bullets[i] = (Bullet*)objpool_alloc(pool);
+        bullets[i]->x = (float)i;
+        bullets[i]->damage = 10;
+        if (i == 99 || i == 9999 || i == 99999) {
+            printf("After %6d bullets:\n", i + 1);
+            print_stats(pool);
+        }
+    }
+    printf("03_memory_pool's pool_create(sizeof(Bullet), 1000) would have\n");
+    printf("returned NULL at bullet 1001.\n");
+
+    long adjacent = 0;
+    for (int i = 1; i < 1000; i++) {
+        if ((char*)bullets[i] - (char*)bullets[i - 1] == (long)pool->object_size) adjacent++;
+    }
+    printf("Fresh objects are carved in order: %ld of 999 neighbours adjacent.\n", adjacent);
+
+    for (int i = 0; i < 100000; i++) objpool_free(pool, bullets[i]);
+    objpool_destroy(pool);
+}
+
+// ===== Example 2: Single-thread benchmark (workload from 03) =====
+
+void benchmark_pool_vs_malloc(void) {
+    printf("\n=== Example 2: Performance Benchmark ===\n");
+
+    const int iterations = 10000000;
+    void* ptrs[1000];
+
+    ObjPool* pool = objpool_create("bench", 64, 0);
+    double start = get_time_ms();
+    for (int i = 0; i < iterations; i++) {
+        if (i >= 1000) objpool_free(pool, ptrs[i % 1000]);
+        ptrs[i % 1000] = objpool_alloc(pool);
+    }
+    double pool_time = get_time_ms() - start;
+    for (int i = 0; i < 1000; i++) objpool_free(pool, ptrs[i]);
+    objpool_destroy(pool);
+
+    start = get_time_ms();
+    for (int i = 0; i < iterations; i++) {
+        if (i >= 1000) free(ptrs[i % 1000]);
+        ptrs[i % 1000] = malloc(64);
+    }
+    double malloc_time = get_time_ms() - start;
+    for (int i = 0; i < 1000; i++) free(ptrs[i]);
+
+    printf("Operations: %d alloc+free pairs, 1000 live\n", iterations);
+    printf("Pool:   %6.2f ns/pair\n", pool_time * 1e6 / iterations);
+    printf("malloc: %6.2f ns/pair\n", malloc_time * 1e6 / iterations);
+    printf("Speedup: %.1fx\n", malloc_time / pool_time);
+}
+
+// ===== Example 3: Particles from many threads =====
+
+typedef struct {
+    float x, y;
+    float vx, vy;
+    float life;
+    unsigned char r, g, b;
+} Particle;
+
+#define LIVE_PARTICLES 2000
+#define PARTICLE_OPS 1000000
+
+ObjPool* particle_pool;
+
+typedef struct {
+    int use_pool;
+    unsigned seed;
+} ParticleArg;
+
+THREAD_FUNC particle_thread(void* arg) {
+    ParticleArg* a = (ParticleArg*)arg;
+    Particle* live[LIVE_PARTICLES];
+    unsigned s = a->seed;
+
+    for (int i = 0; i < LIVE_PARTICLES; i++) {
+        live[i] = a->use_pool ? (Particle*)objpool_alloc(particle_pool)
+                              : (Particle*)malloc(sizeof(Particle));
+        live[i]->life = 1.0f;
+    }
+    for (int i = 0; i < PARTICLE_OPS; i++) {
+        s = s * 1103515245u + 12345u;
+        int victim = (s >> 8) % LIVE_PARTICLES;     // A random particle dies...
+        if (a->use_pool) objpool_free(particle_pool, live[victim]);
+        else free(live[victim]);
+
+        Particle* p = a->use_pool ? (Particle*)objpool_alloc(particle_pool)   // ...one spawns
+                                  : (Particle*)malloc(sizeof(Particle));
+        p->x = (float)i;
+        p->life = 1.0f;
+        live[victim] = p;
+    }
+    for (int i = 0; i < LIVE_PARTICLES; i++) {
+        if (a->use_pool) objpool_free(particle_pool, live[i]);
+        else free(live[i]);
+    }
+    objpool_thread_exit();
+    THREAD_RETURN;
+}
+
+double run_particles(int use_pool, int threads) {
+    thread_t handles[MAX_THREADS];
+    ParticleArg args[MAX_THREADS];
+
+    double start = get_time_ms();
+    for (int i = 0; i < threads; i++) {
+        args[i].use_pool = use_pool;
+        args[i].seed = 1234u + i;
+        thread_create(&handles[i], particle_thread, &args[i]);
+    }
+    for (int i = 0; i < threads; i++) thread_join(handles[i]);
+    return (get_time_ms() - start) * 1e6 / ((double)threads * PARTICLE_OPS);
+}
+
+void particle_example(void) {
+    printf("\n=== Example 3: Particle Systems on Many Threads ===\n");
+    printf("Each thread: %d live particles, %d random kill+spawn pairs\n",
+           LIVE_PARTICLES, PARTICLE_OPS);
+    particle_pool = objpool_create("particles", sizeof(Particle), 0);
+
+    printf("%8s %12s %12s\n", "threads", "malloc ns", "pool ns");
+    for (int t = 1; t <= 8; t *= 2) {
+        double m = run_particles(0, t);
+        double p = run_particles(1, t);
+        printf("%8d %12.2f %12.2f\n", t, m, p);
+    }
+    print_stats(particle_pool);
+    objpool_destroy(particle_pool);
+}
+
+// ===== Example 4: Allocated on one thread, freed on another =====
+//
+// A network server accepts connections on one thread and closes them
+// on a worker. A single-threaded free list can't do this at all.
+
+typedef struct {
+    int fd;
+    char peer[46];
+    char buffer[192];
+} Connection;
+
+#define RING_SIZE 1024
+#define CONNECTIONS 2000000
+
+typedef struct {
+    _Alignas(64) atomic_int head;
+    _Alignas(64) atomic_int tail;
+    Connection* slots[RING_SIZE];
+} Ring;
+
+Ring ring;
+ObjPool* conn_pool;
+int ring_use_pool;
+
+THREAD_FUNC acceptor_thread(void* arg) {
+    (void)arg;
+    for (int i = 0; i < CONNECTIONS; i++) {
+        Connection* c = ring_use_pool ? (Connection*)objpool_alloc(conn_pool)
+                                      : (Connection*)malloc(sizeof(Connection));
+        c->fd = i;
+        int t = atomic_load_explicit(&ring.tail, memory_order_relaxed);
+        while (t - atomic_load_explicit(&ring.head, memory_order_acquire) == RING_SIZE) thread_yield();
+        ring.slots[t % RING_SIZE] = c;
+        atomic_store_explicit(&ring.tail, t + 1, memory_order_release);
+    }
+    objpool_thread_exit();
+    THREAD_RETURN;
+}
+
+THREAD_FUNC closer_thread(void* arg) {
+    long* sum = (long*)arg;
+    for (int i = 0; i < CONNECTIONS; i++) {
+        int h = atomic_load_explicit(&ring.head, memory_order_relaxed);
+        while (atomic_load_explicit(&ring.tail, memory_order_acquire) == h) thread_yield();
+        Connection* c = ring.slots[h % RING_SIZE];
+        atomic_store_explicit(&ring.head, h + 1, memory_order_release);
+        *sum += c->fd;
+        if (ring_use_pool) objpool_free(conn_pool, c);
+        else free(c);
+    }
+    objpool_thread_exit();
+    THREAD_RETURN;
+}
+
+double run_handoff(int use_pool) {
+    thread_t acceptor, closer;
+    long sum = 0;
+    ring_use_pool = use_pool;
+    atomic_store(&ring.head, 0);
+    atomic_store(&ring.tail, 0);
+
+    double start = get_time_ms();
+    thread_create(&closer, closer_thread, &sum);
+    thread_create(&acceptor, acceptor_thread, NULL);
+    thread_join(acceptor);
+    thread_join(closer);
+    double ms = get_time_ms() - start;
+
+    if (sum != (long)CONNECTIONS * (CONNECTIONS - 1) / 2) printf("  LOST CONNECTIONS\n");
+    return ms * 1e6 / CONNECTIONS;
+}
+
+void handoff_example(void) {
+    printf("\n=== Example 4: Cross-Thread Free (acceptor -> closer) ===\n");
+    conn_pool = objpool_create("connections", sizeof(Connection), 0);
+    double m = run_handoff(0);
+    double p = run_handoff(1);
+    printf("malloc: %6.1f ns per connection\n", m);
+    printf("pool:   %6.1f ns per connection\n", p);
+    print_stats(conn_pool);
+    printf("Full magazines go from the closer to the depot and on to the\n");
+    printf("acceptor: one depot operation per %d objects.\n", OBJPOOL_MAG_SIZE);
+    objpool_destroy(conn_pool);
+}
+
+// ===== Example 5: Checks =====
+
+void report_bug(ObjPool* p, void* obj, const char* what) {
+    printf("  caught in '%s': %s (%p)\n", p->name, what, obj);
+}
+
+void checks_example(void) {
+    printf("\n=== Example 5: Catching Bugs (OBJPOOL_CHECKED) ===\n");
+    objpool_set_error_handler(report_bug);     // Report instead of abort
+    ObjPool* pool = objpool_create("checked", sizeof(Bullet), OBJPOOL_CHECKED);
+
+    Bullet* a = (Bullet*)objpool_alloc(pool);
+    objpool_free(pool, a);
+    printf("Freeing the same bullet twice:\n");
+    objpool_free(pool, a);
+
+    printf("Freeing memory from malloc:\n");
+    void* foreign = malloc(sizeof(Bullet));
+    objpool_free(pool, foreign);
+    free(foreign);
+
+    printf("Writing to a bullet after freeing it:\n");
+    Bullet* b = (Bullet*)objpool_alloc(pool);
+    objpool_free(pool, b);
+    b->damage = 999;                    // Dangling write
+    objpool_alloc(pool);                // Detected when handed out again
+
+    print_stats(pool);
+    objpool_destroy(pool);
+    objpool_set_error_handler(NULL);
+}
+
+int main(void) {
+    printf("=== Thread-Safe Object Pool ===\n");
+    printf("Checks %s in this build\n", OBJPOOL_CHECK_DEFAULT ? "ON (slower)" : "off");
+
+    growth_example();
+    benchmark_pool_vs_malloc();
+    particle_example();
+    handoff_example();
+    checks_example();
+
+    printf("\n\n=== Summary ===\n");
+    printf("Compared with 03_memory_pool.c:\n");
+    printf("  - Grows by slabs instead of returning NULL\n");
+    printf("  - Any thread can alloc or free; the common path has no atomics\n");
+    printf("  - Objects freed elsewhere come back through the depot in batches\n");
+    printf("  - Debug builds report double frees and use-after-free writes\n");
+
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Magazines Explained (Bonwick, "Magazines and Vmem", 2001):
+ *
+ * alloc:  loaded non-empty?   pop                        (common case)
+ *         previous non-empty? swap loaded/previous, pop
+ *         depot has a full?   previous -> depot empty list,
+ *                             loaded -> previous, full -> loaded
+ *         else                carve 32 new objects from a slab
+ *
+ * free:   mirror image, with full and empty swapped
+ *
+ * Why two magazines per thread: with one, a thread that alternates
+ * alloc/free right at a magazine boundary would hit the depot on
+ * every call. With two, it has to go a full magazine (32 ops) in
+ * one direction before touching shared state again.
+ *
+ * Depot stacks are Treiber stacks of magazine *indices* with a 32-bit
+ * tag in the same word. The tag changes on every push/pop, so a CAS
+ * that saw "A" can't succeed after A was popped and pushed back (ABA).
+ *
+ * Locality: freed objects are reused LIFO per thread - the object
+ * just freed is the one most likely still in this core's cache.
+ */
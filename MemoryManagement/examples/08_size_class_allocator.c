@@ -0,0 +1,374 @@
+/*
+ * 08_size_class_allocator.c
+ *
+ * A general-purpose malloc replacement (size_alloc.h / size_alloc.c).
+ * The arena (02) and pool (03) beat malloc by knowing the workload; this
+ * one has to take any size in any order, like malloc itself:
+ *   - 41 size classes from 8 B to 32 KB, each with its own slabs
+ *   - per-thread caches: most malloc/free calls touch no shared state
+ *   - larger blocks get their own mmap, with freed mappings cached
+ *   - can replace malloc in an unmodified program via LD_PRELOAD
+ *
+ * Build: gcc -O2 08_size_class_allocator.c size_alloc.c -o 08_size_class_allocator -pthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "size_alloc.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    }
+    void thread_join(thread_t t) {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <pthread.h>
+    #include <time.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        pthread_create(t, NULL, fn, arg);
+    }
+    void thread_join(thread_t t) {
+        pthread_join(t, NULL);
+    }
+
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+// Every benchmark runs the same code against both allocators
+typedef struct {
+    const char* name;
+    void* (*alloc)(size_t);
+    void (*release)(void*);
+    void* (*resize)(void*, size_t);
+} Allocator;
+
+static const Allocator system_malloc = { "malloc    ", malloc, free, realloc };
+static const Allocator size_classes = { "size_alloc", sa_malloc, sa_free, sa_realloc };
+
+static unsigned xorshift(unsigned* state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Small sizes are much more common than big ones in real programs
+static size_t random_size(unsigned* rng) {
+    unsigned r = xorshift(rng);
+    switch (r % 8) {
+        case 0: case 1: case 2: case 3: return 8 + r / 8 % 56;         // 8-63
+        case 4: case 5: return 64 + r / 8 % 448;                        // 64-511
+        case 6: return 512 + r / 8 % 3584;                              // 512-4095
+        default: return 4096 + r / 8 % 12288;                           // 4K-16K
+    }
+}
+
+void print_result(const Allocator* a, double ms, long ops) {
+    printf("  %s %8.2f ms  %6.1f ns/op\n", a->name, ms, ms * 1e6 / ops);
+}
+
+void print_stats(void) {
+    SaStats s;
+    sa_get_stats(&s);
+    printf("  size_alloc: %.1f MB mapped, %zu slabs, %zu large live, %.1f MB large cached\n",
+           s.mapped / 1048576.0, s.small_slabs, s.large_live, s.large_cached / 1048576.0);
+}
+
+// ===== Example 1: Size classes =====
+
+void example_size_classes(void) {
+    printf("\n=== Example 1: Size Classes ===\n");
+
+    printf("  Request -> class (padding)\n");
+    size_t requests[] = { 1, 8, 9, 24, 100, 129, 200, 300, 1000, 1025, 5000, 20000, 32768 };
+    for (size_t i = 0; i < sizeof(requests) / sizeof(requests[0]); i++) {
+        void* p = sa_malloc(requests[i]);
+        size_t usable = sa_usable_size(p);
+        printf("  %6zu -> %6zu  (%4.1f%%)\n", requests[i], usable,
+               100.0 * (usable - requests[i]) / usable);
+        sa_free(p);
+    }
+
+    // Worst case over all sizes
+    double worst = 0;
+    size_t worst_size = 0;
+    for (size_t n = 65; n <= SA_MAX_SMALL; n++) {
+        void* p = sa_malloc(n);
+        double waste = (double)(sa_usable_size(p) - n) / sa_usable_size(p);
+        if (waste > worst) {
+            worst = waste;
+            worst_size = n;
+        }
+        sa_free(p);
+    }
+    printf("  Worst padding over 65..%d bytes: %.1f%% (at %zu bytes)\n",
+           SA_MAX_SMALL, worst * 100, worst_size);
+    printf("  (below 64 bytes the steps are 8-16 bytes: a large fraction,\n");
+    printf("   but only a few bytes)\n");
+}
+
+// ===== Example 2: The workloads from 02 and 03 =====
+
+double arena_workload(const Allocator* a) {
+    // 02_arena_allocator.c: 100 x 64 bytes, all freed, 10000 times
+    double start = get_time_ms();
+    for (int i = 0; i < 10000; i++) {
+        void* ptrs[100];
+        for (int j = 0; j < 100; j++) {
+            ptrs[j] = a->alloc(64);
+            *(char*)ptrs[j] = (char)j;
+        }
+        for (int j = 0; j < 100; j++) a->release(ptrs[j]);
+    }
+    return get_time_ms() - start;
+}
+
+double pool_workload(const Allocator* a, int iterations) {
+    // 03_memory_pool.c: 64-byte objects, 1000 live, oldest freed first
+    void* ptrs[1000];
+    double start = get_time_ms();
+    for (int i = 0; i < iterations; i++) {
+        if (i >= 1000) a->release(ptrs[i % 1000]);
+        ptrs[i % 1000] = a->alloc(64);
+        *(char*)ptrs[i % 1000] = (char)i;
+    }
+    double ms = get_time_ms() - start;
+    for (int i = 0; i < 1000; i++) a->release(ptrs[i]);
+    return ms;
+}
+
+void example_known_workloads(void) {
+    printf("\n=== Example 2: The Arena and Pool Workloads (02, 03) ===\n");
+
+    // Warm up both, so neither pays for its first pages in the timing
+    arena_workload(&system_malloc);
+    arena_workload(&size_classes);
+
+    printf("  benchmark_arena_vs_malloc: 10000 x 100 x 64 bytes\n");
+    print_result(&system_malloc, arena_workload(&system_malloc), 1000000);
+    print_result(&size_classes, arena_workload(&size_classes), 1000000);
+
+    const int iterations = 5000000;
+    printf("  benchmark_pool_vs_malloc: %d x 64 bytes, 1000 live\n", iterations);
+    print_result(&system_malloc, pool_workload(&system_malloc, iterations), iterations);
+    print_result(&size_classes, pool_workload(&size_classes, iterations), iterations);
+
+    printf("  (the specialised arena and pool are still faster: they skip\n");
+    printf("   the size lookup, and the arena skips free entirely)\n");
+}
+
+// ===== Example 3: Mixed sizes, random order =====
+
+#define MIXED_SLOTS 20000
+
+double mixed_workload(const Allocator* a, long ops, unsigned seed) {
+    void** slots = calloc(MIXED_SLOTS, sizeof(void*));
+    unsigned rng = seed;
+    double start = get_time_ms();
+    for (long i = 0; i < ops; i++) {
+        unsigned k = xorshift(&rng) % MIXED_SLOTS;
+        if (slots[k]) {
+            a->release(slots[k]);
+            slots[k] = NULL;
+        } else {
+            size_t n = random_size(&rng);
+            slots[k] = a->alloc(n);
+            memset(slots[k], (int)i, n < 64 ? n : 64);
+        }
+    }
+    for (int k = 0; k < MIXED_SLOTS; k++) a->release(slots[k]);
+    double ms = get_time_ms() - start;
+    free(slots);
+    return ms;
+}
+
+void example_mixed(void) {
+    printf("\n=== Example 3: Mixed Sizes, Random Frees ===\n");
+
+    const long ops = 4000000;
+    printf("  %ld ops, 8 B - 16 KB, ~10000 live\n", ops);
+    print_result(&system_malloc, mixed_workload(&system_malloc, ops, 42), ops);
+    print_result(&size_classes, mixed_workload(&size_classes, ops, 42), ops);
+    print_stats();
+}
+
+// ===== Example 4: Many threads =====
+
+typedef struct {
+    const Allocator* a;
+    long ops;
+    unsigned seed;
+} ThreadArgs;
+
+THREAD_FUNC mixed_thread(void* arg) {
+    ThreadArgs* t = (ThreadArgs*)arg;
+    mixed_workload(t->a, t->ops, t->seed);
+    THREAD_RETURN;
+}
+
+double run_threads(const Allocator* a, int threads, long ops_per_thread) {
+    thread_t tids[16];
+    ThreadArgs args[16];
+    double start = get_time_ms();
+    for (int i = 0; i < threads; i++) {
+        args[i].a = a;
+        args[i].ops = ops_per_thread;
+        args[i].seed = 1000 + i;
+        thread_create(&tids[i], mixed_thread, &args[i]);
+    }
+    for (int i = 0; i < threads; i++) thread_join(tids[i]);
+    return get_time_ms() - start;
+}
+
+void example_threads(void) {
+    printf("\n=== Example 4: Mixed Sizes on Many Threads ===\n");
+
+    const long ops = 1000000;
+    int counts[] = { 1, 4, 8 };
+    for (int i = 0; i < 3; i++) {
+        printf("  %d thread(s) x %ld ops\n", counts[i], ops);
+        print_result(&system_malloc, run_threads(&system_malloc, counts[i], ops), ops * counts[i]);
+        print_result(&size_classes, run_threads(&size_classes, counts[i], ops), ops * counts[i]);
+    }
+    print_stats();
+    printf("  (exited threads' caches were handed back: slabs stay bounded)\n");
+}
+
+// ===== Example 5: realloc =====
+
+double grow_workload(const Allocator* a, int strings, int appends) {
+    double start = get_time_ms();
+    for (int s = 0; s < strings; s++) {
+        // A string builder growing 16 bytes at a time
+        size_t len = 0;
+        char* buf = NULL;
+        for (int i = 0; i < appends; i++) {
+            buf = a->resize(buf, len + 16);
+            memset(buf + len, 'a' + i % 26, 16);
+            len += 16;
+        }
+        a->release(buf);
+    }
+    return get_time_ms() - start;
+}
+
+void example_realloc(void) {
+    printf("\n=== Example 5: Growing with realloc ===\n");
+
+    // 2000 strings, each grown to 64 KB
+    printf("  2000 buffers grown by 16 bytes up to 64 KB\n");
+    print_result(&system_malloc, grow_workload(&system_malloc, 2000, 4096), 2000L * 4096);
+    print_result(&size_classes, grow_workload(&size_classes, 2000, 4096), 2000L * 4096);
+    printf("  (growing inside the same size class is free: the pointer\n");
+    printf("   only moves when the block crosses into the next class)\n");
+}
+
+// ===== Example 6: Large blocks =====
+
+double large_workload(const Allocator* a, int rounds) {
+    unsigned rng = 7;
+    double start = get_time_ms();
+    for (int i = 0; i < rounds; i++) {
+        size_t n = 64 * 1024 + xorshift(&rng) % (1024 * 1024);
+        char* p = a->alloc(n);
+        p[0] = 1;
+        p[n - 1] = 1;
+        a->release(p);
+    }
+    return get_time_ms() - start;
+}
+
+void example_large(void) {
+    printf("\n=== Example 6: Large Blocks (64 KB - 1 MB) ===\n");
+
+    print_result(&system_malloc, large_workload(&system_malloc, 20000), 20000);
+    print_result(&size_classes, large_workload(&size_classes, 20000), 20000);
+    print_stats();
+    printf("  (without the mapping cache every one of these is an mmap\n");
+    printf("   plus munmap, and every first touch a page fault; glibc\n");
+    printf("   avoids it too, by raising its mmap threshold after a free)\n");
+
+    void* aligned = sa_memalign(4096, 100);
+    printf("  sa_memalign(4096, 100) = %p (aligned: %s)\n", aligned,
+           ((size_t)aligned % 4096) == 0 ? "yes" : "NO");
+    sa_free(aligned);
+}
+
+int main(void) {
+    printf("=== Size-Class Allocator ===\n");
+
+    example_size_classes();
+    example_known_workloads();
+    example_mixed();
+    example_threads();
+    example_realloc();
+    example_large();
+
+    printf("\n=== Replacing malloc in Any Program (Linux) ===\n");
+    printf("  gcc -O2 -shared -fPIC -DSIZE_ALLOC_OVERRIDE size_alloc.c -o libsizealloc.so -pthread\n");
+    printf("  LD_PRELOAD=./libsizealloc.so ./06_growable_arena\n");
+    printf("  (build_all.sh builds bin/libsizealloc.so)\n");
+
+    printf("\n\n=== Summary ===\n");
+    printf("  - Size classes bound padding at 20%% and make free lists exact\n");
+    printf("  - Per-thread caches make the common malloc/free lock-free\n");
+    printf("  - Batches amortise the shared lists: one lock per ~64 objects\n");
+    printf("  - Big blocks go straight to the OS, with recent ones cached\n");
+    printf("  - Still, an arena or a pool beats any general allocator\n");
+
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * How malloc(n) Finds Its Memory:
+ *
+ *   n <= 32 KB:  class = size_class(n)           (a few instructions)
+ *                thread cache for class empty?
+ *                  no:  pop                      (common case)
+ *                  yes: lock the class's central list, take a batch
+ *                       (free objects, or carve a new 256 KB slab)
+ *   n >  32 KB:  reuse a cached mapping, or mmap a new one
+ *
+ * free(p) finds the size from p alone: every slab and every large
+ * mapping starts at a 256 KB boundary with a header, so
+ *   header = p & ~(256 KB - 1)
+ * says which class (or which mapping) p belongs to. No per-object
+ * header, so 8-byte objects really cost 8 bytes.
+ *
+ * A freed object goes to *this* thread's cache, even if another thread
+ * allocated it. When a cache holds more than two batches, one batch
+ * moves back to the central list - that's how memory flows from
+ * threads that free to threads that allocate.
+ *
+ * This is the design of tcmalloc, jemalloc and mimalloc, minus their
+ * returning of unused memory to the OS, NUMA awareness and per-CPU
+ * (rather than per-thread) caches.
+ */
@@ -0,0 +1,370 @@
+/*
+ * 09_heap_profiler.c
+ *
+ * Sampling heap profiler (heapprof.h / heapprof.c) - the production
+ * version of 05_tracking_allocator.c:
+ *   - records ~1 allocation per 512 KB allocated, weighted to stay unbiased
+ *   - pointer hash table instead of a list: free is O(1), not O(live)
+ *   - thread-safe; unsampled calls touch only thread-local state
+ *   - groups the live heap by call stack, and writes pprof's format
+ *
+ * Build: gcc -O2 09_heap_profiler.c heapprof.c -o 09_heap_profiler -pthread -rdynamic -lm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "heapprof.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define NOINLINE __declspec(noinline)
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    }
+    void thread_join(thread_t t) {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <pthread.h>
+    #include <time.h>
+    #define NOINLINE __attribute__((noinline))
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        pthread_create(t, NULL, fn, arg);
+    }
+    void thread_join(thread_t t) {
+        pthread_join(t, NULL);
+    }
+
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+static unsigned xorshift(unsigned* state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// ===== Example 1: Why the list in 05 doesn't scale =====
+
+// 05's tracker, cut down: one node per allocation, linear search on free
+typedef struct Node {
+    void* ptr;
+    size_t size;
+    struct Node* next;
+} Node;
+
+static Node* list_head;
+
+void* list_malloc(size_t size) {
+    void* p = malloc(size);
+    Node* n = malloc(sizeof(Node));
+    n->ptr = p;
+    n->size = size;
+    n->next = list_head;
+    list_head = n;
+    return p;
+}
+
+void list_free(void* p) {
+    for (Node** cur = &list_head; *cur; cur = &(*cur)->next) {
+        if ((*cur)->ptr == p) {
+            Node* n = *cur;
+            *cur = n->next;
+            free(n);
+            break;
+        }
+    }
+    free(p);
+}
+
+// Frees the oldest of `live` allocations and makes a new one, `ops` times
+double churn(int live, int ops, void* (*alloc)(size_t), void (*release)(void*)) {
+    void** ptrs = calloc(live, sizeof(void*));
+    for (int i = 0; i < live; i++) ptrs[i] = alloc(64);
+    double start = get_time_ms();
+    for (int i = 0; i < ops; i++) {
+        release(ptrs[i % live]);
+        ptrs[i % live] = alloc(64);
+    }
+    double ms = get_time_ms() - start;
+    for (int i = 0; i < live; i++) release(ptrs[i]);
+    free(ptrs);
+    return ms;
+}
+
+void example_list_cost(void) {
+    printf("\n=== Example 1: The Linked List Tracker (05) at Scale ===\n");
+
+    heapprof_init(0);                   // Record everything, like 05
+    int sizes[] = { 1000, 10000, 50000 };
+    for (int i = 0; i < 3; i++) {
+        int ops = 20000;
+        double list_ms = churn(sizes[i], ops, list_malloc, list_free);
+        double table_ms = churn(sizes[i], ops, heapprof_malloc, heapprof_free);
+        printf("  %6d live: list %8.1f ns/op   hash table %6.1f ns/op\n",
+               sizes[i], list_ms * 1e6 / ops, table_ms * 1e6 / ops);
+    }
+    heapprof_shutdown();
+    printf("  (free searches the list: its cost grows with the live count.\n");
+    printf("   The table's cost is flat - mostly the backtrace per malloc)\n");
+}
+
+// ===== Example 2: Overhead =====
+
+double churn_mixed(int live, int ops, void* (*alloc)(size_t), void (*release)(void*)) {
+    void** ptrs = calloc(live, sizeof(void*));
+    unsigned rng = 99;
+    for (int i = 0; i < live; i++) ptrs[i] = alloc(16 + xorshift(&rng) % 1024);
+    double start = get_time_ms();
+    for (int i = 0; i < ops; i++) {
+        int k = xorshift(&rng) % live;
+        release(ptrs[k]);
+        ptrs[k] = alloc(16 + xorshift(&rng) % 1024);
+    }
+    double ms = get_time_ms() - start;
+    for (int i = 0; i < live; i++) release(ptrs[i]);
+    free(ptrs);
+    return ms;
+}
+
+void example_overhead(void) {
+    printf("\n=== Example 2: Overhead (100000 live, 16 B - 1 KB) ===\n");
+
+    const int ops = 2000000;
+    churn_mixed(100000, ops / 10, malloc, free);            // Warm up the heap
+
+    // Alternate and keep the best of 3: heap state and timer noise
+    // are bigger than the difference being measured
+    double plain = 1e30, sampled = 1e30;
+    heapprof_init(HEAPPROF_DEFAULT_RATE);
+    for (int round = 0; round < 3; round++) {
+        double ms = churn_mixed(100000, ops, malloc, free);
+        if (ms < plain) plain = ms;
+        ms = churn_mixed(100000, ops, heapprof_malloc, heapprof_free);
+        if (ms < sampled) sampled = ms;
+    }
+    HeapProfStats s;
+    heapprof_get_stats(&s);
+    printf("  malloc/free                 %6.1f ns/op\n", plain * 1e6 / ops);
+    printf("  sampled (512 KB)            %6.1f ns/op  (%zu of %zu allocations recorded)\n",
+           sampled * 1e6 / ops, s.samples, s.allocs);
+    heapprof_shutdown();
+
+    heapprof_init(0);
+    double all = churn_mixed(100000, ops, heapprof_malloc, heapprof_free);
+    printf("  every allocation            %6.1f ns/op\n", all * 1e6 / ops);
+    heapprof_shutdown();
+
+    printf("  Sampling overhead: %+.1f%%\n", 100.0 * (sampled - plain) / plain);
+}
+
+// ===== Example 3: Finding who holds the memory =====
+
+typedef struct {
+    char* key;
+    char* value;
+} CacheEntry;
+
+static CacheEntry* cache[4096];
+static int cache_count;
+static size_t true_live;                // What a perfect profiler would report
+
+NOINLINE char* parse_request(int id) {
+    char* buf = HP_MALLOC(256);
+    snprintf(buf, 256, "GET /item/%d HTTP/1.1", id);
+    return buf;
+}
+
+NOINLINE void cache_insert(const char* request) {
+    if (cache_count == 4096) return;
+    CacheEntry* e = HP_MALLOC(sizeof(CacheEntry));
+    e->key = HP_MALLOC(64);
+    e->value = HP_MALLOC(4096);         // The big one
+    strncpy(e->key, request, 63);
+    e->key[63] = '\0';
+    memset(e->value, 'v', 4096);
+    cache[cache_count++] = e;
+    true_live += sizeof(CacheEntry) + 64 + 4096;
+}
+
+NOINLINE void log_request(const char* request) {
+    char* line = HP_MALLOC(128);
+    snprintf(line, 128, "[log] %s", request);
+    // Forgot HP_FREE(line): a slow leak
+    true_live += 128;
+}
+
+NOINLINE void render_thumbnail(void) {
+    unsigned char* pixels = HP_MALLOC(1 << 20);
+    memset(pixels, 0, 1 << 20);
+    HP_FREE(pixels);                    // Big, but short-lived
+}
+
+NOINLINE void serve(int requests) {
+    for (int i = 0; i < requests; i++) {
+        char* req = parse_request(i);
+        if (i % 5 == 0) cache_insert(req);
+        log_request(req);
+        if (i % 100 == 0) render_thumbnail();
+        HP_FREE(req);
+    }
+}
+
+void example_profile(void) {
+    printf("\n=== Example 3: Where Is the Memory? ===\n");
+
+    // 64 KB rather than the default, for a tighter estimate in a short run
+    heapprof_init(64 * 1024);
+    serve(20000);
+
+    HeapProfStats s;
+    heapprof_get_stats(&s);
+    printf("  Actually live: %.1f KB   profiler's estimate: %.1f KB (%+.1f%%)\n",
+           true_live / 1024.0, s.live_bytes_estimate / 1024.0,
+           100.0 * ((double)s.live_bytes_estimate - (double)true_live) / true_live);
+    printf("  from %zu samples out of %zu allocations\n\n", s.samples, s.allocs);
+    heapprof_dump(stdout, 4);
+    printf("\n  (1 MB thumbnails don't show: they're freed. The 4 KB cache\n");
+    printf("   values dominate; the leaked log lines are next)\n");
+
+    for (int i = 0; i < cache_count; i++) {
+        HP_FREE(cache[i]->key);
+        HP_FREE(cache[i]->value);
+        HP_FREE(cache[i]);
+    }
+    heapprof_shutdown();
+}
+
+// ===== Example 4: Many threads =====
+
+NOINLINE void* worker_allocate(size_t size) {
+    return HP_MALLOC(size);
+}
+
+THREAD_FUNC worker(void* arg) {
+    void* keep[2000];
+    unsigned rng = 17 + (unsigned)(size_t)arg;
+    for (int i = 0; i < 2000; i++) {
+        keep[i] = worker_allocate(32 + xorshift(&rng) % 2048);
+        for (int j = 0; j < 50; j++) HP_FREE(HP_MALLOC(32 + xorshift(&rng) % 512));
+    }
+    // Free half; the other half stays live for the profile
+    for (int i = 0; i < 2000; i += 2) HP_FREE(keep[i]);
+    heapprof_thread_flush();
+    THREAD_RETURN;
+}
+
+void example_threads(void) {
+    printf("\n=== Example 4: Profiling Many Threads ===\n");
+
+    // Small rate so the thread example has plenty of samples
+    heapprof_init(16 * 1024);
+    thread_t threads[8];
+    double start = get_time_ms();
+    for (int i = 0; i < 8; i++) thread_create(&threads[i], worker, (void*)(size_t)i);
+    for (int i = 0; i < 8; i++) thread_join(threads[i]);
+    double ms = get_time_ms() - start;
+
+    HeapProfStats s;
+    heapprof_get_stats(&s);
+    printf("  8 threads, %zu allocations, %zu frees in %.1f ms\n", s.allocs, s.frees, ms);
+    printf("  %zu samples, %zu still live, ~%.0f KB live estimated\n",
+           s.samples, s.live_samples, s.live_bytes_estimate / 1024.0);
+    printf("  (expected ~%.0f KB: 8 threads x 1000 blocks x ~1 KB)\n",
+           8 * 1000 * (32 + 2047 / 2.0) / 1024.0);
+}
+
+// ===== Example 5: pprof =====
+
+void example_pprof(void) {
+    printf("\n=== Example 5: Writing a Profile for pprof ===\n");
+
+    if (heapprof_write("heap.prof") != 0) {
+        printf("  Could not write heap.prof\n");
+        return;
+    }
+    FILE* f = fopen("heap.prof", "r");
+    char line[4096];
+    int stacks = 0;
+    if (f && fgets(line, sizeof(line), f)) printf("  %s", line);
+    while (f && fgets(line, sizeof(line), f) && line[0] != '\n') stacks++;
+    if (f) fclose(f);
+    printf("  + %d call stacks, then the process memory map\n", stacks);
+    printf("  Wrote heap.prof. View it with:\n");
+    printf("    pprof --text ./09_heap_profiler heap.prof\n");
+    printf("    pprof -http=:8080 ./09_heap_profiler heap.prof\n");
+}
+
+int main(void) {
+    printf("=== Sampling Heap Profiler ===\n");
+
+    example_list_cost();
+    example_overhead();
+    example_profile();
+    example_threads();
+    example_pprof();
+    heapprof_shutdown();
+
+    printf("\n\n=== Summary ===\n");
+    printf("  - A hash table makes free O(1): the list made it O(live)\n");
+    printf("  - Sampling by bytes keeps the cost to a countdown per malloc\n");
+    printf("  - Weighting each sample by 1/P(sampled) keeps totals unbiased\n");
+    printf("  - Grouping by call stack answers \"who holds the memory?\"\n");
+    printf("  - Cheap enough to leave on in production\n");
+
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Sampling by Bytes (tcmalloc's heap profiler):
+ *
+ * Each thread counts down the bytes until its next sample. When a
+ * malloc crosses zero, that allocation is recorded and a new gap is
+ * drawn from an exponential distribution with mean R (512 KB):
+ *
+ *   |--- gap ---|X|--------- gap ---------|X|--- gap ---|X|
+ *               ^ sampled                  ^ sampled
+ *
+ * That makes sampling a Poisson process over bytes: an allocation of
+ * size s is sampled with probability
+ *
+ *   P(s) = 1 - exp(-s / R)       (1 MB: 86%, 4 KB: 0.8%, 64 B: 0.01%)
+ *
+ * and each sample counts as 1 / P(s) allocations. Summed over many
+ * samples, that's an unbiased estimate of the real heap - and
+ * allocations big enough to matter are almost never missed.
+ *
+ * Why "by bytes" and not "every Nth allocation": a program making
+ * one 100 MB allocation among a million tiny ones would almost never
+ * have it sampled by count.
+ *
+ * free() has to check whether the pointer was sampled. The table is
+ * read without a lock: an unsampled pointer finds an empty slot after
+ * a probe or two, and only sampled ones (rare) take the lock.
+ */
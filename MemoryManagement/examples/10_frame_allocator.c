@@ -0,0 +1,361 @@
+/*
+ * 10_frame_allocator.c
+ *
+ * Double-ended stack and N-buffered frame allocator (frame_alloc.h /
+ * frame_alloc.c) - the header-free, game-loop version of
+ * 04_stack_allocator.c:
+ *   - one buffer, two stacks: long-lived data at one end, scratch at the other
+ *   - no per-allocation header: free by rolling back to a mark
+ *   - per-frame buffers in a ring, so frame N can be rendered on another
+ *     thread while frame N+1 is built
+ *
+ * Build: gcc -O2 10_frame_allocator.c frame_alloc.c -o 10_frame_allocator -pthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "frame_alloc.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    }
+    void thread_join(thread_t t) {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+    void thread_yield(void) { SwitchToThread(); }
+    void sleep_ms(int ms) { Sleep(ms); }
+
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <time.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        pthread_create(t, NULL, fn, arg);
+    }
+    void thread_join(thread_t t) {
+        pthread_join(t, NULL);
+    }
+    void thread_yield(void) { sched_yield(); }
+    void sleep_ms(int ms) {
+        struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+    }
+
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+void print_dstack(DoubleStack* s) {
+    printf("  [lo %6zu | free %6zu | hi %6zu]  peak %zu of %zu bytes\n",
+           s->lo, dstack_free_bytes(s), s->size - s->hi, s->peak_used, s->size);
+}
+
+// ===== Example 1: Two ends, no headers =====
+
+typedef struct {
+    float x, y, z;
+} Vec3;
+
+void example_double_ended(void) {
+    printf("\n=== Example 1: Level Data at One End, Scratch at the Other ===\n");
+
+    DoubleStack* s = dstack_create(256 * 1024);
+
+    // Loading a level: lives until the level is unloaded
+    StackMark level = dstack_mark(s, DSTACK_HI);
+    Vec3* vertices = dstack_alloc(s, DSTACK_HI, 4000 * sizeof(Vec3));
+    int* indices = dstack_alloc(s, DSTACK_HI, 12000 * sizeof(int));
+    for (int i = 0; i < 4000; i++) vertices[i] = (Vec3){ (float)i, 0, 0 };
+    for (int i = 0; i < 12000; i++) indices[i] = i % 4000;
+    printf("Level loaded (cold end):\n");
+    print_dstack(s);
+
+    // Three frames of scratch work: each rolls back to the same mark
+    for (int frame = 1; frame <= 3; frame++) {
+        StackMark scratch = dstack_mark(s, DSTACK_LO);
+        int visible = 0;
+        int* list = dstack_alloc(s, DSTACK_LO, 12000 * sizeof(int));
+        for (int i = 0; i < 12000; i++) {
+            if (vertices[indices[i]].x > frame * 1000) list[visible++] = indices[i];
+        }
+        char* text = dstack_alloc(s, DSTACK_LO, 64);
+        snprintf(text, 64, "frame %d: %d visible", frame, visible);
+        printf("  %s\n", text);
+        print_dstack(s);
+        dstack_restore(scratch);
+    }
+
+    dstack_restore(level);
+    printf("Level unloaded:\n");
+    print_dstack(s);
+
+    // What 04's 16-byte headers would cost for small allocations
+    StackMark m = dstack_mark(s, DSTACK_LO);
+    for (int i = 0; i < 1000; i++) dstack_alloc(s, DSTACK_LO, 16);
+    printf("1000 x 16 bytes: %zu bytes here, %d bytes with 04's headers\n",
+           s->lo, 1000 * (16 + 16));
+    dstack_restore(m);
+
+    dstack_destroy(s);
+}
+
+// ===== Example 2: Scopes =====
+
+int sum_digits(DoubleStack* s, int n, int depth) {
+    int result;
+    DSTACK_SCOPE(s, DSTACK_LO) {
+        char* text = dstack_alloc(s, DSTACK_LO, 32);
+        snprintf(text, 32, "%d", n);
+        printf("  %*sdepth %d: \"%s\" (top at %zu)\n", depth * 2, "", depth, text, s->lo);
+        result = n < 10 ? n : (n % 10) + sum_digits(s, n / 10, depth + 1);
+    }
+    return result;
+}
+
+void example_scopes(void) {
+    printf("\n=== Example 2: Marker Scopes ===\n");
+
+    DoubleStack* s = dstack_create(4096);
+    printf("sum_digits(98765) with a scope per call:\n");
+    printf("  result %d, top back at %zu\n", sum_digits(s, 98765, 0), s->lo);
+
+    printf("\nRestoring an outer mark before an inner one:\n");
+    StackMark outer = dstack_mark(s, DSTACK_LO);
+    dstack_alloc(s, DSTACK_LO, 100);
+    StackMark inner = dstack_mark(s, DSTACK_LO);
+    dstack_alloc(s, DSTACK_LO, 100);
+    dstack_restore(outer);
+    dstack_restore(inner);              // Reported, ignored
+
+    dstack_destroy(s);
+}
+
+// ===== Example 3: Transient render data, malloc vs frame allocator =====
+
+typedef struct {
+    int mesh;
+    float transform[16];
+    char* label;
+} DrawCmd;
+
+typedef struct {
+    DrawCmd** cmds;
+    int count;
+} DrawList;
+
+// Builds one frame's draw list: the per-frame churn games do with malloc
+unsigned build_frame_malloc(int objects, unsigned seed) {
+    DrawList list;
+    list.cmds = malloc(objects * sizeof(DrawCmd*));
+    list.count = 0;
+    for (int i = 0; i < objects; i++) {
+        if ((seed + i) % 3 == 0) continue;                      // Culled
+        DrawCmd* c = malloc(sizeof(DrawCmd));
+        c->mesh = i;
+        for (int k = 0; k < 16; k++) c->transform[k] = (float)(i + k);
+        c->label = malloc(24);
+        snprintf(c->label, 24, "obj%d", i);
+        list.cmds[list.count++] = c;
+    }
+    unsigned check = list.count;
+    for (int i = 0; i < list.count; i++) {
+        check += list.cmds[i]->mesh;
+        free(list.cmds[i]->label);
+        free(list.cmds[i]);
+    }
+    free(list.cmds);
+    return check;
+}
+
+DrawList* build_frame(FrameAllocator* fa, int objects, unsigned seed) {
+    DrawList* list = frame_alloc(fa, sizeof(DrawList));
+    list->cmds = frame_alloc(fa, objects * sizeof(DrawCmd*));
+    list->count = 0;
+    for (int i = 0; i < objects; i++) {
+        if ((seed + i) % 3 == 0) continue;
+        DrawCmd* c = frame_alloc(fa, sizeof(DrawCmd));
+        c->mesh = i;
+        for (int k = 0; k < 16; k++) c->transform[k] = (float)(i + k);
+        c->label = frame_alloc(fa, 24);
+        snprintf(c->label, 24, "obj%d", i);
+        list->cmds[list->count++] = c;
+    }
+    return list;
+}
+
+void example_transient(void) {
+    printf("\n=== Example 3: Per-Frame Render Data (malloc vs frames) ===\n");
+
+    const int frames = 500, objects = 5000;
+    unsigned check1 = 0, check2 = 0;
+
+    double start = get_time_ms();
+    for (int f = 0; f < frames; f++) check1 += build_frame_malloc(objects, f);
+    double malloc_ms = get_time_ms() - start;
+
+    FrameAllocator* fa = frame_allocator_create(2, 512 * 1024);
+    start = get_time_ms();
+    for (int f = 0; f < frames; f++) {
+        frame_begin(fa);
+        DrawList* list = build_frame(fa, objects, f);
+        unsigned check = list->count;
+        for (int i = 0; i < list->count; i++) check += list->cmds[i]->mesh;
+        check2 += check;
+        frame_release(fa, frame_end(fa));                       // Nobody else reads it
+    }
+    double frame_ms = get_time_ms() - start;
+
+    FrameStats st;
+    frame_get_stats(fa, &st);
+    printf("  %d frames x %d objects (2 allocations each + list)\n", frames, objects);
+    printf("  malloc/free:     %7.3f ms/frame\n", malloc_ms / frames);
+    printf("  frame allocator: %7.3f ms/frame  (%.1fx)\n", frame_ms / frames, malloc_ms / frame_ms);
+    printf("  Results match: %s\n", check1 == check2 ? "yes" : "NO");
+    printf("  Peak frame: %zu KB of %d KB, overflow %zu bytes\n",
+           st.peak_used / 1024, 512, st.overflow_total);
+    frame_allocator_destroy(fa);
+}
+
+// ===== Example 4: Build frame N+1 while frame N renders =====
+
+#define MAX_BUFFERS 4
+
+typedef struct {
+    FrameAllocator* fa;
+    DrawList* lists[MAX_BUFFERS];       // Published draw list per buffer
+    atomic_ulong published;             // Last frame handed to the renderer
+    atomic_int done;
+    unsigned long rendered;
+    unsigned checksum;
+} Pipeline;
+
+THREAD_FUNC render_thread(void* arg) {
+    Pipeline* p = (Pipeline*)arg;
+    unsigned long next = 1;
+    for (;;) {
+        unsigned long ready = atomic_load(&p->published);
+        if (ready < next) {
+            if (atomic_load(&p->done)) break;
+            thread_yield();
+            continue;
+        }
+        DrawList* list = p->lists[(next - 1) % p->fa->count];
+        for (int i = 0; i < list->count; i++) {
+            p->checksum += list->cmds[i]->mesh + (unsigned)list->cmds[i]->label[3];
+        }
+        sleep_ms(2);                    // Waiting on the GPU to present
+        frame_release(p->fa, next);
+        p->rendered = next++;
+    }
+    THREAD_RETURN;
+}
+
+void run_pipeline(int buffers, int frames) {
+    Pipeline p;
+    memset(&p, 0, sizeof(p));
+    p.fa = frame_allocator_create(buffers, 512 * 1024);
+    atomic_init(&p.published, 0);
+    atomic_init(&p.done, 0);
+
+    thread_t renderer;
+    thread_create(&renderer, render_thread, &p);
+
+    unsigned expected = 0;
+    double start = get_time_ms();
+    for (int f = 0; f < frames; f++) {
+        unsigned long id = frame_begin(p.fa);
+        DrawList* list = build_frame(p.fa, 5000, f);
+        for (int i = 0; i < list->count; i++) {
+            expected += list->cmds[i]->mesh + (unsigned)list->cmds[i]->label[3];
+        }
+        sleep_ms(1);                    // Game logic that isn't allocation
+        frame_end(p.fa);
+        p.lists[(id - 1) % buffers] = list;
+        atomic_store(&p.published, id);
+    }
+    atomic_store(&p.done, 1);
+    thread_join(renderer);
+    double ms = get_time_ms() - start;
+
+    FrameStats st;
+    frame_get_stats(p.fa, &st);
+    printf("  %d buffer%s: %5.2f ms/frame, game thread waited %3ld times (%6.1f ms), %s\n",
+           buffers, buffers == 1 ? " " : "s", ms / frames, st.waits, st.wait_ms,
+           p.checksum == expected && p.rendered == (unsigned long)frames ? "data intact" : "CORRUPT");
+    frame_allocator_destroy(p.fa);
+}
+
+void example_pipeline(void) {
+    printf("\n=== Example 4: Game Thread + Render Thread ===\n");
+    printf("  Build: ~1 ms + allocations; render: ~2 ms per frame\n");
+    for (int buffers = 1; buffers <= 3; buffers++) run_pipeline(buffers, 100);
+    printf("  (1 buffer: the game waits for every render. 2+: building\n");
+    printf("   overlaps rendering, so the slower of the two sets the pace)\n");
+}
+
+int main(void) {
+    printf("=== Double-Ended Stack and Frame Allocator ===\n");
+
+    example_double_ended();
+    example_scopes();
+    example_transient();
+    example_pipeline();
+
+    printf("\n\n=== Summary ===\n");
+    printf("  - Marks replace per-allocation headers: 0 bytes of overhead\n");
+    printf("  - Two ends share one buffer: no fixed split between lifetimes\n");
+    printf("  - A frame's memory is freed by one pointer reset, not N frees\n");
+    printf("  - N buffers let the next frame be built while one is rendered\n");
+    printf("  - Frames that outgrow their buffer spill to malloc, never fail\n");
+
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Why a Ring of Frame Buffers:
+ *
+ * With one buffer, the game can't start frame N+1 until the renderer
+ * is done reading frame N - they take turns:
+ *
+ *   game:   [build 1]           [build 2]           [build 3]
+ *   render:          [render 1]          [render 2]
+ *
+ * With two, each writes a different buffer:
+ *
+ *   game:   [build 1][build 2][build 3][build 4]
+ *   render:          [render 1][render 2][render 3]
+ *            buf A    buf B     buf A     buf B
+ *
+ * frame_begin(N) waits only if frame N - buffers hasn't been released
+ * yet, i.e. the game got more than one frame ahead. Three buffers
+ * absorb a slow frame on either side; GPUs use the same scheme for
+ * their command buffers ("frames in flight").
+ *
+ * Inside a buffer, allocation is a bump pointer and the whole frame is
+ * freed by resetting it - the arena from 02, once per frame.
+ */
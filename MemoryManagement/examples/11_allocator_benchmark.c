@@ -0,0 +1,681 @@
+/*
+ * 11_allocator_benchmark.c
+ *
+ * Allocator benchmark harness. Replays allocation traces - synthetic
+ * or loaded from a file - against every allocator in this folder and
+ * reports:
+ *   - ns per operation (every allocation is written, every free read:
+ *     nothing can be optimized away)
+ *   - peak RSS and RSS per live byte (fragmentation + overhead)
+ *   - scaling across threads, including frees on another thread
+ *
+ * On Linux each run is a fork()ed child, so one allocator's leftover
+ * heap can't flatter or hurt the next, and RSS is per run.
+ *
+ * Usage:
+ *   11_allocator_benchmark                       all synthetic traces
+ *   11_allocator_benchmark trace.txt             replay a trace file
+ *   11_allocator_benchmark --write cache out.txt save a synthetic trace
+ *
+ * Trace file: one op per line
+ *   a <slot> <size>    allocate into slot, which must be empty
+ *                      (size 0 is replayed as 1)
+ *   f <slot>           free the slot, which must be allocated
+ *   r                  request boundary: nothing allocated since the
+ *                      previous r is live (lets the arena reset)
+ *
+ * Build: gcc -O2 -DNDEBUG 11_allocator_benchmark.c arena.c objpool.c size_alloc.c -o 11_allocator_benchmark -pthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "arena.h"
+#include "objpool.h"
+#include "size_alloc.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    }
+    void thread_join(thread_t t) {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+    void thread_yield(void) {
+        SwitchToThread();
+    }
+
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+
+    size_t current_rss(void) {
+        PROCESS_MEMORY_COUNTERS pmc;
+        GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+        return pmc.WorkingSetSize;
+    }
+    size_t peak_rss(void) {
+        PROCESS_MEMORY_COUNTERS pmc;
+        GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+        return pmc.PeakWorkingSetSize;
+    }
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <time.h>
+    #include <unistd.h>
+    #include <sys/resource.h>
+    #include <sys/wait.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        pthread_create(t, NULL, fn, arg);
+    }
+    void thread_join(thread_t t) {
+        pthread_join(t, NULL);
+    }
+    void thread_yield(void) {
+        sched_yield();
+    }
+
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+
+    size_t current_rss(void) {
+        long pages = 0, resident = 0;
+        FILE* f = fopen("/proc/self/statm", "r");
+        if (f) {
+            if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+            fclose(f);
+        }
+        return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+    }
+    size_t peak_rss(void) {
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        return (size_t)ru.ru_maxrss * 1024;
+    }
+#endif
+
+#define MAX_THREADS 8
+
+// ===== Allocators under test =====
+
+// Sized free: pools need the size, and every caller here knows it
+typedef struct {
+    const char* name;
+    void (*setup)(void);
+    void* (*alloc)(size_t size);
+    void (*release)(void* p, size_t size);
+    void (*reset)(void);                // Request boundary
+    void (*thread_done)(void);
+    int needs_resets;                   // Never frees otherwise: skip traces without them
+} Allocator;
+
+static void nothing(void) {}
+
+static void* libc_alloc(size_t n) { return malloc(n); }
+static void libc_free(void* p, size_t n) { (void)n; free(p); }
+
+// Arena: free is a no-op, memory comes back at request boundaries
+static void* arena_impl_alloc(size_t n) { return arena_alloc(arena_thread(), n); }
+static void arena_impl_free(void* p, size_t n) { (void)p; (void)n; }
+static void arena_impl_reset(void) { arena_reset(arena_thread()); }
+
+// Pools: one objpool per power-of-two size up to 2 KB, malloc above
+#define POOL_BUCKETS 8
+static ObjPool* pools[POOL_BUCKETS];
+
+static void pool_setup(void) {
+    for (int i = 0; i < POOL_BUCKETS; i++) pools[i] = objpool_create("bench", (size_t)16 << i, 0);
+}
+static int pool_bucket(size_t n) {
+    if (n <= 16) return 0;
+    return 64 - __builtin_clzll((unsigned long long)(n - 1)) - 4;
+}
+static void* pool_alloc(size_t n) {
+    int b = pool_bucket(n);
+    return b < POOL_BUCKETS ? objpool_alloc(pools[b]) : malloc(n);
+}
+static void pool_free(void* p, size_t n) {
+    int b = pool_bucket(n);
+    if (b < POOL_BUCKETS) objpool_free(pools[b], p);
+    else free(p);
+}
+
+static void sa_impl_free(void* p, size_t n) { (void)n; sa_free(p); }
+
+static const Allocator allocators[] = {
+    { "malloc",     nothing,    libc_alloc,       libc_free,       nothing,          nothing,              0 },
+    { "arena",      nothing,    arena_impl_alloc, arena_impl_free, arena_impl_reset, arena_thread_destroy, 1 },
+    { "objpool",    pool_setup, pool_alloc,       pool_free,       nothing,          objpool_thread_exit,  0 },
+    { "size_alloc", nothing,    sa_malloc,        sa_impl_free,    nothing,          sa_thread_flush,      0 },
+};
+#define NUM_ALLOCATORS (int)(sizeof(allocators) / sizeof(allocators[0]))
+
+// ===== Traces =====
+
+enum { OP_ALLOC, OP_FREE, OP_RESET, OP_SEND, OP_RECEIVE };
+
+typedef struct {
+    uint8_t type;
+    uint32_t slot;
+    uint32_t size;
+} Op;
+
+typedef struct {
+    Op* ops;
+    size_t count;
+    size_t capacity;
+    uint32_t slots;                     // Highest slot + 1
+    int has_resets;
+} Trace;
+
+static void emit(Trace* t, int type, uint32_t slot, uint32_t size) {
+    if (t->count == t->capacity) {
+        t->capacity = t->capacity ? t->capacity * 2 : 4096;
+        t->ops = realloc(t->ops, t->capacity * sizeof(Op));
+    }
+    t->ops[t->count].type = (uint8_t)type;
+    t->ops[t->count].slot = slot;
+    t->ops[t->count].size = size;
+    t->count++;
+    if ((type == OP_ALLOC || type == OP_FREE) && slot >= t->slots) t->slots = slot + 1;
+    if (type == OP_RESET) t->has_resets = 1;
+}
+
+static unsigned xorshift(unsigned* state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Sizes seen by server-style code: mostly small, a long tail of big
+static uint32_t server_size(unsigned* rng) {
+    unsigned r = xorshift(rng);
+    switch (r % 16) {
+        case 0: case 1: case 2: case 3: case 4: case 5: return 16 + r / 16 % 48;
+        case 6: case 7: case 8: case 9: return 64 + r / 16 % 192;
+        case 10: case 11: case 12: return 256 + r / 16 % 768;
+        case 13: case 14: return 1024 + r / 16 % 3072;
+        default: return 4096 + r / 16 % 28672;
+    }
+}
+
+// Request handling: allocate, use, free everything at the end
+static void gen_request(Trace* t, unsigned seed) {
+    unsigned rng = seed;
+    for (int req = 0; req < 20000; req++) {
+        int n = 20 + xorshift(&rng) % 180;
+        for (int i = 0; i < n; i++) emit(t, OP_ALLOC, i, server_size(&rng));
+        for (int i = n - 1; i >= 0; i--) emit(t, OP_FREE, i, 0);
+        emit(t, OP_RESET, 0, 0);
+    }
+}
+
+// A cache: 20000 live objects, random eviction, and a shift from small
+// to large objects half way through (the classic fragmentation maker)
+static void gen_cache(Trace* t, unsigned seed) {
+    unsigned rng = seed;
+    const uint32_t live = 20000;
+    for (uint32_t i = 0; i < live; i++) emit(t, OP_ALLOC, i, 16 + xorshift(&rng) % 240);
+    for (int i = 0; i < 1500000; i++) {
+        uint32_t slot = xorshift(&rng) % live;
+        emit(t, OP_FREE, slot, 0);
+        uint32_t size = i < 750000 ? 16 + xorshift(&rng) % 240 : 256 + xorshift(&rng) % 3840;
+        emit(t, OP_ALLOC, slot, size);
+    }
+    for (uint32_t i = 0; i < live; i++) emit(t, OP_FREE, i, 0);
+}
+
+// 03's benchmark: 64-byte objects, 1000 live, oldest freed first
+static void gen_fixed(Trace* t, unsigned seed) {
+    (void)seed;
+    for (int i = 0; i < 2000000; i++) {
+        if (i >= 1000) emit(t, OP_FREE, i % 1000, 0);
+        emit(t, OP_ALLOC, i % 1000, 64);
+    }
+    for (int i = 0; i < 1000; i++) emit(t, OP_FREE, i, 0);
+}
+
+// Producer/consumer: every object is freed by the next thread over
+static void gen_handoff(Trace* t, unsigned seed) {
+    unsigned rng = seed;
+    for (int i = 0; i < 1000000; i++) {
+        emit(t, OP_SEND, 0, 64 + xorshift(&rng) % 960);
+        emit(t, OP_RECEIVE, 0, 0);
+    }
+}
+
+typedef struct {
+    const char* name;
+    const char* description;
+    void (*generate)(Trace* t, unsigned seed);
+} TraceKind;
+
+static const TraceKind trace_kinds[] = {
+    { "request", "20000 requests x 20-200 allocs, 16 B - 32 KB, freed at request end", gen_request },
+    { "cache",   "20000 live, random eviction, 16-256 B then 256 B - 4 KB", gen_cache },
+    { "fixed64", "64 B objects, 1000 live, FIFO (03's benchmark)", gen_fixed },
+    { "handoff", "64 B - 1 KB, each freed by another thread", gen_handoff },
+};
+#define NUM_TRACES (int)(sizeof(trace_kinds) / sizeof(trace_kinds[0]))
+
+// Replay trusts a trace, so check it here: a free must match a live
+// slot and an alloc must not overwrite one. Size 0 is replayed as 1
+static int load_trace(const char* path, Trace* t) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+    unsigned char* live = NULL;
+    size_t live_cap = 0;
+    char line[128];
+    int line_no = 0, ok = 1;
+    while (ok && fgets(line, sizeof(line), f)) {
+        line_no++;
+        unsigned slot, size;
+        int is_alloc = line[0] == 'a' && sscanf(line + 1, "%u %u", &slot, &size) == 2;
+        int is_free = !is_alloc && line[0] == 'f' && sscanf(line + 1, "%u", &slot) == 1;
+        if (is_alloc || is_free) {
+            if (slot >= live_cap) {
+                size_t cap = live_cap ? live_cap : 1024;
+                while (cap <= slot) cap *= 2;
+                unsigned char* grown = realloc(live, cap);
+                if (!grown) {
+                    ok = 0;
+                    break;
+                }
+                memset(grown + live_cap, 0, cap - live_cap);
+                live = grown;
+                live_cap = cap;
+            }
+            if (is_alloc && live[slot]) {
+                printf("%s:%d: alloc into slot %u, which is still live\n", path, line_no, slot);
+                ok = 0;
+            } else if (is_free && !live[slot]) {
+                printf("%s:%d: free of slot %u, which isn't allocated\n", path, line_no, slot);
+                ok = 0;
+            } else if (is_alloc) {
+                live[slot] = 1;
+                emit(t, OP_ALLOC, slot, size ? size : 1);
+            } else {
+                live[slot] = 0;
+                emit(t, OP_FREE, slot, 0);
+            }
+        } else if (line[0] == 'r') {
+            emit(t, OP_RESET, 0, 0);
+        }
+    }
+    free(live);
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+static int save_trace(const char* path, Trace* t) {
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+    for (size_t i = 0; i < t->count; i++) {
+        Op* op = &t->ops[i];
+        if (op->type == OP_ALLOC) fprintf(f, "a %u %u\n", op->slot, op->size);
+        else if (op->type == OP_FREE) fprintf(f, "f %u\n", op->slot);
+        else if (op->type == OP_RESET) fprintf(f, "r\n");
+    }
+    return fclose(f);
+}
+
+// ===== Replay =====
+
+// Cross-thread frees go through a ring per thread; when it's full the
+// sender frees locally, so no thread can block another
+#define INBOX_SIZE 1024
+
+typedef struct {
+    _Alignas(64) atomic_size_t head;
+    _Alignas(64) atomic_size_t tail;
+    void* items[INBOX_SIZE];
+    uint32_t sizes[INBOX_SIZE];
+} Inbox;
+
+typedef struct {
+    const Allocator* a;
+    Trace* trace;
+    Inbox* inbox;                       // Ours
+    Inbox* next_inbox;                  // The thread we send to
+    atomic_int* senders_left;
+    size_t peak_live;
+    size_t ops;
+    uint64_t checksum;
+} Worker;
+
+static int inbox_push(Inbox* in, void* p, uint32_t size) {
+    size_t tail = atomic_load_explicit(&in->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&in->head, memory_order_acquire) == INBOX_SIZE) return 0;
+    in->items[tail % INBOX_SIZE] = p;
+    in->sizes[tail % INBOX_SIZE] = size;
+    atomic_store_explicit(&in->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+static int inbox_pop(Inbox* in, void** p, uint32_t* size) {
+    size_t head = atomic_load_explicit(&in->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&in->tail, memory_order_acquire)) return 0;
+    *p = in->items[head % INBOX_SIZE];
+    *size = in->sizes[head % INBOX_SIZE];
+    atomic_store_explicit(&in->head, head + 1, memory_order_release);
+    return 1;
+}
+
+static inline void touch(unsigned char* p, uint32_t size, uint32_t tag) {
+    if (size == 0) return;
+    p[0] = (unsigned char)tag;
+    p[size - 1] = (unsigned char)tag;
+}
+
+THREAD_FUNC replay(void* arg) {
+    Worker* w = (Worker*)arg;
+    const Allocator* a = w->a;
+    Trace* t = w->trace;
+    void** slots = calloc(t->slots + 1, sizeof(void*));
+    uint32_t* sizes = calloc(t->slots + 1, sizeof(uint32_t));
+    size_t live = 0;
+    uint64_t check = 0;
+
+    for (size_t i = 0; i < t->count; i++) {
+        Op* op = &t->ops[i];
+        switch (op->type) {
+            case OP_ALLOC: {
+                unsigned char* p = a->alloc(op->size);
+                touch(p, op->size, (uint32_t)i);
+                slots[op->slot] = p;
+                sizes[op->slot] = op->size;
+                live += op->size;
+                if (live > w->peak_live) w->peak_live = live;
+                break;
+            }
+            case OP_FREE: {
+                unsigned char* p = slots[op->slot];
+                if (sizes[op->slot]) check += p[0] + p[sizes[op->slot] - 1];
+                a->release(p, sizes[op->slot]);
+                live -= sizes[op->slot];
+                break;
+            }
+            case OP_RESET:
+                a->reset();
+                break;
+            case OP_SEND: {
+                unsigned char* p = a->alloc(op->size);
+                touch(p, op->size, (uint32_t)i);
+                if (!inbox_push(w->next_inbox, p, op->size)) a->release(p, op->size);
+                break;
+            }
+            case OP_RECEIVE: {
+                void* p;
+                uint32_t size;
+                if (inbox_pop(w->inbox, &p, &size)) {
+                    check += ((unsigned char*)p)[0];
+                    a->release(p, size);
+                }
+                break;
+            }
+        }
+    }
+
+    // Handoff: keep draining until every sender is done
+    atomic_fetch_sub(w->senders_left, 1);
+    void* p;
+    uint32_t size;
+    for (;;) {
+        if (inbox_pop(w->inbox, &p, &size)) {
+            a->release(p, size);
+        } else if (atomic_load(w->senders_left) == 0) {
+            if (!inbox_pop(w->inbox, &p, &size)) break;
+            a->release(p, size);
+        } else {
+            thread_yield();
+        }
+    }
+
+    w->ops = t->count;
+    w->checksum = check;
+    free(slots);
+    free(sizes);
+    a->thread_done();
+    THREAD_RETURN;
+}
+
+typedef struct {
+    double ns_per_op;
+    double mops;                        // Million ops/s, all threads
+    size_t peak_live;                   // Sum of per-thread peaks
+    size_t rss_growth;                  // Peak RSS minus RSS before the replay
+    uint64_t checksum;
+} Result;
+
+// One thread per trace copy; each thread gets its own seed
+static Result run(const Allocator* a, Trace* traces, int threads) {
+    Result r;
+    memset(&r, 0, sizeof(r));
+    a->setup();
+
+    Worker workers[MAX_THREADS];
+    Inbox* inboxes = calloc(threads, sizeof(Inbox));
+    atomic_int senders_left;
+    atomic_init(&senders_left, threads);
+    for (int i = 0; i < threads; i++) {
+        memset(&workers[i], 0, sizeof(Worker));
+        workers[i].a = a;
+        workers[i].trace = &traces[i];
+        workers[i].inbox = &inboxes[i];
+        workers[i].next_inbox = &inboxes[(i + 1) % threads];
+        workers[i].senders_left = &senders_left;
+    }
+
+    size_t rss_before = current_rss();
+    double start = get_time_ms();
+    thread_t tids[MAX_THREADS];
+    for (int i = 0; i < threads; i++) thread_create(&tids[i], replay, &workers[i]);
+    for (int i = 0; i < threads; i++) thread_join(tids[i]);
+    double ms = get_time_ms() - start;
+    size_t peak = peak_rss();
+
+    size_t ops = 0;
+    for (int i = 0; i < threads; i++) {
+        ops += workers[i].ops;
+        r.peak_live += workers[i].peak_live;
+        r.checksum += workers[i].checksum;
+    }
+    r.ns_per_op = ms * 1e6 / ((double)ops / threads);
+    r.mops = ops / (ms * 1000.0);
+    r.rss_growth = peak > rss_before ? peak - rss_before : 0;
+    free(inboxes);
+    return r;
+}
+
+// Runs in a child process where possible: fresh heap, own RSS
+static Result run_isolated(const Allocator* a, Trace* traces, int threads) {
+#ifdef _WIN32
+    return run(a, traces, threads);
+#else
+    int fds[2];
+    Result r;
+    memset(&r, 0, sizeof(r));
+    if (pipe(fds) != 0) return run(a, traces, threads);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        r = run(a, traces, threads);
+        if (write(fds[1], &r, sizeof(r)) != (ssize_t)sizeof(r)) _exit(1);
+        _exit(0);
+    }
+    close(fds[1]);
+    if (read(fds[0], &r, sizeof(r)) != (ssize_t)sizeof(r)) r.ns_per_op = -1;
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+    return r;
+#endif
+}
+
+static void print_header(void) {
+    printf("  %-11s %7s %9s %9s %10s %10s %9s\n",
+           "allocator", "threads", "ns/op", "Mops/s", "peak live", "RSS grew", "RSS/live");
+}
+
+static void print_result(const char* name, int threads, Result* r) {
+    if (r->ns_per_op < 0) {
+        printf("  %-11s %7d   (failed)\n", name, threads);
+        return;
+    }
+    printf("  %-11s %7d %9.1f %9.1f %8.1fMB %8.1fMB", name, threads,
+           r->ns_per_op, r->mops, r->peak_live / 1048576.0, r->rss_growth / 1048576.0);
+    // Handoff objects belong to no one thread: no live count
+    if (r->peak_live) printf(" %8.2fx\n", (double)r->rss_growth / r->peak_live);
+    else printf(" %9s\n", "-");
+}
+
+static void print_skipped(const char* name, int threads) {
+    printf("  %-11s %7d   (skipped: trace has no request boundaries to reset at)\n", name, threads);
+}
+
+static void free_traces(Trace* traces, int n) {
+    for (int i = 0; i < n; i++) free(traces[i].ops);
+}
+
+// ===== Benchmarks =====
+
+static void bench_synthetic(void) {
+    int thread_counts[] = { 1, 4 };
+
+    for (int k = 0; k < NUM_TRACES; k++) {
+        const TraceKind* kind = &trace_kinds[k];
+        printf("\n=== Trace: %s ===\n", kind->name);
+        printf("  %s\n", kind->description);
+
+        Trace traces[MAX_THREADS];
+        memset(traces, 0, sizeof(traces));
+        for (int i = 0; i < MAX_THREADS; i++) kind->generate(&traces[i], 1234 + 7 * i);
+        printf("  %zu ops per thread\n", traces[0].count);
+        print_header();
+
+        for (int c = 0; c < 2; c++) {
+            int threads = thread_counts[c];
+            if (threads == 1 && strcmp(kind->name, "handoff") == 0) continue;
+            uint64_t expected = 0;
+            for (int a = 0; a < NUM_ALLOCATORS; a++) {
+                if (allocators[a].needs_resets && !traces[0].has_resets) {
+                    print_skipped(allocators[a].name, threads);
+                    continue;
+                }
+                Result r = run_isolated(&allocators[a], traces, threads);
+                print_result(allocators[a].name, threads, &r);
+                // Same trace, same data: every allocator must agree
+                if (strcmp(kind->name, "handoff") != 0 && r.ns_per_op >= 0) {
+                    if (a == 0) expected = r.checksum;
+                    else if (r.checksum != expected) printf("  ^ checksum mismatch!\n");
+                }
+            }
+        }
+        free_traces(traces, MAX_THREADS);
+    }
+}
+
+static void bench_file(const char* path) {
+    Trace t;
+    memset(&t, 0, sizeof(t));
+    if (load_trace(path, &t) != 0 || t.count == 0) {
+        printf("Could not read a trace from %s\n", path);
+        free(t.ops);
+        return;
+    }
+    printf("\n=== Trace: %s (%zu ops, %u slots) ===\n", path, t.count, t.slots);
+    print_header();
+    for (int a = 0; a < NUM_ALLOCATORS; a++) {
+        if (allocators[a].needs_resets && !t.has_resets) {
+            print_skipped(allocators[a].name, 1);
+            continue;
+        }
+        Result r = run_isolated(&allocators[a], &t, 1);
+        print_result(allocators[a].name, 1, &r);
+    }
+    free(t.ops);
+}
+
+int main(int argc, char** argv) {
+    printf("=== Allocator Benchmark Harness ===\n");
+
+    if (argc == 4 && strcmp(argv[1], "--write") == 0) {
+        for (int k = 0; k < NUM_TRACES; k++) {
+            if (strcmp(trace_kinds[k].name, argv[2]) != 0) continue;
+            Trace t;
+            memset(&t, 0, sizeof(t));
+            trace_kinds[k].generate(&t, 1234);
+            int ok = save_trace(argv[3], &t) == 0;
+            printf("%s %zu ops to %s\n", ok ? "Wrote" : "Failed to write", t.count, argv[3]);
+            free(t.ops);
+            return ok ? 0 : 1;
+        }
+        printf("Unknown trace '%s' (request, cache, fixed64)\n", argv[2]);
+        return 1;
+    }
+    if (argc == 2) {
+        bench_file(argv[1]);
+        return 0;
+    }
+
+    bench_synthetic();
+
+    printf("\n\n=== Reading the Results ===\n");
+    printf("  ns/op      wall time per op, per thread (lower is better)\n");
+    printf("  peak live  most bytes the program had allocated at once\n");
+    printf("  RSS grew   physical memory the allocator took to serve it\n");
+    printf("  RSS/live   1.0 = no overhead; higher = headers, padding,\n");
+    printf("             fragmentation and memory kept after free\n");
+    printf("  The arena only frees at resets: fastest for requests, and not\n");
+    printf("  an option for a cache. Pick per workload, not per benchmark.\n");
+
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Why Replay Traces:
+ *
+ * Loops like 02's "allocate 100 x 64 bytes, free them, repeat" test one
+ * size and one lifetime, and the compiler may drop allocations whose
+ * results are never used. Real programs have:
+ *
+ *   - size mixes:      mostly tiny, a few huge
+ *   - lifetimes:       per-request scratch vs. long-lived caches
+ *   - phase changes:   the cache trace switches object sizes half way,
+ *                      leaving holes small objects can't refill
+ *   - threads:         objects freed on a different thread than the
+ *                      one that allocated them (the handoff trace)
+ *
+ * A trace is a list of (alloc slot size | free slot | reset) ops.
+ * Replaying the same list against every allocator makes the results
+ * comparable, and the checksum (first and last byte of every block,
+ * written on alloc and read on free) proves the work was done.
+ *
+ * RSS/live is the number that matters for services: an allocator 10%
+ * faster but holding 2x the memory needs twice the machines.
+ */
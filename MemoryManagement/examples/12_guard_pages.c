@@ -0,0 +1,369 @@
+/*
+ * 12_guard_pages.c
+ *
+ * Sampled guard-page allocator (guardalloc.h / guardalloc.c) - the
+ * debug mode 05_tracking_allocator.c is missing:
+ *   - overflows and underflows fault on the exact instruction
+ *   - use-after-free faults too, and the report shows who freed it
+ *   - small overruns, double frees and bad frees are reported at free
+ *   - only 1 in N allocations is guarded, so it can stay on
+ *
+ * The crashing examples run in a child process so the demo survives
+ * them. To crash this process instead:
+ *   12_guard_pages overflow | underflow | use-after-free | sampled
+ *
+ * Build: gcc -O2 12_guard_pages.c guardalloc.c -o 12_guard_pages -pthread -rdynamic
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "guardalloc.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define NOINLINE __declspec(noinline)
+
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <time.h>
+    #include <unistd.h>
+    #include <sys/wait.h>
+    #define NOINLINE __attribute__((noinline))
+
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+static unsigned xorshift(unsigned* state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// ===== The bugs =====
+
+// Off-by-one: <= instead of <
+NOINLINE void fill_scores(int* scores, int count) {
+    for (int i = 0; i <= count; i++) scores[i] = i * 10;
+}
+
+void bug_overflow(void) {
+    int* scores = GA_MALLOC(16 * sizeof(int));
+    printf("  Filling 16 scores with i <= 16...\n");
+    fflush(stdout);
+    fill_scores(scores, 16);
+    printf("  Not reached\n");
+}
+
+// Walks back one element too far
+NOINLINE int find_last_negative(const int* values, int count) {
+    int i = count - 1;
+    while (i >= -1 && values[i] >= 0) i--;
+    return i;
+}
+
+void bug_underflow(void) {
+    // Guarded allocations alternate between the right and left guard:
+    // the first of these is caught at free, the second faults
+    for (int n = 0; n < 2; n++) {
+        int* values = GA_MALLOC(8 * sizeof(int));
+        for (int i = 0; i < 8; i++) values[i] = i;
+        values[-1] = 0;                 // What find_last_negative will read
+        printf("  Allocation %d: searching backwards past the start...\n", n + 1);
+        fflush(stdout);
+        find_last_negative(values, 8);
+        GA_FREE(values);
+    }
+    printf("  Not reached\n");
+}
+
+typedef struct {
+    int id;
+    char user[28];
+} Session;
+
+NOINLINE void close_session(Session* s) {
+    GA_FREE(s);
+}
+
+NOINLINE Session* open_session(int id, const char* user) {
+    Session* s = GA_MALLOC(sizeof(Session));
+    s->id = id;
+    strncpy(s->user, user, sizeof(s->user) - 1);
+    s->user[sizeof(s->user) - 1] = '\0';
+    return s;
+}
+
+void bug_use_after_free(void) {
+    Session* s = open_session(42, "alice");
+    close_session(s);
+    printf("  Session closed; logging it afterwards...\n");
+    fflush(stdout);
+    printf("  closed session %d\n", s->id);
+    printf("  Not reached\n");
+}
+
+// A request handler with an off-by-one in a buffer it allocates every
+// time. With 1-in-1000 sampling it runs fine until its buffer is
+// the sampled one.
+NOINLINE void handle_request(int id, unsigned* rng) {
+    size_t len = 16 + xorshift(rng) % 48;
+    char* copy = GA_MALLOC(len);
+    char* other = GA_MALLOC(64);        // The rest of the service's allocations
+    if (guard_is_guarded(copy)) {
+        printf("  Request %d: its buffer is the guarded one\n", id);
+        fflush(stdout);
+    }
+    for (size_t i = 0; i <= len + 16; i++) copy[i] = 'x';  // Overruns by 17
+    GA_FREE(other);
+    GA_FREE(copy);
+}
+
+void bug_sampled(void) {
+    guardalloc_init(GUARDALLOC_DEFAULT_SLOTS, GUARDALLOC_DEFAULT_SAMPLE);
+    unsigned rng = 1;
+    for (int i = 1; i <= 1000000; i++) handle_request(i, &rng);
+    printf("  Never caught\n");
+}
+
+typedef struct {
+    const char* name;
+    void (*run)(void);
+} Bug;
+
+static const Bug bugs[] = {
+    { "overflow", bug_overflow },
+    { "underflow", bug_underflow },
+    { "use-after-free", bug_use_after_free },
+    { "sampled", bug_sampled },
+};
+#define NUM_BUGS (int)(sizeof(bugs) / sizeof(bugs[0]))
+
+// Runs a bug in a child process and reports how the child ended
+void run_crash(const char* name) {
+    const Bug* bug = NULL;
+    for (int i = 0; i < NUM_BUGS; i++) {
+        if (strcmp(bugs[i].name, name) == 0) bug = &bugs[i];
+    }
+#ifdef _WIN32
+    (void)bug;
+    printf("  (crashing examples need fork; run: 12_guard_pages %s)\n", name);
+#else
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        bug->run();
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    if (WIFSIGNALED(status)) {
+        printf("  -> child died with signal %d (%s), at the bad access\n",
+               WTERMSIG(status), WTERMSIG(status) == 11 ? "SIGSEGV" : "see above");
+    } else {
+        printf("  -> child exited normally: the bug went unnoticed\n");
+    }
+#endif
+}
+
+// ===== Examples =====
+
+void example_overflow(void) {
+    printf("\n=== Example 1: Overflow Faults at the Write ===\n");
+    printf("  Without guard pages scores[16] lands in the next allocation's\n");
+    printf("  header and crashes much later, somewhere unrelated.\n\n");
+    run_crash("overflow");
+}
+
+void example_underflow(void) {
+    printf("\n=== Example 2: Underflow ===\n");
+    run_crash("underflow");
+}
+
+void example_use_after_free(void) {
+    printf("\n=== Example 3: Use After Free ===\n");
+    printf("  Freed slots stay inaccessible until they're reused (oldest\n");
+    printf("  first), so stale pointers fault - and the report shows both\n");
+    printf("  where the object was allocated and where it was freed.\n\n");
+    run_crash("use-after-free");
+}
+
+void example_caught_at_free(void) {
+    printf("\n=== Example 4: Caught at Free ===\n");
+    printf("  Bugs that don't touch a guard page, reported without crashing:\n\n");
+    GuardAllocStats before, after;
+    guardalloc_get_stats(&before);
+
+    printf("  strcpy of 13 bytes into 10 (stays inside the page):\n");
+    fflush(stdout);
+    char* name = GA_MALLOC(10);
+    strcpy(name, "overflowing!");
+    GA_FREE(name);
+
+    printf("\n  Double free:\n");
+    fflush(stdout);
+    char* twice = GA_MALLOC(32);
+    GA_FREE(twice);
+    GA_FREE(twice);
+
+    printf("\n  Freeing a pointer into the middle of an allocation:\n");
+    fflush(stdout);
+    char* buffer = GA_MALLOC(100);
+    GA_FREE(buffer + 40);
+    GA_FREE(buffer);
+    fflush(stderr);
+
+    guardalloc_get_stats(&after);
+    printf("\n  Errors reported: %zu\n", after.errors - before.errors);
+
+    // Not a bug: malloc(0) returns a pointer that must be freeable
+    guardalloc_get_stats(&before);
+    for (int i = 0; i < 4; i++) GA_FREE(GA_MALLOC(0));
+    guardalloc_get_stats(&after);
+    printf("  4 x malloc(0)/free: errors %zu, still live %zu\n", after.errors - before.errors,
+           after.live - before.live);
+}
+
+void example_overhead(void) {
+    printf("\n=== Example 5: Cost of Sampling ===\n");
+    printf("  Mixed 16 B - 1 KB allocations, 1000 live, 2M malloc/free pairs:\n\n");
+    const int live = 1000;
+    const int ops = 2000000;
+    void** slots = calloc(live, sizeof(void*));
+    unsigned samples[] = { 0, 10000, 1000, 100, 10 };
+
+    printf("  %-14s %10s %10s %12s %10s\n", "guarded", "ns/pair", "guarded", "us/guarded", "pool full");
+    double base_ms = 0;
+    for (int r = 0; r < 5; r++) {
+        unsigned rng = 99;
+        GuardAllocStats before, after;
+        if (samples[r]) guardalloc_init(GUARDALLOC_DEFAULT_SLOTS, samples[r]);
+        guardalloc_get_stats(&before);
+        double start = get_time_ms();
+        for (int i = 0; i < ops; i++) {
+            int k = xorshift(&rng) % live;
+            size_t size = 16 + xorshift(&rng) % 1008;
+            if (samples[r]) {
+                GA_FREE(slots[k]);
+                slots[k] = GA_MALLOC(size);
+            } else {
+                free(slots[k]);
+                slots[k] = malloc(size);
+            }
+            ((char*)slots[k])[0] = 1;
+        }
+        double ms = get_time_ms() - start;
+        guardalloc_get_stats(&after);
+        for (int k = 0; k < live; k++) {
+            if (samples[r]) GA_FREE(slots[k]);
+            else free(slots[k]);
+            slots[k] = NULL;
+        }
+
+        size_t guarded = after.guarded - before.guarded;
+        if (!samples[r]) {
+            base_ms = ms;
+            printf("  %-14s %10.1f %10s %12s %10s\n", "none (malloc)", ms * 1e6 / ops, "-", "-", "-");
+            continue;
+        }
+        char label[32];
+        snprintf(label, sizeof(label), "1 in %u", samples[r]);
+        printf("  %-14s %10.1f %10zu %12.1f %10zu\n", label, ms * 1e6 / ops, guarded,
+               guarded ? (ms - base_ms) * 1000.0 / guarded : 0.0, after.pool_full - before.pool_full);
+    }
+    free(slots);
+    printf("\n  A guarded allocation costs microseconds: two mprotect calls,\n");
+    printf("  two backtraces, filling and checking a page. Spread over 1000\n");
+    printf("  allocations that's a few ns each - small next to the work a\n");
+    printf("  real program does between mallocs.\n");
+}
+
+void example_sampled(void) {
+    printf("\n=== Example 6: Catching a Bug by Sampling ===\n");
+    printf("  A handler overruns its buffer on every request. Unguarded, it\n");
+    printf("  corrupts the heap quietly; 1 in 1000 allocations is guarded:\n\n");
+    run_crash("sampled");
+    printf("  A bug on a path that runs ~1000 times is caught; across a\n");
+    printf("  fleet of load-test machines, rarer paths get caught too.\n");
+}
+
+int main(int argc, char** argv) {
+    guardalloc_init(GUARDALLOC_DEFAULT_SLOTS, 1);
+
+    if (argc == 2) {
+        for (int i = 0; i < NUM_BUGS; i++) {
+            if (strcmp(bugs[i].name, argv[1]) == 0) {
+                bugs[i].run();
+                return 0;
+            }
+        }
+        printf("Unknown bug '%s'\n", argv[1]);
+        return 1;
+    }
+
+    printf("=== Guard Pages ===\n");
+    printf("Every allocation guarded (1 in 1) until Example 5\n");
+
+    example_overflow();
+    example_underflow();
+    example_use_after_free();
+    example_caught_at_free();
+    example_overhead();
+    example_sampled();
+
+    printf("\n\n=== Summary ===\n");
+    printf("  - A PROT_NONE page next to an allocation turns an overflow\n");
+    printf("    into a crash at the faulting instruction\n");
+    printf("  - Freed memory stays PROT_NONE in quarantine: use-after-free\n");
+    printf("    crashes, with the allocating and freeing stacks\n");
+    printf("  - Fill patterns catch smaller overruns at free\n");
+    printf("  - Sampling 1 in N keeps the cost low enough to leave on\n");
+
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Why Guard Pages Work:
+ *
+ * The MMU checks every load and store against page permissions for
+ * free. Put an inaccessible page right after an allocation and the
+ * first byte past its end is a hardware fault - no instrumentation,
+ * no slowdown for the accesses that are in bounds.
+ *
+ *   page N (read/write)          page N+1 (PROT_NONE)
+ *   ┌─────────────────┬────────┐┌──────────────────┐
+ *   │ fill 0xAB ...   │ object ││ guard            │
+ *   └─────────────────┴────────┘└──────────────────┘
+ *                       p[size] ─┘ faults here
+ *
+ * The price is a page per allocation plus two system calls, which is
+ * why electric fence guarding everything is too slow for real loads.
+ * GWP-ASan (Chrome, Android, tcmalloc) made it practical by guarding
+ * a random 1 in N allocations: each process catches little, but a
+ * fleet running for days catches a lot, with overhead in the noise.
+ *
+ * The gap between samples is random (uniform, mean N) rather than
+ * every Nth, so a loop allocating the same few objects can't keep
+ * stepping around the guarded one.
+ *
+ * Compared with the tools:
+ *
+ *   valgrind:   every access checked, 20-50x slower, test runs only
+ *   ASan:       every access checked, ~2x slower, needs a rebuild
+ *   guard pages (sampled): only some allocations, ~free, production
+ */
@@ -0,0 +1,260 @@
+/*
+ * Growable arena allocator - implementation
+ *
+ * See arena.h for the API.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+#define PAGE_SIZE 4096
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+static size_t round_up(size_t n, size_t to) {
+    return (n + to - 1) & ~(to - 1);
+}
+
+static void out_of_memory(size_t size) {
+    fprintf(stderr, "arena: out of memory allocating %zu bytes\n", size);
+    abort();
+}
+
+// ===== Blocks from the system =====
+
+#ifdef _WIN32
+static void* os_map(size_t size, int huge) {
+    // Large pages need SeLockMemoryPrivilege; use normal pages
+    (void)huge;
+    return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+}
+
+static void os_unmap(void* p, size_t size) {
+    (void)size;
+    VirtualFree(p, 0, MEM_RELEASE);
+}
+#else
+static void* os_map(size_t size, int huge) {
+    if (huge) {
+        #ifdef MAP_HUGETLB
+        // Explicit huge pages: only works if the admin reserved some
+        // (vm.nr_hugepages). Fall through to transparent ones if not.
+        void* p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) return p;
+        #endif
+
+        // Transparent huge pages need a 2 MB aligned range: map extra
+        // and cut off the misaligned ends
+        char* raw = mmap(NULL, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return NULL;
+        char* aligned = (char*)round_up((size_t)raw, HUGE_PAGE_SIZE);
+        if (aligned > raw) munmap(raw, aligned - raw);
+        size_t tail = (raw + size + HUGE_PAGE_SIZE) - (aligned + size);
+        if (tail) munmap(aligned + size, tail);
+        #ifdef MADV_HUGEPAGE
+        madvise(aligned, size, MADV_HUGEPAGE);
+        #endif
+        return aligned;
+    }
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+static void os_unmap(void* p, size_t size) {
+    munmap(p, size);
+}
+#endif
+
+static ArenaBlock* block_new(Arena* a, size_t size) {
+    ArenaBlock* b;
+    size_t header = round_up(sizeof(ArenaBlock), 64);
+
+    if (a->flags & (ARENA_MMAP | ARENA_HUGE_PAGES)) {
+        int huge = (a->flags & ARENA_HUGE_PAGES) != 0;
+        size_t map_size = round_up(header + size, huge ? HUGE_PAGE_SIZE : PAGE_SIZE);
+        void* base = os_map(map_size, huge);
+        if (!base) out_of_memory(map_size);
+        b = (ArenaBlock*)base;
+        b->map_base = base;
+        b->map_size = map_size;
+        b->size = map_size - header;    // Rounding slack is usable too
+    } else {
+        b = (ArenaBlock*)malloc(header + size);
+        if (!b) out_of_memory(header + size);
+        b->map_base = NULL;
+        b->map_size = 0;
+        b->size = size;
+    }
+    b->data = (char*)b + header;
+    b->used = 0;
+    b->prev = NULL;
+
+    a->reserved += b->size;
+    a->os_allocs++;
+    return b;
+}
+
+static void block_free(Arena* a, ArenaBlock* b) {
+    a->reserved -= b->size;
+    if (b->map_size) os_unmap(b->map_base, b->map_size);
+    else free(b);
+}
+
+// ===== Arena =====
+
+Arena* arena_create(size_t first_block, int flags) {
+    Arena* a = (Arena*)calloc(1, sizeof(Arena));
+    if (!a) out_of_memory(sizeof(Arena));
+    a->next_size = first_block ? first_block : ARENA_DEFAULT_BLOCK;
+    a->flags = flags;
+    return a;
+}
+
+void arena_destroy(Arena* a) {
+    if (!a) return;
+    arena_reset(a);
+    arena_trim(a);
+    free(a);
+}
+
+static void update_peak(Arena* a) {
+    size_t used = a->used_before + (a->current ? a->current->used : 0);
+    if (used > a->peak_used) a->peak_used = used;
+}
+
+// First spare block big enough
+static ArenaBlock* take_spare(Arena* a, size_t need) {
+    ArenaBlock** link = &a->spare;
+    while (*link) {
+        ArenaBlock* b = *link;
+        if (b->size >= need) {
+            *link = b->prev;
+            b->used = 0;
+            return b;
+        }
+        link = &b->prev;
+    }
+    return NULL;
+}
+
+void* arena_alloc_slow(Arena* a, size_t size, size_t align) {
+    if (align == 0 || (align & (align - 1))) {
+        fprintf(stderr, "arena: alignment %zu is not a power of two\n", align);
+        abort();
+    }
+    if (size > ((size_t)-1) / 2) out_of_memory(size);
+    update_peak(a);
+
+    size_t need = size + align - 1;     // Worst-case padding
+    ArenaBlock* b = take_spare(a, need);
+    if (!b) {
+        size_t block_size = a->next_size;
+        if (need > block_size) {
+            // Oversized request: a block of its own, growth unchanged
+            block_size = round_up(need, PAGE_SIZE);
+        } else if (a->next_size < ARENA_MAX_BLOCK) {
+            a->next_size *= 2;
+        }
+        b = block_new(a, block_size);
+    }
+
+    if (a->current) a->used_before += a->current->used;
+    b->prev = a->current;
+    a->current = b;
+    a->blocks++;
+
+    // Fits by construction
+    return arena_alloc_aligned(a, size, align);
+}
+
+void* arena_zalloc(Arena* a, size_t size) {
+    void* p = arena_alloc(a, size);
+    memset(p, 0, size);
+    return p;
+}
+
+char* arena_strdup(Arena* a, const char* s) {
+    size_t len = strlen(s) + 1;
+    char* copy = (char*)arena_alloc_aligned(a, len, 1);
+    memcpy(copy, s, len);
+    return copy;
+}
+
+// ===== Scopes =====
+
+ArenaMark arena_save(Arena* a) {
+    ArenaMark m;
+    m.arena = a;
+    m.block = a->current;
+    m.used = a->current ? a->current->used : 0;
+    return m;
+}
+
+void arena_restore(ArenaMark mark) {
+    Arena* a = mark.arena;
+    update_peak(a);
+
+    // Blocks added since the mark go to the spare list
+    while (a->current != mark.block) {
+        ArenaBlock* b = a->current;
+        if (!b) {
+            fprintf(stderr, "arena: restoring a mark that is no longer valid\n");
+            abort();
+        }
+        a->current = b->prev;
+        b->prev = a->spare;
+        a->spare = b;
+        a->blocks--;
+        if (a->current) a->used_before -= a->current->used;
+    }
+    if (a->current) a->current->used = mark.used;
+}
+
+void arena_reset(Arena* a) {
+    ArenaMark empty = { a, NULL, 0 };
+    arena_restore(empty);
+    a->used_before = 0;
+}
+
+void arena_trim(Arena* a) {
+    while (a->spare) {
+        ArenaBlock* b = a->spare;
+        a->spare = b->prev;
+        block_free(a, b);
+    }
+}
+
+void arena_get_stats(Arena* a, ArenaStats* out) {
+    update_peak(a);
+    out->used = a->used_before + (a->current ? a->current->used : 0);
+    out->reserved = a->reserved;
+    out->peak_used = a->peak_used;
+    out->blocks = a->blocks;
+    out->spare_blocks = 0;
+    for (ArenaBlock* b = a->spare; b; b = b->prev) out->spare_blocks++;
+    out->os_allocs = a->os_allocs;
+}
+
+// ===== Per-thread arena =====
+
+static _Thread_local Arena* thread_arena = NULL;
+
+Arena* arena_thread(void) {
+    if (!thread_arena) thread_arena = arena_create(0, 0);
+    return thread_arena;
+}
+
+void arena_thread_destroy(void) {
+    arena_destroy(thread_arena);
+    thread_arena = NULL;
+}
@@ -0,0 +1,127 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+/*
+ * Growable arena allocator
+ *
+ * The arena in 02_arena_allocator.c is one fixed buffer: it returns
+ * NULL when full and only aligns to 8. This one chains blocks:
+ *
+ *   current                                  oldest
+ *   ┌──────────────┐   ┌────────┐   ┌────┐
+ *   │██████░░░░░░░░│ → │████████│ → │████│ → NULL
+ *   └──────────────┘   └────────┘   └────┘
+ *       16 KB             8 KB       4 KB
+ *
+ * When a block is full the next one is twice as big (up to
+ * ARENA_MAX_BLOCK), so N bytes take O(log N) blocks. Blocks freed by
+ * arena_restore/arena_reset are kept and reused, so a loop that
+ * allocates and resets settles into zero system calls.
+ *
+ *   Arena* a = arena_create(0, 0);
+ *   Vec4* v = arena_alloc_aligned(a, 1024 * sizeof(Vec4), 32);  // AVX
+ *
+ *   ArenaMark m = arena_save(a);
+ *   ... temporary allocations ...
+ *   arena_restore(m);               // Everything since save is gone
+ *
+ * Per-thread scratch: arena_thread() returns an arena owned by the
+ * calling thread, so request handlers and parsers can allocate with
+ * no locks at all.
+ *
+ * Build: add arena.c to the compile line.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARENA_DEFAULT_BLOCK (64 * 1024)
+#define ARENA_MAX_BLOCK (64 * 1024 * 1024)
+#define ARENA_DEFAULT_ALIGN 16          // Like malloc: fits any basic type
+
+// Flags for arena_create
+#define ARENA_MMAP 1                    // Blocks come straight from the OS
+#define ARENA_HUGE_PAGES 2              // 2 MB pages (implies ARENA_MMAP)
+
+typedef struct ArenaBlock {
+    struct ArenaBlock* prev;            // Older block (or next spare)
+    char* data;
+    size_t size;                        // Usable bytes at data
+    size_t used;
+    size_t map_size;                    // Bytes to unmap, 0 if from malloc
+    void* map_base;
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock* current;                // Newest block, allocations go here
+    ArenaBlock* spare;                  // Released blocks, reused first
+    size_t used_before;                 // Bytes used in blocks below current
+    size_t next_size;                   // Size of the next new block
+    int flags;
+
+    // Stats
+    size_t reserved;                    // Bytes in all blocks, incl. spare
+    size_t peak_used;
+    int blocks;
+    int os_allocs;                      // Blocks obtained from malloc/mmap
+} Arena;
+
+// Position to roll back to; only valid while the arena hasn't been
+// restored past it
+typedef struct {
+    Arena* arena;
+    ArenaBlock* block;
+    size_t used;
+} ArenaMark;
+
+typedef struct {
+    size_t used;                        // Live bytes, incl. alignment padding
+    size_t reserved;
+    size_t peak_used;
+    int blocks;
+    int spare_blocks;
+    int os_allocs;
+} ArenaStats;
+
+// first_block 0 = ARENA_DEFAULT_BLOCK
+Arena* arena_create(size_t first_block, int flags);
+void arena_destroy(Arena* a);
+
+void* arena_alloc_slow(Arena* a, size_t size, size_t align);
+
+// Never NULL: aborts if the system is out of memory.
+// Inline: the common case is an add, a mask and a compare.
+static inline void* arena_alloc_aligned(Arena* a, size_t size, size_t align) {
+    ArenaBlock* b = a->current;         // align: power of two
+    if (b) {
+        uintptr_t start = ((uintptr_t)(b->data + b->used) + align - 1) & ~(uintptr_t)(align - 1);
+        uintptr_t end = start + size;
+        if (end <= (uintptr_t)(b->data + b->size) && end >= start) {
+            b->used = end - (uintptr_t)b->data;
+            return (void*)start;
+        }
+    }
+    return arena_alloc_slow(a, size, align);
+}
+
+static inline void* arena_alloc(Arena* a, size_t size) {
+    return arena_alloc_aligned(a, size, ARENA_DEFAULT_ALIGN);
+}
+
+void* arena_zalloc(Arena* a, size_t size);
+char* arena_strdup(Arena* a, const char* s);
+
+ArenaMark arena_save(Arena* a);
+void arena_restore(ArenaMark mark);
+void arena_reset(Arena* a);
+void arena_trim(Arena* a);              // Give spare blocks back to the system
+
+void arena_get_stats(Arena* a, ArenaStats* out);
+
+// The calling thread's own arena, created on first use. Pair with
+// save/restore per request. Call arena_thread_destroy() before the
+// thread exits.
+Arena* arena_thread(void);
+void arena_thread_destroy(void);
+
+#endif
@@ -25,6 +25,34 @@ echo Building 05_tracking_allocator...
 gcc 05_tracking_allocator.c -o bin\05_tracking_allocator.exe
 if %ERRORLEVEL% NEQ 0 goto error
 
+echo Building 06_growable_arena...
+gcc 06_growable_arena.c arena.c -o bin\06_growable_arena.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 07_concurrent_pool...
+gcc -O2 -DNDEBUG 07_concurrent_pool.c objpool.c -o bin\07_concurrent_pool.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 08_size_class_allocator...
+gcc -O2 08_size_class_allocator.c size_alloc.c -o bin\08_size_class_allocator.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 09_heap_profiler...
+gcc -O2 09_heap_profiler.c heapprof.c -o bin\09_heap_profiler.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 10_frame_allocator...
+gcc -O2 10_frame_allocator.c frame_alloc.c -o bin\10_frame_allocator.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 11_allocator_benchmark...
+gcc -O2 -DNDEBUG 11_allocator_benchmark.c arena.c objpool.c size_alloc.c -o bin\11_allocator_benchmark.exe -lpsapi
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 12_guard_pages...
+gcc -O2 12_guard_pages.c guardalloc.c -o bin\12_guard_pages.exe
+if %ERRORLEVEL% NEQ 0 goto error
+
 echo.
 echo All examples built successfully!
 echo Run them from bin\
@@ -21,6 +21,30 @@ gcc 04_stack_allocator.c -o bin/04_stack_allocator || exit 1
 echo "Building 05_tracking_allocator..."
 gcc 05_tracking_allocator.c -o bin/05_tracking_allocator || exit 1
 
+echo "Building 06_growable_arena..."
+gcc 06_growable_arena.c arena.c -o bin/06_growable_arena -pthread || exit 1
+
+echo "Building 07_concurrent_pool..."
+gcc -O2 -DNDEBUG 07_concurrent_pool.c objpool.c -o bin/07_concurrent_pool -pthread || exit 1
+
+echo "Building 08_size_class_allocator..."
+gcc -O2 08_size_class_allocator.c size_alloc.c -o bin/08_size_class_allocator -pthread || exit 1
+
+echo "Building libsizealloc.so (LD_PRELOAD malloc replacement)..."
+gcc -O2 -shared -fPIC -DSIZE_ALLOC_OVERRIDE size_alloc.c -o bin/libsizealloc.so -pthread || exit 1
+
+echo "Building 09_heap_profiler..."
+gcc -O2 09_heap_profiler.c heapprof.c -o bin/09_heap_profiler -pthread -rdynamic -lm || exit 1
+
+echo "Building 10_frame_allocator..."
+gcc -O2 10_frame_allocator.c frame_alloc.c -o bin/10_frame_allocator -pthread || exit 1
+
+echo "Building 11_allocator_benchmark..."
+gcc -O2 -DNDEBUG 11_allocator_benchmark.c arena.c objpool.c size_alloc.c -o bin/11_allocator_benchmark -pthread || exit 1
+
+echo "Building 12_guard_pages..."
+gcc -O2 12_guard_pages.c guardalloc.c -o bin/12_guard_pages -pthread -rdynamic || exit 1
+
 echo
 echo "All examples built successfully!"
 echo "Run them from bin/"
@@ -0,0 +1,223 @@
+/*
+ * Double-ended stack allocator and N-buffered frame allocator - implementation
+ *
+ * See frame_alloc.h for the API.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "frame_alloc.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    typedef CRITICAL_SECTION mutex_t;
+    typedef CONDITION_VARIABLE cond_t;
+    #define mutex_init(m) InitializeCriticalSection(m)
+    #define mutex_destroy(m) DeleteCriticalSection(m)
+    #define mutex_lock(m) EnterCriticalSection(m)
+    #define mutex_unlock(m) LeaveCriticalSection(m)
+    #define cond_init(c) InitializeConditionVariable(c)
+    #define cond_destroy(c) ((void)0)
+    #define cond_wait(c, m) SleepConditionVariableCS(c, m, INFINITE)
+    #define cond_broadcast(c) WakeAllConditionVariable(c)
+
+    static double now_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <pthread.h>
+    #include <time.h>
+    typedef pthread_mutex_t mutex_t;
+    typedef pthread_cond_t cond_t;
+    #define mutex_init(m) pthread_mutex_init(m, NULL)
+    #define mutex_destroy(m) pthread_mutex_destroy(m)
+    #define mutex_lock(m) pthread_mutex_lock(m)
+    #define mutex_unlock(m) pthread_mutex_unlock(m)
+    #define cond_init(c) pthread_cond_init(c, NULL)
+    #define cond_destroy(c) pthread_cond_destroy(c)
+    #define cond_wait(c, m) pthread_cond_wait(c, m)
+    #define cond_broadcast(c) pthread_cond_broadcast(c)
+
+    static double now_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+// ===== Double-ended stack =====
+
+DoubleStack* dstack_create(size_t size) {
+    // One malloc: the struct, then the buffer aligned to DSTACK_MAX_ALIGN
+    char* raw = malloc(sizeof(DoubleStack) + DSTACK_MAX_ALIGN + size);
+    if (!raw) return NULL;
+    DoubleStack* s = (DoubleStack*)raw;
+    uintptr_t data = (uintptr_t)(raw + sizeof(DoubleStack));
+    s->buffer = (char*)((data + DSTACK_MAX_ALIGN - 1) & ~(uintptr_t)(DSTACK_MAX_ALIGN - 1));
+    s->size = size;
+    s->lo = 0;
+    s->hi = size;
+    s->peak_used = 0;
+    return s;
+}
+
+void dstack_destroy(DoubleStack* s) {
+    free(s);
+}
+
+void dstack_restore(StackMark m) {
+    DoubleStack* s = m.stack;
+    if (m.end == DSTACK_LO) {
+        if (m.offset > s->lo) {
+            printf("ERROR: dstack_restore: low-end mark at %zu is above the top (%zu)\n",
+                   m.offset, s->lo);
+            printf("  (an enclosing mark was restored first)\n");
+            return;
+        }
+        s->lo = m.offset;
+    } else {
+        if (m.offset < s->hi) {
+            printf("ERROR: dstack_restore: high-end mark at %zu is below the top (%zu)\n",
+                   m.offset, s->hi);
+            printf("  (an enclosing mark was restored first)\n");
+            return;
+        }
+        s->hi = m.offset;
+    }
+}
+
+size_t dstack_free_bytes(DoubleStack* s) {
+    return s->hi - s->lo;
+}
+
+// ===== Frame allocator =====
+
+struct FrameOverflow {
+    FrameOverflow* next;
+};
+
+struct FrameSync {
+    mutex_t lock;
+    cond_t released;                    // A buffer became free
+    unsigned long* owner;               // Frame holding each buffer, 0 = free
+    unsigned long release_count;
+};
+
+FrameAllocator* frame_allocator_create(int buffers, size_t bytes_per_frame) {
+    FrameAllocator* fa = calloc(1, sizeof(FrameAllocator));
+    fa->buffers = calloc(buffers, sizeof(FrameBuffer));
+    fa->count = buffers;
+    for (int i = 0; i < buffers; i++) {
+        fa->buffers[i].data = malloc(bytes_per_frame);
+        fa->buffers[i].size = bytes_per_frame;
+    }
+    fa->sync = calloc(1, sizeof(FrameSync));
+    fa->sync->owner = calloc(buffers, sizeof(unsigned long));
+    mutex_init(&fa->sync->lock);
+    cond_init(&fa->sync->released);
+    return fa;
+}
+
+static void free_overflow(FrameBuffer* b) {
+    while (b->overflow) {
+        FrameOverflow* next = b->overflow->next;
+        free(b->overflow);
+        b->overflow = next;
+    }
+    b->overflow_bytes = 0;
+}
+
+void frame_allocator_destroy(FrameAllocator* fa) {
+    for (int i = 0; i < fa->count; i++) {
+        free_overflow(&fa->buffers[i]);
+        free(fa->buffers[i].data);
+    }
+    mutex_destroy(&fa->sync->lock);
+    cond_destroy(&fa->sync->released);
+    free(fa->sync->owner);
+    free(fa->sync);
+    free(fa->buffers);
+    free(fa);
+}
+
+unsigned long frame_begin(FrameAllocator* fa) {
+    if (fa->current) frame_end(fa);
+    unsigned long id = ++fa->frame;
+    int slot = (int)((id - 1) % fa->count);
+    FrameSync* sync = fa->sync;
+
+    mutex_lock(&sync->lock);
+    if (sync->owner[slot] != 0) {       // Frame id - count is still being read
+        double start = now_ms();
+        while (sync->owner[slot] != 0) cond_wait(&sync->released, &sync->lock);
+        fa->waits++;
+        fa->wait_ms += now_ms() - start;
+    }
+    sync->owner[slot] = id;
+    mutex_unlock(&sync->lock);
+
+    // The consumer is done with this buffer: recycle it
+    FrameBuffer* b = &fa->buffers[slot];
+    free_overflow(b);
+    b->used = 0;
+    fa->current = b;
+    return id;
+}
+
+unsigned long frame_end(FrameAllocator* fa) {
+    FrameBuffer* b = fa->current;
+    if (b) {
+        size_t used = b->used + b->overflow_bytes;
+        if (used > fa->peak_used) fa->peak_used = used;
+        fa->current = NULL;
+    }
+    return fa->frame;
+}
+
+void frame_release(FrameAllocator* fa, unsigned long id) {
+    FrameSync* sync = fa->sync;
+    int slot = (int)((id - 1) % fa->count);
+    mutex_lock(&sync->lock);
+    if (sync->owner[slot] != id) {
+        mutex_unlock(&sync->lock);
+        printf("ERROR: frame_release(%lu): frame isn't in flight (double release?)\n", id);
+        return;
+    }
+    sync->owner[slot] = 0;
+    sync->release_count++;
+    cond_broadcast(&sync->released);
+    mutex_unlock(&sync->lock);
+}
+
+// The frame's buffer is full: the rest of this frame comes from
+// malloc, and the frame's peak tells you how big to make the buffers
+void* frame_alloc_slow(FrameAllocator* fa, size_t size, size_t align) {
+    FrameBuffer* b = fa->current;
+    size_t header = (sizeof(FrameOverflow) + align - 1) & ~(align - 1);
+    FrameOverflow* o = malloc(header + size + align);
+    if (!o) {
+        fprintf(stderr, "frame_alloc: out of memory\n");
+        abort();
+    }
+    o->next = b->overflow;
+    b->overflow = o;
+    b->overflow_bytes += size;
+    fa->overflow_total += size;
+    uintptr_t p = ((uintptr_t)o + header + align - 1) & ~(uintptr_t)(align - 1);
+    return (void*)p;
+}
+
+void frame_get_stats(FrameAllocator* fa, FrameStats* out) {
+    mutex_lock(&fa->sync->lock);
+    out->released = fa->sync->release_count;
+    mutex_unlock(&fa->sync->lock);
+    out->frames = fa->frame;
+    out->peak_used = fa->peak_used;
+    out->overflow_total = fa->overflow_total;
+    out->waits = fa->waits;
+    out->wait_ms = fa->wait_ms;
+}
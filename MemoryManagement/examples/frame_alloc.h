@@ -0,0 +1,183 @@
+#ifndef FRAME_ALLOC_H
+#define FRAME_ALLOC_H
+
+/*
+ * Double-ended stack allocator and N-buffered frame allocator
+ *
+ * The StackAllocator in 04_stack_allocator.c puts a 16-byte header in
+ * front of every allocation so stack_free can find the previous top,
+ * and grows from one end only. DoubleStack has no headers - you free
+ * by rolling back to a mark - and grows from both ends:
+ *
+ *   lo ─────────►                         ◄───────── hi
+ *   ┌────────────┬────────────────────────┬──────────┐
+ *   │ hot: temps │          free          │ cold:    │
+ *   │ per frame  │                        │ level    │
+ *   └────────────┴────────────────────────┴──────────┘
+ *
+ * Long-lived data (a loaded level) goes at one end, scratch data at
+ * the other; neither rolls back over the other, and one buffer serves
+ * both without deciding the split up front.
+ *
+ *   StackMark m = dstack_mark(s, DSTACK_LO);
+ *   ... dstack_alloc(s, DSTACK_LO, n) ...
+ *   dstack_restore(m);                  // Everything since the mark is gone
+ *
+ * FrameAllocator gives each frame its own buffer, N of them in a ring.
+ * The game thread builds frame N+1 while the render thread still reads
+ * frame N; a buffer is reused only once the consumer releases it:
+ *
+ *   game:    begin(1) alloc... end(1)  begin(2) alloc... end(2)  begin(3)...
+ *   render:                   [draw frame 1 .......] release(1)
+ *
+ *   FrameAllocator* fa = frame_allocator_create(3, 1 << 20);
+ *   frame_begin(fa);                    // Waits if all 3 buffers are in use
+ *   DrawCmd* cmds = frame_alloc(fa, n * sizeof(DrawCmd));
+ *   unsigned long id = frame_end(fa);   // Hand cmds and id to the renderer
+ *   ...                                 // renderer, when done:
+ *   frame_release(fa, id);
+ *
+ * Build: add frame_alloc.c to the compile line (-pthread on Linux).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_DEFAULT_ALIGN 16
+
+// ===== Double-ended stack =====
+
+#define DSTACK_LO 0
+#define DSTACK_HI 1
+#define DSTACK_MAX_ALIGN 64
+
+typedef struct {
+    char* buffer;
+    size_t size;
+    size_t lo;                          // Bytes used from the bottom
+    size_t hi;                          // Top end: buffer + hi .. buffer + size is used
+    size_t peak_used;
+} DoubleStack;
+
+// Position on one end to roll back to
+typedef struct {
+    DoubleStack* stack;
+    size_t offset;
+    int end;
+} StackMark;
+
+DoubleStack* dstack_create(size_t size);
+void dstack_destroy(DoubleStack* s);
+
+// NULL when the two ends would meet.
+// align: power of two, at most DSTACK_MAX_ALIGN (the buffer's alignment).
+static inline void* dstack_alloc_aligned(DoubleStack* s, int end, size_t size, size_t align) {
+    size_t start;
+    if (end == DSTACK_LO) {
+        start = (s->lo + align - 1) & ~(align - 1);
+        if (start > s->hi || size > s->hi - start) return NULL;
+        s->lo = start + size;
+    } else {
+        if (size > s->hi) return NULL;
+        start = (s->hi - size) & ~(align - 1);
+        if (start < s->lo) return NULL;
+        s->hi = start;
+    }
+    size_t used = s->lo + (s->size - s->hi);
+    if (used > s->peak_used) s->peak_used = used;
+    return s->buffer + start;
+}
+
+static inline void* dstack_alloc(DoubleStack* s, int end, size_t size) {
+    return dstack_alloc_aligned(s, end, size, FRAME_DEFAULT_ALIGN);
+}
+
+static inline StackMark dstack_mark(DoubleStack* s, int end) {
+    StackMark m = { s, end == DSTACK_LO ? s->lo : s->hi, end };
+    return m;
+}
+
+// Frees everything allocated on the mark's end since the mark.
+// Restoring an outer mark before an inner one is reported and ignored.
+void dstack_restore(StackMark m);
+
+// Runs the block, then restores: DSTACK_SCOPE(s, DSTACK_LO) { ... }
+// (leaving the block with break or return skips the restore)
+#define DSTACK_SCOPE(s, end) \
+    for (StackMark dstack_scope_ = dstack_mark((s), (end)); \
+         dstack_scope_.stack; dstack_restore(dstack_scope_), dstack_scope_.stack = NULL)
+
+size_t dstack_free_bytes(DoubleStack* s);
+
+// ===== N-buffered frame allocator =====
+
+typedef struct FrameOverflow FrameOverflow;
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t used;
+    FrameOverflow* overflow;            // malloc'd blocks when a frame outgrows its buffer
+    size_t overflow_bytes;
+} FrameBuffer;
+
+typedef struct FrameSync FrameSync;
+
+typedef struct {
+    FrameBuffer* current;               // NULL between frame_end and frame_begin
+    FrameBuffer* buffers;
+    int count;
+    unsigned long frame;                // Id of the frame being built (first is 1)
+    FrameSync* sync;
+
+    // Stats
+    size_t peak_used;
+    size_t overflow_total;              // Bytes that didn't fit, all frames
+    long waits;                         // frame_begin calls that had to wait
+    double wait_ms;
+} FrameAllocator;
+
+typedef struct {
+    unsigned long frames;
+    unsigned long released;
+    size_t peak_used;                   // Most bytes any one frame used
+    size_t overflow_total;
+    long waits;
+    double wait_ms;
+} FrameStats;
+
+FrameAllocator* frame_allocator_create(int buffers, size_t bytes_per_frame);
+void frame_allocator_destroy(FrameAllocator* fa);   // Consumers must be done
+
+// Start the next frame. Blocks until its buffer's previous frame (N
+// frames back) has been released.
+unsigned long frame_begin(FrameAllocator* fa);
+
+// Finish the frame; its memory stays valid until frame_release(id).
+unsigned long frame_end(FrameAllocator* fa);
+
+// Any thread, in frame order: the buffer can be reused
+void frame_release(FrameAllocator* fa, unsigned long id);
+
+void* frame_alloc_slow(FrameAllocator* fa, size_t size, size_t align);
+
+// Only between frame_begin and frame_end, on the building thread.
+// Never NULL: a frame that outgrows its buffer spills to malloc.
+static inline void* frame_alloc_aligned(FrameAllocator* fa, size_t size, size_t align) {
+    FrameBuffer* b = fa->current;
+    uintptr_t start = ((uintptr_t)(b->data + b->used) + align - 1) & ~(uintptr_t)(align - 1);
+    uintptr_t end = start + size;
+    if (end <= (uintptr_t)(b->data + b->size) && end >= start) {
+        b->used = end - (uintptr_t)b->data;
+        return (void*)start;
+    }
+    return frame_alloc_slow(fa, size, align);
+}
+
+static inline void* frame_alloc(FrameAllocator* fa, size_t size) {
+    return frame_alloc_aligned(fa, size, FRAME_DEFAULT_ALIGN);
+}
+
+void frame_get_stats(FrameAllocator* fa, FrameStats* out);
+
+#endif
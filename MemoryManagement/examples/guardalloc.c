@@ -0,0 +1,495 @@
+/*
+ * Sampled guard-page allocator - implementation
+ *
+ * See guardalloc.h for the API.
+ */
+
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "guardalloc.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    static void cpu_yield(void) { SwitchToThread(); }
+    #define CALLER() NULL
+    static int capture_stack(void** frames, void* caller) {
+        (void)caller;
+        return CaptureStackBackTrace(3, GUARDALLOC_MAX_DEPTH, frames, NULL);
+    }
+    static void write_err(const char* s, size_t n) {
+        DWORD written;
+        WriteFile(GetStdHandle(STD_ERROR_HANDLE), s, (DWORD)n, &written, NULL);
+    }
+    static void print_stack(void** frames, int depth) {
+        char line[64];
+        for (int i = 0; i < depth; i++) {
+            int n = snprintf(line, sizeof(line), "    %p\n", frames[i]);
+            write_err(line, (size_t)n);
+        }
+    }
+#else
+    #include <execinfo.h>
+    #include <sched.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    static void cpu_yield(void) { sched_yield(); }
+    #define CALLER() __builtin_return_address(0)
+    // Starts at the caller of guard_*, however much was inlined
+    static int capture_stack(void** frames, void* caller) {
+        void* all[GUARDALLOC_MAX_DEPTH + 8];
+        int n = backtrace(all, GUARDALLOC_MAX_DEPTH + 8);
+        int skip = 0;
+        while (skip < n && all[skip] != caller) skip++;
+        if (skip == n) skip = 0;
+        n -= skip;
+        if (n <= 0) return 0;
+        if (n > GUARDALLOC_MAX_DEPTH) n = GUARDALLOC_MAX_DEPTH;
+        memcpy(frames, all + skip, n * sizeof(void*));
+        return n;
+    }
+    // Reports may come from a signal handler: write(2), no stdio
+    static void write_err(const char* s, size_t n) {
+        while (n > 0) {
+            ssize_t w = write(STDERR_FILENO, s, n);
+            if (w <= 0) return;
+            s += w;
+            n -= (size_t)w;
+        }
+    }
+    static void print_stack(void** frames, int depth) {
+        backtrace_symbols_fd(frames, depth, STDERR_FILENO);   // Doesn't malloc
+    }
+#endif
+
+#define FILL_BYTE 0xAB                  // Unused part of a slot's page, and fresh memory
+#define POISON_BYTE 0xDD                // Freed memory
+#define FLUSH_EVERY 1024                // Thread-local alloc counts folded in this often
+
+enum { SLOT_UNUSED, SLOT_LIVE, SLOT_FREED };
+
+typedef struct {
+    int state;
+    char* ptr;
+    size_t size;
+    int alloc_thread;
+    int free_thread;
+    int alloc_depth;
+    int free_depth;
+    void* alloc_stack[GUARDALLOC_MAX_DEPTH];
+    void* free_stack[GUARDALLOC_MAX_DEPTH];
+} Slot;
+
+// Pool: guard page, slot 0, guard page, slot 1, ..., guard page
+static char* g_pool;
+static size_t g_pool_size;
+static size_t g_page;
+static Slot* g_slots;
+static char* g_fill;                    // A page of FILL_BYTE to compare against
+static size_t g_slot_count;
+static unsigned g_sample = GUARDALLOC_DEFAULT_SAMPLE;
+
+static atomic_flag g_lock = ATOMIC_FLAG_INIT;
+static size_t g_next_unused;            // Slots below this have been used
+static size_t* g_quarantine;            // Freed slots, oldest first (a ring)
+static size_t g_quarantine_head;
+static size_t g_quarantined;
+
+static atomic_size_t g_allocs;
+static atomic_int g_thread_ids;
+static size_t g_guarded;
+static size_t g_pool_full;
+static size_t g_live;
+static size_t g_errors;
+
+typedef struct {
+    long countdown;                     // Allocations until the next guarded one
+    uint64_t rng;
+    size_t allocs;
+    int id;
+} ThreadState;
+
+static _Thread_local ThreadState tls;
+
+static void lock(void) {
+    int spins = 0;
+    while (atomic_flag_test_and_set_explicit(&g_lock, memory_order_acquire)) {
+        if (++spins == 64) {
+            cpu_yield();
+            spins = 0;
+        }
+    }
+}
+
+static void unlock(void) {
+    atomic_flag_clear_explicit(&g_lock, memory_order_release);
+}
+
+static inline int in_pool(uintptr_t p) {
+    return p - (uintptr_t)g_pool < g_pool_size;
+}
+
+static char* slot_page(size_t i) {
+    return g_pool + (2 * i + 1) * g_page;
+}
+
+static int thread_id(ThreadState* t) {
+    if (t->id == 0) t->id = atomic_fetch_add(&g_thread_ids, 1) + 1;
+    return t->id;
+}
+
+static void report(const char* fmt, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (n > (int)sizeof(line) - 1) n = sizeof(line) - 1;
+    if (n > 0) write_err(line, (size_t)n);
+}
+
+static void report_stacks(Slot* s) {
+    report("  allocated by thread %d:\n", s->alloc_thread);
+    print_stack(s->alloc_stack, s->alloc_depth);
+    if (s->state == SLOT_FREED) {
+        report("  freed by thread %d:\n", s->free_thread);
+        print_stack(s->free_stack, s->free_depth);
+    }
+}
+
+// ===== OS memory =====
+
+#ifdef _WIN32
+static int os_init(size_t slots) {
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    g_page = si.dwPageSize;
+    g_pool_size = (2 * slots + 1) * g_page;
+    g_pool = VirtualAlloc(NULL, g_pool_size, MEM_RESERVE | MEM_COMMIT, PAGE_NOACCESS);
+    return g_pool != NULL;
+}
+
+static void os_protect(char* page, int accessible) {
+    DWORD old;
+    VirtualProtect(page, g_page, accessible ? PAGE_READWRITE : PAGE_NOACCESS, &old);
+}
+#else
+static int os_init(size_t slots) {
+    g_page = (size_t)sysconf(_SC_PAGESIZE);
+    g_pool_size = (2 * slots + 1) * g_page;
+    void* p = mmap(NULL, g_pool_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) return 0;
+    g_pool = p;
+    return 1;
+}
+
+static void os_protect(char* page, int accessible) {
+    mprotect(page, g_page, accessible ? PROT_READ | PROT_WRITE : PROT_NONE);
+}
+#endif
+
+// ===== Fault reports =====
+
+// What did an access at addr hit? Called from the fault handler.
+static void describe_fault(uintptr_t addr) {
+    size_t page = (addr - (uintptr_t)g_pool) / g_page;
+    if (page % 2 == 1) {
+        Slot* s = &g_slots[page / 2];
+        if (s->state == SLOT_FREED) {
+            report("guardalloc: use-after-free at %p: %ld bytes into %zu-byte allocation %p\n",
+                   (void*)addr, (long)(addr - (uintptr_t)s->ptr), s->size, (void*)s->ptr);
+            report_stacks(s);
+        } else {
+            report("guardalloc: wild access at %p: slot %zu holds no allocation\n",
+                   (void*)addr, page / 2);
+        }
+        return;
+    }
+
+    // A guard page: blame the nearer neighbour
+    Slot* left = page > 0 ? &g_slots[page / 2 - 1] : NULL;
+    Slot* right = page / 2 < g_slot_count ? &g_slots[page / 2] : NULL;
+    if (left && left->state == SLOT_UNUSED) left = NULL;
+    if (right && right->state == SLOT_UNUSED) right = NULL;
+    uintptr_t left_gap = left ? addr - ((uintptr_t)left->ptr + left->size) : SIZE_MAX;
+    uintptr_t right_gap = right ? (uintptr_t)right->ptr - addr : SIZE_MAX;
+    if (!left && !right) {
+        report("guardalloc: wild access at %p: guard page next to unused slots\n", (void*)addr);
+    } else if (left_gap <= right_gap) {
+        report("guardalloc: heap-buffer-overflow at %p: %zu bytes right of %zu-byte allocation %p%s\n",
+               (void*)addr, (size_t)left_gap, left->size, (void*)left->ptr,
+               left->state == SLOT_FREED ? " (freed)" : "");
+        report_stacks(left);
+    } else {
+        report("guardalloc: heap-buffer-underflow at %p: %zu bytes left of %zu-byte allocation %p%s\n",
+               (void*)addr, (size_t)right_gap, right->size, (void*)right->ptr,
+               right->state == SLOT_FREED ? " (freed)" : "");
+        report_stacks(right);
+    }
+}
+
+#ifdef _WIN32
+static LONG WINAPI on_fault(EXCEPTION_POINTERS* e) {
+    static atomic_int reported;
+    EXCEPTION_RECORD* r = e->ExceptionRecord;
+    if (r->ExceptionCode == EXCEPTION_ACCESS_VIOLATION && r->NumberParameters >= 2 &&
+        in_pool((uintptr_t)r->ExceptionInformation[1]) && !atomic_exchange(&reported, 1)) {
+        describe_fault((uintptr_t)r->ExceptionInformation[1]);
+    }
+    return EXCEPTION_CONTINUE_SEARCH;   // Crash (or reach the next handler) as usual
+}
+
+static void install_handler(void) {
+    AddVectoredExceptionHandler(1, on_fault);
+}
+#else
+static struct sigaction g_old_segv;
+static struct sigaction g_old_bus;
+
+static void on_fault(int sig, siginfo_t* info, void* context) {
+    (void)context;
+    if (in_pool((uintptr_t)info->si_addr)) describe_fault((uintptr_t)info->si_addr);
+    // Put the old handler back and return: the access runs again and
+    // now crashes (core dump, debugger) or reaches that handler
+    sigaction(sig, sig == SIGSEGV ? &g_old_segv : &g_old_bus, NULL);
+}
+
+static void install_handler(void) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = on_fault;
+    sa.sa_flags = SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGSEGV, &sa, &g_old_segv);
+    sigaction(SIGBUS, &sa, &g_old_bus);
+}
+#endif
+
+// ===== Guarded slots =====
+
+static void* guarded_alloc(size_t size, void* caller) {
+    lock();
+    size_t i;
+    if (g_next_unused < g_slot_count) {
+        i = g_next_unused++;
+    } else if (g_quarantined > 0) {
+        i = g_quarantine[g_quarantine_head];
+        g_quarantine_head = (g_quarantine_head + 1) % g_slot_count;
+        g_quarantined--;
+    } else {
+        g_pool_full++;
+        unlock();
+        return NULL;
+    }
+    Slot* s = &g_slots[i];
+    char* page = slot_page(i);
+    os_protect(page, 1);
+    memset(page, FILL_BYTE, g_page);
+
+    // Against the right guard with malloc's alignment for this size
+    // (nothing of 10 bytes needs more than 8), or against the left.
+    // malloc(0) is placed as 1 byte: page + g_page would be the guard
+    size_t span = size ? size : 1;
+    if (g_guarded % 2 == 0) {
+        size_t align = 16;
+        while (align > 1 && align > span) align /= 2;
+        s->ptr = (char*)(((uintptr_t)page + g_page - span) & ~(uintptr_t)(align - 1));
+    } else {
+        s->ptr = page;
+    }
+    s->size = size;
+    s->state = SLOT_LIVE;
+    s->alloc_thread = thread_id(&tls);
+    s->alloc_depth = capture_stack(s->alloc_stack, caller);
+    g_guarded++;
+    g_live++;
+    unlock();
+    return s->ptr;
+}
+
+// Nearest byte to the allocation in [from, to) that lost its fill
+static char* first_overwrite(char* from, char* to, int from_end) {
+    if (memcmp(from, g_fill, (size_t)(to - from)) == 0) return NULL;
+    if (from_end) {
+        for (char* p = to - 1; p >= from; p--) if ((unsigned char)*p != FILL_BYTE) return p;
+    } else {
+        for (char* p = from; p < to; p++) if ((unsigned char)*p != FILL_BYTE) return p;
+    }
+    return NULL;
+}
+
+// A byte of the page outside the allocation that lost its fill, or NULL
+static char* find_overwrite(Slot* s) {
+    char* page = (char*)((uintptr_t)s->ptr & ~(uintptr_t)(g_page - 1));
+    char* bad = first_overwrite(page, s->ptr, 1);
+    return bad ? bad : first_overwrite(s->ptr + s->size, page + g_page, 0);
+}
+
+static void guarded_free(char* ptr, void* caller) {
+    size_t page = (size_t)(ptr - g_pool) / g_page;
+    lock();
+    Slot* s = page % 2 == 1 ? &g_slots[page / 2] : NULL;
+    if (!s || s->state == SLOT_UNUSED || (s->state == SLOT_LIVE && ptr != s->ptr)) {
+        g_errors++;
+        report("guardalloc: invalid free of %p", (void*)ptr);
+        if (s && s->state == SLOT_LIVE) {
+            report(": %ld bytes into %zu-byte allocation %p\n",
+                   (long)(ptr - s->ptr), s->size, (void*)s->ptr);
+            report_stacks(s);
+        } else {
+            report(": not an allocation\n");
+        }
+        unlock();
+        return;
+    }
+    if (s->state == SLOT_FREED) {
+        g_errors++;
+        report("guardalloc: double free of %zu-byte allocation %p\n", s->size, (void*)s->ptr);
+        report_stacks(s);
+        unlock();
+        return;
+    }
+
+    // Overruns too small to reach a guard page still hit the fill
+    char* bad = find_overwrite(s);
+    if (bad) {
+        g_errors++;
+        if (bad < s->ptr) {
+            report("guardalloc: heap-buffer-underflow detected at free: %ld bytes left of "
+                   "%zu-byte allocation %p overwritten\n", (long)(s->ptr - bad), s->size, (void*)s->ptr);
+        } else {
+            report("guardalloc: heap-buffer-overflow detected at free: %ld bytes right of "
+                   "%zu-byte allocation %p overwritten\n", (long)(bad - (s->ptr + s->size)),
+                   s->size, (void*)s->ptr);
+        }
+        report_stacks(s);
+    }
+
+    s->state = SLOT_FREED;
+    s->free_thread = thread_id(&tls);
+    s->free_depth = capture_stack(s->free_stack, caller);
+    memset(s->ptr, POISON_BYTE, s->size);
+    os_protect(slot_page(page / 2), 0);
+    g_quarantine[(g_quarantine_head + g_quarantined) % g_slot_count] = page / 2;
+    g_quarantined++;
+    g_live--;
+    unlock();
+}
+
+// ===== Entry points =====
+
+// Uniform in [1, 2N - 1]: one in N on average, but not periodic, so a
+// loop can't keep stepping over the same allocation
+static long next_gap(ThreadState* t) {
+    if (g_sample == 1) return 1;
+    if (t->rng == 0) t->rng = ((uint64_t)(uintptr_t)t * 0x9E3779B97F4A7C15ull) | 1;
+    t->rng ^= t->rng << 13;
+    t->rng ^= t->rng >> 7;
+    t->rng ^= t->rng << 17;
+    return 1 + (long)(t->rng % (2 * (uint64_t)g_sample - 1));
+}
+
+void guardalloc_init(size_t slots, unsigned sample_every) {
+    g_sample = sample_every ? sample_every : 1;
+    tls.countdown = next_gap(&tls);
+    if (g_slots) return;                // Already set up: only the rate changes
+    if (!os_init(slots)) {
+        fprintf(stderr, "guardalloc: couldn't reserve %zu slots; guarding is off\n", slots);
+        g_pool = NULL;
+        g_pool_size = 0;
+        return;
+    }
+    g_slot_count = slots;
+    g_slots = calloc(slots, sizeof(Slot));
+    g_fill = malloc(g_page);
+    memset(g_fill, FILL_BYTE, g_page);
+    g_quarantine = calloc(slots, sizeof(size_t));
+    install_handler();
+#ifndef _WIN32
+    void* warm[1];
+    backtrace(warm, 1);                 // First call loads libgcc (and mallocs)
+#endif
+}
+
+// NULL unless this allocation is the sampled one and a slot is free
+static inline void* try_guarded(size_t size, void* caller) {
+    ThreadState* t = &tls;
+    if (++t->allocs == FLUSH_EVERY) {
+        atomic_fetch_add_explicit(&g_allocs, t->allocs, memory_order_relaxed);
+        t->allocs = 0;
+    }
+    if (t->countdown == 0) t->countdown = next_gap(t);  // First allocation on this thread
+    if (--t->countdown > 0) return NULL;
+    t->countdown = next_gap(t);
+    if (size > g_page || !g_pool) return NULL;
+    return guarded_alloc(size, caller);
+}
+
+void* guard_malloc(size_t size) {
+    void* p = try_guarded(size, CALLER());
+    return p ? p : malloc(size);
+}
+
+void* guard_calloc(size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+    void* p = try_guarded(count * size, CALLER());
+    if (!p) return calloc(count, size);
+    memset(p, 0, count * size);
+    return p;
+}
+
+// Unguarded blocks stay with realloc (their old size is unknown);
+// guarded ones move, so the stale pointer faults
+void* guard_realloc(void* ptr, size_t size) {
+    if (!ptr) {
+        void* p = try_guarded(size, CALLER());
+        return p ? p : malloc(size);
+    }
+    if (!in_pool((uintptr_t)ptr)) return realloc(ptr, size);
+
+    size_t page = (size_t)((char*)ptr - g_pool) / g_page;
+    lock();
+    Slot* s = page % 2 == 1 ? &g_slots[page / 2] : NULL;
+    size_t old_size = s && s->state == SLOT_LIVE && s->ptr == ptr ? s->size : SIZE_MAX;
+    unlock();
+    if (old_size == SIZE_MAX || size == 0) {
+        guarded_free(ptr, CALLER());    // Reports the bad pointer, if it is one
+        return NULL;
+    }
+    void* p = try_guarded(size, CALLER());
+    if (!p) p = malloc(size);
+    if (!p) return NULL;
+    memcpy(p, ptr, old_size < size ? old_size : size);
+    guarded_free(ptr, CALLER());
+    return p;
+}
+
+void guard_free(void* ptr) {
+    if (!ptr) return;
+    if (in_pool((uintptr_t)ptr)) guarded_free(ptr, CALLER());
+    else free(ptr);
+}
+
+int guard_is_guarded(const void* ptr) {
+    return g_pool && in_pool((uintptr_t)ptr);
+}
+
+void guardalloc_get_stats(GuardAllocStats* out) {
+    ThreadState* t = &tls;
+    atomic_fetch_add_explicit(&g_allocs, t->allocs, memory_order_relaxed);
+    t->allocs = 0;
+    lock();
+    out->sample_every = g_sample;
+    out->slots = g_slot_count;
+    out->allocs = atomic_load_explicit(&g_allocs, memory_order_relaxed);
+    out->guarded = g_guarded;
+    out->pool_full = g_pool_full;
+    out->live = g_live;
+    out->errors = g_errors;
+    unlock();
+}
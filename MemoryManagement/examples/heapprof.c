@@ -0,0 +1,518 @@
+/*
+ * Sampling heap profiler - implementation
+ *
+ * See heapprof.h for the API.
+ */
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "heapprof.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    static void cpu_yield(void) { SwitchToThread(); }
+    #define CALLER() NULL
+    static int capture_stack(void** frames, void* caller) {
+        (void)caller;
+        return CaptureStackBackTrace(3, HEAPPROF_MAX_DEPTH, frames, NULL);
+    }
+#else
+    #include <execinfo.h>
+    #include <sched.h>
+    static void cpu_yield(void) { sched_yield(); }
+    #define CALLER() __builtin_return_address(0)
+    // Starts at the caller of heapprof_*, however much of the
+    // profiler itself was inlined
+    static int capture_stack(void** frames, void* caller) {
+        void* all[HEAPPROF_MAX_DEPTH + 8];
+        int n = backtrace(all, HEAPPROF_MAX_DEPTH + 8);
+        int skip = 0;
+        while (skip < n && all[skip] != caller) skip++;
+        if (skip == n) skip = 0;
+        n -= skip;
+        if (n <= 0) return 0;
+        if (n > HEAPPROF_MAX_DEPTH) n = HEAPPROF_MAX_DEPTH;
+        memcpy(frames, all + skip, n * sizeof(void*));
+        return n;
+    }
+#endif
+
+#define EMPTY 0
+#define TOMBSTONE 1
+#define FLUSH_EVERY 4096                // Thread-local counts folded in this often
+#define MIN_TABLE 1024
+
+// ===== Tables =====
+
+typedef struct {
+    _Atomic(uintptr_t) key;             // The pointer, EMPTY or TOMBSTONE
+    size_t size;
+    int stack;
+} Entry;
+
+typedef struct Table {
+    Entry* entries;
+    size_t mask;
+    size_t used;                        // Live + tombstones
+    size_t live;
+    struct Table* retired;              // Older tables: lock-free readers may still be in them
+} Table;
+
+typedef struct {
+    uint64_t hash;
+    int depth;
+    void* frames[HEAPPROF_MAX_DEPTH];
+    size_t alloc_count;                 // Samples taken here, ever
+    size_t alloc_bytes;
+} Stack;
+
+static _Atomic(Table*) g_table;
+static atomic_flag g_lock = ATOMIC_FLAG_INIT;
+
+static Stack* g_stacks;
+static int g_stack_count;
+static int g_stack_capacity;
+static int* g_stack_index;              // Open addressing, -1 = empty
+static size_t g_stack_index_mask;
+
+static size_t g_rate = HEAPPROF_DEFAULT_RATE;
+static atomic_size_t g_allocs;
+static atomic_size_t g_frees;
+static atomic_size_t g_samples;
+static atomic_size_t g_unknown_frees;
+
+typedef struct {
+    long countdown;                     // Bytes until the next sample
+    uint64_t rng;
+    size_t allocs;
+    size_t frees;
+    int started;
+} ThreadState;
+
+static _Thread_local ThreadState tls;
+
+static void lock(void) {
+    int spins = 0;
+    while (atomic_flag_test_and_set_explicit(&g_lock, memory_order_acquire)) {
+        if (++spins == 64) {
+            cpu_yield();
+            spins = 0;
+        }
+    }
+}
+
+static void unlock(void) {
+    atomic_flag_clear_explicit(&g_lock, memory_order_release);
+}
+
+static size_t hash_pointer(uintptr_t p) {
+    uint64_t h = (uint64_t)p * 0x9E3779B97F4A7C15ull;
+    return (size_t)(h ^ (h >> 29));
+}
+
+static Table* table_new(size_t capacity) {
+    Table* t = calloc(1, sizeof(Table));
+    t->entries = calloc(capacity, sizeof(Entry));
+    t->mask = capacity - 1;
+    return t;
+}
+
+static void table_put(Table* t, uintptr_t key, size_t size, int stack) {
+    size_t i = hash_pointer(key) & t->mask;
+    while (atomic_load_explicit(&t->entries[i].key, memory_order_relaxed) > TOMBSTONE) {
+        i = (i + 1) & t->mask;
+    }
+    if (atomic_load_explicit(&t->entries[i].key, memory_order_relaxed) == EMPTY) t->used++;
+    t->entries[i].size = size;
+    t->entries[i].stack = stack;
+    atomic_store_explicit(&t->entries[i].key, key, memory_order_release);
+    t->live++;
+}
+
+// Under the lock. Grows (or just drops tombstones) at half full.
+static Table* table_for_insert(void) {
+    Table* t = atomic_load_explicit(&g_table, memory_order_relaxed);
+    if (t && (t->used + 1) * 2 <= t->mask + 1) return t;
+
+    size_t capacity = MIN_TABLE;
+    while (t && capacity < (t->live + 1) * 4) capacity *= 2;
+    Table* bigger = table_new(capacity);
+    if (t) {
+        for (size_t i = 0; i <= t->mask; i++) {
+            uintptr_t key = atomic_load_explicit(&t->entries[i].key, memory_order_relaxed);
+            if (key > TOMBSTONE) table_put(bigger, key, t->entries[i].size, t->entries[i].stack);
+        }
+        bigger->retired = t;
+    }
+    atomic_store_explicit(&g_table, bigger, memory_order_release);
+    return bigger;
+}
+
+// Without the lock: "no" is certain, "yes" must be checked under it.
+// The pointer was inserted before malloc returned it, so a free of a
+// sampled pointer always finds it, in whichever table it loads.
+static int maybe_recorded(void* ptr) {
+    Table* t = atomic_load_explicit(&g_table, memory_order_acquire);
+    if (!t) return 0;
+    uintptr_t key = (uintptr_t)ptr;
+    for (size_t i = hash_pointer(key) & t->mask;; i = (i + 1) & t->mask) {
+        uintptr_t k = atomic_load_explicit(&t->entries[i].key, memory_order_relaxed);
+        if (k == key) return 1;
+        if (k == EMPTY) return 0;
+    }
+}
+
+// Under the lock: remove a record; returns 0 if ptr wasn't recorded.
+// size and stack, if not NULL, get what it held
+static int forget_locked(void* ptr, size_t* size, int* stack) {
+    uintptr_t key = (uintptr_t)ptr;
+    int found = 0;
+    Table* t = atomic_load_explicit(&g_table, memory_order_relaxed);
+    if (t) {
+        for (size_t i = hash_pointer(key) & t->mask;; i = (i + 1) & t->mask) {
+            uintptr_t k = atomic_load_explicit(&t->entries[i].key, memory_order_relaxed);
+            if (k == key) {
+                if (size) *size = t->entries[i].size;
+                if (stack) *stack = t->entries[i].stack;
+                atomic_store_explicit(&t->entries[i].key, TOMBSTONE, memory_order_relaxed);
+                t->live--;
+                found = 1;
+                break;
+            }
+            if (k == EMPTY) break;
+        }
+    }
+    return found;
+}
+
+static int forget(void* ptr) {
+    lock();
+    int found = forget_locked(ptr, NULL, NULL);
+    unlock();
+    return found;
+}
+
+// Under the lock: the id of this call stack, added if new
+static int intern_stack(void** frames, int depth) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (int i = 0; i < depth; i++) {
+        h = (h ^ (uint64_t)(uintptr_t)frames[i]) * 0x100000001B3ull;
+    }
+
+    if (g_stack_index) {
+        for (size_t i = h & g_stack_index_mask;; i = (i + 1) & g_stack_index_mask) {
+            int id = g_stack_index[i];
+            if (id < 0) break;
+            Stack* s = &g_stacks[id];
+            if (s->hash == h && s->depth == depth &&
+                memcmp(s->frames, frames, depth * sizeof(void*)) == 0) {
+                return id;
+            }
+        }
+    }
+
+    if (g_stack_count == g_stack_capacity) {
+        g_stack_capacity = g_stack_capacity ? g_stack_capacity * 2 : 256;
+        g_stacks = realloc(g_stacks, g_stack_capacity * sizeof(Stack));
+        // Rebuild the index at the same 2x ratio
+        free(g_stack_index);
+        g_stack_index_mask = (size_t)g_stack_capacity * 2 - 1;
+        g_stack_index = malloc((g_stack_index_mask + 1) * sizeof(int));
+        memset(g_stack_index, 0xFF, (g_stack_index_mask + 1) * sizeof(int));
+        for (int id = 0; id < g_stack_count; id++) {
+            size_t i = g_stacks[id].hash & g_stack_index_mask;
+            while (g_stack_index[i] >= 0) i = (i + 1) & g_stack_index_mask;
+            g_stack_index[i] = id;
+        }
+    }
+
+    int id = g_stack_count++;
+    Stack* s = &g_stacks[id];
+    s->hash = h;
+    s->depth = depth;
+    memcpy(s->frames, frames, depth * sizeof(void*));
+    s->alloc_count = 0;
+    s->alloc_bytes = 0;
+    size_t i = h & g_stack_index_mask;
+    while (g_stack_index[i] >= 0) i = (i + 1) & g_stack_index_mask;
+    g_stack_index[i] = id;
+    return id;
+}
+
+// ===== Sampling =====
+
+static uint64_t next_random(ThreadState* t) {
+    t->rng ^= t->rng << 13;
+    t->rng ^= t->rng >> 7;
+    t->rng ^= t->rng << 17;
+    return t->rng;
+}
+
+// Exponential gap with mean g_rate: makes sampling a Poisson process
+// over allocated bytes, so P(sampled) = 1 - exp(-size / rate)
+static long next_gap(ThreadState* t) {
+    if (g_rate == 0) return 0;
+    double u = (double)(next_random(t) >> 11) * (1.0 / 9007199254740992.0);
+    double gap = -log(1.0 - u) * (double)g_rate;
+    return gap > 1e15 ? (long)1e15 : (long)gap;
+}
+
+// Each sample stands for 1 / P(sampled) allocations of its size
+static double sample_weight(size_t size) {
+    if (g_rate == 0) return 1.0;
+    return 1.0 / (1.0 - exp(-(double)size / (double)g_rate));
+}
+
+static void flush_counts(ThreadState* t) {
+    atomic_fetch_add_explicit(&g_allocs, t->allocs, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_frees, t->frees, memory_order_relaxed);
+    t->allocs = 0;
+    t->frees = 0;
+}
+
+void heapprof_thread_flush(void) {
+    flush_counts(&tls);
+}
+
+static void record(ThreadState* t, void* ptr, size_t size, void* caller) {
+    if (!t->started) {                  // First allocation on this thread
+        t->started = 1;
+        t->rng = hash_pointer((uintptr_t)t) | 1;
+        t->countdown += next_gap(t);
+        if (t->countdown >= 0) return;
+    }
+    t->countdown = next_gap(t);
+
+    void* frames[HEAPPROF_MAX_DEPTH];
+    int depth = capture_stack(frames, caller);
+
+    lock();
+    int stack = intern_stack(frames, depth);
+    g_stacks[stack].alloc_count++;
+    g_stacks[stack].alloc_bytes += size;
+    table_put(table_for_insert(), (uintptr_t)ptr, size, stack);
+    unlock();
+    atomic_fetch_add_explicit(&g_samples, 1, memory_order_relaxed);
+}
+
+static void untracked_free(void* ptr) {
+    atomic_fetch_add_explicit(&g_unknown_frees, 1, memory_order_relaxed);
+    fprintf(stderr, "heapprof: free of untracked pointer %p (double free?)\n", ptr);
+}
+
+static void release(ThreadState* t, void* ptr) {
+    if (++t->frees == FLUSH_EVERY) flush_counts(t);
+    // Must happen before the memory can be handed out again
+    if (g_rate == 0 || maybe_recorded(ptr)) {
+        if (!forget(ptr) && g_rate == 0) untracked_free(ptr);
+    }
+}
+
+static void* track(void* ptr, size_t size, void* caller) {
+    ThreadState* t = &tls;
+    if (++t->allocs == FLUSH_EVERY) flush_counts(t);
+    t->countdown -= (long)size;
+    if (t->countdown < 0 || g_rate == 0) record(t, ptr, size, caller);
+    return ptr;
+}
+
+// ===== Entry points =====
+
+void heapprof_init(size_t sample_rate) {
+    g_rate = sample_rate;
+#ifndef _WIN32
+    void* warm[1];
+    backtrace(warm, 1);                 // First call loads libgcc (and mallocs)
+#endif
+}
+
+void* heapprof_malloc(size_t size) {
+    void* p = malloc(size);
+    return p ? track(p, size, CALLER()) : NULL;
+}
+
+void* heapprof_calloc(size_t count, size_t size) {
+    void* p = calloc(count, size);
+    return p ? track(p, count * size, CALLER()) : NULL;
+}
+
+// If realloc fails the old block is still live, and keeps its record.
+// A sampled block's record is taken out and realloc runs under the
+// lock, so no thread can record the old address (which realloc may
+// hand out again) before we are done; on failure it goes back.
+void* heapprof_realloc(void* ptr, size_t size) {
+    if (!ptr) return heapprof_malloc(size);
+    if (++tls.frees == FLUSH_EVERY) flush_counts(&tls);
+    if (g_rate == 0 || maybe_recorded(ptr)) {
+        size_t old_size = 0;
+        int stack = 0;
+        lock();
+        int found = forget_locked(ptr, &old_size, &stack);
+        if (!found && g_rate == 0) untracked_free(ptr);
+        void* p = realloc(ptr, size);
+        if (!p && size && found) table_put(table_for_insert(), (uintptr_t)ptr, old_size, stack);
+        unlock();
+        return p ? track(p, size, CALLER()) : NULL;
+    }
+    void* p = realloc(ptr, size);
+    return p ? track(p, size, CALLER()) : NULL;
+}
+
+void heapprof_free(void* ptr) {
+    if (!ptr) return;
+    release(&tls, ptr);
+    free(ptr);
+}
+
+// ===== Reports =====
+
+typedef struct {
+    int stack;
+    size_t count;                       // Live samples
+    size_t bytes;
+    double est_count;                   // Scaled by the sample weights
+    double est_bytes;
+} SiteTotal;
+
+// Under the lock: live totals per stack, indexed by stack id
+static SiteTotal* collect_sites(void) {
+    SiteTotal* sites = calloc(g_stack_count + 1, sizeof(SiteTotal));
+    for (int i = 0; i < g_stack_count; i++) sites[i].stack = i;
+    Table* t = atomic_load_explicit(&g_table, memory_order_relaxed);
+    for (size_t i = 0; t && i <= t->mask; i++) {
+        if (atomic_load_explicit(&t->entries[i].key, memory_order_relaxed) <= TOMBSTONE) continue;
+        SiteTotal* s = &sites[t->entries[i].stack];
+        double w = sample_weight(t->entries[i].size);
+        s->count++;
+        s->bytes += t->entries[i].size;
+        s->est_count += w;
+        s->est_bytes += w * t->entries[i].size;
+    }
+    return sites;
+}
+
+static int by_est_bytes(const void* a, const void* b) {
+    double x = ((const SiteTotal*)a)->est_bytes;
+    double y = ((const SiteTotal*)b)->est_bytes;
+    return (x < y) - (x > y);
+}
+
+void heapprof_get_stats(HeapProfStats* out) {
+    memset(out, 0, sizeof(*out));
+    out->sample_rate = g_rate;
+    out->allocs = atomic_load(&g_allocs) + tls.allocs;
+    out->frees = atomic_load(&g_frees) + tls.frees;
+    out->samples = atomic_load(&g_samples);
+    out->unknown_frees = atomic_load(&g_unknown_frees);
+
+    lock();
+    SiteTotal* sites = collect_sites();
+    double live = 0;
+    for (int i = 0; i < g_stack_count; i++) {
+        out->live_samples += sites[i].count;
+        live += sites[i].est_bytes;
+    }
+    out->live_bytes_estimate = (size_t)live;
+    out->stacks = g_stack_count;
+    unlock();
+    free(sites);
+}
+
+static void print_frames(FILE* out, Stack* s) {
+    int shown = s->depth < 6 ? s->depth : 6;
+#ifdef _WIN32
+    for (int i = 0; i < shown; i++) fprintf(out, "        %p\n", s->frames[i]);
+#else
+    char** names = backtrace_symbols(s->frames, shown);
+    for (int i = 0; i < shown; i++) {
+        fprintf(out, "        %s\n", names ? names[i] : "?");
+    }
+    free(names);
+#endif
+}
+
+void heapprof_dump(FILE* out, int top) {
+    lock();
+    SiteTotal* sites = collect_sites();
+    int count = g_stack_count;
+    qsort(sites, count, sizeof(SiteTotal), by_est_bytes);
+
+    double total = 0;
+    for (int i = 0; i < count; i++) total += sites[i].est_bytes;
+    fprintf(out, "Heap profile: ~%.1f KB live (sampling every %zu bytes on average)\n",
+            total / 1024, g_rate);
+
+    for (int i = 0; i < count && i < top && sites[i].count > 0; i++) {
+        fprintf(out, "  %10.1f KB %5.1f%%  ~%.0f objects (%zu sampled)\n",
+                sites[i].est_bytes / 1024, total > 0 ? 100 * sites[i].est_bytes / total : 0,
+                sites[i].est_count, sites[i].count);
+        print_frames(out, &g_stacks[sites[i].stack]);
+    }
+    unlock();
+    free(sites);
+}
+
+int heapprof_write(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+
+    lock();
+    SiteTotal* sites = collect_sites();
+    size_t live_count = 0, live_bytes = 0, alloc_count = 0, alloc_bytes = 0;
+    for (int i = 0; i < g_stack_count; i++) {
+        live_count += sites[i].count;
+        live_bytes += sites[i].bytes;
+        alloc_count += g_stacks[i].alloc_count;
+        alloc_bytes += g_stacks[i].alloc_bytes;
+    }
+
+    // Raw sample counts: pprof scales heap_v2 by the rate itself
+    fprintf(f, "heap profile: %6zu: %8zu [%6zu: %8zu] @ heap_v2/%zu\n",
+            live_count, live_bytes, alloc_count, alloc_bytes, g_rate ? g_rate : 1);
+    for (int i = 0; i < g_stack_count; i++) {
+        Stack* s = &g_stacks[i];
+        fprintf(f, "%6zu: %8zu [%6zu: %8zu] @", sites[i].count, sites[i].bytes,
+                s->alloc_count, s->alloc_bytes);
+        for (int d = 0; d < s->depth; d++) fprintf(f, " %p", s->frames[d]);
+        fprintf(f, "\n");
+    }
+    unlock();
+    free(sites);
+
+    // Lets pprof map addresses back to binaries and shared libraries
+    fprintf(f, "\nMAPPED_LIBRARIES:\n");
+    FILE* maps = fopen("/proc/self/maps", "r");
+    if (maps) {
+        char buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), maps)) > 0) fwrite(buf, 1, n, f);
+        fclose(maps);
+    }
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+void heapprof_shutdown(void) {
+    lock();
+    Table* t = atomic_exchange(&g_table, NULL);
+    while (t) {
+        Table* older = t->retired;
+        free(t->entries);
+        free(t);
+        t = older;
+    }
+    free(g_stacks);
+    free(g_stack_index);
+    g_stacks = NULL;
+    g_stack_index = NULL;
+    g_stack_count = g_stack_capacity = 0;
+    atomic_store(&g_allocs, 0);
+    atomic_store(&g_frees, 0);
+    atomic_store(&g_samples, 0);
+    atomic_store(&g_unknown_frees, 0);
+    tls.allocs = tls.frees = 0;
+    unlock();
+}
@@ -0,0 +1,80 @@
+#ifndef HEAPPROF_H
+#define HEAPPROF_H
+
+/*
+ * Sampling heap profiler
+ *
+ * The tracking allocator in 05_tracking_allocator.c records every
+ * allocation in one linked list: a second malloc per malloc, an O(n)
+ * search per free, and no locking. This one is built to stay on in
+ * production:
+ *
+ *   - sampling: on average one allocation per HEAPPROF_DEFAULT_RATE
+ *     bytes is recorded, chosen by a per-thread byte countdown with
+ *     exponentially distributed gaps (tcmalloc's scheme). Big
+ *     allocations are almost always sampled, tiny ones rarely, and
+ *     each sample is weighted so the totals are unbiased estimates
+ *   - unsampled malloc: a subtraction and a branch on thread-local data
+ *   - sampled allocations live in an open-addressing hash table keyed
+ *     by pointer; free probes it without a lock and locks only when
+ *     the pointer is actually in it
+ *   - every sample records a backtrace; the profile groups live (and
+ *     total allocated) bytes by call stack
+ *
+ * Rate 0 records every allocation - exact, slower, and frees of
+ * unknown pointers are reported, like 05.
+ *
+ * Output: heapprof_dump() prints the top call sites; heapprof_write()
+ * writes gperftools' heap profile format for pprof:
+ *
+ *   pprof --text ./program heap.prof
+ *
+ * Build: add heapprof.c to the compile line (-pthread -rdynamic on
+ * Linux; -rdynamic lets the dump name non-static functions).
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define HEAPPROF_DEFAULT_RATE (512 * 1024)  // Mean bytes between samples
+#define HEAPPROF_MAX_DEPTH 32
+
+// Call once, before any other thread allocates through the profiler
+void heapprof_init(size_t sample_rate);
+
+void* heapprof_malloc(size_t size);
+void* heapprof_calloc(size_t count, size_t size);
+void* heapprof_realloc(void* ptr, size_t size);
+void heapprof_free(void* ptr);
+
+// Fold this thread's counters into the totals (do it before a thread exits)
+void heapprof_thread_flush(void);
+
+typedef struct {
+    size_t sample_rate;
+    size_t allocs;                      // All allocations seen
+    size_t frees;
+    size_t samples;                     // Allocations recorded
+    size_t live_samples;                // Recorded and not yet freed
+    size_t live_bytes_estimate;         // Live heap, scaled up from the samples
+    size_t stacks;                      // Distinct call stacks
+    size_t unknown_frees;               // Rate 0 only
+} HeapProfStats;
+
+void heapprof_get_stats(HeapProfStats* out);
+
+// Top call sites by estimated live bytes, with symbolized stacks
+void heapprof_dump(FILE* out, int top);
+
+// gperftools heap profile (heap_v2) for pprof; returns 0 on success
+int heapprof_write(const char* path);
+
+// Free the profiler's tables and zero the counts (allocations still
+// live are forgotten)
+void heapprof_shutdown(void);
+
+// Like 05's MALLOC / FREE
+#define HP_MALLOC(size) heapprof_malloc(size)
+#define HP_FREE(ptr) heapprof_free(ptr)
+
+#endif
@@ -0,0 +1,469 @@
+/*
+ * Thread-safe growable object pool - implementation
+ *
+ * See objpool.h for the API.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "objpool.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <malloc.h>
+    static void cpu_yield(void) { SwitchToThread(); }
+    static void* slab_memory(size_t size) { return _aligned_malloc(size, size); }
+    static void slab_release(void* p) { _aligned_free(p); }
+#else
+    #include <sched.h>
+    static void cpu_yield(void) { sched_yield(); }
+    static void* slab_memory(size_t size) {
+        void* p = NULL;
+        return posix_memalign(&p, size, size) == 0 ? p : NULL;
+    }
+    static void slab_release(void* p) { free(p); }
+#endif
+
+#define SLAB_MIN_SIZE (64 * 1024)
+#define SLAB_MAGIC 0x51AB51ABu
+#define MAG_CHUNK 256
+#define NIL 0xFFFFFFFFu
+#define POISON 0xDD
+
+struct Magazine {
+    atomic_uint next;                   // Depot link (index), read racily by pop
+    unsigned index;
+    int count;
+    void* objs[OBJPOOL_MAG_SIZE];
+};
+
+// Slabs are aligned to their size, so obj & ~(slab_size - 1) finds the
+// header. Checked pools keep one state byte per object after it.
+struct Slab {
+    unsigned magic;
+    ObjPool* pool;
+    Slab* next;
+    atomic_uchar states[];              // 1 = allocated
+};
+
+// Slab addresses of a checked pool, so a free can tell its pointer is
+// ours without reading memory around it. Open addressing, written
+// under grow_lock and read without it. Slabs are only ever added, and
+// an outgrown table stays allocated (linked from its successor) until
+// the pool is destroyed, so a reader holding it still reads valid memory.
+struct SlabSet {
+    SlabSet* older;
+    size_t mask;
+    size_t count;
+    _Atomic(Slab*) slots[];
+};
+
+typedef struct {
+    Magazine* loaded;
+    Magazine* previous;
+    unsigned long serial;
+} ThreadCache;
+
+static _Thread_local ThreadCache tls_cache[OBJPOOL_MAX_POOLS];
+static _Atomic(ObjPool*) registry[OBJPOOL_MAX_POOLS];
+static atomic_ulong next_serial = 1;
+
+static void default_error(ObjPool* p, void* obj, const char* what) {
+    fprintf(stderr, "objpool '%s': %s (%p)\n", p->name, what, obj);
+    abort();
+}
+
+static ObjPoolErrorFn error_fn = default_error;
+
+void objpool_set_error_handler(ObjPoolErrorFn fn) {
+    error_fn = fn ? fn : default_error;
+}
+
+static void out_of_memory(const char* what) {
+    fprintf(stderr, "objpool: out of memory (%s)\n", what);
+    abort();
+}
+
+static size_t round_up(size_t n, size_t to) {
+    return (n + to - 1) & ~(to - 1);
+}
+
+static void grow_lock(ObjPool* p) {
+    int spins = 0;
+    while (atomic_flag_test_and_set_explicit(&p->grow_lock, memory_order_acquire)) {
+        if (++spins == 64) {
+            cpu_yield();
+            spins = 0;
+        }
+    }
+}
+
+static void grow_unlock(ObjPool* p) {
+    atomic_flag_clear_explicit(&p->grow_lock, memory_order_release);
+}
+
+// ===== Depot: lock-free stacks of magazines =====
+//
+// Magazines are never freed while the pool lives, so a pop that reads
+// `next` of a magazine someone else just took reads valid (if stale)
+// memory; the tag in the head makes its CAS fail.
+
+static Magazine* mag_at(ObjPool* p, unsigned index) {
+    Magazine* chunk = atomic_load_explicit(&p->mag_chunks[index / MAG_CHUNK], memory_order_acquire);
+    return &chunk[index % MAG_CHUNK];
+}
+
+static void depot_push(atomic_ullong* head, Magazine* m) {
+    unsigned long long old = atomic_load_explicit(head, memory_order_relaxed);
+    unsigned long long desired;
+    do {
+        atomic_store_explicit(&m->next, (unsigned)old, memory_order_relaxed);
+        desired = (((old >> 32) + 1) << 32) | m->index;
+    } while (!atomic_compare_exchange_weak_explicit(head, &old, desired,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+static Magazine* depot_pop(ObjPool* p, atomic_ullong* head) {
+    unsigned long long old = atomic_load_explicit(head, memory_order_acquire);
+    for (;;) {
+        unsigned index = (unsigned)old;
+        if (index == NIL) return NULL;
+        Magazine* m = mag_at(p, index);
+        unsigned next = atomic_load_explicit(&m->next, memory_order_relaxed);
+        unsigned long long desired = (((old >> 32) + 1) << 32) | next;
+        if (atomic_compare_exchange_weak_explicit(head, &old, desired,
+                                                  memory_order_acquire, memory_order_acquire)) {
+            return m;
+        }
+    }
+}
+
+// ===== Growth =====
+
+static Magazine* new_magazine(ObjPool* p) {
+    grow_lock(p);
+    unsigned index = atomic_load_explicit(&p->mag_count, memory_order_relaxed);
+    if (index >= OBJPOOL_MAX_MAGAZINES) out_of_memory("magazine table full");
+    _Atomic(Magazine*)* slot = &p->mag_chunks[index / MAG_CHUNK];
+    Magazine* chunk = atomic_load_explicit(slot, memory_order_relaxed);
+    if (!chunk) {
+        chunk = (Magazine*)calloc(MAG_CHUNK, sizeof(Magazine));
+        if (!chunk) out_of_memory("magazines");
+        atomic_store_explicit(slot, chunk, memory_order_release);
+    }
+    Magazine* m = &chunk[index % MAG_CHUNK];
+    m->index = index;
+    m->count = 0;
+    atomic_store_explicit(&p->mag_count, index + 1, memory_order_release);
+    grow_unlock(p);
+    return m;
+}
+
+static Magazine* get_empty(ObjPool* p) {
+    Magazine* m = depot_pop(p, &p->empty);
+    return m ? m : new_magazine(p);
+}
+
+static size_t slab_hash(ObjPool* p, uintptr_t base) {
+    return (size_t)((base / p->slab_size) * 0x9E3779B97F4A7C15ull >> 32);
+}
+
+static void slab_set_put(ObjPool* p, SlabSet* set, Slab* s) {
+    size_t i = slab_hash(p, (uintptr_t)s) & set->mask;
+    while (atomic_load_explicit(&set->slots[i], memory_order_relaxed)) i = (i + 1) & set->mask;
+    atomic_store_explicit(&set->slots[i], s, memory_order_release);
+    set->count++;
+}
+
+// Under grow_lock. Keeps the table at most half full
+static void slab_set_add(ObjPool* p, Slab* s) {
+    SlabSet* set = atomic_load_explicit(&p->slab_set, memory_order_relaxed);
+    if (!set || (set->count + 1) * 2 > set->mask + 1) {
+        size_t capacity = set ? (set->mask + 1) * 2 : 16;
+        SlabSet* bigger = (SlabSet*)calloc(1, sizeof(SlabSet) + capacity * sizeof(_Atomic(Slab*)));
+        if (!bigger) out_of_memory("slab set");
+        bigger->older = set;
+        bigger->mask = capacity - 1;
+        if (set) {
+            for (size_t i = 0; i <= set->mask; i++) {
+                Slab* old = atomic_load_explicit(&set->slots[i], memory_order_relaxed);
+                if (old) slab_set_put(p, bigger, old);
+            }
+        }
+        atomic_store_explicit(&p->slab_set, bigger, memory_order_release);
+        set = bigger;
+    }
+    slab_set_put(p, set, s);
+}
+
+static int slab_set_contains(ObjPool* p, uintptr_t base) {
+    SlabSet* set = atomic_load_explicit(&p->slab_set, memory_order_acquire);
+    if (!set) return 0;
+    for (size_t i = slab_hash(p, base) & set->mask;; i = (i + 1) & set->mask) {
+        Slab* s = atomic_load_explicit(&set->slots[i], memory_order_acquire);
+        if (!s) return 0;
+        if ((uintptr_t)s == base) return 1;
+    }
+}
+
+// Fill m with never-used objects. Stored in reverse so they are handed
+// out in address order: consecutive allocs are neighbours in memory.
+// Checked pools poison them after the lock is dropped.
+static void refill(ObjPool* p, Magazine* m) {
+    grow_lock(p);
+    int n = 0;
+    char* objs[OBJPOOL_MAG_SIZE];
+    while (n < OBJPOOL_MAG_SIZE) {
+        if ((size_t)(p->carve_end - p->carve_next) < p->object_size) {
+            if (n > 0) break;           // Hand out the rest of this slab first
+            Slab* s = (Slab*)slab_memory(p->slab_size);
+            if (!s) out_of_memory("slab");
+            s->magic = SLAB_MAGIC;
+            s->pool = p;
+            s->next = p->slabs;
+            if (p->checked) {
+                for (int i = 0; i < p->objects_per_slab; i++) atomic_init(&s->states[i], 0);
+                slab_set_add(p, s);
+            }
+            p->slabs = s;
+            p->carve_next = (char*)s + p->header_size;
+            p->carve_end = p->carve_next + (size_t)p->objects_per_slab * p->object_size;
+            atomic_fetch_add_explicit(&p->slab_count, 1, memory_order_relaxed);
+        }
+        objs[n++] = p->carve_next;
+        p->carve_next += p->object_size;
+    }
+    grow_unlock(p);
+
+    if (p->checked) {
+        for (int i = 0; i < n; i++) memset(objs[i], POISON, p->object_size);
+    }
+    for (int i = 0; i < n; i++) m->objs[n - 1 - i] = objs[i];
+    m->count = n;
+}
+
+// ===== Checks =====
+
+static Slab* slab_of(ObjPool* p, void* obj, int* index) {
+    uintptr_t base = (uintptr_t)obj & ~(uintptr_t)(p->slab_size - 1);
+    if (!slab_set_contains(p, base)) return NULL;   // Don't read unknown memory
+    Slab* s = (Slab*)base;
+    if (s->magic != SLAB_MAGIC || s->pool != p) return NULL;
+    size_t offset = (char*)obj - ((char*)s + p->header_size);
+    if ((char*)obj < (char*)s + p->header_size || offset % p->object_size ||
+        offset / p->object_size >= (size_t)p->objects_per_slab) {
+        return NULL;
+    }
+    *index = (int)(offset / p->object_size);
+    return s;
+}
+
+static void check_alloc(ObjPool* p, void* obj) {
+    int index;
+    Slab* s = slab_of(p, obj, &index);
+    atomic_store_explicit(&s->states[index], 1, memory_order_relaxed);
+
+    const unsigned char* bytes = (const unsigned char*)obj;
+    for (size_t i = 0; i < p->object_size; i++) {
+        if (bytes[i] != POISON) {
+            error_fn(p, obj, "object was written after it was freed");
+            break;
+        }
+    }
+}
+
+// Returns 0 if the free must not proceed. Ownership is O(1) and takes
+// no lock: obj's aligned base must be one of this pool's slabs.
+static int check_free(ObjPool* p, void* obj) {
+    int index;
+    Slab* s = slab_of(p, obj, &index);
+    if (!s) {
+        error_fn(p, obj, "free of a pointer this pool did not allocate");
+        return 0;
+    }
+    if (atomic_exchange_explicit(&s->states[index], 0, memory_order_relaxed) == 0) {
+        error_fn(p, obj, "double free");
+        return 0;
+    }
+    memset(obj, POISON, p->object_size);
+    return 1;
+}
+
+// ===== Pool =====
+
+ObjPool* objpool_create(const char* name, size_t object_size, int flags) {
+    ObjPool* p = (ObjPool*)calloc(1, sizeof(ObjPool));
+    if (!p) out_of_memory("pool");
+
+    p->name = name;
+    p->object_size = round_up(object_size ? object_size : 1, 16);
+    p->checked = (flags & OBJPOOL_CHECKED) || OBJPOOL_CHECK_DEFAULT;
+
+    // At least 16 objects per slab
+    p->slab_size = SLAB_MIN_SIZE;
+    while (p->slab_size < 1024 + 16 * (p->object_size + 1)) p->slab_size *= 2;
+    size_t max_objects = p->slab_size / p->object_size;
+    p->header_size = round_up(sizeof(Slab) + (p->checked ? max_objects : 0), 64);
+    p->objects_per_slab = (int)((p->slab_size - p->header_size) / p->object_size);
+
+    p->mag_chunks = (_Atomic(Magazine*)*)calloc(OBJPOOL_MAX_MAGAZINES / MAG_CHUNK,
+                                                sizeof(_Atomic(Magazine*)));
+    if (!p->mag_chunks) out_of_memory("magazine table");
+    atomic_init(&p->full, NIL);
+    atomic_init(&p->empty, NIL);
+    atomic_init(&p->slab_set, NULL);
+    atomic_flag_clear(&p->grow_lock);
+    p->serial = atomic_fetch_add(&next_serial, 1);
+
+    p->slot = -1;
+    for (int i = 0; i < OBJPOOL_MAX_POOLS && p->slot < 0; i++) {
+        ObjPool* expected = NULL;
+        if (atomic_compare_exchange_strong(&registry[i], &expected, p)) p->slot = i;
+    }
+    if (p->slot < 0) {
+        fprintf(stderr, "objpool: more than %d pools\n", OBJPOOL_MAX_POOLS);
+        abort();
+    }
+    return p;
+}
+
+void objpool_destroy(ObjPool* p) {
+    if (!p) return;
+    objpool_thread_flush(p);
+    while (p->slabs) {
+        Slab* s = p->slabs;
+        p->slabs = s->next;
+        s->magic = 0;                   // Stale pointers must not match
+        slab_release(s);
+    }
+    SlabSet* set = atomic_load(&p->slab_set);
+    while (set) {
+        SlabSet* older = set->older;
+        free(set);
+        set = older;
+    }
+    for (int i = 0; i < OBJPOOL_MAX_MAGAZINES / MAG_CHUNK; i++) {
+        free(atomic_load(&p->mag_chunks[i]));
+    }
+    free(p->mag_chunks);
+    atomic_store(&registry[p->slot], NULL);
+    free(p);
+}
+
+static ThreadCache* cache_for(ObjPool* p) {
+    ThreadCache* c = &tls_cache[p->slot];
+    if (c->serial != p->serial) {       // Slot belonged to a destroyed pool
+        c->loaded = c->previous = NULL;
+        c->serial = p->serial;
+    }
+    return c;
+}
+
+static Magazine* alloc_slow(ObjPool* p, ThreadCache* c) {
+    if (c->previous && c->previous->count > 0) {
+        Magazine* t = c->loaded;
+        c->loaded = c->previous;
+        c->previous = t;
+        return c->loaded;
+    }
+
+    Magazine* full = depot_pop(p, &p->full);
+    if (full) {
+        atomic_fetch_add_explicit(&p->depot_gets, 1, memory_order_relaxed);
+        if (c->previous) depot_push(&p->empty, c->previous);
+        c->previous = c->loaded;
+        c->loaded = full;
+        return full;
+    }
+
+    if (!c->loaded) c->loaded = get_empty(p);
+    refill(p, c->loaded);
+    return c->loaded;
+}
+
+void* objpool_alloc(ObjPool* p) {
+    ThreadCache* c = cache_for(p);
+    Magazine* m = c->loaded;
+    if (!m || m->count == 0) m = alloc_slow(p, c);
+
+    void* obj = m->objs[--m->count];
+    if (p->checked) check_alloc(p, obj);
+    return obj;
+}
+
+static Magazine* free_slow(ObjPool* p, ThreadCache* c) {
+    if (!c->loaded) {
+        c->loaded = get_empty(p);
+        return c->loaded;
+    }
+    if (c->previous && c->previous->count == 0) {
+        Magazine* t = c->loaded;
+        c->loaded = c->previous;
+        c->previous = t;
+        return c->loaded;
+    }
+
+    // Both full: hand one to the depot for threads that are allocating
+    if (c->previous) {
+        depot_push(&p->full, c->previous);
+        atomic_fetch_add_explicit(&p->depot_puts, 1, memory_order_relaxed);
+    }
+    c->previous = c->loaded;
+    c->loaded = get_empty(p);
+    return c->loaded;
+}
+
+void objpool_free(ObjPool* p, void* obj) {
+    if (!obj) return;
+    if (p->checked && !check_free(p, obj)) return;
+
+    ThreadCache* c = cache_for(p);
+    Magazine* m = c->loaded;
+    if (!m || m->count == OBJPOOL_MAG_SIZE) m = free_slow(p, c);
+    m->objs[m->count++] = obj;
+}
+
+void objpool_thread_flush(ObjPool* p) {
+    ThreadCache* c = cache_for(p);
+    Magazine* mags[2] = { c->loaded, c->previous };
+    for (int i = 0; i < 2; i++) {
+        if (!mags[i]) continue;
+        if (mags[i]->count > 0) {
+            depot_push(&p->full, mags[i]);
+            atomic_fetch_add_explicit(&p->depot_puts, 1, memory_order_relaxed);
+        } else {
+            depot_push(&p->empty, mags[i]);
+        }
+    }
+    c->loaded = c->previous = NULL;
+}
+
+void objpool_thread_exit(void) {
+    for (int i = 0; i < OBJPOOL_MAX_POOLS; i++) {
+        ObjPool* p = atomic_load(&registry[i]);
+        if (p && tls_cache[i].serial == p->serial) objpool_thread_flush(p);
+    }
+}
+
+void objpool_get_stats(ObjPool* p, ObjPoolStats* out) {
+    grow_lock(p);
+    out->slabs = atomic_load_explicit(&p->slab_count, memory_order_relaxed);
+    out->capacity = out->slabs * p->objects_per_slab -
+                    (long)((p->carve_end - p->carve_next) / p->object_size);
+    out->live = -1;
+    if (p->checked) {
+        out->live = 0;
+        for (Slab* s = p->slabs; s; s = s->next) {
+            for (int i = 0; i < p->objects_per_slab; i++) {
+                out->live += atomic_load_explicit(&s->states[i], memory_order_relaxed);
+            }
+        }
+    }
+    grow_unlock(p);
+    out->magazines = (long)atomic_load(&p->mag_count);
+    out->depot_gets = atomic_load_explicit(&p->depot_gets, memory_order_relaxed);
+    out->depot_puts = atomic_load_explicit(&p->depot_puts, memory_order_relaxed);
+}
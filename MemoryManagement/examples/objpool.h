@@ -0,0 +1,115 @@
+#ifndef OBJPOOL_H
+#define OBJPOOL_H
+
+/*
+ * Thread-safe growable object pool with per-thread magazines
+ *
+ * The Pool in 03_memory_pool.c is one fixed buffer with one free list:
+ * it runs out, and two threads using it corrupt the list. This one:
+ *
+ *   thread 1            thread 2                  shared
+ *   ┌────────────┐      ┌────────────┐    ┌──────────────────────┐
+ *   │ loaded  [32]│     │ loaded  [32]│    │ depot: full mags     │
+ *   │ previous[32]│     │ previous[32]│ ⇄  │        empty mags    │
+ *   └────────────┘      └────────────┘    └──────────┬───────────┘
+ *                                                     │ when empty
+ *                                                 ┌───▼────┐
+ *                                                 │ slabs  │ grow
+ *                                                 └────────┘
+ *
+ * A magazine is an array of up to OBJPOOL_MAG_SIZE free objects. Each
+ * thread keeps two; alloc and free touch only those, with no atomics.
+ * Only when both are empty (or both full) does the thread swap a whole
+ * magazine with the depot - one lock-free push/pop per 32 objects.
+ * If the depot has no objects either, a new slab is carved.
+ *
+ * Objects freed on another thread simply land in that thread's
+ * magazines and flow back through the depot.
+ *
+ * Checks: debug builds (no NDEBUG), or pools created with
+ * OBJPOOL_CHECKED, catch double frees, frees of foreign pointers and
+ * writes to freed objects (freed memory is filled with 0xDD and
+ * verified on the next alloc). A free is checked in O(1), without
+ * locking: the pointer's aligned base is looked up in a hash set of
+ * the pool's slab addresses before its slab header is read.
+ *
+ * Build: add objpool.c to the compile line (-pthread on Linux).
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define OBJPOOL_MAG_SIZE 32
+#define OBJPOOL_MAX_POOLS 64            // Live pools at once
+#define OBJPOOL_MAX_MAGAZINES (1 << 20)
+
+// Flags for objpool_create
+#define OBJPOOL_CHECKED 1               // Checks even in release builds
+
+#ifdef NDEBUG
+    #define OBJPOOL_CHECK_DEFAULT 0
+#else
+    #define OBJPOOL_CHECK_DEFAULT 1
+#endif
+
+typedef struct Magazine Magazine;
+typedef struct Slab Slab;
+typedef struct SlabSet SlabSet;
+
+typedef struct {
+    // Lock-free depot stacks: (ABA tag << 32) | magazine index
+    _Alignas(64) atomic_ullong full;
+    _Alignas(64) atomic_ullong empty;
+
+    // Growth: rare, under a spinlock
+    _Alignas(64) atomic_flag grow_lock;
+    Slab* slabs;
+    char* carve_next;                   // Uncarved part of the newest slab
+    char* carve_end;
+    _Atomic(Magazine*)* mag_chunks;     // Magazines by index, 256 per chunk
+    _Atomic(SlabSet*) slab_set;         // Checked pools: slab addresses
+    atomic_uint mag_count;
+
+    size_t object_size;                 // Rounded up to 16
+    size_t slab_size;                   // Power of two; slabs are aligned to it
+    size_t header_size;
+    int objects_per_slab;
+    int checked;
+    int slot;                           // In the thread-cache table
+    unsigned long serial;               // Tells a reused slot from the old pool
+    const char* name;
+
+    // Stats (slow paths only)
+    atomic_long slab_count;
+    atomic_long depot_gets;
+    atomic_long depot_puts;
+} ObjPool;
+
+typedef struct {
+    long slabs;
+    long capacity;                      // Objects carved so far
+    long magazines;
+    long depot_gets;                    // Full magazines taken by threads
+    long depot_puts;                    // Full magazines handed back
+    long live;                          // Checked pools only, else -1
+} ObjPoolStats;
+
+ObjPool* objpool_create(const char* name, size_t object_size, int flags);
+void objpool_destroy(ObjPool* p);       // All threads must be done with it
+
+void* objpool_alloc(ObjPool* p);        // Never NULL: grows instead
+void objpool_free(ObjPool* p, void* obj);
+
+// Return this thread's magazines to the depot. Call before a thread
+// exits (objpool_thread_exit does it for every pool).
+void objpool_thread_flush(ObjPool* p);
+void objpool_thread_exit(void);
+
+void objpool_get_stats(ObjPool* p, ObjPoolStats* out);
+
+// Called on a detected bug. Default prints and aborts; a handler that
+// returns makes the bad free a no-op.
+typedef void (*ObjPoolErrorFn)(ObjPool* p, void* obj, const char* what);
+void objpool_set_error_handler(ObjPoolErrorFn fn);
+
+#endif
@@ -0,0 +1,526 @@
+/*
+ * Size-class general-purpose allocator - implementation
+ *
+ * See size_alloc.h for the API.
+ *
+ * Everything, including our own bookkeeping, comes from the OS
+ * directly: when this file replaces malloc it can't call malloc, and
+ * that includes printf. Errors are reported with write().
+ */
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "size_alloc.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define SA_TLS _Thread_local
+    static void cpu_yield(void) { SwitchToThread(); }
+    static void fatal(const char* msg) {
+        DWORD written;
+        WriteFile(GetStdHandle(STD_ERROR_HANDLE), msg, (DWORD)strlen(msg), &written, NULL);
+        abort();
+    }
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    // initial-exec: no allocation on first access, which matters when
+    // this file is malloc itself (LD_PRELOAD)
+    #define SA_TLS _Thread_local __attribute__((tls_model("initial-exec")))
+    static void cpu_yield(void) { sched_yield(); }
+    static void fatal(const char* msg) {
+        ssize_t ignored = write(2, msg, strlen(msg));
+        (void)ignored;
+        abort();
+    }
+#endif
+
+#define PAGE_SIZE 4096
+#define HEADER_SIZE 64
+#define SEGMENT_SIZE (16 * SA_SLAB_SIZE)        // Slabs are carved from 4 MB segments
+#define SLAB_MAGIC 0x5A5A1AB5u
+#define LARGE_CLASS (-1)
+#define LARGE_CACHE_ENTRIES 32
+#define LARGE_CACHE_MAX (4 * 1024 * 1024)       // Bigger mappings are unmapped at once
+#define LARGE_CACHE_TOTAL (64 * 1024 * 1024)
+
+static const unsigned class_sizes[SA_NUM_CLASSES] = {
+    8, 16, 32, 48, 64, 80, 96, 112,
+    128, 160, 192, 224, 256, 320, 384, 448,
+    512, 640, 768, 896, 1024, 1280, 1536, 1792,
+    2048, 2560, 3072, 3584, 4096, 5120, 6144, 7168,
+    8192, 10240, 12288, 14336, 16384, 20480, 24576, 28672,
+    32768,
+};
+
+// First 64 bytes of every slab and every large mapping. Both are
+// aligned to SA_SLAB_SIZE, so ptr & ~(SA_SLAB_SIZE - 1) finds it.
+typedef struct {
+    unsigned magic;
+    int cls;                            // LARGE_CLASS for large
+    int interior;                       // memalign handed out inner pointers
+    unsigned obj_size;
+    char* objects;                      // First object (small)
+    void* map_base;                     // Large only
+    size_t map_size;
+} SlabHeader;
+
+typedef struct {
+    _Alignas(64) atomic_flag lock;
+    void* free_list;                    // Linked through the objects' first word
+    char* carve;                        // Unused part of the newest slab
+    char* carve_end;
+} Central;
+
+typedef struct {
+    void* head;
+    int count;
+} ClassCache;
+
+typedef struct {
+    ClassCache classes[SA_NUM_CLASSES];
+    int registered;                     // Flushed at thread exit
+} ThreadCache;
+
+static Central central[SA_NUM_CLASSES];
+static SA_TLS ThreadCache tcache;
+
+static atomic_flag segment_lock = ATOMIC_FLAG_INIT;
+static char* segment_next;
+static char* segment_end;
+
+typedef struct {
+    void* base;
+    size_t size;
+} CachedMapping;
+
+static atomic_flag large_lock = ATOMIC_FLAG_INIT;
+static CachedMapping large_cache[LARGE_CACHE_ENTRIES];
+static int large_cache_count;
+static size_t large_cache_bytes;
+
+static atomic_size_t stat_mapped;
+static atomic_size_t stat_slabs;
+static atomic_size_t stat_large_live;
+
+static void spin_lock(atomic_flag* f) {
+    int spins = 0;
+    while (atomic_flag_test_and_set_explicit(f, memory_order_acquire)) {
+        if (++spins == 64) {
+            cpu_yield();
+            spins = 0;
+        }
+    }
+}
+
+static void spin_unlock(atomic_flag* f) {
+    atomic_flag_clear_explicit(f, memory_order_release);
+}
+
+static size_t round_up(size_t n, size_t to) {
+    return (n + to - 1) & ~(to - 1);
+}
+
+// ===== Size classes =====
+
+static inline int size_class(size_t n) {
+    if (n <= 128) return n <= 8 ? 0 : (int)((n + 15) >> 4);
+    // (2^k, 2^(k+1)] is split into 4 classes
+    int k = 63 - __builtin_clzll((unsigned long long)(n - 1));
+    return 9 + (k - 7) * 4 + (int)(((n - 1) >> (k - 2)) & 3);
+}
+
+size_t sa_class_size(int cls) {
+    return class_sizes[cls];
+}
+
+// Objects moved between a thread and the central list at once
+static inline int batch_for(int cls) {
+    unsigned size = class_sizes[cls];
+    if (size <= 512) return 64;
+    int n = 32768 / size;
+    return n < 2 ? 2 : n;
+}
+
+// ===== OS memory =====
+
+#ifdef _WIN32
+static void* os_map_aligned(size_t size, size_t align) {
+    for (;;) {
+        // Reserve extra to find an aligned address, release, then take
+        // exactly that range (another thread may beat us to it: retry)
+        char* probe = VirtualAlloc(NULL, size + align, MEM_RESERVE, PAGE_NOACCESS);
+        if (!probe) return NULL;
+        char* aligned = (char*)round_up((size_t)probe, align);
+        VirtualFree(probe, 0, MEM_RELEASE);
+        void* p = VirtualAlloc(aligned, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (p) return p;
+    }
+}
+
+static void os_unmap(void* p, size_t size) {
+    (void)size;
+    VirtualFree(p, 0, MEM_RELEASE);
+}
+#else
+static void* os_map_aligned(size_t size, size_t align) {
+    char* raw = mmap(NULL, size + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    char* aligned = (char*)round_up((size_t)raw, align);
+    if (aligned > raw) munmap(raw, aligned - raw);
+    size_t tail = (raw + size + align) - (aligned + size);
+    if (tail) munmap(aligned + size, tail);
+    return aligned;
+}
+
+static void os_unmap(void* p, size_t size) {
+    munmap(p, size);
+}
+#endif
+
+static char* new_slab(void) {
+    spin_lock(&segment_lock);
+    if (segment_next == segment_end) {
+        char* seg = (char*)os_map_aligned(SEGMENT_SIZE, SA_SLAB_SIZE);
+        if (!seg) {
+            spin_unlock(&segment_lock);
+            return NULL;
+        }
+        atomic_fetch_add_explicit(&stat_mapped, SEGMENT_SIZE, memory_order_relaxed);
+        segment_next = seg;
+        segment_end = seg + SEGMENT_SIZE;
+    }
+    char* slab = segment_next;
+    segment_next += SA_SLAB_SIZE;
+    spin_unlock(&segment_lock);
+    atomic_fetch_add_explicit(&stat_slabs, 1, memory_order_relaxed);
+    return slab;
+}
+
+static inline SlabHeader* header_of(void* p) {
+    return (SlabHeader*)((uintptr_t)p & ~(uintptr_t)(SA_SLAB_SIZE - 1));
+}
+
+// ===== Thread caches =====
+
+static void release(int cls, int n);
+
+static void flush_all(void) {
+    for (int c = 0; c < SA_NUM_CLASSES; c++) {
+        if (tcache.classes[c].count > 0) release(c, tcache.classes[c].count);
+    }
+}
+
+void sa_thread_flush(void) {
+    flush_all();
+}
+
+#ifdef _WIN32
+static void register_thread(void) {
+    tcache.registered = 1;              // No exit hook: call sa_thread_flush()
+}
+#else
+static pthread_key_t cache_key;
+static atomic_int init_state;           // 0 = not yet, 1 = in progress, 2 = done
+
+static void thread_exit_hook(void* arg) {
+    (void)arg;
+    flush_all();
+    tcache.registered = 0;
+}
+
+// Held across fork() so the child never inherits a lock mid-update
+static void before_fork(void) {
+    spin_lock(&segment_lock);
+    spin_lock(&large_lock);
+    for (int c = 0; c < SA_NUM_CLASSES; c++) spin_lock(&central[c].lock);
+}
+
+static void after_fork(void) {
+    for (int c = 0; c < SA_NUM_CLASSES; c++) spin_unlock(&central[c].lock);
+    spin_unlock(&large_lock);
+    spin_unlock(&segment_lock);
+}
+
+static void register_thread(void) {
+    if (atomic_load(&init_state) != 2) {
+        int expected = 0;
+        if (!atomic_compare_exchange_strong(&init_state, &expected, 1)) {
+            return;                     // Being set up (possibly by a malloc inside
+        }                               // pthread_atfork): retry on a later slow path
+        pthread_key_create(&cache_key, thread_exit_hook);
+        pthread_atfork(before_fork, after_fork, after_fork);
+        atomic_store(&init_state, 2);
+    }
+    tcache.registered = 1;
+    pthread_setspecific(cache_key, &tcache);
+}
+#endif
+
+// Move up to a batch from the central list (or a fresh slab) into this
+// thread's cache; returns one object for the caller
+static void* refill(int cls) {
+    if (!tcache.registered) register_thread();
+
+    Central* ce = &central[cls];
+    size_t size = class_sizes[cls];
+    int want = batch_for(cls);
+    void* head = NULL;
+    void** tail = &head;
+    int n = 0;
+
+    spin_lock(&ce->lock);
+    while (n < want && ce->free_list) {
+        void* p = ce->free_list;
+        ce->free_list = *(void**)p;
+        *tail = p;
+        tail = (void**)p;
+        n++;
+    }
+    while (n < want) {
+        if ((size_t)(ce->carve_end - ce->carve) < size) {
+            if (n > 0) break;
+            char* slab = new_slab();
+            if (!slab) break;
+            SlabHeader* h = (SlabHeader*)slab;
+            h->magic = SLAB_MAGIC;
+            h->cls = cls;
+            h->interior = 0;
+            h->obj_size = (unsigned)size;
+            h->objects = slab + HEADER_SIZE;
+            ce->carve = h->objects;
+            ce->carve_end = h->objects + ((SA_SLAB_SIZE - HEADER_SIZE) / size) * size;
+        }
+        void* p = ce->carve;            // Carved in address order
+        ce->carve += size;
+        *tail = p;
+        tail = (void**)p;
+        n++;
+    }
+    spin_unlock(&ce->lock);
+
+    if (n == 0) return NULL;
+    *tail = NULL;
+    tcache.classes[cls].head = *(void**)head;
+    tcache.classes[cls].count = n - 1;
+    return head;
+}
+
+// Give the first n cached objects of a class back to the central list
+static void release(int cls, int n) {
+    ClassCache* cc = &tcache.classes[cls];
+    void* first = cc->head;
+    void* last = first;
+    for (int i = 1; i < n; i++) last = *(void**)last;
+    cc->head = *(void**)last;
+    cc->count -= n;
+
+    Central* ce = &central[cls];
+    spin_lock(&ce->lock);
+    *(void**)last = ce->free_list;
+    ce->free_list = first;
+    spin_unlock(&ce->lock);
+}
+
+// ===== Large allocations =====
+
+static void* large_alloc(size_t size, size_t align, int zero) {
+    size_t offset = align > HEADER_SIZE ? align : HEADER_SIZE;
+    if (size > SIZE_MAX / 2) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    size_t need = round_up(offset + size, PAGE_SIZE);
+
+    char* base = NULL;
+    size_t map_size = need;
+    spin_lock(&large_lock);
+    for (int i = 0; i < large_cache_count; i++) {
+        // Reuse a mapping that fits without wasting more than half
+        if (large_cache[i].size >= need && large_cache[i].size / 2 <= need) {
+            base = (char*)large_cache[i].base;
+            map_size = large_cache[i].size;
+            large_cache_bytes -= map_size;
+            large_cache[i] = large_cache[--large_cache_count];
+            break;
+        }
+    }
+    spin_unlock(&large_lock);
+
+    if (base) {
+        if (zero) memset(base + offset, 0, size);
+    } else {
+        base = (char*)os_map_aligned(map_size, SA_SLAB_SIZE);   // Fresh pages are zero
+        if (!base) {
+            errno = ENOMEM;
+            return NULL;
+        }
+        atomic_fetch_add_explicit(&stat_mapped, map_size, memory_order_relaxed);
+    }
+
+    SlabHeader* h = (SlabHeader*)base;
+    h->magic = SLAB_MAGIC;
+    h->cls = LARGE_CLASS;
+    h->interior = 0;
+    h->map_base = base;
+    h->map_size = map_size;
+    atomic_fetch_add_explicit(&stat_large_live, 1, memory_order_relaxed);
+    return base + offset;
+}
+
+static void large_free(SlabHeader* h) {
+    void* base = h->map_base;
+    size_t size = h->map_size;
+    atomic_fetch_sub_explicit(&stat_large_live, 1, memory_order_relaxed);
+
+    if (size <= LARGE_CACHE_MAX) {
+        spin_lock(&large_lock);
+        if (large_cache_count < LARGE_CACHE_ENTRIES && large_cache_bytes + size <= LARGE_CACHE_TOTAL) {
+            large_cache[large_cache_count].base = base;
+            large_cache[large_cache_count].size = size;
+            large_cache_count++;
+            large_cache_bytes += size;
+            base = NULL;
+        }
+        spin_unlock(&large_lock);
+    }
+    if (base) {
+        os_unmap(base, size);
+        atomic_fetch_sub_explicit(&stat_mapped, size, memory_order_relaxed);
+    }
+}
+
+// ===== Entry points =====
+
+void* sa_malloc(size_t size) {
+    if (size <= SA_MAX_SMALL) {
+        int cls = size_class(size);
+        ClassCache* cc = &tcache.classes[cls];
+        void* p = cc->head;
+        if (p) {                        // Fast path: pop from this thread's list
+            cc->head = *(void**)p;
+            cc->count--;
+            return p;
+        }
+        p = refill(cls);
+        if (!p) errno = ENOMEM;
+        return p;
+    }
+    return large_alloc(size, 0, 0);
+}
+
+void sa_free(void* ptr) {
+    if (!ptr) return;
+    SlabHeader* h = header_of(ptr);
+    if (h->magic != SLAB_MAGIC) fatal("size_alloc: free() of a pointer it did not allocate\n");
+
+    int cls = h->cls;
+    if (cls == LARGE_CLASS) {
+        large_free(h);
+        return;
+    }
+    if (h->interior) {                  // From memalign: find the object start
+        ptr = h->objects + (size_t)((char*)ptr - h->objects) / h->obj_size * h->obj_size;
+    }
+
+    ClassCache* cc = &tcache.classes[cls];
+    *(void**)ptr = cc->head;
+    cc->head = ptr;
+    if (++cc->count > 2 * batch_for(cls)) {
+        if (!tcache.registered) register_thread();
+        release(cls, batch_for(cls));
+    }
+}
+
+size_t sa_usable_size(void* ptr) {
+    if (!ptr) return 0;
+    SlabHeader* h = header_of(ptr);
+    if (h->cls == LARGE_CLASS) return (char*)h->map_base + h->map_size - (char*)ptr;
+    char* start = h->objects + (size_t)((char*)ptr - h->objects) / h->obj_size * h->obj_size;
+    return start + h->obj_size - (char*)ptr;
+}
+
+void* sa_calloc(size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    size_t total = count * size;
+    if (total > SA_MAX_SMALL) return large_alloc(total, 0, 1);
+    void* p = sa_malloc(total);
+    if (p) memset(p, 0, total);
+    return p;
+}
+
+void* sa_realloc(void* ptr, size_t size) {
+    if (!ptr) return sa_malloc(size);
+    if (size == 0) {
+        sa_free(ptr);
+        return NULL;
+    }
+    size_t old = sa_usable_size(ptr);
+    if (size <= old && size >= old / 2) return ptr;     // Still a good fit
+
+    void* p = sa_malloc(size);
+    if (!p) return NULL;
+    memcpy(p, ptr, old < size ? old : size);
+    sa_free(ptr);
+    return p;
+}
+
+void* sa_memalign(size_t align, size_t size) {
+    if (align == 0 || (align & (align - 1))) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (align <= 16) return sa_malloc(size);
+    if (align > SA_SLAB_SIZE / 4) {     // The header must stay in the first slab-sized block
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (size + align - 1 <= SA_MAX_SMALL && size <= SA_MAX_SMALL) {
+        char* p = (char*)sa_malloc(size + align - 1);
+        if (!p) return NULL;
+        char* aligned = (char*)round_up((size_t)p, align);
+        if (aligned != p) header_of(p)->interior = 1;
+        return aligned;
+    }
+    return large_alloc(size, align, 0);
+}
+
+void sa_get_stats(SaStats* out) {
+    out->mapped = atomic_load(&stat_mapped);
+    out->small_slabs = atomic_load(&stat_slabs);
+    out->large_live = atomic_load(&stat_large_live);
+    spin_lock(&large_lock);
+    out->large_cached = large_cache_bytes;
+    spin_unlock(&large_lock);
+}
+
+// ===== Replacing malloc =====
+
+#ifdef SIZE_ALLOC_OVERRIDE
+void* malloc(size_t size) { return sa_malloc(size); }
+void free(void* ptr) { sa_free(ptr); }
+void* calloc(size_t count, size_t size) { return sa_calloc(count, size); }
+void* realloc(void* ptr, size_t size) { return sa_realloc(ptr, size); }
+void* memalign(size_t align, size_t size) { return sa_memalign(align, size); }
+void* aligned_alloc(size_t align, size_t size) { return sa_memalign(align, size); }
+void* valloc(size_t size) { return sa_memalign(PAGE_SIZE, size); }
+void* pvalloc(size_t size) { return sa_memalign(PAGE_SIZE, round_up(size, PAGE_SIZE)); }
+size_t malloc_usable_size(void* ptr) { return sa_usable_size(ptr); }
+
+int posix_memalign(void** out, size_t align, size_t size) {
+    if (align < sizeof(void*) || (align & (align - 1))) return EINVAL;
+    void* p = sa_memalign(align, size);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+#endif
@@ -0,0 +1,60 @@
+#ifndef SIZE_ALLOC_H
+#define SIZE_ALLOC_H
+
+/*
+ * Size-class general-purpose allocator
+ *
+ * A drop-in malloc built from the pieces of this module:
+ *   - like the pools (03, objpool.c): every small size is rounded up to
+ *     one of 41 size classes (8 B .. 32 KB), and each class has its own
+ *     slabs of equal-sized objects
+ *   - like the arena (arena.c): slabs are bump-allocated out of big
+ *     mmap'd segments
+ *   - like objpool's magazines: each thread caches free objects per
+ *     class and trades them with a central list in batches
+ *   - bigger requests get their own mmap (with a small cache of
+ *     recently freed mappings)
+ *
+ *   size      8 16 32 48 ... 128 | 160 192 224 256 | 320 ... 512 | ...
+ *   step        16 up to 128     |  4 classes per power of two
+ *
+ * Above 64 bytes, at most 20% (typically ~10%) of a block is padding.
+ *
+ * Use directly (sa_malloc/sa_free/...), or build as a shared library
+ * that replaces malloc in any program:
+ *
+ *   gcc -O2 -shared -fPIC -DSIZE_ALLOC_OVERRIDE size_alloc.c -o libsizealloc.so -pthread
+ *   LD_PRELOAD=./libsizealloc.so ./some_program
+ *
+ * Memory of small classes is reused but never returned to the OS.
+ * Build: add size_alloc.c to the compile line (-pthread on Linux).
+ */
+
+#include <stddef.h>
+
+#define SA_NUM_CLASSES 41
+#define SA_MAX_SMALL 32768
+#define SA_SLAB_SIZE (256 * 1024)       // Slabs are aligned to this
+
+void* sa_malloc(size_t size);
+void sa_free(void* ptr);
+void* sa_calloc(size_t count, size_t size);
+void* sa_realloc(void* ptr, size_t size);
+void* sa_memalign(size_t align, size_t size);   // align <= SA_SLAB_SIZE / 4
+size_t sa_usable_size(void* ptr);
+
+// Return the calling thread's cached objects to the central lists.
+// Runs automatically at thread exit on POSIX.
+void sa_thread_flush(void);
+
+typedef struct {
+    size_t mapped;                      // Bytes obtained from the OS
+    size_t small_slabs;
+    size_t large_live;                  // Live large allocations
+    size_t large_cached;                // Freed mappings kept for reuse
+} SaStats;
+
+void sa_get_stats(SaStats* out);
+size_t sa_class_size(int cls);
+
+#endif
@@ -0,0 +1,348 @@
+/*
+ * Work-Stealing Thread Pool
+ *
+ * Earlier examples create a thread per job and join it right away.
+ * Creating a thread costs tens of microseconds, so tiny jobs spend
+ * more time starting than working. A pool keeps N threads alive and
+ * feeds them tasks; work stealing balances load without a shared queue.
+ *
+ * Shows: futures, continuations, recursive fork-join with helping
+ * join, parallel_for with automatic grain size, and per-worker stats.
+ *
+ * Build: gcc -o 06_work_stealing 06_work_stealing.c thread_pool.c -pthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <stdatomic.h>
+
+#include "thread_pool.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <pthread.h>
+    #include <time.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+#define FIB_N 32
+#define FIB_CUTOFF 18           // Below this, recursion runs serially
+#define IMAGE_SIZE 4096
+#define TINY_TASKS 100000
+#define RAW_THREADS 2000
+
+ThreadPool* pool;
+
+// ===== 1. Futures =====
+
+void* sum_range_task(void* arg) {
+    long n = (long)(intptr_t)arg;
+    long long sum = 0;
+    for (long i = 1; i <= n; i++) sum += i;
+    return (void*)(intptr_t)(sum % 1000000007);
+}
+
+void demo_futures(void) {
+    printf("--- Futures ---\n");
+    Future* futures[8];
+    for (int i = 0; i < 8; i++) {
+        futures[i] = pool_submit(pool, sum_range_task, (void*)(intptr_t)((i + 1) * 1000000L));
+    }
+    for (int i = 0; i < 8; i++) {
+        long result = (long)(intptr_t)future_wait(pool, futures[i]);
+        printf("  sum(1..%dM) mod p = %ld\n", i + 1, result);
+        future_release(futures[i]);
+    }
+    printf("\n");
+}
+
+// ===== 2. Continuations =====
+
+typedef struct {
+    int* data;
+    int count;
+} Buffer;
+
+void* load_stage(void* arg) {
+    int count = (int)(intptr_t)arg;
+    Buffer* b = (Buffer*)malloc(sizeof(Buffer));
+    b->data = (int*)malloc(count * sizeof(int));
+    b->count = count;
+    for (int i = 0; i < count; i++) b->data[i] = (int)((i * 7919LL) % 1000);
+    return b;
+}
+
+void* filter_stage(void* prev, void* arg) {
+    Buffer* b = (Buffer*)prev;
+    int threshold = (int)(intptr_t)arg;
+    int kept = 0;
+    for (int i = 0; i < b->count; i++) {
+        if (b->data[i] >= threshold) b->data[kept++] = b->data[i];
+    }
+    b->count = kept;
+    return b;
+}
+
+void* average_stage(void* prev, void* arg) {
+    (void)arg;
+    Buffer* b = (Buffer*)prev;
+    long long sum = 0;
+    for (int i = 0; i < b->count; i++) sum += b->data[i];
+    int avg = b->count ? (int)(sum / b->count) : 0;
+    printf("  pipeline: %d values kept, average %d\n", b->count, avg);
+    free(b->data);
+    free(b);
+    return (void*)(intptr_t)avg;
+}
+
+void demo_continuations(void) {
+    printf("--- Continuations: load -> filter -> average ---\n");
+    Future* loaded = pool_submit(pool, load_stage, (void*)(intptr_t)1000000);
+    Future* filtered = future_then(pool, loaded, filter_stage, (void*)(intptr_t)500);
+    Future* averaged = future_then(pool, filtered, average_stage, NULL);
+
+    // Intermediate futures can be dropped right away
+    future_release(loaded);
+    future_release(filtered);
+
+    future_wait(pool, averaged);
+    future_release(averaged);
+    printf("\n");
+}
+
+// ===== 3. Recursive fork-join =====
+
+long fib_serial(int n) {
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+void* fib_task(void* arg) {
+    int n = (int)(intptr_t)arg;
+    if (n < FIB_CUTOFF) return (void*)(intptr_t)fib_serial(n);
+
+    // Fork one half, do the other, then join. The join runs other
+    // tasks while waiting, so every worker can be inside a join
+    // without the pool deadlocking.
+    Future* left = pool_submit(pool, fib_task, (void*)(intptr_t)(n - 1));
+    long right = (long)(intptr_t)fib_task((void*)(intptr_t)(n - 2));
+    long result = (long)(intptr_t)future_wait(pool, left) + right;
+    future_release(left);
+    return (void*)(intptr_t)result;
+}
+
+void demo_fork_join(void) {
+    printf("--- Recursive fork-join: fib(%d) ---\n", FIB_N);
+
+    double start = get_time_ms();
+    long serial = fib_serial(FIB_N);
+    double serial_ms = get_time_ms() - start;
+
+    start = get_time_ms();
+    Future* f = pool_submit(pool, fib_task, (void*)(intptr_t)FIB_N);
+    long parallel = (long)(intptr_t)future_wait(pool, f);
+    future_release(f);
+    double parallel_ms = get_time_ms() - start;
+
+    printf("  serial:   %ld in %.1f ms\n", serial, serial_ms);
+    printf("  pool:     %ld in %.1f ms (%.2fx)\n\n", parallel, parallel_ms, serial_ms / parallel_ms);
+}
+
+// ===== 4. parallel_for =====
+
+typedef struct {
+    uint8_t* pixels;
+    int width;
+} Image;
+
+void brighten_rows(long begin, long end, void* ctx) {
+    Image* img = (Image*)ctx;
+    for (long y = begin; y < end; y++) {
+        uint8_t* row = img->pixels + y * img->width;
+        for (int x = 0; x < img->width; x++) {
+            // Gamma-ish curve: enough math to be worth parallelizing
+            double v = row[x] / 255.0;
+            row[x] = (uint8_t)(sqrt(v) * 255.0);
+        }
+    }
+}
+
+// Raw threads for comparison: one per chunk, like 03_mutex.c
+typedef struct {
+    Image* img;
+    long begin, end;
+} RawChunk;
+
+THREAD_FUNC raw_chunk_thread(void* arg) {
+    RawChunk* c = (RawChunk*)arg;
+    brighten_rows(c->begin, c->end, c->img);
+    THREAD_RETURN;
+}
+
+void brighten_raw_threads(Image* img, int height, int num_threads) {
+    RawChunk chunks[64];
+    #ifdef _WIN32
+    HANDLE threads[64];
+    #else
+    pthread_t threads[64];
+    #endif
+    for (int i = 0; i < num_threads; i++) {
+        chunks[i].img = img;
+        chunks[i].begin = (long)height * i / num_threads;
+        chunks[i].end = (long)height * (i + 1) / num_threads;
+        #ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, raw_chunk_thread, &chunks[i], 0, NULL);
+        #else
+        pthread_create(&threads[i], NULL, raw_chunk_thread, &chunks[i]);
+        #endif
+    }
+    for (int i = 0; i < num_threads; i++) {
+        #ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+        #else
+        pthread_join(threads[i], NULL);
+        #endif
+    }
+}
+
+void fill_image(Image* img) {
+    for (long i = 0; i < (long)IMAGE_SIZE * IMAGE_SIZE; i++) {
+        img->pixels[i] = (uint8_t)(i * 31);
+    }
+}
+
+void demo_parallel_for(void) {
+    printf("--- parallel_for: brighten %dx%d image ---\n", IMAGE_SIZE, IMAGE_SIZE);
+    Image img;
+    img.width = IMAGE_SIZE;
+    img.pixels = (uint8_t*)malloc((size_t)IMAGE_SIZE * IMAGE_SIZE);
+    int threads = pool_num_threads(pool);
+    if (threads > 64) threads = 64;
+
+    fill_image(&img);
+    double start = get_time_ms();
+    brighten_rows(0, IMAGE_SIZE, &img);
+    double serial_ms = get_time_ms() - start;
+    long checksum_serial = 0;
+    for (long i = 0; i < (long)IMAGE_SIZE * IMAGE_SIZE; i += 4099) checksum_serial += img.pixels[i];
+
+    fill_image(&img);
+    start = get_time_ms();
+    brighten_raw_threads(&img, IMAGE_SIZE, threads);
+    double raw_ms = get_time_ms() - start;
+
+    fill_image(&img);
+    start = get_time_ms();
+    parallel_for(pool, 0, IMAGE_SIZE, 0, brighten_rows, &img);
+    double pool_ms = get_time_ms() - start;
+    long checksum_pool = 0;
+    for (long i = 0; i < (long)IMAGE_SIZE * IMAGE_SIZE; i += 4099) checksum_pool += img.pixels[i];
+
+    printf("  serial:          %7.1f ms\n", serial_ms);
+    printf("  %2d raw threads:  %7.1f ms\n", threads, raw_ms);
+    printf("  pool (auto):     %7.1f ms  %s\n\n", pool_ms,
+           checksum_pool == checksum_serial ? "(matches serial)" : "(MISMATCH!)");
+    free(img.pixels);
+}
+
+// ===== 5. Per-task overhead =====
+
+atomic_long tiny_done;
+
+void* counting_task(void* arg) {
+    (void)arg;
+    atomic_fetch_add_explicit(&tiny_done, 1, memory_order_relaxed);
+    return NULL;
+}
+
+// Spawned from inside a task, pushes go to the worker's own deque
+void* spawner_task(void* arg) {
+    (void)arg;
+    for (int i = 0; i < TINY_TASKS; i++) pool_spawn(pool, counting_task, NULL);
+    return NULL;
+}
+
+THREAD_FUNC empty_thread(void* arg) {
+    (void)arg;
+    THREAD_RETURN;
+}
+
+void demo_overhead(void) {
+    printf("--- Overhead per tiny task ---\n");
+
+    double start = get_time_ms();
+    for (int i = 0; i < RAW_THREADS; i++) {
+        #ifdef _WIN32
+        HANDLE t = CreateThread(NULL, 0, empty_thread, NULL, 0, NULL);
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+        #else
+        pthread_t t;
+        pthread_create(&t, NULL, empty_thread, NULL);
+        pthread_join(t, NULL);
+        #endif
+    }
+    double raw_us = (get_time_ms() - start) * 1000.0 / RAW_THREADS;
+
+    atomic_store(&tiny_done, 0);
+    start = get_time_ms();
+    Future* f = pool_submit(pool, spawner_task, NULL);
+    future_wait(pool, f);
+    future_release(f);
+    while (atomic_load(&tiny_done) < TINY_TASKS) {
+        pool_run_pending(pool);  // Help instead of spinning idle
+    }
+    double pool_us = (get_time_ms() - start) * 1000.0 / TINY_TASKS;
+
+    printf("  create+join thread: %7.2f us/task\n", raw_us);
+    printf("  pool_spawn:         %7.2f us/task\n\n", pool_us);
+}
+
+int main(int argc, char* argv[]) {
+    int threads = argc >= 2 ? atoi(argv[1]) : 0;
+
+    printf("=== Work-Stealing Thread Pool ===\n\n");
+    pool = pool_create(threads);
+    printf("Workers: %d\n\n", pool_num_threads(pool));
+
+    demo_futures();
+    demo_continuations();
+    demo_fork_join();
+    demo_parallel_for();
+    demo_overhead();
+
+    printf("--- Worker stats ---\n");
+    printf("  %-8s %10s %10s %8s\n", "worker", "executed", "stolen", "slept");
+    for (int i = 0; i < pool_num_threads(pool); i++) {
+        WorkerStats s;
+        pool_get_stats(pool, i, &s);
+        printf("  %-8d %10ld %10ld %8ld\n", i, s.executed, s.stolen, s.slept);
+    }
+    printf("  (tasks run by main while helping are not counted)\n");
+
+    pool_destroy(pool);
+
+    printf("\n=== Complete ===\n");
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
@@ -0,0 +1,629 @@
+/*
+ * Lock-Free MPMC Queue
+ *
+ * BoundedBuffer in 04_producer_consumer.c takes one mutex for every
+ * item, so all producers and consumers line up behind each other.
+ * This is Dmitry Vyukov's bounded MPMC queue: each slot carries a
+ * sequence number that says whose turn it is, so threads only
+ * contend on a single CAS of the head or tail index.
+ *
+ * Also shows batch enqueue/dequeue (one CAS for many items) and a
+ * blocking wrapper that sleeps on a futex instead of spinning when
+ * the queue is empty or full.
+ *
+ * Usage: 07_lockfree_queue [max_threads] [items]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+    typedef CRITICAL_SECTION mutex_t;
+    typedef CONDITION_VARIABLE cond_t;
+
+    void mutex_init(mutex_t* m) { InitializeCriticalSection(m); }
+    void mutex_lock(mutex_t* m) { EnterCriticalSection(m); }
+    void mutex_unlock(mutex_t* m) { LeaveCriticalSection(m); }
+    void mutex_destroy(mutex_t* m) { DeleteCriticalSection(m); }
+
+    void cond_init(cond_t* c) { InitializeConditionVariable(c); }
+    void cond_wait(cond_t* c, mutex_t* m) { SleepConditionVariableCS(c, m, INFINITE); }
+    void cond_signal(cond_t* c) { WakeConditionVariable(c); }
+    void cond_broadcast(cond_t* c) { WakeAllConditionVariable(c); }
+    void cond_destroy(cond_t* c) { (void)c; }
+
+    // WaitOnAddress is Windows' futex (link with -lsynchronization)
+    void futex_wait(atomic_uint* addr, unsigned expected) {
+        WaitOnAddress((volatile void*)addr, &expected, sizeof(expected), INFINITE);
+    }
+    void futex_wake(atomic_uint* addr, int all) {
+        if (all) WakeByAddressAll((void*)addr);
+        else WakeByAddressSingle((void*)addr);
+    }
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    }
+    void thread_join(thread_t t) {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <pthread.h>
+    #include <time.h>
+    #include <unistd.h>
+    #include <limits.h>
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+    typedef pthread_mutex_t mutex_t;
+    typedef pthread_cond_t cond_t;
+
+    void mutex_init(mutex_t* m) { pthread_mutex_init(m, NULL); }
+    void mutex_lock(mutex_t* m) { pthread_mutex_lock(m); }
+    void mutex_unlock(mutex_t* m) { pthread_mutex_unlock(m); }
+    void mutex_destroy(mutex_t* m) { pthread_mutex_destroy(m); }
+
+    void cond_init(cond_t* c) { pthread_cond_init(c, NULL); }
+    void cond_wait(cond_t* c, mutex_t* m) { pthread_cond_wait(c, m); }
+    void cond_signal(cond_t* c) { pthread_cond_signal(c); }
+    void cond_broadcast(cond_t* c) { pthread_cond_broadcast(c); }
+    void cond_destroy(cond_t* c) { pthread_cond_destroy(c); }
+
+    // Sleep only if *addr still equals expected - no lost wakeups
+    void futex_wait(atomic_uint* addr, unsigned expected) {
+        syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+    }
+    void futex_wake(atomic_uint* addr, int all) {
+        syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, NULL, NULL, 0);
+    }
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        pthread_create(t, NULL, fn, arg);
+    }
+    void thread_join(thread_t t) {
+        pthread_join(t, NULL);
+    }
+
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define cpu_relax() __builtin_ia32_pause()
+#else
+    #define cpu_relax() ((void)0)
+#endif
+
+#define CACHE_LINE 64
+#define QUEUE_CAPACITY 1024     // Power of two
+#define BATCH_SIZE 32
+#define SPIN_LIMIT 200          // Spins before sleeping in the blocking wrapper
+#define MAX_THREADS 64
+
+// ===== Vyukov MPMC Queue =====
+//
+// Slot i holds sequence number s:
+//   s == pos        -> empty, producer for position pos may write
+//   s == pos + 1    -> full, consumer for position pos may read
+//   s == pos + size -> emptied, ready for the producer one lap later
+//
+// head and tail live on their own cache lines: producers hammer one,
+// consumers the other, and neither invalidates the other's line.
+
+typedef struct {
+    atomic_size_t seq;
+    long value;
+} Slot;
+
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_size_t tail;    // Next position to enqueue
+    _Alignas(CACHE_LINE) atomic_size_t head;    // Next position to dequeue
+    _Alignas(CACHE_LINE) Slot* slots;
+    size_t mask;
+} MPMCQueue;
+
+void mpmc_init(MPMCQueue* q, size_t capacity) {
+    q->slots = (Slot*)malloc(capacity * sizeof(Slot));
+    q->mask = capacity - 1;
+    for (size_t i = 0; i < capacity; i++) atomic_init(&q->slots[i].seq, i);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->head, 0);
+}
+
+void mpmc_destroy(MPMCQueue* q) {
+    free(q->slots);
+}
+
+int mpmc_try_enqueue(MPMCQueue* q, long value) {
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    while (1) {
+        Slot* slot = &q->slots[pos & q->mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            // Our turn: claim the position (CAS updates pos on failure)
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                slot->value = value;
+                atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0;  // Slot still holds last lap's item: full
+        } else {
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        }
+    }
+}
+
+int mpmc_try_dequeue(MPMCQueue* q, long* value) {
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    while (1) {
+        Slot* slot = &q->slots[pos & q->mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                *value = slot->value;
+                atomic_store_explicit(&slot->seq, pos + q->mask + 1, memory_order_release);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0;  // Producer hasn't filled it yet: empty
+        } else {
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+        }
+    }
+}
+
+// Claim up to n consecutive free slots with one CAS. A slot that
+// looked free stays free until someone moves tail past it, and our
+// CAS guarantees nobody did.
+int mpmc_try_enqueue_batch(MPMCQueue* q, const long* values, int n) {
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    while (1) {
+        int count = 0;
+        while (count < n) {
+            Slot* slot = &q->slots[(pos + count) & q->mask];
+            if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + count) break;
+            count++;
+        }
+        if (count == 0) {
+            size_t seq = atomic_load_explicit(&q->slots[pos & q->mask].seq, memory_order_acquire);
+            if ((intptr_t)seq - (intptr_t)pos < 0) return 0;     // Full
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + count,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            for (int i = 0; i < count; i++) {
+                Slot* slot = &q->slots[(pos + i) & q->mask];
+                slot->value = values[i];
+                atomic_store_explicit(&slot->seq, pos + i + 1, memory_order_release);
+            }
+            return count;
+        }
+    }
+}
+
+int mpmc_try_dequeue_batch(MPMCQueue* q, long* values, int n) {
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    while (1) {
+        int count = 0;
+        while (count < n) {
+            Slot* slot = &q->slots[(pos + count) & q->mask];
+            if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + count + 1) break;
+            count++;
+        }
+        if (count == 0) {
+            size_t seq = atomic_load_explicit(&q->slots[pos & q->mask].seq, memory_order_acquire);
+            if ((intptr_t)seq - (intptr_t)(pos + 1) < 0) return 0;  // Empty
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + count,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            for (int i = 0; i < count; i++) {
+                Slot* slot = &q->slots[(pos + i) & q->mask];
+                values[i] = slot->value;
+                atomic_store_explicit(&slot->seq, pos + i + q->mask + 1, memory_order_release);
+            }
+            return count;
+        }
+    }
+}
+
+// ===== Blocking wrapper =====
+//
+// Spin briefly (the other side is usually microseconds away), then
+// sleep on a futex. Each side has an event counter: a waiter reads it,
+// registers, re-checks the queue, and sleeps only if the counter is
+// unchanged. The other side bumps the counter and wakes only when
+// someone is registered, so the fast path is one extra load.
+//
+// wake_pending stops a burst of pushes from making one futex_wake
+// syscall each while the woken thread is still getting scheduled:
+// the first signal claims it, a waiter re-arms it before sleeping.
+
+typedef struct {
+    atomic_uint event;
+    atomic_uint waiting;
+    atomic_uint wake_pending;
+} WaitSide;
+
+typedef struct {
+    MPMCQueue q;
+    _Alignas(CACHE_LINE) WaitSide not_empty;    // Consumers sleep here
+    _Alignas(CACHE_LINE) WaitSide not_full;     // Producers sleep here
+    atomic_int closed;
+} BlockingQueue;
+
+void wait_side_init(WaitSide* w) {
+    atomic_init(&w->event, 0);
+    atomic_init(&w->waiting, 0);
+    atomic_init(&w->wake_pending, 0);
+}
+
+void bq_init(BlockingQueue* bq, size_t capacity) {
+    mpmc_init(&bq->q, capacity);
+    wait_side_init(&bq->not_empty);
+    wait_side_init(&bq->not_full);
+    atomic_init(&bq->closed, 0);
+}
+
+void bq_destroy(BlockingQueue* bq) {
+    mpmc_destroy(&bq->q);
+}
+
+void bq_signal(WaitSide* w, int all) {
+    // Orders our enqueue/dequeue before reading 'waiting'
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&w->waiting, memory_order_relaxed) > 0 &&
+        !atomic_exchange(&w->wake_pending, 1)) {
+        atomic_fetch_add(&w->event, 1);
+        futex_wake(&w->event, all);
+    }
+}
+
+// Returns the event value to sleep on; caller re-checks, then sleeps
+unsigned bq_prepare_wait(WaitSide* w) {
+    unsigned key = atomic_load(&w->event);
+    atomic_fetch_add(&w->waiting, 1);
+    atomic_exchange(&w->wake_pending, 0);   // Re-arm wakeups
+    return key;
+}
+
+void bq_finish_wait(WaitSide* w, int sleep, unsigned key) {
+    if (sleep) {
+        futex_wait(&w->event, key);
+        atomic_store(&w->wake_pending, 0);  // Let the next push wake another
+    }
+    atomic_fetch_sub(&w->waiting, 1);
+}
+
+void bq_push_batch(BlockingQueue* bq, const long* values, int n) {
+    int done = 0;
+    int spins = 0;
+    while (done < n) {
+        int k = mpmc_try_enqueue_batch(&bq->q, values + done, n - done);
+        if (k > 0) {
+            done += k;
+            spins = 0;
+            bq_signal(&bq->not_empty, k > 1);
+            continue;
+        }
+        if (++spins < SPIN_LIMIT) {
+            cpu_relax();
+            continue;
+        }
+
+        unsigned key = bq_prepare_wait(&bq->not_full);
+        k = mpmc_try_enqueue_batch(&bq->q, values + done, n - done);
+        bq_finish_wait(&bq->not_full, k == 0, key);
+        if (k > 0) {
+            done += k;
+            bq_signal(&bq->not_empty, k > 1);
+        }
+        spins = 0;
+    }
+}
+
+void bq_push(BlockingQueue* bq, long value) {
+    bq_push_batch(bq, &value, 1);
+}
+
+// Returns number of items, 0 once closed and drained
+int bq_pop_batch(BlockingQueue* bq, long* values, int n) {
+    int spins = 0;
+    while (1) {
+        int k = mpmc_try_dequeue_batch(&bq->q, values, n);
+        if (k > 0) {
+            bq_signal(&bq->not_full, k > 1);
+            return k;
+        }
+        if (++spins < SPIN_LIMIT) {
+            cpu_relax();
+            continue;
+        }
+
+        unsigned key = bq_prepare_wait(&bq->not_empty);
+        k = mpmc_try_dequeue_batch(&bq->q, values, n);
+        int closed = atomic_load(&bq->closed);
+        bq_finish_wait(&bq->not_empty, k == 0 && !closed, key);
+        if (k > 0) {
+            bq_signal(&bq->not_full, k > 1);
+            return k;
+        }
+        if (closed) return 0;
+        spins = 0;
+    }
+}
+
+int bq_pop(BlockingQueue* bq, long* value) {
+    return bq_pop_batch(bq, value, 1);
+}
+
+// No more pushes: wake every sleeping consumer so it can see 'closed'
+void bq_close(BlockingQueue* bq) {
+    atomic_store(&bq->closed, 1);
+    atomic_fetch_add(&bq->not_empty.event, 1);
+    futex_wake(&bq->not_empty.event, 1);
+}
+
+// ===== BoundedBuffer from 04_producer_consumer.c (printf removed) =====
+
+typedef struct {
+    long* buffer;
+    int capacity;
+    int count;
+    int in;
+    int out;
+    mutex_t mutex;
+    cond_t not_empty;
+    cond_t not_full;
+    int done;
+} BoundedBuffer;
+
+void buffer_init(BoundedBuffer* buf, int capacity) {
+    buf->buffer = (long*)malloc(capacity * sizeof(long));
+    buf->capacity = capacity;
+    buf->count = 0;
+    buf->in = 0;
+    buf->out = 0;
+    buf->done = 0;
+    mutex_init(&buf->mutex);
+    cond_init(&buf->not_empty);
+    cond_init(&buf->not_full);
+}
+
+void buffer_destroy(BoundedBuffer* buf) {
+    free(buf->buffer);
+    mutex_destroy(&buf->mutex);
+    cond_destroy(&buf->not_empty);
+    cond_destroy(&buf->not_full);
+}
+
+void buffer_put(BoundedBuffer* buf, long item) {
+    mutex_lock(&buf->mutex);
+    while (buf->count == buf->capacity) cond_wait(&buf->not_full, &buf->mutex);
+    buf->buffer[buf->in] = item;
+    buf->in = (buf->in + 1) % buf->capacity;
+    buf->count++;
+    cond_signal(&buf->not_empty);
+    mutex_unlock(&buf->mutex);
+}
+
+int buffer_get(BoundedBuffer* buf, long* item) {
+    mutex_lock(&buf->mutex);
+    while (buf->count == 0 && !buf->done) cond_wait(&buf->not_empty, &buf->mutex);
+    if (buf->count == 0) {
+        mutex_unlock(&buf->mutex);
+        return 0;
+    }
+    *item = buf->buffer[buf->out];
+    buf->out = (buf->out + 1) % buf->capacity;
+    buf->count--;
+    cond_signal(&buf->not_full);
+    mutex_unlock(&buf->mutex);
+    return 1;
+}
+
+void buffer_set_done(BoundedBuffer* buf) {
+    mutex_lock(&buf->mutex);
+    buf->done = 1;
+    cond_broadcast(&buf->not_empty);
+    mutex_unlock(&buf->mutex);
+}
+
+// ===== Benchmark =====
+
+typedef enum { IMPL_MUTEX, IMPL_LOCKFREE, IMPL_BATCH } Impl;
+
+typedef struct {
+    Impl impl;
+    BoundedBuffer* buf;
+    BlockingQueue* bq;
+    long first, count;          // Producer: items [first, first + count)
+    long long sum;              // Consumer: checksum of what it got
+    long received;
+} BenchArg;
+
+THREAD_FUNC producer_thread(void* arg) {
+    BenchArg* a = (BenchArg*)arg;
+    long end = a->first + a->count;
+
+    if (a->impl == IMPL_MUTEX) {
+        for (long i = a->first; i < end; i++) buffer_put(a->buf, i);
+    } else if (a->impl == IMPL_LOCKFREE) {
+        for (long i = a->first; i < end; i++) bq_push(a->bq, i);
+    } else {
+        long batch[BATCH_SIZE];
+        for (long i = a->first; i < end; ) {
+            int n = 0;
+            while (n < BATCH_SIZE && i < end) batch[n++] = i++;
+            bq_push_batch(a->bq, batch, n);
+        }
+    }
+    THREAD_RETURN;
+}
+
+THREAD_FUNC consumer_thread(void* arg) {
+    BenchArg* a = (BenchArg*)arg;
+    long v;
+
+    if (a->impl == IMPL_MUTEX) {
+        while (buffer_get(a->buf, &v)) {
+            a->sum += v;
+            a->received++;
+        }
+    } else if (a->impl == IMPL_LOCKFREE) {
+        while (bq_pop(a->bq, &v)) {
+            a->sum += v;
+            a->received++;
+        }
+    } else {
+        long batch[BATCH_SIZE];
+        int n;
+        while ((n = bq_pop_batch(a->bq, batch, BATCH_SIZE)) > 0) {
+            for (int i = 0; i < n; i++) a->sum += batch[i];
+            a->received += n;
+        }
+    }
+    THREAD_RETURN;
+}
+
+// pairs producers + pairs consumers move 'items' through the queue
+double run_bench(Impl impl, int pairs, long items) {
+    BoundedBuffer buf;
+    BlockingQueue* bq = NULL;
+    if (impl == IMPL_MUTEX) {
+        buffer_init(&buf, QUEUE_CAPACITY);
+    } else {
+        #ifdef _WIN32
+        bq = (BlockingQueue*)_aligned_malloc(sizeof(BlockingQueue), CACHE_LINE);
+        #else
+        bq = (BlockingQueue*)aligned_alloc(CACHE_LINE, sizeof(BlockingQueue));
+        #endif
+        bq_init(bq, QUEUE_CAPACITY);
+    }
+
+    thread_t producers[MAX_THREADS], consumers[MAX_THREADS];
+    BenchArg pargs[MAX_THREADS], cargs[MAX_THREADS];
+    long per = items / pairs;
+
+    double start = get_time_ms();
+    for (int i = 0; i < pairs; i++) {
+        cargs[i] = (BenchArg){ impl, &buf, bq, 0, 0, 0, 0 };
+        thread_create(&consumers[i], consumer_thread, &cargs[i]);
+    }
+    for (int i = 0; i < pairs; i++) {
+        pargs[i] = (BenchArg){ impl, &buf, bq, i * per, per, 0, 0 };
+        thread_create(&producers[i], producer_thread, &pargs[i]);
+    }
+    for (int i = 0; i < pairs; i++) thread_join(producers[i]);
+
+    if (impl == IMPL_MUTEX) buffer_set_done(&buf);
+    else bq_close(bq);
+
+    for (int i = 0; i < pairs; i++) thread_join(consumers[i]);
+    double elapsed = get_time_ms() - start;
+
+    // Every item exactly once
+    long total = per * pairs;
+    long long expected = (long long)total * (total - 1) / 2;
+    long long sum = 0;
+    long received = 0;
+    for (int i = 0; i < pairs; i++) {
+        sum += cargs[i].sum;
+        received += cargs[i].received;
+    }
+    if (sum != expected || received != total) {
+        printf("\n  CHECKSUM MISMATCH: got %ld items, expected %ld\n", received, total);
+    }
+
+    if (impl == IMPL_MUTEX) {
+        buffer_destroy(&buf);
+    } else {
+        bq_destroy(bq);
+        #ifdef _WIN32
+        _aligned_free(bq);
+        #else
+        free(bq);
+        #endif
+    }
+    return total / elapsed / 1000.0;  // Million items per second
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = argc >= 2 ? atoi(argv[1]) : MAX_THREADS;
+    long items = argc >= 3 ? atol(argv[2]) : 2000000;
+    if (max_threads < 2) max_threads = 2;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+    printf("=== Lock-Free MPMC Queue ===\n\n");
+    printf("Capacity %d, %ld items per run, batch size %d\n", QUEUE_CAPACITY, items, BATCH_SIZE);
+    printf("Threads = producers + consumers (half each)\n\n");
+
+    printf("%8s %14s %14s %14s\n", "threads", "mutex+cond", "lock-free", "lock-free x32");
+    printf("%8s %14s %14s %14s\n", "", "(M items/s)", "(M items/s)", "(M items/s)");
+
+    for (int threads = 2; threads <= max_threads; threads *= 2) {
+        int pairs = threads / 2;
+        double mutex_rate = run_bench(IMPL_MUTEX, pairs, items);
+        double lf_rate = run_bench(IMPL_LOCKFREE, pairs, items);
+        double batch_rate = run_bench(IMPL_BATCH, pairs, items);
+        printf("%8d %14.2f %14.2f %14.2f\n", threads, mutex_rate, lf_rate, batch_rate);
+    }
+
+    printf("\n=== Complete ===\n");
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Why it's faster:
+ *
+ * Mutex queue per item:   lock -> write -> signal -> unlock
+ *   Every thread fights for the same lock line; a waiter that loses
+ *   sleeps in the kernel and pays a context switch to wake up.
+ *
+ * MPMC queue per item:    read slot seq -> CAS tail -> write -> store seq
+ *   Producers only touch tail, consumers only head. Items in
+ *   different slots don't interfere at all.
+ *
+ * Batches amortize the CAS (and the cache miss on head/tail) over
+ * many items, which matters most when the queue is contended.
+ *
+ * Lock-free isn't wait-free: a producer preempted between CAS and
+ * "store seq" makes consumers of that slot wait. Fine in practice,
+ * but don't use this from signal handlers.
+ */
@@ -0,0 +1,294 @@
+/*
+ * Sharded Counters and Histograms
+ *
+ * 03_mutex.c shows that locking per increment is slow, and its
+ * "optimized" thread sidesteps the problem by adding a constant once.
+ * Real code can't do that: request metrics are bumped on every
+ * request, in every thread, and someone reads them while they change.
+ *
+ * Compares four ways to count from many threads:
+ *   mutex      - lock, ++, unlock
+ *   atomic     - one shared atomic_fetch_add (no lock, same cache line)
+ *   sharded    - sharded_stats.c: per-thread cache lines, summed on read
+ *   local      - plain thread-local variable, added once at the end
+ *                (the ceiling; only works if nobody reads mid-run)
+ * and the same for a latency histogram.
+ *
+ * Usage: 08_sharded_counters [max_threads] [ops_per_thread]
+ * Build: gcc -o 08_sharded_counters 08_sharded_counters.c sharded_stats.c -pthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "sharded_stats.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+    typedef CRITICAL_SECTION mutex_t;
+
+    void mutex_init(mutex_t* m) { InitializeCriticalSection(m); }
+    void mutex_lock(mutex_t* m) { EnterCriticalSection(m); }
+    void mutex_unlock(mutex_t* m) { LeaveCriticalSection(m); }
+    void mutex_destroy(mutex_t* m) { DeleteCriticalSection(m); }
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    }
+    void thread_join(thread_t t) {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+    void thread_sleep(int ms) { Sleep(ms); }
+
+    double get_time_ms(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+    }
+#else
+    #include <pthread.h>
+    #include <time.h>
+    #include <unistd.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+    typedef pthread_mutex_t mutex_t;
+
+    void mutex_init(mutex_t* m) { pthread_mutex_init(m, NULL); }
+    void mutex_lock(mutex_t* m) { pthread_mutex_lock(m); }
+    void mutex_unlock(mutex_t* m) { pthread_mutex_unlock(m); }
+    void mutex_destroy(mutex_t* m) { pthread_mutex_destroy(m); }
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        pthread_create(t, NULL, fn, arg);
+    }
+    void thread_join(thread_t t) {
+        pthread_join(t, NULL);
+    }
+    void thread_sleep(int ms) { usleep(ms * 1000); }
+
+    double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    }
+#endif
+
+#define MAX_THREADS 64
+
+typedef enum { MODE_MUTEX, MODE_ATOMIC, MODE_SHARDED, MODE_LOCAL } Mode;
+const char* mode_names[] = { "mutex", "atomic", "sharded", "local" };
+
+// ===== The contenders =====
+
+mutex_t counter_mutex;
+long long mutex_counter;
+_Alignas(64) atomic_llong atomic_counter;
+StatCounter sharded_counter;
+_Alignas(64) atomic_llong local_total;
+
+long long mutex_hist[STATS_HIST_BUCKETS];
+StatHistogram sharded_hist;
+
+typedef struct {
+    Mode mode;
+    int histogram;              // 0 = counter test, 1 = histogram test
+    long ops;
+    unsigned seed;
+} WorkerArg;
+
+atomic_int reader_stop;
+
+// Cheap per-thread "latency" values: xorshift, 0..~16K
+unsigned next_value(unsigned* s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s & 0x3FFF;
+}
+
+THREAD_FUNC worker_thread(void* arg) {
+    WorkerArg* a = (WorkerArg*)arg;
+    long ops = a->ops;
+
+    if (!a->histogram) {
+        switch (a->mode) {
+        case MODE_MUTEX:
+            for (long i = 0; i < ops; i++) {
+                mutex_lock(&counter_mutex);
+                mutex_counter++;
+                mutex_unlock(&counter_mutex);
+            }
+            break;
+        case MODE_ATOMIC:
+            for (long i = 0; i < ops; i++) {
+                atomic_fetch_add_explicit(&atomic_counter, 1, memory_order_relaxed);
+            }
+            break;
+        case MODE_SHARDED:
+            for (long i = 0; i < ops; i++) stat_counter_inc(&sharded_counter);
+            break;
+        case MODE_LOCAL: {
+            volatile long long local = 0;  // volatile: keep the loop honest
+            for (long i = 0; i < ops; i++) local = local + 1;
+            atomic_fetch_add(&local_total, local);
+            break;
+        }
+        }
+    } else {
+        unsigned seed = a->seed;
+        if (a->mode == MODE_MUTEX) {
+            for (long i = 0; i < ops; i++) {
+                int b = stat_hist_bucket(next_value(&seed));
+                mutex_lock(&counter_mutex);
+                mutex_hist[b]++;
+                mutex_unlock(&counter_mutex);
+            }
+        } else {
+            for (long i = 0; i < ops; i++) stat_hist_record(&sharded_hist, next_value(&seed));
+        }
+    }
+    THREAD_RETURN;
+}
+
+// Scrapes the metric while workers run, like a monitoring endpoint
+THREAD_FUNC reader_thread(void* arg) {
+    Mode mode = *(Mode*)arg;
+    while (!atomic_load(&reader_stop)) {
+        if (mode == MODE_SHARDED) {
+            stat_counter_read(&sharded_counter);
+        } else if (mode == MODE_ATOMIC) {
+            atomic_load(&atomic_counter);
+        } else if (mode == MODE_MUTEX) {
+            mutex_lock(&counter_mutex);
+            mutex_unlock(&counter_mutex);
+        }
+        thread_sleep(1);
+    }
+    THREAD_RETURN;
+}
+
+long long counter_value(Mode mode) {
+    switch (mode) {
+    case MODE_MUTEX: return mutex_counter;
+    case MODE_ATOMIC: return atomic_load(&atomic_counter);
+    case MODE_SHARDED: return stat_counter_read(&sharded_counter);
+    default: return atomic_load(&local_total);
+    }
+}
+
+void reset_all(void) {
+    mutex_counter = 0;
+    atomic_store(&atomic_counter, 0);
+    stat_counter_reset(&sharded_counter);
+    atomic_store(&local_total, 0);
+    memset(mutex_hist, 0, sizeof(mutex_hist));
+    stat_hist_destroy(&sharded_hist);
+    stat_hist_init(&sharded_hist, "latency");
+}
+
+// Returns ns per operation per thread
+double run(Mode mode, int histogram, int threads, long ops) {
+    thread_t handles[MAX_THREADS], reader;
+    WorkerArg args[MAX_THREADS];
+    reset_all();
+
+    atomic_store(&reader_stop, 0);
+    thread_create(&reader, reader_thread, &mode);
+
+    double start = get_time_ms();
+    for (int i = 0; i < threads; i++) {
+        args[i] = (WorkerArg){ mode, histogram, ops, 0x9E3779B9u * (i + 1) };
+        thread_create(&handles[i], worker_thread, &args[i]);
+    }
+    for (int i = 0; i < threads; i++) thread_join(handles[i]);
+    double elapsed = get_time_ms() - start;
+
+    atomic_store(&reader_stop, 1);
+    thread_join(reader);
+
+    long long expected = (long long)threads * ops;
+    long long got;
+    if (!histogram) {
+        got = counter_value(mode);
+    } else if (mode == MODE_MUTEX) {
+        got = 0;
+        for (int b = 0; b < STATS_HIST_BUCKETS; b++) got += mutex_hist[b];
+    } else {
+        HistSnapshot snap;
+        stat_hist_snapshot(&sharded_hist, &snap);
+        got = snap.count;
+    }
+    if (got != expected) {
+        printf("\n  %s: WRONG TOTAL %lld, expected %lld\n", mode_names[mode], got, expected);
+    }
+
+    return elapsed * 1e6 / ops;  // Wall time per op, per thread
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = argc >= 2 ? atoi(argv[1]) : 16;
+    long ops = argc >= 3 ? atol(argv[2]) : 2000000;
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+    printf("=== Sharded Counters and Histograms ===\n\n");
+    printf("%ld operations per thread, %d shards of %d bytes\n", ops, STATS_SHARDS, STATS_CACHE_LINE);
+    printf("A reader thread sums the metric every 1 ms during each run.\n");
+    printf("Numbers are ns per operation as seen by one thread (lower is better).\n\n");
+
+    mutex_init(&counter_mutex);
+    stat_counter_init(&sharded_counter, "requests");
+    stat_hist_init(&sharded_hist, "latency");
+
+    printf("--- Counter increment ---\n");
+    printf("%8s %10s %10s %10s %10s\n", "threads", "mutex", "atomic", "sharded", "local");
+    for (int t = 1; t <= max_threads; t *= 2) {
+        printf("%8d", t);
+        for (Mode m = MODE_MUTEX; m <= MODE_LOCAL; m++) {
+            printf(" %10.2f", run(m, 0, t, ops));
+        }
+        printf("\n");
+    }
+
+    printf("\n--- Histogram record ---\n");
+    printf("%8s %10s %10s\n", "threads", "mutex", "sharded");
+    for (int t = 1; t <= max_threads; t *= 2) {
+        double mutex_ns = run(MODE_MUTEX, 1, t, ops);
+        double sharded_ns = run(MODE_SHARDED, 1, t, ops);
+        printf("%8d %10.2f %10.2f\n", t, mutex_ns, sharded_ns);
+    }
+
+    printf("\nLast sharded histogram: ");
+    stat_hist_print(&sharded_hist);
+
+    stat_hist_destroy(&sharded_hist);
+    mutex_destroy(&counter_mutex);
+
+    printf("\n=== Complete ===\n");
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * What the numbers mean (on a multi-core machine):
+ *
+ * mutex    Grows with threads: every increment is a lock handoff.
+ * atomic   No lock, but the counter's cache line ping-pongs between
+ *          cores. ~5 ns alone, 50-100+ ns with many writers.
+ * sharded  Flat: each thread owns its line. Reads walk 32 lines -
+ *          microseconds, which is nothing at scrape frequency.
+ * local    The floor. Sharded gets close without giving up
+ *          live reads.
+ *
+ * False sharing check: remove _Alignas from CounterShard and watch
+ * "sharded" turn back into "atomic".
+ */
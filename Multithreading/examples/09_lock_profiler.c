@@ -0,0 +1,423 @@
+/*
+ * Lock Types and Lock Profiling
+ *
+ * 03_mutex.c and 05_deadlock.c use one kind of lock: the mutex.
+ * Before replacing one, find out which locks actually hurt. This
+ * example shows:
+ *   1. Spinlocks (ticket, MCS) vs mutex for tiny critical sections
+ *   2. Read-mostly data: mutex vs reader-writer lock vs seqlock
+ *   3. A profiled mutex: wait/hold/contention per call site
+ *   4. Runtime lock-order checking: the 05_deadlock.c bug, reported
+ *      without having to hit the actual deadlock
+ *
+ * Usage: 09_lock_profiler [max_threads]
+ * Build: gcc -o 09_lock_profiler 09_lock_profiler.c locks.c -pthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "locks.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+    typedef CRITICAL_SECTION mutex_t;
+
+    void mutex_init(mutex_t* m) { InitializeCriticalSection(m); }
+    void mutex_lock(mutex_t* m) { EnterCriticalSection(m); }
+    void mutex_unlock(mutex_t* m) { LeaveCriticalSection(m); }
+    void mutex_destroy(mutex_t* m) { DeleteCriticalSection(m); }
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    }
+    void thread_join(thread_t t) {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+    void thread_sleep(int ms) { Sleep(ms); }
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+    typedef pthread_mutex_t mutex_t;
+
+    void mutex_init(mutex_t* m) { pthread_mutex_init(m, NULL); }
+    void mutex_lock(mutex_t* m) { pthread_mutex_lock(m); }
+    void mutex_unlock(mutex_t* m) { pthread_mutex_unlock(m); }
+    void mutex_destroy(mutex_t* m) { pthread_mutex_destroy(m); }
+
+    void thread_create(thread_t* t, THREAD_FUNC (*fn)(void*), void* arg) {
+        pthread_create(t, NULL, fn, arg);
+    }
+    void thread_join(thread_t t) {
+        pthread_join(t, NULL);
+    }
+    void thread_sleep(int ms) { usleep(ms * 1000); }
+#endif
+
+#define MAX_THREADS 64
+#define SPIN_ITERS 200000
+#define READ_TEST_MS 300
+
+double elapsed_ms(unsigned long long start) {
+    return (locks_now_ns() - start) / 1e6;
+}
+
+// ===== 1. Spinlocks vs mutex =====
+
+typedef enum { SPIN_MUTEX, SPIN_TICKET, SPIN_MCS } SpinKind;
+
+mutex_t plain_mutex;
+TicketLock ticket;
+MCSLock mcs;
+long shared_counter;
+
+THREAD_FUNC spin_worker(void* arg) {
+    SpinKind kind = *(SpinKind*)arg;
+    MCSNode node;  // One per thread, reused for every acquisition
+
+    for (int i = 0; i < SPIN_ITERS; i++) {
+        switch (kind) {
+        case SPIN_MUTEX:
+            mutex_lock(&plain_mutex);
+            shared_counter++;
+            mutex_unlock(&plain_mutex);
+            break;
+        case SPIN_TICKET:
+            ticket_lock(&ticket);
+            shared_counter++;
+            ticket_unlock(&ticket);
+            break;
+        case SPIN_MCS:
+            mcs_lock(&mcs, &node);
+            shared_counter++;
+            mcs_unlock(&mcs, &node);
+            break;
+        }
+    }
+    THREAD_RETURN;
+}
+
+double run_spin(SpinKind kind, int threads) {
+    thread_t handles[MAX_THREADS];
+    shared_counter = 0;
+
+    unsigned long long start = locks_now_ns();
+    for (int i = 0; i < threads; i++) thread_create(&handles[i], spin_worker, &kind);
+    for (int i = 0; i < threads; i++) thread_join(handles[i]);
+    double ms = elapsed_ms(start);
+
+    if (shared_counter != (long)threads * SPIN_ITERS) {
+        printf("  LOST UPDATES: %ld of %ld\n", shared_counter, (long)threads * SPIN_ITERS);
+    }
+    return ms * 1e6 / ((double)threads * SPIN_ITERS);  // ns per lock/unlock
+}
+
+void demo_spinlocks(int max_threads) {
+    printf("--- 1. Tiny critical section: ns per lock+unlock ---\n");
+    printf("%8s %10s %10s %10s\n", "threads", "mutex", "ticket", "MCS");
+    for (int t = 1; t <= max_threads; t *= 2) {
+        double m = run_spin(SPIN_MUTEX, t);
+        double k = run_spin(SPIN_TICKET, t);
+        double q = run_spin(SPIN_MCS, t);
+        printf("%8d %10.1f %10.1f %10.1f\n", t, m, k, q);
+    }
+    printf("Ticket and MCS are fair (FIFO). MCS waiters each spin on their\n");
+    printf("own cache line, so it degrades least with many cores. With more\n");
+    printf("threads than cores, spinners burn the holder's time slice and\n");
+    printf("every spinlock collapses - the mutex sleeps instead.\n\n");
+}
+
+// ===== 2. Read-mostly data =====
+//
+// Invariant: b == 2 * a and c == a + b. A reader that sees it broken
+// read a half-written update ("torn read").
+
+typedef struct {
+    atomic_long a, b, c;
+} Config;
+
+typedef enum { READ_MUTEX, READ_RWLOCK, READ_SEQLOCK } ReadKind;
+
+Config config;
+RWLock rwlock;
+SeqLock seqlock;
+atomic_int read_stop;
+
+typedef struct {
+    ReadKind kind;
+    long reads;
+    long torn;
+} ReaderArg;
+
+void config_write(long v) {
+    atomic_store_explicit(&config.a, v, memory_order_relaxed);
+    atomic_store_explicit(&config.b, 2 * v, memory_order_relaxed);
+    atomic_store_explicit(&config.c, 3 * v, memory_order_relaxed);
+}
+
+void config_read(long* a, long* b, long* c) {
+    *a = atomic_load_explicit(&config.a, memory_order_relaxed);
+    *b = atomic_load_explicit(&config.b, memory_order_relaxed);
+    *c = atomic_load_explicit(&config.c, memory_order_relaxed);
+}
+
+THREAD_FUNC config_reader(void* arg) {
+    ReaderArg* r = (ReaderArg*)arg;
+    long a, b, c;
+
+    while (!atomic_load_explicit(&read_stop, memory_order_relaxed)) {
+        if (r->kind == READ_MUTEX) {
+            mutex_lock(&plain_mutex);
+            config_read(&a, &b, &c);
+            mutex_unlock(&plain_mutex);
+        } else if (r->kind == READ_RWLOCK) {
+            rwlock_read_lock(&rwlock);
+            config_read(&a, &b, &c);
+            rwlock_read_unlock(&rwlock);
+        } else {
+            unsigned start;
+            do {
+                start = seqlock_read_begin(&seqlock);
+                config_read(&a, &b, &c);
+            } while (seqlock_read_retry(&seqlock, start));
+        }
+        if (b != 2 * a || c != a + b) r->torn++;
+        r->reads++;
+    }
+    THREAD_RETURN;
+}
+
+THREAD_FUNC config_writer(void* arg) {
+    ReadKind kind = *(ReadKind*)arg;
+    long v = 0;
+    while (!atomic_load_explicit(&read_stop, memory_order_relaxed)) {
+        v++;
+        if (kind == READ_MUTEX) {
+            mutex_lock(&plain_mutex);
+            config_write(v);
+            mutex_unlock(&plain_mutex);
+        } else if (kind == READ_RWLOCK) {
+            rwlock_write_lock(&rwlock);
+            config_write(v);
+            rwlock_write_unlock(&rwlock);
+        } else {
+            seqlock_write_begin(&seqlock);
+            config_write(v);
+            seqlock_write_end(&seqlock);
+        }
+        thread_sleep(1);  // Config changes rarely
+    }
+    THREAD_RETURN;
+}
+
+double run_readers(ReadKind kind, int readers, long* torn) {
+    thread_t handles[MAX_THREADS], writer;
+    ReaderArg args[MAX_THREADS];
+    atomic_store(&read_stop, 0);
+    config_write(0);
+
+    thread_create(&writer, config_writer, &kind);
+    for (int i = 0; i < readers; i++) {
+        args[i] = (ReaderArg){ kind, 0, 0 };
+        thread_create(&handles[i], config_reader, &args[i]);
+    }
+    thread_sleep(READ_TEST_MS);
+    atomic_store(&read_stop, 1);
+
+    long reads = 0;
+    *torn = 0;
+    for (int i = 0; i < readers; i++) {
+        thread_join(handles[i]);
+        reads += args[i].reads;
+        *torn += args[i].torn;
+    }
+    thread_join(writer);
+    return reads / (READ_TEST_MS / 1000.0) / 1e6;  // Million reads/s
+}
+
+void demo_read_mostly(int max_threads) {
+    printf("--- 2. Read-mostly data: million reads/s (1 writer, 1 update/ms) ---\n");
+    printf("%8s %10s %10s %10s %8s\n", "readers", "mutex", "rwlock", "seqlock", "torn");
+    for (int t = 1; t <= max_threads; t *= 2) {
+        long torn_m, torn_r, torn_s;
+        double m = run_readers(READ_MUTEX, t, &torn_m);
+        double r = run_readers(READ_RWLOCK, t, &torn_r);
+        double s = run_readers(READ_SEQLOCK, t, &torn_s);
+        printf("%8d %10.2f %10.2f %10.2f %8ld\n", t, m, r, s, torn_m + torn_r + torn_s);
+    }
+    printf("This rwlock guards its state with a mutex, so a short read pays\n");
+    printf("two lock round trips; it wins only when reads take a while.\n");
+    printf("Seqlock readers never write shared memory at all.\n\n");
+}
+
+// ===== 3. Profiled mutexes =====
+
+ProfiledMutex inventory_lock;
+ProfiledMutex stats_lock;
+ProfiledMutex audit_lock;
+long inventory[16];
+long order_count;
+
+void busy_work(int n) {
+    volatile int x = 0;
+    for (int i = 0; i < n; i++) x = x + i;
+}
+
+THREAD_FUNC shop_worker(void* arg) {
+    int id = *(int*)arg;
+    for (int i = 0; i < 2000; i++) {
+        // Hot: every order holds this while "checking stock"
+        PROFILED_LOCK(&inventory_lock);
+        inventory[(id + i) & 15]--;
+        busy_work(2000);
+        PROFILED_UNLOCK(&inventory_lock);
+
+        // Short, frequent
+        PROFILED_LOCK(&stats_lock);
+        order_count++;
+        PROFILED_UNLOCK(&stats_lock);
+
+        // Rare
+        if (i % 100 == 0) {
+            PROFILED_LOCK(&audit_lock);
+            busy_work(500);
+            PROFILED_UNLOCK(&audit_lock);
+        }
+    }
+    THREAD_RETURN;
+}
+
+void demo_profiler(int threads) {
+    printf("--- 3. Lock profiler: %d threads placing orders ---\n", threads);
+    thread_t handles[MAX_THREADS];
+    int ids[MAX_THREADS];
+
+    profiled_reset_stats();
+    for (int i = 0; i < threads; i++) {
+        ids[i] = i;
+        thread_create(&handles[i], shop_worker, &ids[i]);
+    }
+    for (int i = 0; i < threads; i++) thread_join(handles[i]);
+
+    profiled_report();
+    printf("The top row is where to look: shrink what happens under\n");
+    printf("inventory_lock or split it per item.\n\n");
+}
+
+// ===== 4. Lock-order checking =====
+
+ProfiledMutex account_a_lock;
+ProfiledMutex account_b_lock;
+int account_a = 1000;
+int account_b = 1000;
+
+void transfer_a_to_b(int amount) {
+    PROFILED_LOCK(&account_a_lock);
+    PROFILED_LOCK(&account_b_lock);
+    account_a -= amount;
+    account_b += amount;
+    PROFILED_UNLOCK(&account_b_lock);
+    PROFILED_UNLOCK(&account_a_lock);
+}
+
+void transfer_b_to_a(int amount) {
+    // The 05_deadlock.c bug: opposite order
+    PROFILED_LOCK(&account_b_lock);
+    PROFILED_LOCK(&account_a_lock);
+    account_b -= amount;
+    account_a += amount;
+    PROFILED_UNLOCK(&account_a_lock);
+    PROFILED_UNLOCK(&account_b_lock);
+}
+
+void transfer_b_to_a_fixed(int amount) {
+    PROFILED_LOCK_PAIR(&account_b_lock, &account_a_lock);  // Sorted internally
+    account_b -= amount;
+    account_a += amount;
+    PROFILED_UNLOCK(&account_a_lock);
+    PROFILED_UNLOCK(&account_b_lock);
+}
+
+void demo_lock_order(void) {
+    printf("--- 4. Lock-order checking ---\n");
+    printf("One thread, run one after another - nothing can hang here,\n");
+    printf("but two threads running these at once could:\n");
+
+    int before = profiled_order_violations();
+    transfer_a_to_b(100);
+    transfer_b_to_a(200);
+    printf("Violations reported: %d\n\n", profiled_order_violations() - before);
+
+    before = profiled_order_violations();
+    transfer_a_to_b(100);
+    transfer_b_to_a_fixed(200);
+    printf("With PROFILED_LOCK_PAIR (same global order): %d new violations\n",
+           profiled_order_violations() - before);
+    printf("Balances: A=%d B=%d\n\n", account_a, account_b);
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = argc >= 2 ? atoi(argv[1]) : 8;
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+    printf("=== Lock Types and Lock Profiling ===\n\n");
+
+    mutex_init(&plain_mutex);
+    ticket_init(&ticket);
+    mcs_init(&mcs);
+    rwlock_init(&rwlock);
+    seqlock_init(&seqlock);
+    profiled_init(&inventory_lock, "inventory");
+    profiled_init(&stats_lock, "stats");
+    profiled_init(&audit_lock, "audit");
+    profiled_init(&account_a_lock, "account_a");
+    profiled_init(&account_b_lock, "account_b");
+
+    demo_spinlocks(max_threads);
+    demo_read_mostly(max_threads);
+    demo_profiler(max_threads);
+    demo_lock_order();
+
+    profiled_destroy(&inventory_lock);
+    profiled_destroy(&stats_lock);
+    profiled_destroy(&audit_lock);
+    profiled_destroy(&account_a_lock);
+    profiled_destroy(&account_b_lock);
+    rwlock_destroy(&rwlock);
+    mutex_destroy(&plain_mutex);
+
+    printf("=== Complete ===\n");
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Choosing a lock:
+ *
+ *   Critical section       Contention     Use
+ *   ---------------------  -------------  ---------------------------
+ *   ns (counter, pointer)  low            atomic, or spinlock
+ *   ns                     high           MCS, or redesign (sharding)
+ *   us+ (I/O, allocation)  any            mutex (sleeps instead of burning CPU)
+ *   read-mostly, small     any            seqlock
+ *   read-mostly, long      any            rwlock
+ *
+ * How the order checker works (like Linux's lockdep):
+ * - Each thread keeps a list of locks it holds
+ * - Taking B while holding A records the edge A -> B
+ * - A new edge A -> B when B -> ... -> A already exists is a cycle:
+ *   some interleaving of those code paths deadlocks
+ * It catches the bug the first time both orders RUN, not the first
+ * time they collide - which may be never in testing and daily in
+ * production.
+ */
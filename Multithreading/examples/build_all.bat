@@ -25,6 +25,26 @@ echo Building 05_deadlock...
 gcc -o bin/05_deadlock.exe 05_deadlock.c -Wall
 if %errorlevel% neq 0 goto error
 
+echo Building 06_work_stealing...
+gcc -o bin/06_work_stealing.exe 06_work_stealing.c thread_pool.c -O2 -Wall
+if %errorlevel% neq 0 goto error
+
+echo Building 07_lockfree_queue...
+gcc -o bin/07_lockfree_queue.exe 07_lockfree_queue.c -O2 -Wall -lsynchronization
+if %errorlevel% neq 0 goto error
+
+echo Building 08_sharded_counters...
+gcc -o bin/08_sharded_counters.exe 08_sharded_counters.c sharded_stats.c -O2 -Wall
+if %errorlevel% neq 0 goto error
+
+echo Building 09_lock_profiler...
+gcc -o bin/09_lock_profiler.exe 09_lock_profiler.c locks.c -O2 -Wall
+if %errorlevel% neq 0 goto error
+
+echo Building 10_safe_reclamation...
+gcc -o bin/10_safe_reclamation.exe 10_safe_reclamation.c smr.c -O2 -Wall
+if %errorlevel% neq 0 goto error
+
 echo.
 echo ============================================
 echo All examples built successfully!
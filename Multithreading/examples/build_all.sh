@@ -21,6 +21,21 @@ gcc -o bin/04_producer_consumer 04_producer_consumer.c -pthread -Wall || exit 1
 echo "Building 05_deadlock..."
 gcc -o bin/05_deadlock 05_deadlock.c -pthread -Wall || exit 1
 
+echo "Building 06_work_stealing..."
+gcc -o bin/06_work_stealing 06_work_stealing.c thread_pool.c -pthread -lm -O2 -Wall || exit 1
+
+echo "Building 07_lockfree_queue..."
+gcc -o bin/07_lockfree_queue 07_lockfree_queue.c -pthread -O2 -Wall || exit 1
+
+echo "Building 08_sharded_counters..."
+gcc -o bin/08_sharded_counters 08_sharded_counters.c sharded_stats.c -pthread -O2 -Wall || exit 1
+
+echo "Building 09_lock_profiler..."
+gcc -o bin/09_lock_profiler 09_lock_profiler.c locks.c -pthread -O2 -Wall || exit 1
+
+echo "Building 10_safe_reclamation..."
+gcc -o bin/10_safe_reclamation 10_safe_reclamation.c smr.c -pthread -O2 -Wall || exit 1
+
 echo ""
 echo "============================================"
 echo "All examples built successfully!"
@@ -0,0 +1,486 @@
+/*
+ * Locks and lock profiler - implementation
+ *
+ * See locks.h for the API.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "locks.h"
+
+#ifdef _WIN32
+    static void mutex_init(lk_mutex_t* m) { InitializeCriticalSection(m); }
+    static void mutex_lock(lk_mutex_t* m) { EnterCriticalSection(m); }
+    static int mutex_trylock(lk_mutex_t* m) { return TryEnterCriticalSection(m) != 0; }
+    static void mutex_unlock(lk_mutex_t* m) { LeaveCriticalSection(m); }
+    static void mutex_destroy(lk_mutex_t* m) { DeleteCriticalSection(m); }
+
+    static void cond_init(lk_cond_t* c) { InitializeConditionVariable(c); }
+    static void cond_wait(lk_cond_t* c, lk_mutex_t* m) { SleepConditionVariableCS(c, m, INFINITE); }
+    static void cond_signal(lk_cond_t* c) { WakeConditionVariable(c); }
+    static void cond_broadcast(lk_cond_t* c) { WakeAllConditionVariable(c); }
+    static void cond_destroy(lk_cond_t* c) { (void)c; }
+
+    static void thread_yield(void) { SwitchToThread(); }
+
+    unsigned long long locks_now_ns(void) {
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (unsigned long long)((double)count.QuadPart * 1e9 / (double)freq.QuadPart);
+    }
+#else
+    #include <sched.h>
+    #include <time.h>
+
+    static void mutex_init(lk_mutex_t* m) { pthread_mutex_init(m, NULL); }
+    static void mutex_lock(lk_mutex_t* m) { pthread_mutex_lock(m); }
+    static int mutex_trylock(lk_mutex_t* m) { return pthread_mutex_trylock(m) == 0; }
+    static void mutex_unlock(lk_mutex_t* m) { pthread_mutex_unlock(m); }
+    static void mutex_destroy(lk_mutex_t* m) { pthread_mutex_destroy(m); }
+
+    static void cond_init(lk_cond_t* c) { pthread_cond_init(c, NULL); }
+    static void cond_wait(lk_cond_t* c, lk_mutex_t* m) { pthread_cond_wait(c, m); }
+    static void cond_signal(lk_cond_t* c) { pthread_cond_signal(c); }
+    static void cond_broadcast(lk_cond_t* c) { pthread_cond_broadcast(c); }
+    static void cond_destroy(lk_cond_t* c) { pthread_cond_destroy(c); }
+
+    static void thread_yield(void) { sched_yield(); }
+
+    unsigned long long locks_now_ns(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+    }
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define cpu_relax() __builtin_ia32_pause()
+#else
+    #define cpu_relax() ((void)0)
+#endif
+
+// Spin politely: pause for a while, then give the CPU away. Pure
+// spinning with more threads than cores waits on a holder that
+// isn't even running.
+static void spin_backoff(int* spins) {
+    if (++*spins < 100) cpu_relax();
+    else thread_yield();
+}
+
+// ===== Reader-Writer Lock =====
+
+void rwlock_init(RWLock* rw) {
+    mutex_init(&rw->mutex);
+    cond_init(&rw->readers_ok);
+    cond_init(&rw->writer_ok);
+    rw->active_readers = 0;
+    rw->waiting_writers = 0;
+    rw->writer_active = 0;
+}
+
+void rwlock_destroy(RWLock* rw) {
+    mutex_destroy(&rw->mutex);
+    cond_destroy(&rw->readers_ok);
+    cond_destroy(&rw->writer_ok);
+}
+
+void rwlock_read_lock(RWLock* rw) {
+    mutex_lock(&rw->mutex);
+    while (rw->writer_active || rw->waiting_writers > 0) {
+        cond_wait(&rw->readers_ok, &rw->mutex);
+    }
+    rw->active_readers++;
+    mutex_unlock(&rw->mutex);
+}
+
+void rwlock_read_unlock(RWLock* rw) {
+    mutex_lock(&rw->mutex);
+    rw->active_readers--;
+    if (rw->active_readers == 0 && rw->waiting_writers > 0) cond_signal(&rw->writer_ok);
+    mutex_unlock(&rw->mutex);
+}
+
+void rwlock_write_lock(RWLock* rw) {
+    mutex_lock(&rw->mutex);
+    rw->waiting_writers++;
+    while (rw->writer_active || rw->active_readers > 0) {
+        cond_wait(&rw->writer_ok, &rw->mutex);
+    }
+    rw->waiting_writers--;
+    rw->writer_active = 1;
+    mutex_unlock(&rw->mutex);
+}
+
+void rwlock_write_unlock(RWLock* rw) {
+    mutex_lock(&rw->mutex);
+    rw->writer_active = 0;
+    if (rw->waiting_writers > 0) cond_signal(&rw->writer_ok);
+    else cond_broadcast(&rw->readers_ok);
+    mutex_unlock(&rw->mutex);
+}
+
+// ===== Sequence Lock =====
+
+void seqlock_init(SeqLock* s) {
+    atomic_init(&s->seq, 0);
+    atomic_flag_clear(&s->writer);
+}
+
+unsigned seqlock_read_begin(SeqLock* s) {
+    int spins = 0;
+    while (1) {
+        unsigned seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+        if ((seq & 1) == 0) return seq;
+        spin_backoff(&spins);           // Writer mid-update
+    }
+}
+
+int seqlock_read_retry(SeqLock* s, unsigned start) {
+    // Keep the data reads above from moving below the re-check
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&s->seq, memory_order_relaxed) != start;
+}
+
+void seqlock_write_begin(SeqLock* s) {
+    int spins = 0;
+    while (atomic_flag_test_and_set_explicit(&s->writer, memory_order_acquire)) {
+        spin_backoff(&spins);
+    }
+    unsigned seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, seq + 1, memory_order_relaxed);
+    // Odd sequence must be visible before any data write
+    atomic_thread_fence(memory_order_release);
+}
+
+void seqlock_write_end(SeqLock* s) {
+    unsigned seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, seq + 1, memory_order_release);
+    atomic_flag_clear_explicit(&s->writer, memory_order_release);
+}
+
+// ===== Ticket Spinlock =====
+
+void ticket_init(TicketLock* t) {
+    atomic_init(&t->next_ticket, 0);
+    atomic_init(&t->now_serving, 0);
+}
+
+void ticket_lock(TicketLock* t) {
+    unsigned my = atomic_fetch_add_explicit(&t->next_ticket, 1, memory_order_relaxed);
+    int spins = 0;
+    while (atomic_load_explicit(&t->now_serving, memory_order_acquire) != my) {
+        spin_backoff(&spins);
+    }
+}
+
+void ticket_unlock(TicketLock* t) {
+    // Only the holder writes now_serving: no RMW needed
+    unsigned next = atomic_load_explicit(&t->now_serving, memory_order_relaxed) + 1;
+    atomic_store_explicit(&t->now_serving, next, memory_order_release);
+}
+
+// ===== MCS Queue Spinlock =====
+
+void mcs_init(MCSLock* m) {
+    atomic_init(&m->tail, NULL);
+}
+
+void mcs_lock(MCSLock* m, MCSNode* node) {
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    atomic_store_explicit(&node->locked, 1, memory_order_relaxed);
+
+    MCSNode* prev = atomic_exchange_explicit(&m->tail, node, memory_order_acq_rel);
+    if (prev == NULL) return;  // Lock was free
+
+    // Queue behind prev and spin on OUR node only
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+    int spins = 0;
+    while (atomic_load_explicit(&node->locked, memory_order_acquire)) {
+        spin_backoff(&spins);
+    }
+}
+
+void mcs_unlock(MCSLock* m, MCSNode* node) {
+    MCSNode* next = atomic_load_explicit(&node->next, memory_order_acquire);
+    if (next == NULL) {
+        // No visible successor: try to mark the lock free
+        MCSNode* expected = node;
+        if (atomic_compare_exchange_strong_explicit(&m->tail, &expected, NULL,
+                                                    memory_order_release,
+                                                    memory_order_relaxed)) {
+            return;
+        }
+        // Someone swapped tail but hasn't linked in yet: wait for it
+        int spins = 0;
+        while ((next = atomic_load_explicit(&node->next, memory_order_acquire)) == NULL) {
+            spin_backoff(&spins);
+        }
+    }
+    atomic_store_explicit(&next->locked, 0, memory_order_release);
+}
+
+// ===== Profiled Mutex: per-site statistics =====
+
+typedef struct {
+    atomic_int used;                    // Published after the key fields
+    const char* file;
+    int line;
+    int lock_id;
+    const char* lock_name;
+    atomic_llong acquisitions;
+    atomic_llong contended;
+    atomic_llong wait_ns;
+    atomic_llong max_wait_ns;
+    atomic_llong hold_ns;
+    atomic_llong max_hold_ns;
+} LockSite;
+
+static LockSite sites[PROFILED_MAX_SITES];
+static lk_mutex_t registry_mutex;
+static atomic_int registry_ready;
+static atomic_int next_lock_id;
+
+// Lock-order graph: order[a][b] = 1 once b was taken while holding a
+static atomic_uchar order[PROFILED_MAX_LOCKS][PROFILED_MAX_LOCKS];
+static short order_site[PROFILED_MAX_LOCKS][PROFILED_MAX_LOCKS];
+static const char* lock_names[PROFILED_MAX_LOCKS];
+static atomic_int violations;
+
+// Locks held by this thread, in acquisition order
+#define MAX_HELD 16
+static _Thread_local int held_ids[MAX_HELD];
+static _Thread_local int held_count;
+
+static void registry_init_once(void) {
+    // 0 = not started, 1 = someone is initializing, 2 = ready
+    int expected = 0;
+    if (atomic_compare_exchange_strong(&registry_ready, &expected, 1)) {
+        mutex_init(&registry_mutex);
+        atomic_store(&registry_ready, 2);
+    }
+    while (atomic_load(&registry_ready) != 2) thread_yield();
+}
+
+static void atomic_max(atomic_llong* target, long long value) {
+    long long cur = atomic_load_explicit(target, memory_order_relaxed);
+    while (value > cur &&
+           !atomic_compare_exchange_weak_explicit(target, &cur, value,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {}
+}
+
+static int find_site(ProfiledMutex* m, const char* file, int line) {
+    unsigned h = (unsigned)((size_t)file * 31 + (unsigned)line * 2654435761u + (unsigned)m->id);
+    for (int probe = 0; probe < PROFILED_MAX_SITES; probe++) {
+        int i = (int)((h + probe) % PROFILED_MAX_SITES);
+        LockSite* s = &sites[i];
+
+        if (!atomic_load_explicit(&s->used, memory_order_acquire)) {
+            // New site: insert under the registry lock (rare)
+            mutex_lock(&registry_mutex);
+            if (!atomic_load_explicit(&s->used, memory_order_relaxed)) {
+                s->file = file;
+                s->line = line;
+                s->lock_id = m->id;
+                s->lock_name = m->name;
+                atomic_store_explicit(&s->used, 1, memory_order_release);
+                mutex_unlock(&registry_mutex);
+                return i;
+            }
+            mutex_unlock(&registry_mutex);
+        }
+        if (s->file == file && s->line == line && s->lock_id == m->id) return i;
+    }
+    return -1;  // Table full: stop profiling new sites
+}
+
+// ===== Profiled Mutex: lock-order checking =====
+
+// Is there a path from -> ... -> to in the order graph?
+static int order_path(int from, int to, unsigned char* visited) {
+    if (from == to) return 1;
+    visited[from] = 1;
+    int n = atomic_load(&next_lock_id);
+    for (int next = 0; next < n; next++) {
+        if (!visited[next] && atomic_load_explicit(&order[from][next], memory_order_relaxed) &&
+            order_path(next, to, visited)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static const char* short_path(const char* file) {
+    const char* s = strrchr(file, '/');
+    const char* b = strrchr(file, '\\');
+    if (b > s) s = b;
+    return s ? s + 1 : file;
+}
+
+// Called BEFORE blocking on m, so an inversion is reported even if
+// this very acquisition is the one that would deadlock
+static void check_order(ProfiledMutex* m, int site) {
+    for (int i = 0; i < held_count; i++) {
+        int held = held_ids[i];
+        if (held == m->id) continue;
+        if (atomic_load_explicit(&order[held][m->id], memory_order_relaxed)) continue;
+
+        // First time we see held -> m: does m -> ... -> held exist?
+        mutex_lock(&registry_mutex);
+        unsigned char visited[PROFILED_MAX_LOCKS] = {0};
+        if (order_path(m->id, held, visited)) {
+            atomic_fetch_add(&violations, 1);
+            int other = order_site[m->id][held];
+            printf("\n!! LOCK ORDER INVERSION: taking '%s' while holding '%s' (%s:%d)\n",
+                   m->name, lock_names[held], short_path(sites[site].file), sites[site].line);
+            if (atomic_load(&order[m->id][held]) && other >= 0) {
+                printf("!! elsewhere '%s' is held while taking '%s' (%s:%d)\n",
+                       m->name, lock_names[held], short_path(sites[other].file), sites[other].line);
+            } else {
+                printf("!! elsewhere '%s' is (indirectly) held while taking '%s'\n",
+                       m->name, lock_names[held]);
+            }
+            printf("!! Two threads doing these at once deadlock. Pick one order.\n\n");
+        }
+        order_site[held][m->id] = (short)site;
+        atomic_store_explicit(&order[held][m->id], 1, memory_order_relaxed);
+        mutex_unlock(&registry_mutex);
+    }
+}
+
+// ===== Profiled Mutex: API =====
+
+void profiled_init(ProfiledMutex* m, const char* name) {
+    registry_init_once();
+    mutex_init(&m->mutex);
+    m->name = name;
+    m->id = atomic_fetch_add(&next_lock_id, 1);
+    if (m->id >= PROFILED_MAX_LOCKS) {
+        printf("profiled_init: more than %d locks, order checks disabled for '%s'\n",
+               PROFILED_MAX_LOCKS, name);
+        m->id = -1;
+    } else {
+        lock_names[m->id] = name;
+        for (int i = 0; i < PROFILED_MAX_LOCKS; i++) {
+            order_site[m->id][i] = -1;
+            order_site[i][m->id] = -1;
+        }
+    }
+    m->acquired_at = 0;
+    m->site = -1;
+}
+
+void profiled_destroy(ProfiledMutex* m) {
+    mutex_destroy(&m->mutex);
+}
+
+void profiled_lock_at(ProfiledMutex* m, const char* file, int line) {
+    int site = find_site(m, file, line);
+    if (m->id >= 0 && site >= 0) check_order(m, site);
+
+    unsigned long long start = locks_now_ns();
+    int contended = 0;
+    if (!mutex_trylock(&m->mutex)) {
+        contended = 1;
+        mutex_lock(&m->mutex);
+    }
+    unsigned long long now = locks_now_ns();
+
+    m->acquired_at = now;
+    m->site = site;
+    if (held_count < MAX_HELD && m->id >= 0) held_ids[held_count++] = m->id;
+
+    if (site >= 0) {
+        LockSite* s = &sites[site];
+        long long waited = contended ? (long long)(now - start) : 0;
+        atomic_fetch_add_explicit(&s->acquisitions, 1, memory_order_relaxed);
+        if (contended) {
+            atomic_fetch_add_explicit(&s->contended, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&s->wait_ns, waited, memory_order_relaxed);
+            atomic_max(&s->max_wait_ns, waited);
+        }
+    }
+}
+
+void profiled_unlock(ProfiledMutex* m) {
+    long long held = (long long)(locks_now_ns() - m->acquired_at);
+    int site = m->site;
+
+    for (int i = held_count - 1; i >= 0; i--) {
+        if (held_ids[i] == m->id) {
+            memmove(&held_ids[i], &held_ids[i + 1], (held_count - i - 1) * sizeof(int));
+            held_count--;
+            break;
+        }
+    }
+    mutex_unlock(&m->mutex);
+
+    if (site >= 0) {
+        atomic_fetch_add_explicit(&sites[site].hold_ns, held, memory_order_relaxed);
+        atomic_max(&sites[site].max_hold_ns, held);
+    }
+}
+
+void profiled_lock_pair_at(ProfiledMutex* a, ProfiledMutex* b, const char* file, int line) {
+    if (a->id > b->id) {
+        ProfiledMutex* t = a;
+        a = b;
+        b = t;
+    }
+    profiled_lock_at(a, file, line);
+    profiled_lock_at(b, file, line);
+}
+
+// ===== Report =====
+
+static int compare_wait(const void* x, const void* y) {
+    LockSite* a = *(LockSite* const*)x;
+    LockSite* b = *(LockSite* const*)y;
+    long long wa = atomic_load(&a->wait_ns);
+    long long wb = atomic_load(&b->wait_ns);
+    return (wa < wb) - (wa > wb);
+}
+
+void profiled_report(void) {
+    LockSite* list[PROFILED_MAX_SITES];
+    int n = 0;
+    for (int i = 0; i < PROFILED_MAX_SITES; i++) {
+        if (atomic_load(&sites[i].used) && atomic_load(&sites[i].acquisitions) > 0) list[n++] = &sites[i];
+    }
+    qsort(list, n, sizeof(list[0]), compare_wait);
+
+    printf("%-12s %-26s %9s %7s %10s %10s %10s %10s\n",
+           "lock", "site", "acquires", "contend", "wait tot", "wait max", "hold avg", "hold max");
+    for (int i = 0; i < n; i++) {
+        LockSite* s = list[i];
+        long long acq = atomic_load(&s->acquisitions);
+        long long cont = atomic_load(&s->contended);
+        char where[64];
+        snprintf(where, sizeof(where), "%s:%d", short_path(s->file), s->line);
+        printf("%-12s %-26s %9lld %6.1f%% %8.2fms %8.1fus %8.2fus %8.1fus\n",
+               s->lock_name, where, acq, 100.0 * cont / acq,
+               atomic_load(&s->wait_ns) / 1e6, atomic_load(&s->max_wait_ns) / 1e3,
+               atomic_load(&s->hold_ns) / 1e3 / acq, atomic_load(&s->max_hold_ns) / 1e3);
+    }
+    if (atomic_load(&violations) > 0) {
+        printf("%d lock-order violation(s) detected\n", atomic_load(&violations));
+    }
+}
+
+void profiled_reset_stats(void) {
+    for (int i = 0; i < PROFILED_MAX_SITES; i++) {
+        atomic_store(&sites[i].acquisitions, 0);
+        atomic_store(&sites[i].contended, 0);
+        atomic_store(&sites[i].wait_ns, 0);
+        atomic_store(&sites[i].max_wait_ns, 0);
+        atomic_store(&sites[i].hold_ns, 0);
+        atomic_store(&sites[i].max_hold_ns, 0);
+    }
+}
+
+int profiled_order_violations(void) {
+    return atomic_load(&violations);
+}
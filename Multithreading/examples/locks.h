@@ -0,0 +1,143 @@
+#ifndef LOCKS_H
+#define LOCKS_H
+
+/*
+ * Locks beyond the plain mutex, and a profiler to find the hot ones
+ *
+ *   RWLock         many readers or one writer; writers don't starve
+ *   SeqLock        readers never block or write shared memory; they
+ *                  retry if a writer got in. For small read-mostly data.
+ *   TicketLock     spinlock that serves threads in arrival order
+ *   MCSLock        spinlock where each waiter spins on its own node,
+ *                  so handoff touches one cache line, not all of them
+ *   ProfiledMutex  mutex that records wait time, hold time and
+ *                  contention per call site, and checks lock order
+ *                  at runtime (reports A->B / B->A before it hangs)
+ *
+ * Build: add locks.c to the compile line (-pthread on Linux).
+ */
+
+#include <stdatomic.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    typedef CRITICAL_SECTION lk_mutex_t;
+    typedef CONDITION_VARIABLE lk_cond_t;
+#else
+    #include <pthread.h>
+    typedef pthread_mutex_t lk_mutex_t;
+    typedef pthread_cond_t lk_cond_t;
+#endif
+
+#define LOCKS_CACHE_LINE 64
+
+// ===== Reader-Writer Lock =====
+//
+// Writer-preferring: once a writer waits, new readers queue behind it.
+// Otherwise a steady stream of readers could lock writers out forever.
+
+typedef struct {
+    lk_mutex_t mutex;
+    lk_cond_t readers_ok;
+    lk_cond_t writer_ok;
+    int active_readers;
+    int waiting_writers;
+    int writer_active;
+} RWLock;
+
+void rwlock_init(RWLock* rw);
+void rwlock_destroy(RWLock* rw);
+void rwlock_read_lock(RWLock* rw);
+void rwlock_read_unlock(RWLock* rw);
+void rwlock_write_lock(RWLock* rw);
+void rwlock_write_unlock(RWLock* rw);
+
+// ===== Sequence Lock =====
+//
+//   do {
+//       start = seqlock_read_begin(&lock);
+//       copy = shared;                      // may see a torn value...
+//   } while (seqlock_read_retry(&lock, start));  // ...then it retries
+//
+// Writers serialize with each other through an internal spinlock.
+
+typedef struct {
+    atomic_uint seq;                    // Odd while a write is in progress
+    atomic_flag writer;
+} SeqLock;
+
+void seqlock_init(SeqLock* s);
+unsigned seqlock_read_begin(SeqLock* s);
+int seqlock_read_retry(SeqLock* s, unsigned start);
+void seqlock_write_begin(SeqLock* s);
+void seqlock_write_end(SeqLock* s);
+
+// ===== Ticket Spinlock =====
+
+typedef struct {
+    _Alignas(LOCKS_CACHE_LINE) atomic_uint next_ticket;
+    atomic_uint now_serving;
+} TicketLock;
+
+void ticket_init(TicketLock* t);
+void ticket_lock(TicketLock* t);
+void ticket_unlock(TicketLock* t);
+
+// ===== MCS Queue Spinlock =====
+//
+// Each locker brings a node (usually on its stack) and passes the
+// same node to unlock.
+
+typedef struct MCSNode {
+    _Alignas(LOCKS_CACHE_LINE) _Atomic(struct MCSNode*) next;
+    atomic_int locked;
+} MCSNode;
+
+typedef struct {
+    _Alignas(LOCKS_CACHE_LINE) _Atomic(MCSNode*) tail;
+} MCSLock;
+
+void mcs_init(MCSLock* m);
+void mcs_lock(MCSLock* m, MCSNode* node);
+void mcs_unlock(MCSLock* m, MCSNode* node);
+
+// ===== Profiled Mutex =====
+//
+// Use the macros so the call site is recorded:
+//   PROFILED_LOCK(&m);  ...  PROFILED_UNLOCK(&m);
+
+#define PROFILED_MAX_LOCKS 128          // For lock-order tracking
+#define PROFILED_MAX_SITES 256
+
+typedef struct {
+    lk_mutex_t mutex;
+    const char* name;
+    int id;                             // Index in the lock-order graph
+    // Written by the holder only
+    unsigned long long acquired_at;
+    int site;
+} ProfiledMutex;
+
+void profiled_init(ProfiledMutex* m, const char* name);
+void profiled_destroy(ProfiledMutex* m);
+void profiled_lock_at(ProfiledMutex* m, const char* file, int line);
+void profiled_unlock(ProfiledMutex* m);
+
+// Take two locks in a global order (by id), like lock_both_ordered()
+// in 05_deadlock.c but for any pair
+void profiled_lock_pair_at(ProfiledMutex* a, ProfiledMutex* b, const char* file, int line);
+
+#define PROFILED_LOCK(m) profiled_lock_at((m), __FILE__, __LINE__)
+#define PROFILED_UNLOCK(m) profiled_unlock(m)
+#define PROFILED_LOCK_PAIR(a, b) profiled_lock_pair_at((a), (b), __FILE__, __LINE__)
+
+// Sites sorted by total wait time, worst first
+void profiled_report(void);
+void profiled_reset_stats(void);
+
+// Number of lock-order cycles detected so far
+int profiled_order_violations(void);
+
+unsigned long long locks_now_ns(void);
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * Sharded statistics counters and histograms - implementation
+ *
+ * See sharded_stats.h for the API.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sharded_stats.h"
+
+static atomic_int next_shard = 0;
+_Thread_local int stats_tls_shard = -1;
+
+// Round-robin: the first STATS_SHARDS threads get a shard each
+int stats_assign_shard(void) {
+    stats_tls_shard = atomic_fetch_add_explicit(&next_shard, 1, memory_order_relaxed) &
+                      (STATS_SHARDS - 1);
+    return stats_tls_shard;
+}
+
+// ===== Counters =====
+
+void stat_counter_init(StatCounter* c, const char* name) {
+    for (int i = 0; i < STATS_SHARDS; i++) atomic_init(&c->shards[i].value, 0);
+    c->name = name;
+}
+
+long long stat_counter_read(StatCounter* c) {
+    // Not a snapshot: shards are read one by one while writers keep
+    // going. Each increment is counted exactly once, in this read or
+    // the next, which is all a metric needs.
+    long long total = 0;
+    for (int i = 0; i < STATS_SHARDS; i++) {
+        total += atomic_load_explicit(&c->shards[i].value, memory_order_relaxed);
+    }
+    return total;
+}
+
+long long stat_counter_reset(StatCounter* c) {
+    long long total = 0;
+    for (int i = 0; i < STATS_SHARDS; i++) {
+        total += atomic_exchange_explicit(&c->shards[i].value, 0, memory_order_relaxed);
+    }
+    return total;
+}
+
+// ===== Histograms =====
+
+#define HIST_SUB (1 << STATS_HIST_SUB_BITS)
+
+static int msb_index(unsigned long long v) {
+    #if defined(__GNUC__)
+    return 63 - __builtin_clzll(v);
+    #else
+    int m = 0;
+    while (v >>= 1) m++;
+    return m;
+    #endif
+}
+
+int stat_hist_bucket(long long value) {
+    if (value < 0) value = 0;
+    unsigned long long v = (unsigned long long)value;
+    if (v < 2 * HIST_SUB) return (int)v;
+    int shift = msb_index(v) - STATS_HIST_SUB_BITS;
+    int idx = (shift << STATS_HIST_SUB_BITS) + (int)(v >> shift);
+    return idx < STATS_HIST_BUCKETS ? idx : STATS_HIST_BUCKETS - 1;
+}
+
+// Highest value that lands in bucket idx
+static long long hist_bucket_max(int idx) {
+    if (idx < 2 * HIST_SUB) return idx;
+    int shift = idx / HIST_SUB - 1;
+    long long mantissa = idx - shift * HIST_SUB;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void stat_hist_init(StatHistogram* h, const char* name) {
+    size_t bytes = STATS_SHARDS * sizeof(HistShard);
+    #ifdef _WIN32
+    h->shards = (HistShard*)_aligned_malloc(bytes, STATS_CACHE_LINE);
+    #else
+    h->shards = (HistShard*)aligned_alloc(STATS_CACHE_LINE, bytes);
+    #endif
+    memset(h->shards, 0, bytes);  // All-zero is a valid initial atomic_llong
+    h->name = name;
+}
+
+void stat_hist_destroy(StatHistogram* h) {
+    #ifdef _WIN32
+    _aligned_free(h->shards);
+    #else
+    free(h->shards);
+    #endif
+    h->shards = NULL;
+}
+
+void stat_hist_record(StatHistogram* h, long long value) {
+    HistShard* s = &h->shards[stats_thread_shard()];
+    atomic_fetch_add_explicit(&s->buckets[stat_hist_bucket(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->sum, value, memory_order_relaxed);
+
+    // New maximums are rare once warmed up: plain load first
+    long long cur = atomic_load_explicit(&s->max, memory_order_relaxed);
+    while (value > cur &&
+           !atomic_compare_exchange_weak_explicit(&s->max, &cur, value,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {}
+}
+
+void stat_hist_snapshot(StatHistogram* h, HistSnapshot* out) {
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < STATS_SHARDS; i++) {
+        HistShard* s = &h->shards[i];
+        for (int b = 0; b < STATS_HIST_BUCKETS; b++) {
+            out->buckets[b] += atomic_load_explicit(&s->buckets[b], memory_order_relaxed);
+        }
+        out->sum += atomic_load_explicit(&s->sum, memory_order_relaxed);
+        long long m = atomic_load_explicit(&s->max, memory_order_relaxed);
+        if (m > out->max) out->max = m;
+    }
+    // Count from the buckets so percentiles stay consistent even
+    // when writers race with the snapshot
+    for (int b = 0; b < STATS_HIST_BUCKETS; b++) out->count += out->buckets[b];
+}
+
+long long stat_hist_percentile(const HistSnapshot* s, double p) {
+    if (s->count == 0) return 0;
+    long long target = (long long)(p / 100.0 * s->count + 0.5);
+    if (target < 1) target = 1;
+
+    long long seen = 0;
+    for (int b = 0; b < STATS_HIST_BUCKETS; b++) {
+        seen += s->buckets[b];
+        if (seen >= target) {
+            long long v = hist_bucket_max(b);
+            return v < s->max ? v : s->max;
+        }
+    }
+    return s->max;
+}
+
+void stat_hist_print(StatHistogram* h) {
+    HistSnapshot s;
+    stat_hist_snapshot(h, &s);
+    printf("%s: count=%lld mean=%.1f p50=%lld p90=%lld p99=%lld max=%lld\n",
+           h->name, s.count, s.count ? (double)s.sum / s.count : 0.0,
+           stat_hist_percentile(&s, 50), stat_hist_percentile(&s, 90),
+           stat_hist_percentile(&s, 99), s.max);
+}
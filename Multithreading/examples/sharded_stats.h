@@ -0,0 +1,98 @@
+#ifndef SHARDED_STATS_H
+#define SHARDED_STATS_H
+
+/*
+ * Sharded statistics counters and histograms
+ *
+ * A shared counter that every thread increments is one cache line
+ * bouncing between cores: each increment waits for the line to
+ * arrive. Here every thread writes its own cache-line-sized shard
+ * with a relaxed atomic add, and reads sum the shards. Writes stay
+ * core-local; reads are rare (metrics scrapes) and pay instead.
+ *
+ * Threads pick a shard on first use. With more threads than shards,
+ * some share one - still correct, just a little contention.
+ *
+ * Build: add sharded_stats.c to the compile line (-pthread on Linux).
+ */
+
+#include <stdatomic.h>
+
+#define STATS_CACHE_LINE 64
+#define STATS_SHARDS 32                 // Power of two
+
+// ===== Counters =====
+
+typedef struct {
+    _Alignas(STATS_CACHE_LINE) atomic_llong value;
+} CounterShard;
+
+// ~2KB each. Declare as globals or statics (malloc doesn't honor
+// the 64-byte alignment; use aligned_alloc for heap counters).
+typedef struct {
+    CounterShard shards[STATS_SHARDS];
+    const char* name;
+} StatCounter;
+
+// Which shard the calling thread uses (assigned on first call)
+extern _Thread_local int stats_tls_shard;
+int stats_assign_shard(void);
+
+static inline int stats_thread_shard(void) {
+    int s = stats_tls_shard;
+    return s >= 0 ? s : stats_assign_shard();
+}
+
+void stat_counter_init(StatCounter* c, const char* name);
+long long stat_counter_read(StatCounter* c);        // Sum of all shards
+long long stat_counter_reset(StatCounter* c);       // Returns value before reset
+
+// Inline: this is the hot path, one TLS load and one relaxed add.
+// Relaxed because nobody orders other memory against a metric. On x86
+// it is still a locked add, but on a line only this core owns, so it
+// costs a few cycles instead of a cross-core round trip.
+static inline void stat_counter_add(StatCounter* c, long long n) {
+    atomic_fetch_add_explicit(&c->shards[stats_thread_shard()].value, n, memory_order_relaxed);
+}
+
+static inline void stat_counter_inc(StatCounter* c) {
+    stat_counter_add(c, 1);
+}
+
+// ===== Histograms =====
+//
+// Log-linear buckets: 4 per power of two (<25% error), values 0..2^48.
+// Record is one bucket increment plus the sum, both in the calling
+// thread's shard. The count is the sum of the buckets.
+
+#define STATS_HIST_SUB_BITS 2
+#define STATS_HIST_BUCKETS 192
+
+typedef struct {
+    _Alignas(STATS_CACHE_LINE) atomic_llong buckets[STATS_HIST_BUCKETS];
+    atomic_llong sum;
+    atomic_llong max;
+} HistShard;
+
+typedef struct {
+    HistShard* shards;                  // STATS_SHARDS of them, aligned
+    const char* name;
+} StatHistogram;
+
+// Merged view for reporting
+typedef struct {
+    long long buckets[STATS_HIST_BUCKETS];
+    long long count;
+    long long sum;
+    long long max;
+} HistSnapshot;
+
+void stat_hist_init(StatHistogram* h, const char* name);
+void stat_hist_destroy(StatHistogram* h);
+void stat_hist_record(StatHistogram* h, long long value);
+void stat_hist_snapshot(StatHistogram* h, HistSnapshot* out);
+long long stat_hist_percentile(const HistSnapshot* s, double p);
+int stat_hist_bucket(long long value);              // Bucket index for value
+void stat_hist_print(StatHistogram* h);
+
+#endif
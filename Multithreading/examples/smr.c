@@ -0,0 +1,286 @@
+/*
+ * Safe memory reclamation - implementation
+ *
+ * See smr.h for the API.
+ *
+ * A retired node carries the global epoch at the time it was retired.
+ * At collection time it may be freed when both hold:
+ *   - every thread in an epoch guard entered in a later epoch (it
+ *     started after the node was unlinked, so it cannot have found it)
+ *   - no hazard slot points at it
+ * Threads in hazard mode don't publish an epoch, so they never hold
+ * the first condition back.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "smr.h"
+
+typedef struct {
+    void* node;
+    void (*free_fn)(void*);
+    unsigned long long epoch;
+} Retired;
+
+struct SmrThread {
+    // Read by every collecting thread
+    _Alignas(64) atomic_ullong epoch;   // Epoch at smr_enter, 0 = none
+    _Atomic(void*) hazards[SMR_HAZARDS];
+    atomic_int in_use;
+
+    // Owner only
+    Retired* retired;
+    int count;
+    int cap;
+    int since_collect;
+
+    // Written by the owner, summed by smr_get_stats
+    atomic_llong retired_total;
+    atomic_llong freed_total;
+    atomic_llong advances;
+    atomic_llong stalls;
+};
+
+static _Alignas(64) atomic_ullong global_epoch = 1;
+static struct SmrThread records[SMR_MAX_THREADS];
+static atomic_int record_high = 0;      // Records [0, high) have been used
+static _Thread_local struct SmrThread* tls_thread = NULL;
+
+// Pending nodes of threads that exited, adopted by the next collector
+static atomic_flag orphan_lock = ATOMIC_FLAG_INIT;
+static Retired* orphans = NULL;
+static int orphan_count = 0;
+static int orphan_cap = 0;
+static atomic_int orphans_waiting = 0;
+
+// Single writer, so no read-modify-write needed
+static void bump(atomic_llong* c, long long n) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n,
+                          memory_order_relaxed);
+}
+
+static void push_retired(Retired** list, int* count, int* cap, Retired r) {
+    if (*count == *cap) {
+        *cap = *cap ? *cap * 2 : SMR_COLLECT_EVERY * 2;
+        *list = (Retired*)realloc(*list, *cap * sizeof(Retired));
+        if (!*list) {
+            fprintf(stderr, "smr: out of memory\n");
+            abort();
+        }
+    }
+    (*list)[(*count)++] = r;
+}
+
+static struct SmrThread* smr_self(void) {
+    if (tls_thread) return tls_thread;
+
+    for (int i = 0; i < SMR_MAX_THREADS; i++) {
+        int expected = 0;
+        if (atomic_load_explicit(&records[i].in_use, memory_order_relaxed) == 0 &&
+            atomic_compare_exchange_strong(&records[i].in_use, &expected, 1)) {
+            int high = atomic_load(&record_high);
+            while (high < i + 1 && !atomic_compare_exchange_weak(&record_high, &high, i + 1)) {
+            }
+            tls_thread = &records[i];
+            return tls_thread;
+        }
+    }
+    fprintf(stderr, "smr: more than %d threads registered\n", SMR_MAX_THREADS);
+    abort();
+}
+
+// ===== Guards =====
+
+void smr_enter(SmrGuard* g, SmrMode mode) {
+    struct SmrThread* t = smr_self();
+    g->thread = t;
+    g->mode = mode;
+    if (mode == SMR_EPOCH) {
+        atomic_store_explicit(&t->epoch, atomic_load(&global_epoch), memory_order_relaxed);
+        // Pairs with the fence in collect(): either the collector sees
+        // this epoch, or our loads below see its unlink
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+}
+
+void smr_leave(SmrGuard* g) {
+    struct SmrThread* t = g->thread;
+    if (g->mode == SMR_EPOCH) {
+        atomic_store_explicit(&t->epoch, 0, memory_order_release);
+    } else {
+        for (int i = 0; i < SMR_HAZARDS; i++) {
+            atomic_store_explicit(&t->hazards[i], NULL, memory_order_release);
+        }
+    }
+    g->thread = NULL;
+}
+
+void* smr_protect(SmrGuard* g, int slot, _Atomic(void*)* src) {
+    void* p = atomic_load_explicit(src, memory_order_acquire);
+    if (g->mode == SMR_EPOCH) return p;
+
+    // Publish, then check it is still there. If it is, any collector
+    // that runs after the node is unlinked will see the hazard.
+    _Atomic(void*)* hazard = &g->thread->hazards[slot];
+    for (;;) {
+        atomic_store_explicit(hazard, p, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        void* again = atomic_load_explicit(src, memory_order_acquire);
+        if (again == p) return p;
+        p = again;
+    }
+}
+
+void smr_clear(SmrGuard* g, int slot) {
+    if (g->mode == SMR_HAZARD) {
+        atomic_store_explicit(&g->thread->hazards[slot], NULL, memory_order_release);
+    }
+}
+
+// ===== Reclamation =====
+
+static void adopt_orphans(struct SmrThread* t) {
+    if (atomic_load_explicit(&orphans_waiting, memory_order_relaxed) == 0) return;
+
+    while (atomic_flag_test_and_set_explicit(&orphan_lock, memory_order_acquire)) {
+    }
+    for (int i = 0; i < orphan_count; i++) {
+        push_retired(&t->retired, &t->count, &t->cap, orphans[i]);
+    }
+    orphan_count = 0;
+    atomic_store_explicit(&orphans_waiting, 0, memory_order_relaxed);
+    atomic_flag_clear_explicit(&orphan_lock, memory_order_release);
+}
+
+// The epoch moves on once every thread in an epoch guard has seen it
+static void try_advance(struct SmrThread* self) {
+    unsigned long long e = atomic_load(&global_epoch);
+    int high = atomic_load(&record_high);
+    for (int i = 0; i < high; i++) {
+        unsigned long long seen = atomic_load(&records[i].epoch);
+        if (seen != 0 && seen != e) {
+            bump(&self->stalls, 1);
+            return;
+        }
+    }
+    if (atomic_compare_exchange_strong(&global_epoch, &e, e + 1)) {
+        bump(&self->advances, 1);
+    }
+}
+
+static int compare_ptr(const void* a, const void* b) {
+    const char* x = *(const char* const*)a;
+    const char* y = *(const char* const*)b;
+    return (x > y) - (x < y);
+}
+
+static void collect(struct SmrThread* t) {
+    t->since_collect = 0;
+    adopt_orphans(t);
+    if (t->count == 0) return;
+
+    try_advance(t);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    // Oldest epoch any reader entered in; nodes retired before it are
+    // out of every epoch reader's reach
+    unsigned long long safe = atomic_load(&global_epoch);
+    void* hazards[SMR_MAX_THREADS * SMR_HAZARDS];
+    int num_hazards = 0;
+
+    int high = atomic_load(&record_high);
+    for (int i = 0; i < high; i++) {
+        unsigned long long e = atomic_load_explicit(&records[i].epoch, memory_order_acquire);
+        if (e != 0 && e < safe) safe = e;
+        for (int k = 0; k < SMR_HAZARDS; k++) {
+            void* p = atomic_load_explicit(&records[i].hazards[k], memory_order_acquire);
+            if (p) hazards[num_hazards++] = p;
+        }
+    }
+    qsort(hazards, num_hazards, sizeof(void*), compare_ptr);
+
+    int kept = 0;
+    long long freed = 0;
+    for (int i = 0; i < t->count; i++) {
+        Retired r = t->retired[i];
+        if (r.epoch < safe &&
+            !bsearch(&r.node, hazards, num_hazards, sizeof(void*), compare_ptr)) {
+            r.free_fn(r.node);
+            freed++;
+        } else {
+            t->retired[kept++] = r;
+        }
+    }
+    t->count = kept;
+    bump(&t->freed_total, freed);
+}
+
+void smr_retire(void* node, void (*free_fn)(void*)) {
+    struct SmrThread* t = smr_self();
+    // Read after the caller's unlink (seq_cst), so a reader that
+    // entered in a later epoch cannot have seen the node
+    Retired r = { node, free_fn, atomic_load(&global_epoch) };
+    push_retired(&t->retired, &t->count, &t->cap, r);
+    bump(&t->retired_total, 1);
+
+    // While a reader pins nodes, each pass frees little; spacing passes
+    // by half the pending count keeps the scan cost O(1) per retire
+    int every = t->count / 2 > SMR_COLLECT_EVERY ? t->count / 2 : SMR_COLLECT_EVERY;
+    if (++t->since_collect >= every) collect(t);
+}
+
+void smr_collect(void) {
+    collect(smr_self());
+}
+
+void smr_thread_exit(void) {
+    struct SmrThread* t = tls_thread;
+    if (!t) return;
+
+    collect(t);
+    if (t->count > 0) {
+        while (atomic_flag_test_and_set_explicit(&orphan_lock, memory_order_acquire)) {
+        }
+        for (int i = 0; i < t->count; i++) {
+            push_retired(&orphans, &orphan_count, &orphan_cap, t->retired[i]);
+        }
+        atomic_store_explicit(&orphans_waiting, 1, memory_order_relaxed);
+        atomic_flag_clear_explicit(&orphan_lock, memory_order_release);
+    }
+
+    free(t->retired);
+    t->retired = NULL;
+    t->count = t->cap = t->since_collect = 0;
+    atomic_store(&t->epoch, 0);
+    for (int i = 0; i < SMR_HAZARDS; i++) atomic_store(&t->hazards[i], NULL);
+    atomic_store_explicit(&t->in_use, 0, memory_order_release);
+    tls_thread = NULL;
+}
+
+void smr_drain(void) {
+    struct SmrThread* t = smr_self();
+    atomic_store(&orphans_waiting, 1);
+    adopt_orphans(t);
+    for (int i = 0; i < t->count; i++) t->retired[i].free_fn(t->retired[i].node);
+    bump(&t->freed_total, t->count);
+    t->count = 0;
+
+    free(orphans);
+    orphans = NULL;
+    orphan_cap = 0;
+}
+
+void smr_get_stats(SmrStats* out) {
+    memset(out, 0, sizeof(*out));
+    out->epoch = atomic_load(&global_epoch);
+    int high = atomic_load(&record_high);
+    for (int i = 0; i < high; i++) {
+        out->retired += atomic_load_explicit(&records[i].retired_total, memory_order_relaxed);
+        out->freed += atomic_load_explicit(&records[i].freed_total, memory_order_relaxed);
+        out->advances += atomic_load_explicit(&records[i].advances, memory_order_relaxed);
+        out->stalls += atomic_load_explicit(&records[i].stalls, memory_order_relaxed);
+    }
+    out->pending = out->retired - out->freed;
+}
@@ -0,0 +1,100 @@
+#ifndef SMR_H
+#define SMR_H
+
+/*
+ * Safe memory reclamation for lock-free structures
+ *
+ * dequeue_linked() in DataStructures/04_queue.c does
+ *     temp = front; front = front->next; free(temp);
+ * Fine with one thread. In a lock-free queue another thread may have
+ * read `front` a moment earlier and is about to read temp->next: the
+ * free() turns that into a use-after-free, and if malloc hands the same
+ * address back, a CAS that compares pointers succeeds when it should
+ * fail (the ABA problem). A lock-free structure must not free a node
+ * until no thread can still be holding a pointer to it.
+ *
+ * This library decides when that is. Unlink a node, hand it to
+ * smr_retire(), and it is freed later, once it is safe:
+ *
+ *   SmrGuard g;
+ *   smr_enter(&g, SMR_EPOCH);
+ *   Node* top = SMR_PROTECT(&g, 0, &stack->top);
+ *   ... read top->next, CAS it out ...
+ *   smr_leave(&g);
+ *   smr_retire(top, free);
+ *
+ * Two ways to guard reads, usable side by side on the same structure:
+ *
+ *   SMR_EPOCH   (default) Entering publishes the global epoch; reads
+ *               are plain loads. A node retired in epoch E is freed once
+ *               every thread still inside a guard entered after E.
+ *               Cheapest reads, but a thread that stalls inside a guard
+ *               holds back ALL reclamation until it leaves.
+ *   SMR_HAZARD  Each pointer a thread will dereference is published in
+ *               a hazard slot (SMR_HAZARDS per thread) and re-checked.
+ *               A store + fence per pointer, but a stalled thread pins
+ *               only the nodes it actually points to.
+ *
+ * Use epochs for short operations, and fall back to hazard pointers
+ * for readers that may block or run long (iterators held across I/O,
+ * threads that can be descheduled for a long time).
+ *
+ * Threads register on first use. Call smr_thread_exit() before a
+ * thread that used the library ends; its pending nodes are handed to
+ * the threads still running.
+ *
+ * Build: add smr.c to the compile line (-pthread on Linux).
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define SMR_MAX_THREADS 128
+#define SMR_HAZARDS 4                   // Hazard slots per thread
+#define SMR_COLLECT_EVERY 64            // Minimum retires between reclaim attempts
+
+typedef enum { SMR_EPOCH, SMR_HAZARD } SmrMode;
+
+struct SmrThread;
+
+// One guard per thread at a time; guards don't nest
+typedef struct {
+    struct SmrThread* thread;
+    SmrMode mode;
+} SmrGuard;
+
+void smr_enter(SmrGuard* g, SmrMode mode);
+void smr_leave(SmrGuard* g);
+
+// Load *src and keep the result safe to dereference until smr_leave()
+// or until the slot is reused. Slot matters only in hazard mode.
+void* smr_protect(SmrGuard* g, int slot, _Atomic(void*)* src);
+void smr_clear(SmrGuard* g, int slot);
+
+// Typed pointer fields: SMR_PROTECT(&g, 0, &node->next)
+#define SMR_PROTECT(g, slot, src) smr_protect((g), (slot), (_Atomic(void*)*)(src))
+
+// Node must already be unreachable for threads entering from now on
+void smr_retire(void* node, void (*free_fn)(void*));
+
+// Try to free what the calling thread has retired, now
+void smr_collect(void);
+
+void smr_thread_exit(void);
+
+// Shutdown only: frees every pending node without checking readers.
+// Call when no other thread uses the library.
+void smr_drain(void);
+
+typedef struct {
+    unsigned long long epoch;
+    long long retired;
+    long long freed;
+    long long pending;                  // retired - freed
+    long long advances;                 // Epoch increments
+    long long stalls;                   // Advance attempts blocked by a reader
+} SmrStats;
+
+void smr_get_stats(SmrStats* out);
+
+#endif
@@ -0,0 +1,601 @@
+/*
+ * Work-stealing thread pool - implementation
+ *
+ * See thread_pool.h for the API. The deque follows Chase & Lev,
+ * "Dynamic Circular Work-Stealing Deque" (2005), with the C11 memory
+ * orderings from Le et al., "Correct and Efficient Work-Stealing for
+ * Weak Memory Models" (2013).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "thread_pool.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define THREAD_FUNC DWORD WINAPI
+    #define THREAD_RETURN return 0
+    typedef HANDLE thread_t;
+    typedef CRITICAL_SECTION mutex_t;
+    typedef CONDITION_VARIABLE cond_t;
+
+    static void mutex_init(mutex_t* m) { InitializeCriticalSection(m); }
+    static void mutex_lock(mutex_t* m) { EnterCriticalSection(m); }
+    static void mutex_unlock(mutex_t* m) { LeaveCriticalSection(m); }
+    static void mutex_destroy(mutex_t* m) { DeleteCriticalSection(m); }
+
+    static void cond_init(cond_t* c) { InitializeConditionVariable(c); }
+    static void cond_wait(cond_t* c, mutex_t* m) { SleepConditionVariableCS(c, m, INFINITE); }
+    static void cond_signal(cond_t* c) { WakeConditionVariable(c); }
+    static void cond_broadcast(cond_t* c) { WakeAllConditionVariable(c); }
+    static void cond_destroy(cond_t* c) { (void)c; }
+
+    static void thread_yield(void) { SwitchToThread(); }
+    static int cpu_count(void) {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return (int)info.dwNumberOfProcessors;
+    }
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+    #define THREAD_FUNC void*
+    #define THREAD_RETURN return NULL
+    typedef pthread_t thread_t;
+    typedef pthread_mutex_t mutex_t;
+    typedef pthread_cond_t cond_t;
+
+    static void mutex_init(mutex_t* m) { pthread_mutex_init(m, NULL); }
+    static void mutex_lock(mutex_t* m) { pthread_mutex_lock(m); }
+    static void mutex_unlock(mutex_t* m) { pthread_mutex_unlock(m); }
+    static void mutex_destroy(mutex_t* m) { pthread_mutex_destroy(m); }
+
+    static void cond_init(cond_t* c) { pthread_cond_init(c, NULL); }
+    static void cond_wait(cond_t* c, mutex_t* m) { pthread_cond_wait(c, m); }
+    static void cond_signal(cond_t* c) { pthread_cond_signal(c); }
+    static void cond_broadcast(cond_t* c) { pthread_cond_broadcast(c); }
+    static void cond_destroy(cond_t* c) { pthread_cond_destroy(c); }
+
+    static void thread_yield(void) { sched_yield(); }
+    static int cpu_count(void) { return (int)sysconf(_SC_NPROCESSORS_ONLN); }
+#endif
+
+#define CACHE_LINE 64
+#define DEQUE_INITIAL_SIZE 256      // Grows by doubling
+#define STEAL_ATTEMPTS 4            // Rounds over all victims before idling
+#define SPINS_BEFORE_SLEEP 64
+
+// ===== Tasks and Futures =====
+
+typedef struct Task {
+    TaskFn fn;
+    ContinuationFn cont;            // Set for continuations instead of fn
+    void* arg;
+    void* prev_result;              // Input of a continuation
+    Future* future;                 // NULL for spawn/parallel_for chunks
+    struct Task* next;              // Injection queue / continuation list
+} Task;
+
+struct Future {
+    atomic_int done;
+    atomic_int refs;                // Caller + the task that completes it
+    atomic_flag lock;               // Guards the continuation list
+    void* result;
+    Task* continuations;
+};
+
+// ===== Chase-Lev Deque =====
+
+typedef struct DequeArray {
+    long mask;                      // size - 1, size is a power of two
+    struct DequeArray* retired;     // Older arrays, freed with the deque
+    _Atomic(Task*) slots[];
+} DequeArray;
+
+typedef struct {
+    // top is written by thieves, bottom by the owner: separate lines
+    _Alignas(CACHE_LINE) atomic_long top;
+    _Alignas(CACHE_LINE) atomic_long bottom;
+    _Atomic(DequeArray*) array;
+} Deque;
+
+#define STEAL_ABORT ((Task*)1)      // Lost a race; the deque may not be empty
+
+static DequeArray* deque_array_new(long size) {
+    DequeArray* a = (DequeArray*)malloc(sizeof(DequeArray) + size * sizeof(Task*));
+    a->mask = size - 1;
+    a->retired = NULL;
+    return a;
+}
+
+static void deque_init(Deque* d) {
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+    atomic_init(&d->array, deque_array_new(DEQUE_INITIAL_SIZE));
+}
+
+static void deque_destroy(Deque* d) {
+    DequeArray* a = atomic_load_explicit(&d->array, memory_order_relaxed);
+    while (a) {
+        DequeArray* old = a->retired;
+        free(a);
+        a = old;
+    }
+}
+
+// Owner only. Thieves may still read the old array, so it is kept
+// (not freed) until the pool is destroyed.
+static DequeArray* deque_grow(Deque* d, DequeArray* a, long top, long bottom) {
+    DequeArray* bigger = deque_array_new((a->mask + 1) * 2);
+    for (long i = top; i < bottom; i++) {
+        Task* t = atomic_load_explicit(&a->slots[i & a->mask], memory_order_relaxed);
+        atomic_store_explicit(&bigger->slots[i & bigger->mask], t, memory_order_relaxed);
+    }
+    bigger->retired = a;
+    atomic_store_explicit(&d->array, bigger, memory_order_release);
+    return bigger;
+}
+
+// Owner only
+static void deque_push(Deque* d, Task* t) {
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    DequeArray* a = atomic_load_explicit(&d->array, memory_order_relaxed);
+
+    if (b - top > a->mask) a = deque_grow(d, a, top, b);
+
+    atomic_store_explicit(&a->slots[b & a->mask], t, memory_order_relaxed);
+    // Release publishes the task (and what it points to) to thieves
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_release);
+}
+
+// Owner only: newest task first (LIFO keeps caches warm)
+static Task* deque_take(Deque* d) {
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    DequeArray* a = atomic_load_explicit(&d->array, memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (top > b) {
+        // Empty
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    Task* t = atomic_load_explicit(&a->slots[b & a->mask], memory_order_relaxed);
+    if (top == b) {
+        // Last task: race thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&d->top, &top, top + 1,
+                                                     memory_order_seq_cst,
+                                                     memory_order_relaxed)) {
+            t = NULL;
+        }
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return t;
+}
+
+// Any thread: oldest task first (biggest chunk of work)
+static Task* deque_steal(Deque* d) {
+    long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    if (top >= b) return NULL;
+
+    DequeArray* a = atomic_load_explicit(&d->array, memory_order_acquire);
+    Task* t = atomic_load_explicit(&a->slots[top & a->mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &top, top + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return STEAL_ABORT;
+    }
+    return t;
+}
+
+// ===== Pool =====
+
+typedef struct {
+    Deque deque;
+    ThreadPool* pool;
+    thread_t thread;
+    int index;
+    unsigned rng;
+    // Written only by the owning worker, read by pool_get_stats()
+    atomic_long executed, stolen, slept;
+} Worker;
+
+struct ThreadPool {
+    Worker* workers;
+    int num_workers;
+
+    // Submissions from non-worker threads
+    mutex_t inject_lock;
+    Task* inject_head;
+    Task* inject_tail;
+    atomic_int inject_size;         // Lock-free "anything there?" check
+
+    // Sleeping: see pool_notify() / worker_sleep()
+    mutex_t sleep_lock;
+    cond_t wake;
+    atomic_int idle;
+    atomic_long queued;             // Tasks pushed but not yet taken
+    atomic_int stop;
+};
+
+static _Thread_local Worker* tls_worker = NULL;
+
+// Single writer: a plain load + store, no locked read-modify-write
+static void stat_bump(atomic_long* counter) {
+    long v = atomic_load_explicit(counter, memory_order_relaxed);
+    atomic_store_explicit(counter, v + 1, memory_order_relaxed);
+}
+
+static void pool_notify(ThreadPool* pool) {
+    // Pairs with worker_sleep(): either we see idle > 0 and signal
+    // under the lock, or the worker sees queued > 0 and stays awake.
+    atomic_fetch_add(&pool->queued, 1);
+    if (atomic_load(&pool->idle) > 0) {
+        mutex_lock(&pool->sleep_lock);
+        cond_signal(&pool->wake);
+        mutex_unlock(&pool->sleep_lock);
+    }
+}
+
+static void pool_push(ThreadPool* pool, Task* t) {
+    Worker* w = tls_worker;
+    if (w != NULL && w->pool == pool) {
+        deque_push(&w->deque, t);
+    } else {
+        t->next = NULL;
+        mutex_lock(&pool->inject_lock);
+        if (pool->inject_tail) pool->inject_tail->next = t;
+        else pool->inject_head = t;
+        pool->inject_tail = t;
+        atomic_fetch_add_explicit(&pool->inject_size, 1, memory_order_relaxed);
+        mutex_unlock(&pool->inject_lock);
+    }
+    pool_notify(pool);
+}
+
+static Task* inject_pop(ThreadPool* pool) {
+    if (atomic_load_explicit(&pool->inject_size, memory_order_relaxed) == 0) return NULL;
+
+    mutex_lock(&pool->inject_lock);
+    Task* t = pool->inject_head;
+    if (t) {
+        pool->inject_head = t->next;
+        if (pool->inject_head == NULL) pool->inject_tail = NULL;
+        atomic_fetch_sub_explicit(&pool->inject_size, 1, memory_order_relaxed);
+    }
+    mutex_unlock(&pool->inject_lock);
+    return t;
+}
+
+static unsigned next_random(unsigned* state) {
+    // xorshift32
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Find one task: own deque, then injected work, then steal
+static Task* find_task(ThreadPool* pool, Worker* self) {
+    Task* t = NULL;
+    if (self) t = deque_take(&self->deque);
+    if (t == NULL) t = inject_pop(pool);
+
+    if (t == NULL) {
+        static _Thread_local unsigned outside_rng = 0x9E3779B9u;
+        unsigned* rng = self ? &self->rng : &outside_rng;
+        int n = pool->num_workers;
+
+        for (int round = 0; round < STEAL_ATTEMPTS && t == NULL; round++) {
+            int start = (int)(next_random(rng) % n);
+            int aborted = 0;
+            for (int i = 0; i < n; i++) {
+                Worker* victim = &pool->workers[(start + i) % n];
+                if (victim == self) continue;
+                Task* s = deque_steal(&victim->deque);
+                if (s == STEAL_ABORT) { aborted = 1; continue; }
+                if (s) { t = s; break; }
+            }
+            if (t == NULL && !aborted) break;  // Everything really is empty
+        }
+        if (t && self) stat_bump(&self->stolen);
+    }
+
+    if (t) atomic_fetch_sub(&pool->queued, 1);
+    return t;
+}
+
+static void future_complete(ThreadPool* pool, Future* f, void* result) {
+    f->result = result;
+
+    while (atomic_flag_test_and_set_explicit(&f->lock, memory_order_acquire)) {}
+    atomic_store_explicit(&f->done, 1, memory_order_release);
+    Task* conts = f->continuations;
+    f->continuations = NULL;
+    atomic_flag_clear_explicit(&f->lock, memory_order_release);
+
+    while (conts) {
+        Task* next = conts->next;
+        conts->prev_result = result;
+        pool_push(pool, conts);
+        conts = next;
+    }
+    future_release(f);
+}
+
+static void run_task(ThreadPool* pool, Task* t) {
+    void* result = t->cont ? t->cont(t->prev_result, t->arg) : t->fn(t->arg);
+    if (t->future) future_complete(pool, t->future, result);
+    free(t);
+    if (tls_worker) stat_bump(&tls_worker->executed);
+}
+
+// Run one task if there is one. Used by workers and by helping waiters.
+int pool_run_pending(ThreadPool* pool) {
+    Worker* self = tls_worker;
+    if (self && self->pool != pool) self = NULL;
+
+    Task* t = find_task(pool, self);
+    if (t == NULL) return 0;
+    run_task(pool, t);
+    return 1;
+}
+
+static void worker_sleep(ThreadPool* pool, Worker* w) {
+    mutex_lock(&pool->sleep_lock);
+    atomic_fetch_add(&pool->idle, 1);
+    if (atomic_load(&pool->queued) == 0 && !atomic_load(&pool->stop)) {
+        stat_bump(&w->slept);
+        cond_wait(&pool->wake, &pool->sleep_lock);
+    }
+    atomic_fetch_sub(&pool->idle, 1);
+    mutex_unlock(&pool->sleep_lock);
+}
+
+static THREAD_FUNC worker_main(void* arg) {
+    Worker* w = (Worker*)arg;
+    ThreadPool* pool = w->pool;
+    tls_worker = w;
+
+    int spins = 0;
+    while (!atomic_load_explicit(&pool->stop, memory_order_relaxed)) {
+        if (pool_run_pending(pool)) {
+            spins = 0;
+        } else if (++spins < SPINS_BEFORE_SLEEP) {
+            thread_yield();
+        } else {
+            worker_sleep(pool, w);
+            spins = 0;
+        }
+    }
+    THREAD_RETURN;
+}
+
+ThreadPool* pool_create(int num_threads) {
+    if (num_threads <= 0) num_threads = cpu_count();
+    if (num_threads < 1) num_threads = 1;
+
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    pool->num_workers = num_threads;
+    mutex_init(&pool->inject_lock);
+    mutex_init(&pool->sleep_lock);
+    cond_init(&pool->wake);
+
+    // Workers hold deques with cache-line aligned members
+    #ifdef _WIN32
+    pool->workers = (Worker*)_aligned_malloc(num_threads * sizeof(Worker), CACHE_LINE);
+    #else
+    pool->workers = (Worker*)aligned_alloc(CACHE_LINE,
+        ((num_threads * sizeof(Worker) + CACHE_LINE - 1) / CACHE_LINE) * CACHE_LINE);
+    #endif
+    memset(pool->workers, 0, num_threads * sizeof(Worker));
+
+    for (int i = 0; i < num_threads; i++) {
+        Worker* w = &pool->workers[i];
+        deque_init(&w->deque);
+        w->pool = pool;
+        w->index = i;
+        w->rng = 0x2545F491u * (unsigned)(i + 1);
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        Worker* w = &pool->workers[i];
+        #ifdef _WIN32
+        w->thread = CreateThread(NULL, 0, worker_main, w, 0, NULL);
+        #else
+        pthread_create(&w->thread, NULL, worker_main, w);
+        #endif
+    }
+    return pool;
+}
+
+void pool_destroy(ThreadPool* pool) {
+    // Finish whatever is still queued
+    while (atomic_load(&pool->queued) > 0) {
+        if (!pool_run_pending(pool)) thread_yield();
+    }
+
+    mutex_lock(&pool->sleep_lock);
+    atomic_store(&pool->stop, 1);
+    cond_broadcast(&pool->wake);
+    mutex_unlock(&pool->sleep_lock);
+
+    for (int i = 0; i < pool->num_workers; i++) {
+        #ifdef _WIN32
+        WaitForSingleObject(pool->workers[i].thread, INFINITE);
+        CloseHandle(pool->workers[i].thread);
+        #else
+        pthread_join(pool->workers[i].thread, NULL);
+        #endif
+    }
+    // Only after every thread is gone: any of them may still be stealing
+    for (int i = 0; i < pool->num_workers; i++) {
+        deque_destroy(&pool->workers[i].deque);
+    }
+
+    #ifdef _WIN32
+    _aligned_free(pool->workers);
+    #else
+    free(pool->workers);
+    #endif
+    mutex_destroy(&pool->inject_lock);
+    mutex_destroy(&pool->sleep_lock);
+    cond_destroy(&pool->wake);
+    free(pool);
+}
+
+int pool_num_threads(ThreadPool* pool) {
+    return pool->num_workers;
+}
+
+static Future* future_new(void) {
+    Future* f = (Future*)malloc(sizeof(Future));
+    atomic_init(&f->done, 0);
+    atomic_init(&f->refs, 2);       // Caller + completing task
+    atomic_flag_clear(&f->lock);
+    f->result = NULL;
+    f->continuations = NULL;
+    return f;
+}
+
+static Task* task_new(TaskFn fn, ContinuationFn cont, void* arg, Future* f) {
+    Task* t = (Task*)malloc(sizeof(Task));
+    t->fn = fn;
+    t->cont = cont;
+    t->arg = arg;
+    t->prev_result = NULL;
+    t->future = f;
+    t->next = NULL;
+    return t;
+}
+
+Future* pool_submit(ThreadPool* pool, TaskFn fn, void* arg) {
+    Future* f = future_new();
+    pool_push(pool, task_new(fn, NULL, arg, f));
+    return f;
+}
+
+void pool_spawn(ThreadPool* pool, TaskFn fn, void* arg) {
+    pool_push(pool, task_new(fn, NULL, arg, NULL));
+}
+
+Future* future_then(ThreadPool* pool, Future* f, ContinuationFn fn, void* arg) {
+    Future* next = future_new();
+    Task* t = task_new(NULL, fn, arg, next);
+
+    while (atomic_flag_test_and_set_explicit(&f->lock, memory_order_acquire)) {}
+    if (atomic_load_explicit(&f->done, memory_order_relaxed)) {
+        atomic_flag_clear_explicit(&f->lock, memory_order_release);
+        t->prev_result = f->result;
+        pool_push(pool, t);
+    } else {
+        t->next = f->continuations;
+        f->continuations = t;
+        atomic_flag_clear_explicit(&f->lock, memory_order_release);
+    }
+    return next;
+}
+
+int future_is_done(Future* f) {
+    return atomic_load_explicit(&f->done, memory_order_acquire);
+}
+
+void* future_wait(ThreadPool* pool, Future* f) {
+    // Helping join: keep the thread busy with other tasks. A worker
+    // that blocked here could starve the very task it waits for.
+    while (!future_is_done(f)) {
+        if (!pool_run_pending(pool)) thread_yield();
+    }
+    return f->result;
+}
+
+void future_release(Future* f) {
+    if (atomic_fetch_sub(&f->refs, 1) == 1) free(f);
+}
+
+// ===== parallel_for =====
+
+typedef struct {
+    RangeFn fn;
+    void* ctx;
+    long grain;
+    atomic_long remaining;          // Iterations not finished yet
+    ThreadPool* pool;
+} ForJob;
+
+typedef struct {
+    ForJob* job;
+    long begin, end;
+} ForRange;
+
+static void* for_task(void* arg) {
+    ForRange* r = (ForRange*)arg;
+    ForJob* job = r->job;
+    long begin = r->begin, end = r->end;
+    free(r);
+
+    // Split off the upper half until the rest is one grain. Thieves
+    // take the oldest (largest) halves, so work spreads in log steps.
+    while (end - begin > job->grain) {
+        long mid = begin + (end - begin) / 2;
+        ForRange* upper = (ForRange*)malloc(sizeof(ForRange));
+        upper->job = job;
+        upper->begin = mid;
+        upper->end = end;
+        pool_push(job->pool, task_new(for_task, NULL, upper, NULL));
+        end = mid;
+    }
+
+    job->fn(begin, end, job->ctx);
+    atomic_fetch_sub_explicit(&job->remaining, end - begin, memory_order_release);
+    return NULL;
+}
+
+void parallel_for(ThreadPool* pool, long begin, long end, long grain, RangeFn fn, void* ctx) {
+    if (end <= begin) return;
+
+    long n = end - begin;
+    if (grain <= 0) {
+        grain = n / ((long)pool->num_workers * 8);
+        if (grain < 1) grain = 1;
+    }
+    if (n <= grain) {
+        fn(begin, end, ctx);
+        return;
+    }
+
+    ForJob job;
+    job.fn = fn;
+    job.ctx = ctx;
+    job.grain = grain;
+    job.pool = pool;
+    atomic_init(&job.remaining, n);
+
+    ForRange* all = (ForRange*)malloc(sizeof(ForRange));
+    all->job = &job;
+    all->begin = begin;
+    all->end = end;
+    for_task(all);  // Caller does the first chunk itself
+
+    while (atomic_load_explicit(&job.remaining, memory_order_acquire) > 0) {
+        if (!pool_run_pending(pool)) thread_yield();
+    }
+}
+
+void pool_get_stats(ThreadPool* pool, int worker, WorkerStats* out) {
+    Worker* w = &pool->workers[worker];
+    out->executed = atomic_load_explicit(&w->executed, memory_order_relaxed);
+    out->stolen = atomic_load_explicit(&w->stolen, memory_order_relaxed);
+    out->slept = atomic_load_explicit(&w->slept, memory_order_relaxed);
+}
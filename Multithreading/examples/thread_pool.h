@@ -0,0 +1,64 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/*
+ * Work-stealing thread pool
+ *
+ * One deque per worker (Chase-Lev): the owner pushes and pops at the
+ * bottom without locks, idle workers steal from the top of others.
+ * Tasks spawned by a task stay on the same core, so recursive
+ * fork-join work keeps its cache and never touches a shared lock.
+ *
+ * Waiting never blocks a worker: future_wait() and parallel_for()
+ * run other tasks until the result is ready ("helping join"), so
+ * nested parallelism can't deadlock the pool.
+ *
+ * Build: add thread_pool.c to the compile line (-pthread on Linux).
+ */
+
+typedef struct ThreadPool ThreadPool;
+typedef struct Future Future;
+
+typedef void* (*TaskFn)(void* arg);
+typedef void* (*ContinuationFn)(void* prev_result, void* arg);
+typedef void (*RangeFn)(long begin, long end, void* ctx);
+
+// Pool lifetime. num_threads <= 0 uses one worker per CPU.
+ThreadPool* pool_create(int num_threads);
+void pool_destroy(ThreadPool* pool);
+int pool_num_threads(ThreadPool* pool);
+
+// Run fn(arg) on the pool. The returned future holds its result.
+Future* pool_submit(ThreadPool* pool, TaskFn fn, void* arg);
+
+// Fire-and-forget: no future allocated
+void pool_spawn(ThreadPool* pool, TaskFn fn, void* arg);
+
+// Run fn(result of f, arg) once f completes. Returns its own future.
+Future* future_then(ThreadPool* pool, Future* f, ContinuationFn fn, void* arg);
+
+// Wait for the result, running other pool tasks meanwhile
+void* future_wait(ThreadPool* pool, Future* f);
+int future_is_done(Future* f);
+
+// Run one queued task on the calling thread. Returns 0 if none was
+// found. For custom wait loops that should help rather than spin.
+int pool_run_pending(ThreadPool* pool);
+
+// Drop your reference. Safe before or after completion.
+void future_release(Future* f);
+
+// fn(begin, end, ctx) over [begin, end) split into chunks of about
+// 'grain' iterations. grain <= 0 picks one: ~8 chunks per worker.
+void parallel_for(ThreadPool* pool, long begin, long end, long grain, RangeFn fn, void* ctx);
+
+// Per-worker counters since creation
+typedef struct {
+    long executed;
+    long stolen;
+    long slept;
+} WorkerStats;
+
+void pool_get_stats(ThreadPool* pool, int worker, WorkerStats* out);
+
+#endif
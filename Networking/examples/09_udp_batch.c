@@ -0,0 +1,862 @@
+/*
+ * 09_udp_batch.c
+ *
+ * Batched UDP datagram engine - many datagrams per system call.
+ * 05/06 do one sendto()/recvfrom() per datagram, so the syscall cost
+ * caps throughput. Here we use recvmmsg()/sendmmsg() with preallocated
+ * message vectors, UDP GSO/GRO where the kernel supports it, a tuned
+ * SO_RCVBUF and kernel drop counters.
+ *
+ * Usage:
+ *   09_udp_batch bench [size] [seconds]
+ *   09_udp_batch receiver [port]
+ *   09_udp_batch sender <ip> [port] [pps] [seconds] [size]
+ */
+
+#ifndef _WIN32
+    #define _GNU_SOURCE  // recvmmsg/sendmmsg
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <windows.h>
+    #pragma comment(lib, "ws2_32.lib")
+    #define CLOSE_SOCKET closesocket
+    typedef int socklen_t;
+#else
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <time.h>
+    #include <unistd.h>
+    #define CLOSE_SOCKET close
+#endif
+
+#ifdef __linux__
+    #define HAVE_MMSG 1
+    // Older headers don't know the GSO/GRO options yet
+    #ifndef SOL_UDP
+        #define SOL_UDP 17
+    #endif
+    #ifndef UDP_SEGMENT
+        #define UDP_SEGMENT 103
+    #endif
+    #ifndef UDP_GRO
+        #define UDP_GRO 104
+    #endif
+#else
+    #define HAVE_MMSG 0
+#endif
+
+#define PORT 8080
+#define BATCH_SIZE 64            // Messages per sendmmsg/recvmmsg
+#define MAX_DATAGRAM 1472        // Fits a 1500 byte Ethernet MTU
+#define SUPER_BUFFER 65535       // One GSO/GRO super-packet
+#define GSO_MAX_SEGMENTS 64      // Kernel limit per GSO send (UDP_MAX_SEGMENTS)
+#define GSO_MAX_PAYLOAD 65507    // Largest IPv4 UDP payload: 65535 - 20 IP - 8 UDP
+#define RCVBUF_SIZE (8 * 1024 * 1024)
+#define HEADER_SIZE 8            // 64-bit sequence number
+
+// ===== Timing =====
+
+double now_seconds(void) {
+    #ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+    #else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+    #endif
+}
+
+void sleep_micros(int us) {
+    #ifdef _WIN32
+    Sleep(us / 1000 > 0 ? us / 1000 : 1);
+    #else
+    struct timespec ts = { 0, us * 1000L };
+    nanosleep(&ts, NULL);
+    #endif
+}
+
+// ===== Sequence numbers (big-endian on the wire) =====
+
+void put_u64(unsigned char* p, unsigned long long v) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (unsigned char)(v & 0xFF);
+        v >>= 8;
+    }
+}
+
+unsigned long long get_u64(const unsigned char* p) {
+    unsigned long long v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// ===== Datagram Engine =====
+
+typedef struct {
+    unsigned long long datagrams;     // Datagrams sent or received
+    unsigned long long bytes;         // Payload bytes
+    unsigned long long syscalls;      // sendmmsg/recvmmsg calls
+    unsigned long long send_errors;   // Datagrams the kernel refused (ENOBUFS...)
+    unsigned long long kernel_drops;  // Receive queue overflows (SO_RXQ_OVFL)
+    unsigned long long highest_seq;   // Highest sequence number seen + 1
+    unsigned long long reordered;     // Arrived with a lower seq than before
+} UdpStats;
+
+typedef struct {
+    int fd;
+    int batch;           // Number of message slots
+    size_t slot_size;    // Bytes per slot (MTU, or 64KB with GSO/GRO)
+    char* buffers;       // batch * slot_size, one contiguous block
+    size_t* slot_used;   // Bytes queued in each slot (sender)
+    int slot_count;      // Slots holding queued data (sender)
+    int gso_size;        // Segment size when GSO is on, 0 = off
+    int gro;             // 1 if the kernel coalesces received datagrams
+    UdpStats stats;
+    #if HAVE_MMSG
+    struct mmsghdr* msgs;
+    struct iovec* iovs;
+    struct sockaddr_in* addrs;
+    char* controls;      // Per-message ancillary data space
+    size_t control_size;
+    #endif
+} UdpEngine;
+
+typedef void (*datagram_handler)(void* ctx, const char* data, size_t len);
+
+void udp_engine_destroy(UdpEngine* e) {
+    if (e == NULL) return;
+    #if HAVE_MMSG
+    free(e->msgs);
+    free(e->iovs);
+    free(e->addrs);
+    free(e->controls);
+    #endif
+    free(e->buffers);
+    free(e->slot_used);
+    free(e);
+}
+
+// Preallocate everything once - the hot path never calls malloc
+UdpEngine* udp_engine_create(int fd, int batch, size_t slot_size) {
+    UdpEngine* e = (UdpEngine*)calloc(1, sizeof(UdpEngine));
+    if (e == NULL) return NULL;
+
+    e->fd = fd;
+    e->batch = batch;
+    e->slot_size = slot_size;
+    e->buffers = (char*)malloc((size_t)batch * slot_size);
+    e->slot_used = (size_t*)calloc(batch, sizeof(size_t));
+    int ok = e->buffers != NULL && e->slot_used != NULL;
+
+    #if HAVE_MMSG
+    e->control_size = CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(unsigned int)) +
+                      CMSG_SPACE(sizeof(unsigned short));
+    e->msgs = (struct mmsghdr*)calloc(batch, sizeof(struct mmsghdr));
+    e->iovs = (struct iovec*)calloc(batch, sizeof(struct iovec));
+    e->addrs = (struct sockaddr_in*)calloc(batch, sizeof(struct sockaddr_in));
+    e->controls = (char*)calloc(batch, e->control_size);
+    ok = ok && e->msgs && e->iovs && e->addrs && e->controls;
+    #endif
+
+    if (!ok) {
+        udp_engine_destroy(e);
+        return NULL;
+    }
+
+    return e;
+}
+
+// Ask for a big receive buffer so bursts queue instead of dropping.
+// Returns the size the kernel actually granted.
+int udp_set_rcvbuf(int fd, int bytes) {
+    #ifdef SO_RCVBUFFORCE
+    // Ignores net.core.rmem_max, but needs CAP_NET_ADMIN
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &bytes, sizeof(bytes)) < 0)
+    #endif
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const char*)&bytes, sizeof(bytes));
+
+    int granted = 0;
+    socklen_t len = sizeof(granted);
+    getsockopt(fd, SOL_SOCKET, SO_RCVBUF, (char*)&granted, &len);
+    return granted;
+}
+
+// Turn on the per-socket drop counter (delivered as ancillary data)
+void udp_enable_drop_counter(int fd) {
+    #ifdef SO_RXQ_OVFL
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on));
+    #else
+    (void)fd;
+    #endif
+}
+
+// Receive side: kernel merges same-flow datagrams into super-packets
+int udp_enable_gro(UdpEngine* e) {
+    #if HAVE_MMSG
+    int on = 1;
+    if (e->slot_size >= SUPER_BUFFER &&
+        setsockopt(e->fd, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0) {
+        e->gro = 1;
+    }
+    #endif
+    return e->gro;
+}
+
+// Send side: hand the kernel one 64KB buffer, it splits it into
+// segment_size datagrams. Probed once with a real send on first flush.
+int udp_enable_gso(UdpEngine* e, int segment_size) {
+    #if HAVE_MMSG
+    if (e->slot_size >= SUPER_BUFFER && segment_size <= MAX_DATAGRAM) {
+        e->gso_size = segment_size;
+    }
+    #else
+    (void)segment_size;
+    #endif
+    return e->gso_size > 0;
+}
+
+// Reserve len bytes for one datagram and return where to write it.
+// Writing in place avoids a copy. Returns NULL when all slots are full:
+// call udp_engine_flush() and try again.
+char* udp_engine_reserve(UdpEngine* e, size_t len) {
+    if (len > e->slot_size) return NULL;
+
+    // With GSO, pack equal-sized datagrams into the current slot
+    if (e->gso_size > 0 && e->slot_count > 0 && len == (size_t)e->gso_size) {
+        int s = e->slot_count - 1;
+        size_t used = e->slot_used[s];
+        if (used % e->gso_size == 0 && used + len <= GSO_MAX_PAYLOAD &&
+            used / e->gso_size < GSO_MAX_SEGMENTS) {
+            e->slot_used[s] += len;
+            return e->buffers + (size_t)s * e->slot_size + used;
+        }
+    }
+
+    if (e->slot_count == e->batch) return NULL;
+
+    int s = e->slot_count++;
+    e->slot_used[s] = len;
+    return e->buffers + (size_t)s * e->slot_size;
+}
+
+#if HAVE_MMSG
+// Datagrams a slot goes out as: one per segment when GSO cuts it
+static int slot_segments(size_t bytes, int gso_size) {
+    if (gso_size > 0 && bytes > (size_t)gso_size) {
+        return (int)((bytes + gso_size - 1) / gso_size);
+    }
+    return 1;
+}
+
+// sendmmsg the first count messages, retrying after partial sends.
+// Returns datagrams sent
+static int send_queued(UdpEngine* e, int count) {
+    int sent_datagrams = 0;
+    int done = 0;
+    while (done < count) {
+        int n = sendmmsg(e->fd, e->msgs + done, count - done, 0);
+        e->stats.syscalls++;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            e->stats.send_errors++;
+            done++;
+            continue;
+        }
+        for (int i = done; i < done + n; i++) e->stats.bytes += e->iovs[i].iov_len;
+        sent_datagrams += n;
+        done += n;
+    }
+    return sent_datagrams;
+}
+
+// GSO was refused: send slots from..slot_count again, one message per
+// segment. Returns datagrams sent
+static int send_unsegmented(UdpEngine* e, const struct sockaddr_in* dest, int from, int gso_size) {
+    int sent_datagrams = 0;
+    int queued = 0;
+    for (int s = from; s < e->slot_count; s++) {
+        char* data = e->buffers + (size_t)s * e->slot_size;
+        size_t used = e->slot_used[s];
+        size_t seg = gso_size > 0 ? (size_t)gso_size : used;
+        size_t off = 0;
+        do {
+            struct msghdr* h = &e->msgs[queued].msg_hdr;
+            e->iovs[queued].iov_base = data + off;
+            e->iovs[queued].iov_len = used - off < seg ? used - off : seg;
+            h->msg_name = (void*)dest;
+            h->msg_namelen = sizeof(*dest);
+            h->msg_iov = &e->iovs[queued];
+            h->msg_iovlen = 1;
+            h->msg_control = NULL;
+            h->msg_controllen = 0;
+            h->msg_flags = 0;
+            if (++queued == e->batch) {
+                sent_datagrams += send_queued(e, queued);
+                queued = 0;
+            }
+            off += seg;
+        } while (off < used);
+    }
+    if (queued > 0) sent_datagrams += send_queued(e, queued);
+    return sent_datagrams;
+}
+#endif
+
+// Send every queued slot. Returns datagrams handed to the kernel.
+int udp_engine_flush(UdpEngine* e, const struct sockaddr_in* dest) {
+    if (e->slot_count == 0) return 0;
+
+    int sent_datagrams = 0;
+
+    #if HAVE_MMSG
+    // Segment size the slots are cut with, kept for counting and for the
+    // fallback if the kernel refuses GSO and e->gso_size is turned off
+    int gso_size = e->gso_size;
+    for (int s = 0; s < e->slot_count; s++) {
+        struct msghdr* h = &e->msgs[s].msg_hdr;
+        e->iovs[s].iov_base = e->buffers + (size_t)s * e->slot_size;
+        e->iovs[s].iov_len = e->slot_used[s];
+        h->msg_name = (void*)dest;
+        h->msg_namelen = sizeof(*dest);
+        h->msg_iov = &e->iovs[s];
+        h->msg_iovlen = 1;
+        h->msg_control = NULL;
+        h->msg_controllen = 0;
+        h->msg_flags = 0;
+
+        // Multi-segment slot: tell the kernel where to cut it
+        if (gso_size > 0 && e->slot_used[s] > (size_t)gso_size) {
+            char* control = e->controls + (size_t)s * e->control_size;
+            h->msg_control = control;
+            h->msg_controllen = CMSG_SPACE(sizeof(unsigned short));
+            struct cmsghdr* cm = CMSG_FIRSTHDR(h);
+            cm->cmsg_level = SOL_UDP;
+            cm->cmsg_type = UDP_SEGMENT;
+            cm->cmsg_len = CMSG_LEN(sizeof(unsigned short));
+            unsigned short seg = (unsigned short)gso_size;
+            memcpy(CMSG_DATA(cm), &seg, sizeof(seg));
+        }
+    }
+
+    int done = 0;
+    while (done < e->slot_count) {
+        int n = sendmmsg(e->fd, e->msgs + done, e->slot_count - done, 0);
+        e->stats.syscalls++;
+
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if ((errno == EIO || errno == EINVAL || errno == EMSGSIZE) && gso_size > 0) {
+                // No segmentation offload on this path (or the super-packet
+                // is too big for it) - stop using GSO and resend the rest
+                // one datagram per message
+                fprintf(stderr, "[udp] GSO send failed (%s), disabling\n", strerror(errno));
+                e->gso_size = 0;
+                sent_datagrams += send_unsegmented(e, dest, done, gso_size);
+                break;
+            }
+            // Count this slot's datagrams as lost and move on
+            e->stats.send_errors += slot_segments(e->slot_used[done], gso_size);
+            done++;
+            continue;
+        }
+
+        for (int i = done; i < done + n; i++) {
+            sent_datagrams += slot_segments(e->slot_used[i], gso_size);
+            e->stats.bytes += e->slot_used[i];
+        }
+        done += n;
+    }
+    #else
+    for (int s = 0; s < e->slot_count; s++) {
+        const char* data = e->buffers + (size_t)s * e->slot_size;
+        int n = sendto(e->fd, data, (int)e->slot_used[s], 0,
+                       (const struct sockaddr*)dest, sizeof(*dest));
+        e->stats.syscalls++;
+        if (n < 0) {
+            e->stats.send_errors++;
+        } else {
+            sent_datagrams++;
+            e->stats.bytes += n;
+        }
+    }
+    #endif
+
+    e->stats.datagrams += sent_datagrams;
+    e->slot_count = 0;
+    return sent_datagrams;
+}
+
+// Pull the drop counter / GRO segment size out of ancillary data
+#if HAVE_MMSG
+static void parse_control(UdpEngine* e, struct msghdr* h, size_t* segment) {
+    for (struct cmsghdr* cm = CMSG_FIRSTHDR(h); cm != NULL; cm = CMSG_NXTHDR(h, cm)) {
+        #ifdef SO_RXQ_OVFL
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SO_RXQ_OVFL) {
+            unsigned int drops;
+            memcpy(&drops, CMSG_DATA(cm), sizeof(drops));
+            e->stats.kernel_drops = drops;  // Cumulative, not a delta
+        }
+        #endif
+        if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+            int seg;
+            memcpy(&seg, CMSG_DATA(cm), sizeof(seg));
+            *segment = (size_t)seg;
+        }
+    }
+}
+#endif
+
+// Receive one batch and call handler once per datagram.
+// Returns datagrams received, 0 if nothing was ready, -1 on error.
+int udp_engine_recv(UdpEngine* e, int nonblocking, datagram_handler handler, void* ctx) {
+    int count = 0;
+
+    #if HAVE_MMSG
+    for (int s = 0; s < e->batch; s++) {
+        struct msghdr* h = &e->msgs[s].msg_hdr;
+        e->iovs[s].iov_base = e->buffers + (size_t)s * e->slot_size;
+        e->iovs[s].iov_len = e->slot_size;
+        h->msg_name = &e->addrs[s];
+        h->msg_namelen = sizeof(e->addrs[s]);
+        h->msg_iov = &e->iovs[s];
+        h->msg_iovlen = 1;
+        h->msg_control = e->controls + (size_t)s * e->control_size;
+        h->msg_controllen = e->control_size;  // Kernel shrinks it, reset every time
+        h->msg_flags = 0;
+    }
+
+    // MSG_WAITFORONE: block for the first datagram, then take what's queued
+    int flags = nonblocking ? MSG_DONTWAIT : MSG_WAITFORONE;
+    int n = recvmmsg(e->fd, e->msgs, e->batch, flags, NULL);
+    e->stats.syscalls++;
+
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return 0;
+        return -1;
+    }
+
+    for (int s = 0; s < n; s++) {
+        const char* data = e->buffers + (size_t)s * e->slot_size;
+        size_t len = e->msgs[s].msg_len;
+        size_t segment = len;
+        parse_control(e, &e->msgs[s].msg_hdr, &segment);
+        if (segment == 0) segment = len;
+
+        // A GRO super-packet holds several datagrams back to back
+        for (size_t off = 0; off < len; off += segment) {
+            size_t part = len - off < segment ? len - off : segment;
+            handler(ctx, data + off, part);
+            e->stats.datagrams++;
+            e->stats.bytes += part;
+            count++;
+        }
+    }
+    #else
+    (void)nonblocking;  // Windows: plain blocking recvfrom
+    int n = recvfrom(e->fd, e->buffers, (int)e->slot_size, 0, NULL, NULL);
+    e->stats.syscalls++;
+    if (n < 0) return -1;
+    handler(ctx, e->buffers, (size_t)n);
+    e->stats.datagrams++;
+    e->stats.bytes += n;
+    count = 1;
+    #endif
+
+    return count;
+}
+
+// Default handler: track sequence numbers to detect loss/reordering
+void track_sequence(void* ctx, const char* data, size_t len) {
+    UdpStats* st = (UdpStats*)ctx;
+    if (len < HEADER_SIZE) return;
+
+    unsigned long long seq = get_u64((const unsigned char*)data);
+    if (seq + 1 > st->highest_seq) {
+        st->highest_seq = seq + 1;
+    } else {
+        st->reordered++;
+    }
+}
+
+// ===== Benchmark Helpers =====
+
+int make_udp_socket(void) {
+    int fd = (int)socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket failed");
+    }
+    return fd;
+}
+
+void set_nonblocking(int fd) {
+    #ifdef _WIN32
+    u_long mode = 1;
+    ioctlsocket(fd, FIONBIO, &mode);
+    #else
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    #endif
+}
+
+// How many datagrams we may send now to stay on the target rate
+long long paced_budget(double start, long long sent, long long pps, int max) {
+    if (pps <= 0) return max;
+    long long allowed = (long long)((now_seconds() - start) * pps) - sent;
+    if (allowed > max) allowed = max;
+    return allowed < 0 ? 0 : allowed;
+}
+
+// Queue and flush up to 'count' datagrams of 'size' bytes
+int send_burst(UdpEngine* tx, const struct sockaddr_in* dest,
+               unsigned long long* next_seq, long long count, size_t size) {
+    int sent = 0;
+    for (long long i = 0; i < count; i++) {
+        char* p = udp_engine_reserve(tx, size);
+        if (p == NULL) {
+            sent += udp_engine_flush(tx, dest);
+            p = udp_engine_reserve(tx, size);
+        }
+        put_u64((unsigned char*)p, (*next_seq)++);
+        memset(p + HEADER_SIZE, 'x', size - HEADER_SIZE);
+    }
+    sent += udp_engine_flush(tx, dest);
+    return sent;
+}
+
+void print_report(const char* name, double seconds, UdpStats* tx, UdpStats* rx,
+                  unsigned long long sequenced) {
+    unsigned long long expected = sequenced;
+    unsigned long long lost = expected > rx->datagrams ? expected - rx->datagrams : 0;
+
+    printf("%-28s %10.0f %10.0f %7.2f%% %8llu %10.2f %10.2f\n",
+           name,
+           tx->datagrams / seconds,
+           rx->datagrams / seconds,
+           expected ? lost * 100.0 / expected : 0.0,
+           rx->kernel_drops,
+           tx->syscalls ? (double)tx->datagrams / tx->syscalls : 0.0,
+           rx->syscalls ? (double)rx->datagrams / rx->syscalls : 0.0);
+}
+
+// ===== Loopback benchmark (sender and receiver in one process) =====
+
+void bench_config(const char* name, int batch, int use_offload, size_t size, double seconds) {
+    int rx_fd = make_udp_socket();
+    int tx_fd = make_udp_socket();
+    if (rx_fd < 0 || tx_fd < 0) return;
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;  // Let the OS pick a free port
+
+    if (bind(rx_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind failed");
+        CLOSE_SOCKET(rx_fd);
+        CLOSE_SOCKET(tx_fd);
+        return;
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(rx_fd, (struct sockaddr*)&addr, &len);
+
+    udp_set_rcvbuf(rx_fd, RCVBUF_SIZE);
+    udp_enable_drop_counter(rx_fd);
+    set_nonblocking(rx_fd);
+
+    size_t slot = use_offload ? SUPER_BUFFER : MAX_DATAGRAM;
+    UdpEngine* tx = udp_engine_create(tx_fd, batch, slot);
+    UdpEngine* rx = udp_engine_create(rx_fd, batch, slot);
+    if (tx == NULL || rx == NULL) {
+        printf("Out of memory\n");
+        udp_engine_destroy(tx);
+        udp_engine_destroy(rx);
+        CLOSE_SOCKET(rx_fd);
+        CLOSE_SOCKET(tx_fd);
+        return;
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s", name);
+    if (use_offload) {
+        int gso = udp_enable_gso(tx, (int)size);
+        int gro = udp_enable_gro(rx);
+        if (!gso || !gro) {
+            snprintf(label, sizeof(label), "%s (no %s%s)", name,
+                     gso ? "" : "GSO ", gro ? "" : "GRO");
+        }
+    }
+
+    unsigned long long next_seq = 0;
+    double start = now_seconds();
+    double end = start + seconds;
+
+    while (now_seconds() < end) {
+        // A batch of sends, then drain what has arrived
+        send_burst(tx, &addr, &next_seq,
+                   use_offload ? (long long)batch * GSO_MAX_SEGMENTS : batch, size);
+        while (udp_engine_recv(rx, 1, track_sequence, &rx->stats) > 0) {
+        }
+    }
+
+    // Pick up stragglers still in the socket buffer
+    sleep_micros(20000);
+    while (udp_engine_recv(rx, 1, track_sequence, &rx->stats) > 0) {
+    }
+
+    double elapsed = now_seconds() - start;
+    print_report(label, elapsed, &tx->stats, &rx->stats, next_seq);
+
+    udp_engine_destroy(tx);
+    udp_engine_destroy(rx);
+    CLOSE_SOCKET(rx_fd);
+    CLOSE_SOCKET(tx_fd);
+}
+
+void run_bench(size_t size, double seconds) {
+    printf("=== Batched UDP Loopback Benchmark ===\n");
+    printf("Datagram size: %zu bytes, %.1f seconds per run\n\n", size, seconds);
+
+    printf("%-28s %10s %10s %8s %8s %10s %10s\n",
+           "Mode", "tx pps", "rx pps", "loss", "drops", "tx/call", "rx/call");
+    printf("---------------------------------------------------------------------------------------------\n");
+
+    bench_config("1 per syscall (05/06 style)", 1, 0, size, seconds);
+    bench_config("sendmmsg/recvmmsg x64", BATCH_SIZE, 0, size, seconds);
+    #if HAVE_MMSG
+    bench_config("mmsg + GSO/GRO", 8, 1, size, seconds);
+    #endif
+
+    printf("\ntx/call, rx/call = datagrams moved per system call\n");
+    printf("drops = kernel receive queue overflows (SO_RXQ_OVFL)\n");
+}
+
+// ===== Standalone receiver / paced sender =====
+
+void run_receiver(int port) {
+    printf("=== Batched UDP Receiver ===\n");
+
+    int fd = make_udp_socket();
+    if (fd < 0) return;
+
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&opt, sizeof(opt));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind failed");
+        CLOSE_SOCKET(fd);
+        return;
+    }
+
+    int granted = udp_set_rcvbuf(fd, RCVBUF_SIZE);
+    udp_enable_drop_counter(fd);
+
+    #ifndef _WIN32
+    // Wake up once a second to print stats even when idle
+    struct timeval tv = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    #endif
+
+    UdpEngine* rx = udp_engine_create(fd, BATCH_SIZE, HAVE_MMSG ? SUPER_BUFFER : MAX_DATAGRAM);
+    if (rx == NULL) {
+        printf("Out of memory\n");
+        CLOSE_SOCKET(fd);
+        return;
+    }
+    int gro = udp_enable_gro(rx);
+
+    printf("Listening on port %d (SO_RCVBUF %d bytes, GRO %s)\n",
+           port, granted, gro ? "on" : "off");
+    printf("Press Ctrl+C to stop\n\n");
+
+    double last = now_seconds();
+    unsigned long long last_count = 0;
+
+    while (1) {
+        if (udp_engine_recv(rx, 0, track_sequence, &rx->stats) < 0) {
+            #ifdef _WIN32
+            perror("recvfrom failed");
+            break;
+            #else
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("recvmmsg failed");
+                break;
+            }
+            #endif
+        }
+
+        double now = now_seconds();
+        if (now - last >= 1.0) {
+            UdpStats* st = &rx->stats;
+            unsigned long long lost = st->highest_seq > st->datagrams ?
+                                      st->highest_seq - st->datagrams : 0;
+            printf("%10.0f pps  total %llu  lost %llu (%.2f%%)  kernel drops %llu  per call %.1f\n",
+                   (st->datagrams - last_count) / (now - last),
+                   st->datagrams, lost,
+                   st->highest_seq ? lost * 100.0 / st->highest_seq : 0.0,
+                   st->kernel_drops,
+                   st->syscalls ? (double)st->datagrams / st->syscalls : 0.0);
+            fflush(stdout);
+            last = now;
+            last_count = st->datagrams;
+        }
+    }
+
+    udp_engine_destroy(rx);
+    CLOSE_SOCKET(fd);
+}
+
+void run_sender(const char* ip, int port, long long pps, double seconds, size_t size) {
+    printf("=== Batched UDP Sender ===\n");
+
+    int fd = make_udp_socket();
+    if (fd < 0) return;
+
+    struct sockaddr_in dest = {0};
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(port);
+    dest.sin_addr.s_addr = inet_addr(ip);
+
+    UdpEngine* tx = udp_engine_create(fd, BATCH_SIZE, HAVE_MMSG ? SUPER_BUFFER : MAX_DATAGRAM);
+    if (tx == NULL) {
+        printf("Out of memory\n");
+        CLOSE_SOCKET(fd);
+        return;
+    }
+    int gso = udp_enable_gso(tx, (int)size);
+
+    printf("Sending %zu byte datagrams to %s:%d for %.0f s at %s pps (GSO %s)\n",
+           size, ip, port, seconds, pps > 0 ? "paced" : "unlimited", gso ? "on" : "off");
+    if (pps > 0) printf("Target rate: %lld pps\n", pps);
+
+    unsigned long long seq = 0;
+    long long sent = 0;
+    double start = now_seconds();
+
+    while (now_seconds() - start < seconds) {
+        long long budget = paced_budget(start, sent, pps, BATCH_SIZE * 8);
+        if (budget == 0) {
+            sleep_micros(50);
+            continue;
+        }
+        sent += budget;
+        send_burst(tx, &dest, &seq, budget, size);
+    }
+
+    double elapsed = now_seconds() - start;
+    printf("\nSent %llu datagrams in %.2f s (%.0f pps, %.1f Mbit/s)\n",
+           tx->stats.datagrams, elapsed, tx->stats.datagrams / elapsed,
+           tx->stats.bytes * 8.0 / elapsed / 1e6);
+    printf("System calls: %llu (%.1f datagrams per call)\n",
+           tx->stats.syscalls,
+           tx->stats.syscalls ? (double)tx->stats.datagrams / tx->stats.syscalls : 0.0);
+    printf("Send errors: %llu\n", tx->stats.send_errors);
+
+    udp_engine_destroy(tx);
+    CLOSE_SOCKET(fd);
+}
+
+int main(int argc, char* argv[]) {
+    // Initialize Winsock (Windows)
+    #ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        printf("WSAStartup failed\n");
+        return 1;
+    }
+    #endif
+
+    const char* mode = argc >= 2 ? argv[1] : "bench";
+
+    if (strcmp(mode, "bench") == 0) {
+        size_t size = argc >= 3 ? (size_t)atoi(argv[2]) : 64;
+        double seconds = argc >= 4 ? atof(argv[3]) : 2.0;
+        if (size < HEADER_SIZE) size = HEADER_SIZE;
+        if (size > MAX_DATAGRAM) size = MAX_DATAGRAM;
+        run_bench(size, seconds);
+    } else if (strcmp(mode, "receiver") == 0) {
+        run_receiver(argc >= 3 ? atoi(argv[2]) : PORT);
+    } else if (strcmp(mode, "sender") == 0 && argc >= 3) {
+        int port = argc >= 4 ? atoi(argv[3]) : PORT;
+        long long pps = argc >= 5 ? atoll(argv[4]) : 100000;
+        double seconds = argc >= 6 ? atof(argv[5]) : 5.0;
+        size_t size = argc >= 7 ? (size_t)atoi(argv[6]) : 64;
+        if (size < HEADER_SIZE) size = HEADER_SIZE;
+        if (size > MAX_DATAGRAM) size = MAX_DATAGRAM;
+        run_sender(argv[2], port, pps, seconds, size);
+    } else {
+        printf("Usage:\n");
+        printf("  %s bench [size] [seconds]\n", argv[0]);
+        printf("  %s receiver [port]\n", argv[0]);
+        printf("  %s sender <ip> [port] [pps] [seconds] [size]\n", argv[0]);
+        printf("\npps = 0 sends as fast as possible\n");
+    }
+
+    #ifdef _WIN32
+    WSACleanup();
+    #endif
+
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Where the time goes:
+ *
+ * Small datagrams are dominated by per-packet fixed cost, not bytes:
+ * one syscall entry/exit, socket lookup, skb allocation, wakeup.
+ *
+ *   05/06:    sendto()   x N   ->  N syscalls
+ *   batched:  sendmmsg() x N/64 -> 64x fewer syscalls
+ *   GSO:      one 64KB send, kernel cuts it into N datagrams late
+ *             (on real NICs the hardware does it)
+ *   GRO:      receiver gets same-flow datagrams glued into one buffer,
+ *             split it again using the segment size from the cmsg
+ *
+ * Message vectors:
+ * ┌──────────┬──────────┬─────┐
+ * │ mmsghdr0 │ mmsghdr1 │ ... │  -> iovec -> slot buffer (preallocated)
+ * └──────────┴──────────┴─────┘
+ * Everything is allocated once in udp_engine_create(), so the hot loop
+ * never touches malloc.
+ *
+ * Loss accounting:
+ * - Every datagram carries a 64-bit sequence number
+ * - Receiver: lost = highest_seq - received
+ * - SO_RXQ_OVFL reports datagrams dropped because SO_RCVBUF was full,
+ *   which is the usual cause of loss on a busy receiver
+ * - SO_RCVBUF is capped by net.core.rmem_max unless the process has
+ *   CAP_NET_ADMIN (SO_RCVBUFFORCE)
+ *
+ * Test:
+ * 1. 09_udp_batch bench            (everything on loopback)
+ * 2. Terminal 1: 09_udp_batch receiver
+ *    Terminal 2: 09_udp_batch sender 127.0.0.1 8080 500000 5
+ * 3. Raise pps until "lost" climbs - that's the receiver's limit
+ *
+ * Try:
+ * - Shrink RCVBUF_SIZE and watch kernel drops appear
+ * - Change BATCH_SIZE (1, 8, 64, 256) and compare per-call numbers
+ * - Run several receivers with SO_REUSEPORT to spread load over cores
+ * - Pin sender and receiver to different CPUs (taskset)
+ */
@@ -0,0 +1,1003 @@
+/*
+ * 10_reliable_udp.c
+ *
+ * Reliable ordered messaging over UDP - what games use instead of TCP.
+ * Builds on 05/06: same sockets, plus sequence numbers, selective ACK
+ * bitfields, reliable and unreliable channels, fragmentation, RTT
+ * estimation and a congestion window. Everything is driven by one
+ * select() event loop, like 04_chat_server.
+ *
+ * A lost TCP segment stalls every byte behind it (head-of-line blocking).
+ * Here a lost reliable message only delays its own channel - position
+ * updates on the unreliable channel keep flowing.
+ *
+ * Usage: 10_reliable_udp [loss_percent] [latency_ms] [seconds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <windows.h>
+    #pragma comment(lib, "ws2_32.lib")
+    #define CLOSE_SOCKET closesocket
+    typedef int socklen_t;
+#else
+    #include <sys/socket.h>
+    #include <sys/select.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <time.h>
+    #include <unistd.h>
+    #define CLOSE_SOCKET close
+#endif
+
+#define HEADER_SIZE 16
+#define FRAGMENT_SIZE 1024           // Payload bytes per packet
+#define MAX_PACKET (HEADER_SIZE + FRAGMENT_SIZE)
+#define MAX_FRAGMENTS 64             // Largest message = 64KB
+#define SEQ_BUFFER 1024              // Sent/received packet history
+#define SEND_QUEUE 4096              // Reliable fragments awaiting ACK
+#define RECV_WINDOW 256              // Messages buffered per reliable channel
+#define NUM_CHANNELS 3
+#define ACK_BITS 32
+
+#define INITIAL_CWND 16.0            // Packets in flight; at least MIN_CWND
+#define MIN_CWND 16.0                // Floor: a 60 Hz game always needs a few
+#define LOSS_BETA 0.7                // Window multiplier on loss (CUBIC-style)
+#define MAX_CWND 512.0
+#define INITIAL_RTO 0.100            // Seconds, before the first RTT sample
+#define MIN_RTO 0.020
+#define MAX_RTO 1.000
+#define REORDER_THRESHOLD 3          // Newer packets ACKed before we call it lost
+
+#define FLAG_ACK_ONLY 0x01
+
+typedef enum {
+    CHANNEL_UNRELIABLE,              // Latest state wins, never resent
+    CHANNEL_RELIABLE_ORDERED         // Resent until ACKed, delivered in order
+} ChannelType;
+
+// ===== Timing =====
+
+double now_seconds(void) {
+    #ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+    #else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+    #endif
+}
+
+// ===== 16-bit sequence numbers that wrap around =====
+
+// a is newer than b, even across the 65535 -> 0 wrap
+int seq_greater(unsigned short a, unsigned short b) {
+    return ((a > b) && (a - b <= 32768)) || ((a < b) && (b - a > 32768));
+}
+
+// ===== Wire format (big-endian) =====
+//
+// [seq:2][ack:2][ack_bits:4][flags:1][channel:1]
+// [msg_id:2][frag_index:1][frag_count:1][len:2][payload...]
+
+typedef struct {
+    unsigned short seq;         // This packet's number
+    unsigned short ack;         // Newest packet we received
+    unsigned int ack_bits;      // Bit i set = received (ack - 1 - i)
+    unsigned char flags;
+    unsigned char channel;
+    unsigned short msg_id;      // Per-channel message number
+    unsigned char frag_index;
+    unsigned char frag_count;
+    unsigned short len;
+} PacketHeader;
+
+void write_header(unsigned char* p, const PacketHeader* h) {
+    p[0] = h->seq >> 8;       p[1] = h->seq & 0xFF;
+    p[2] = h->ack >> 8;       p[3] = h->ack & 0xFF;
+    p[4] = h->ack_bits >> 24; p[5] = (h->ack_bits >> 16) & 0xFF;
+    p[6] = (h->ack_bits >> 8) & 0xFF; p[7] = h->ack_bits & 0xFF;
+    p[8] = h->flags;          p[9] = h->channel;
+    p[10] = h->msg_id >> 8;   p[11] = h->msg_id & 0xFF;
+    p[12] = h->frag_index;    p[13] = h->frag_count;
+    p[14] = h->len >> 8;      p[15] = h->len & 0xFF;
+}
+
+void read_header(const unsigned char* p, PacketHeader* h) {
+    h->seq = (unsigned short)((p[0] << 8) | p[1]);
+    h->ack = (unsigned short)((p[2] << 8) | p[3]);
+    h->ack_bits = ((unsigned int)p[4] << 24) | ((unsigned int)p[5] << 16) |
+                  ((unsigned int)p[6] << 8) | p[7];
+    h->flags = p[8];
+    h->channel = p[9];
+    h->msg_id = (unsigned short)((p[10] << 8) | p[11]);
+    h->frag_index = p[12];
+    h->frag_count = p[13];
+    h->len = (unsigned short)((p[14] << 8) | p[15]);
+}
+
+// ===== Endpoint State =====
+
+typedef enum { FRAG_FREE, FRAG_QUEUED, FRAG_IN_FLIGHT, FRAG_ACKED } FragState;
+
+// One reliable fragment waiting to be (re)sent or ACKed
+typedef struct {
+    FragState state;
+    unsigned char channel;
+    unsigned short msg_id;
+    unsigned char frag_index, frag_count;
+    unsigned short len;
+    unsigned short packet_seq;  // Packet that carried it last
+    double sent_time;
+    int transmissions;
+    unsigned char data[FRAGMENT_SIZE];
+} Fragment;
+
+// What went out in each packet, so an ACK can find its fragment
+typedef struct {
+    int valid;
+    unsigned short seq;
+    int fragment;               // Send queue slot, -1 for unreliable
+    unsigned char channel;
+    unsigned short msg_id;
+    unsigned char frag_index;
+} SentPacket;
+
+// A message being put back together from fragments
+typedef struct {
+    int active;
+    unsigned short msg_id;
+    unsigned char frag_count;
+    unsigned long long received;  // Bitmap of fragments we have
+    size_t len;
+    unsigned char* data;
+} Reassembly;
+
+typedef struct {
+    ChannelType type;
+    unsigned short next_send_id;    // Next msg_id to assign
+    unsigned short oldest_unacked;  // Sender window start
+    unsigned short next_deliver;    // Receiver: next msg_id to hand to the app
+    int delivered_any;              // Unreliable receiver: next_deliver is set
+    int pending[RECV_WINDOW];       // Sender: unACKed fragments per message
+    Reassembly slots[RECV_WINDOW];
+} Channel;
+
+typedef struct {
+    unsigned long long packets_sent, packets_received;
+    unsigned long long retransmits, losses;
+    unsigned long long acks_only, duplicates, dropped_by_link;
+    unsigned long long delivered[NUM_CHANNELS];
+} EndpointStats;
+
+// Simulated bad network: delay line + random drops on outgoing packets
+typedef struct {
+    double release_time;
+    int len;
+    unsigned char data[MAX_PACKET];
+} DelayedPacket;
+
+typedef void (*message_handler)(void* ctx, int channel, const unsigned char* data, size_t len);
+
+typedef struct {
+    int fd;
+    struct sockaddr_in peer;
+
+    // Outgoing packet numbers and their history
+    unsigned short next_seq;
+    SentPacket sent[SEQ_BUFFER];
+    unsigned short highest_acked;
+    int have_acked;
+
+    // Incoming packet numbers (for building ACKs)
+    unsigned short remote_seq;
+    int have_remote;
+    unsigned char received[SEQ_BUFFER];
+    unsigned short received_seq[SEQ_BUFFER];
+    int ack_pending;
+    int unacked_received;       // Packets received since our last ACK went out
+
+    // Reliable send queue (ring)
+    Fragment* queue;
+    int queue_head, queue_tail, queue_count;
+
+    Channel channels[NUM_CHANNELS];
+
+    // RTT estimation (RFC 6298) and congestion control
+    double srtt, rttvar, rto;
+    int have_rtt;
+    double cwnd, ssthresh;
+    int in_flight;
+    double last_cut;
+    double last_backoff;            // When the RTO was last doubled
+
+    // Link simulation
+    int loss_percent;
+    double latency;
+    DelayedPacket* delay_line;
+    int delay_head, delay_count;
+
+    message_handler on_message;
+    void* ctx;
+    EndpointStats stats;
+} Endpoint;
+
+#define DELAY_LINE 2048
+
+Endpoint* endpoint_create(int fd, const struct sockaddr_in* peer, const ChannelType* types) {
+    Endpoint* ep = (Endpoint*)calloc(1, sizeof(Endpoint));
+    if (ep == NULL) return NULL;
+
+    ep->queue = (Fragment*)calloc(SEND_QUEUE, sizeof(Fragment));
+    ep->delay_line = (DelayedPacket*)calloc(DELAY_LINE, sizeof(DelayedPacket));
+    if (ep->queue == NULL || ep->delay_line == NULL) {
+        free(ep->queue);
+        free(ep->delay_line);
+        free(ep);
+        return NULL;
+    }
+
+    ep->fd = fd;
+    ep->peer = *peer;
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+        ep->channels[c].type = types[c];
+    }
+    ep->rto = INITIAL_RTO;
+    ep->cwnd = INITIAL_CWND;
+    ep->ssthresh = MAX_CWND;
+    return ep;
+}
+
+void endpoint_destroy(Endpoint* ep) {
+    if (ep == NULL) return;
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+        for (int i = 0; i < RECV_WINDOW; i++) {
+            free(ep->channels[c].slots[i].data);
+        }
+    }
+    free(ep->queue);
+    free(ep->delay_line);
+    free(ep);
+}
+
+// ===== Raw send (through the link simulator) =====
+
+void link_transmit(Endpoint* ep, const unsigned char* packet, int len) {
+    sendto(ep->fd, (const char*)packet, len, 0,
+           (const struct sockaddr*)&ep->peer, sizeof(ep->peer));
+}
+
+void link_send(Endpoint* ep, const unsigned char* packet, int len, double now) {
+    ep->stats.packets_sent++;
+
+    if (ep->loss_percent > 0 && rand() % 100 < ep->loss_percent) {
+        ep->stats.dropped_by_link++;
+        return;
+    }
+
+    if (ep->latency <= 0 || ep->delay_count == DELAY_LINE) {
+        link_transmit(ep, packet, len);
+        return;
+    }
+
+    int slot = (ep->delay_head + ep->delay_count) % DELAY_LINE;
+    ep->delay_line[slot].release_time = now + ep->latency;
+    ep->delay_line[slot].len = len;
+    memcpy(ep->delay_line[slot].data, packet, len);
+    ep->delay_count++;
+}
+
+void link_flush(Endpoint* ep, double now) {
+    while (ep->delay_count > 0 && ep->delay_line[ep->delay_head].release_time <= now) {
+        DelayedPacket* d = &ep->delay_line[ep->delay_head];
+        link_transmit(ep, d->data, d->len);
+        ep->delay_head = (ep->delay_head + 1) % DELAY_LINE;
+        ep->delay_count--;
+    }
+}
+
+// ===== ACK generation =====
+
+void build_acks(Endpoint* ep, PacketHeader* h) {
+    h->ack = ep->remote_seq;
+    h->ack_bits = 0;
+    if (!ep->have_remote) return;
+
+    for (int i = 0; i < ACK_BITS; i++) {
+        unsigned short s = (unsigned short)(ep->remote_seq - 1 - i);
+        int idx = s % SEQ_BUFFER;
+        if (ep->received[idx] && ep->received_seq[idx] == s) {
+            h->ack_bits |= 1u << i;
+        }
+    }
+}
+
+// Stamp header with a fresh seq + current ACKs, remember what it carried
+void send_packet(Endpoint* ep, PacketHeader* h, const unsigned char* payload,
+                 int fragment, double now) {
+    unsigned char packet[MAX_PACKET];
+
+    h->seq = ep->next_seq++;
+    build_acks(ep, h);
+    write_header(packet, h);
+    if (h->len > 0) memcpy(packet + HEADER_SIZE, payload, h->len);  // ACK-only: NULL
+
+    SentPacket* sp = &ep->sent[h->seq % SEQ_BUFFER];
+    sp->valid = !(h->flags & FLAG_ACK_ONLY);
+    sp->seq = h->seq;
+    sp->fragment = fragment;
+    sp->channel = h->channel;
+    sp->msg_id = h->msg_id;
+    sp->frag_index = h->frag_index;
+
+    ep->ack_pending = 0;  // ACKs just rode along
+    ep->unacked_received = 0;
+    link_send(ep, packet, HEADER_SIZE + h->len, now);
+}
+
+// ===== Public API: send a message =====
+
+// Returns 0 on success, -1 if too big or the reliable window is full
+// (caller keeps the message and retries next frame)
+int rudp_send(Endpoint* ep, int channel, const void* data, size_t len, double now) {
+    if (channel < 0 || channel >= NUM_CHANNELS) return -1;
+
+    Channel* ch = &ep->channels[channel];
+    int frag_count = (int)((len + FRAGMENT_SIZE - 1) / FRAGMENT_SIZE);
+    if (frag_count == 0) frag_count = 1;
+    if (frag_count > MAX_FRAGMENTS) return -1;
+
+    const unsigned char* bytes = (const unsigned char*)data;
+
+    if (ch->type == CHANNEL_UNRELIABLE) {
+        // Fire and forget - every fragment goes out right now
+        unsigned short id = ch->next_send_id++;
+        for (int f = 0; f < frag_count; f++) {
+            size_t off = (size_t)f * FRAGMENT_SIZE;
+            PacketHeader h = {0};
+            h.channel = (unsigned char)channel;
+            h.msg_id = id;
+            h.frag_index = (unsigned char)f;
+            h.frag_count = (unsigned char)frag_count;
+            h.len = (unsigned short)(len - off < FRAGMENT_SIZE ? len - off : FRAGMENT_SIZE);
+            send_packet(ep, &h, bytes + off, -1, now);
+        }
+        return 0;
+    }
+
+    // Reliable: receiver can only buffer RECV_WINDOW messages ahead
+    unsigned short in_window = (unsigned short)(ch->next_send_id - ch->oldest_unacked);
+    if (in_window >= RECV_WINDOW || ep->queue_count + frag_count > SEND_QUEUE) {
+        return -1;
+    }
+
+    unsigned short id = ch->next_send_id++;
+    ch->pending[id % RECV_WINDOW] = frag_count;
+
+    for (int f = 0; f < frag_count; f++) {
+        size_t off = (size_t)f * FRAGMENT_SIZE;
+        Fragment* fr = &ep->queue[ep->queue_tail];
+        fr->state = FRAG_QUEUED;
+        fr->channel = (unsigned char)channel;
+        fr->msg_id = id;
+        fr->frag_index = (unsigned char)f;
+        fr->frag_count = (unsigned char)frag_count;
+        fr->len = (unsigned short)(len - off < FRAGMENT_SIZE ? len - off : FRAGMENT_SIZE);
+        fr->transmissions = 0;
+        memcpy(fr->data, bytes + off, fr->len);
+
+        ep->queue_tail = (ep->queue_tail + 1) % SEND_QUEUE;
+        ep->queue_count++;
+    }
+    return 0;
+}
+
+// ===== ACK processing, RTT and congestion window =====
+
+void update_rtt(Endpoint* ep, double sample) {
+    if (!ep->have_rtt) {
+        ep->srtt = sample;
+        ep->rttvar = sample / 2;
+        ep->have_rtt = 1;
+    } else {
+        double err = ep->srtt - sample;
+        if (err < 0) err = -err;
+        ep->rttvar = 0.75 * ep->rttvar + 0.25 * err;
+        ep->srtt = 0.875 * ep->srtt + 0.125 * sample;
+    }
+
+    ep->rto = ep->srtt + 4 * ep->rttvar;
+    if (ep->rto < MIN_RTO) ep->rto = MIN_RTO;
+    if (ep->rto > MAX_RTO) ep->rto = MAX_RTO;
+}
+
+void on_fragment_acked(Endpoint* ep, Fragment* fr, double now) {
+    // Karn's rule: a resent fragment's ACK is ambiguous, skip the sample
+    if (fr->transmissions == 1) {
+        update_rtt(ep, now - fr->sent_time);
+    }
+
+    fr->state = FRAG_ACKED;
+    ep->in_flight--;
+
+    // Slow start below ssthresh, then one packet per round trip
+    if (ep->cwnd < ep->ssthresh) {
+        ep->cwnd += 1.0;
+    } else {
+        ep->cwnd += 1.0 / ep->cwnd;
+    }
+    if (ep->cwnd > MAX_CWND) ep->cwnd = MAX_CWND;
+
+    // Message fully ACKed? Slide this channel's send window
+    Channel* ch = &ep->channels[fr->channel];
+    ch->pending[fr->msg_id % RECV_WINDOW]--;
+    while (ch->oldest_unacked != ch->next_send_id &&
+           ch->pending[ch->oldest_unacked % RECV_WINDOW] == 0) {
+        ch->oldest_unacked++;
+    }
+}
+
+void ack_packet(Endpoint* ep, unsigned short seq, double now) {
+    SentPacket* sp = &ep->sent[seq % SEQ_BUFFER];
+    if (!sp->valid || sp->seq != seq) return;
+    sp->valid = 0;
+
+    if (!ep->have_acked || seq_greater(seq, ep->highest_acked)) {
+        ep->highest_acked = seq;
+        ep->have_acked = 1;
+    }
+
+    if (sp->fragment < 0) return;  // Unreliable, nothing to free
+
+    Fragment* fr = &ep->queue[sp->fragment];
+    // The slot may hold a newer fragment, or this one was already resent
+    if (fr->state != FRAG_IN_FLIGHT || fr->packet_seq != seq ||
+        fr->channel != sp->channel || fr->msg_id != sp->msg_id ||
+        fr->frag_index != sp->frag_index) {
+        return;
+    }
+    on_fragment_acked(ep, fr, now);
+}
+
+void process_acks(Endpoint* ep, const PacketHeader* h, double now) {
+    ack_packet(ep, h->ack, now);
+    for (int i = 0; i < ACK_BITS; i++) {
+        if (h->ack_bits & (1u << i)) {
+            ack_packet(ep, (unsigned short)(h->ack - 1 - i), now);
+        }
+    }
+}
+
+// Multiplicative decrease, at most once per round trip
+void on_loss(Endpoint* ep, double now) {
+    double rtt = ep->have_rtt ? ep->srtt : ep->rto;
+    if (now - ep->last_cut < rtt) return;
+
+    ep->ssthresh = ep->cwnd * LOSS_BETA;
+    if (ep->ssthresh < MIN_CWND) ep->ssthresh = MIN_CWND;
+    ep->cwnd = ep->ssthresh;
+    ep->last_cut = now;
+}
+
+// ===== Receive path =====
+
+void deliver_ready(Endpoint* ep, int channel) {
+    Channel* ch = &ep->channels[channel];
+    while (1) {
+        Reassembly* r = &ch->slots[ch->next_deliver % RECV_WINDOW];
+        if (!r->active || r->msg_id != ch->next_deliver) break;
+
+        unsigned long long all = r->frag_count == 64 ? ~0ULL : (1ULL << r->frag_count) - 1;
+        if (r->received != all) break;
+
+        ep->on_message(ep->ctx, channel, r->data, r->len);
+        ep->stats.delivered[channel]++;
+        free(r->data);
+        r->data = NULL;
+        r->active = 0;
+        ch->next_deliver++;
+    }
+}
+
+void receive_fragment(Endpoint* ep, const PacketHeader* h, const unsigned char* payload) {
+    if (h->channel >= NUM_CHANNELS || h->frag_count == 0 ||
+        h->frag_count > MAX_FRAGMENTS || h->frag_index >= h->frag_count ||
+        h->len > FRAGMENT_SIZE) {
+        return;
+    }
+
+    Channel* ch = &ep->channels[h->channel];
+
+    if (ch->type == CHANNEL_RELIABLE_ORDERED) {
+        // Already delivered, or too far ahead to buffer
+        unsigned short ahead = (unsigned short)(h->msg_id - ch->next_deliver);
+        if (ahead >= RECV_WINDOW) {
+            ep->stats.duplicates++;
+            return;
+        }
+    }
+
+    Reassembly* r = &ch->slots[h->msg_id % RECV_WINDOW];
+    if (!r->active || r->msg_id != h->msg_id) {
+        // Unreliable: a newer message simply evicts a stale partial one
+        if (r->active && ch->type == CHANNEL_RELIABLE_ORDERED) return;
+        free(r->data);
+        r->data = (unsigned char*)malloc((size_t)h->frag_count * FRAGMENT_SIZE);
+        if (r->data == NULL) {
+            r->active = 0;
+            return;
+        }
+        r->active = 1;
+        r->msg_id = h->msg_id;
+        r->frag_count = h->frag_count;
+        r->received = 0;
+        r->len = 0;
+    }
+
+    // A fragment that disagrees with the first one on the message's
+    // size is bogus: it would write past the buffer
+    if (h->frag_count != r->frag_count) return;
+    size_t end = (size_t)h->frag_index * FRAGMENT_SIZE + h->len;
+    if (end > (size_t)r->frag_count * FRAGMENT_SIZE) return;
+
+    unsigned long long bit = 1ULL << h->frag_index;
+    if (r->received & bit) {
+        ep->stats.duplicates++;
+        return;
+    }
+    r->received |= bit;
+    memcpy(r->data + (size_t)h->frag_index * FRAGMENT_SIZE, payload, h->len);
+    if (h->frag_index == h->frag_count - 1) {
+        r->len = end;
+    }
+
+    if (ch->type == CHANNEL_RELIABLE_ORDERED) {
+        deliver_ready(ep, h->channel);
+        return;
+    }
+
+    // Unreliable: deliver as soon as complete, only if newer than last
+    unsigned long long all = r->frag_count == 64 ? ~0ULL : (1ULL << r->frag_count) - 1;
+    if (r->received == all) {
+        if (!ch->delivered_any || seq_greater(h->msg_id, (unsigned short)(ch->next_deliver - 1))) {
+            ep->on_message(ep->ctx, h->channel, r->data, r->len);
+            ep->stats.delivered[h->channel]++;
+            ch->next_deliver = (unsigned short)(h->msg_id + 1);
+            ch->delivered_any = 1;
+        }
+        free(r->data);
+        r->data = NULL;
+        r->active = 0;
+    }
+}
+
+void process_packet(Endpoint* ep, const unsigned char* packet, int len, double now) {
+    if (len < HEADER_SIZE) return;
+
+    PacketHeader h;
+    read_header(packet, &h);
+    if (HEADER_SIZE + h.len > len) return;
+
+    ep->stats.packets_received++;
+    process_acks(ep, &h, now);
+
+    if (h.flags & FLAG_ACK_ONLY) return;  // Never ACK an ACK
+
+    // Remember this seq so our next packet ACKs it
+    int idx = h.seq % SEQ_BUFFER;
+    if (ep->received[idx] && ep->received_seq[idx] == h.seq) {
+        ep->stats.duplicates++;
+        ep->ack_pending = 1;  // Our ACK may have been lost, resend it
+        return;
+    }
+    ep->received[idx] = 1;
+    ep->received_seq[idx] = h.seq;
+    // Forget the entry this seq pushed out of the window
+    ep->received[(unsigned short)(h.seq - SEQ_BUFFER / 2) % SEQ_BUFFER] = 0;
+
+    if (!ep->have_remote || seq_greater(h.seq, ep->remote_seq)) {
+        ep->remote_seq = h.seq;
+        ep->have_remote = 1;
+    }
+    ep->ack_pending = 1;
+
+    receive_fragment(ep, &h, packet + HEADER_SIZE);
+
+    // A burst longer than ack_bits would push seqs out of the ACK window
+    // before we reply - ACK early instead of letting them look lost
+    if (++ep->unacked_received >= ACK_BITS / 2) {
+        PacketHeader ack = {0};
+        ack.flags = FLAG_ACK_ONLY;
+        send_packet(ep, &ack, NULL, -1, now);
+        ep->stats.acks_only++;
+    }
+}
+
+// ===== Event loop hooks =====
+
+// How long select() may sleep before this endpoint needs attention
+double rudp_next_timeout(Endpoint* ep, double now) {
+    double next = now + 0.010;
+
+    if (ep->delay_count > 0 && ep->delay_line[ep->delay_head].release_time < next) {
+        next = ep->delay_line[ep->delay_head].release_time;
+    }
+
+    for (int i = 0, q = ep->queue_head; i < ep->queue_count; i++, q = (q + 1) % SEND_QUEUE) {
+        Fragment* fr = &ep->queue[q];
+        if (fr->state == FRAG_IN_FLIGHT && fr->sent_time + ep->rto < next) {
+            next = fr->sent_time + ep->rto;
+        }
+    }
+
+    return next > now ? next - now : 0;
+}
+
+// Call when the socket is readable, and whenever a timer fires
+void rudp_update(Endpoint* ep, double now) {
+    unsigned char packet[MAX_PACKET];
+
+    // 1. Drain the socket
+    while (1) {
+        int n = recvfrom(ep->fd, (char*)packet, sizeof(packet), 0, NULL, NULL);
+        if (n <= 0) break;
+        process_packet(ep, packet, n, now);
+    }
+
+    // 2. Loss detection: timeout, or enough newer packets ACKed. A
+    // burst of losses is one congestion event and one RTO backoff
+    int lost = 0, any_timed_out = 0;
+    for (int i = 0, q = ep->queue_head; i < ep->queue_count; i++, q = (q + 1) % SEND_QUEUE) {
+        Fragment* fr = &ep->queue[q];
+        if (fr->state != FRAG_IN_FLIGHT) continue;
+
+        int timed_out = now - fr->sent_time > ep->rto;
+        int overtaken = ep->have_acked &&
+                        seq_greater(ep->highest_acked,
+                                    (unsigned short)(fr->packet_seq + REORDER_THRESHOLD));
+        if (timed_out || overtaken) {
+            fr->state = FRAG_QUEUED;
+            ep->in_flight--;
+            ep->stats.losses++;
+            lost = 1;
+            if (timed_out) any_timed_out = 1;
+        }
+    }
+    if (lost) on_loss(ep, now);
+    // Timeouts within one RTO of the last backoff belong to the same
+    // event: fragments sent together expire together
+    if (any_timed_out && now - ep->last_backoff >= ep->rto) {
+        ep->rto *= 2;  // Exponential backoff
+        if (ep->rto > MAX_RTO) ep->rto = MAX_RTO;
+        ep->last_backoff = now;
+    }
+
+    // 3. Pop fully ACKed fragments off the front of the ring
+    while (ep->queue_count > 0 && ep->queue[ep->queue_head].state == FRAG_ACKED) {
+        ep->queue[ep->queue_head].state = FRAG_FREE;
+        ep->queue_head = (ep->queue_head + 1) % SEND_QUEUE;
+        ep->queue_count--;
+    }
+
+    // 4. Send queued fragments while the congestion window allows
+    for (int i = 0, q = ep->queue_head; i < ep->queue_count; i++, q = (q + 1) % SEND_QUEUE) {
+        if (ep->in_flight >= (int)ep->cwnd) break;
+
+        Fragment* fr = &ep->queue[q];
+        if (fr->state != FRAG_QUEUED) continue;
+
+        PacketHeader h = {0};
+        h.channel = fr->channel;
+        h.msg_id = fr->msg_id;
+        h.frag_index = fr->frag_index;
+        h.frag_count = fr->frag_count;
+        h.len = fr->len;
+
+        fr->packet_seq = ep->next_seq;  // send_packet() assigns this seq
+        fr->sent_time = now;
+        fr->state = FRAG_IN_FLIGHT;
+        if (fr->transmissions++ > 0) ep->stats.retransmits++;
+        ep->in_flight++;
+
+        send_packet(ep, &h, fr->data, q, now);
+    }
+
+    // 5. Nothing carried our ACKs this round - send a bare ACK
+    if (ep->ack_pending) {
+        PacketHeader h = {0};
+        h.flags = FLAG_ACK_ONLY;
+        send_packet(ep, &h, NULL, -1, now);
+        ep->stats.acks_only++;
+    }
+
+    link_flush(ep, now);
+}
+
+// ===== Demo: game client -> server over a lossy link =====
+
+#define CH_STATE 0    // Unreliable: player position every frame
+#define CH_EVENTS 1   // Reliable: gameplay events, must arrive in order
+#define CH_CHAT 2     // Reliable: separate ordering, never blocks events
+
+#define TICK_RATE 60
+#define BLOB_SIZE (40 * 1024)  // Fragmented reliable message (level data)
+
+typedef struct {
+    unsigned int expected[NUM_CHANNELS];
+    unsigned int out_of_order;
+    int blob_ok;
+    double latency_sum[NUM_CHANNELS];
+    double latency_max[NUM_CHANNELS];
+    unsigned long long count[NUM_CHANNELS];
+} ServerView;
+
+typedef struct {
+    unsigned int counter;   // Per-channel message number
+    double sent_at;
+} GameMessage;
+
+void server_on_message(void* ctx, int channel, const unsigned char* data, size_t len) {
+    ServerView* view = (ServerView*)ctx;
+
+    if (len == BLOB_SIZE) {
+        // Check every byte of the reassembled blob
+        int ok = 1;
+        for (size_t i = sizeof(GameMessage); i < len; i++) {
+            if (data[i] != (unsigned char)(i * 31)) { ok = 0; break; }
+        }
+        view->blob_ok = ok;
+    }
+
+    if (len < sizeof(GameMessage)) return;
+    GameMessage msg;
+    memcpy(&msg, data, sizeof(msg));
+
+    double latency = now_seconds() - msg.sent_at;
+    view->latency_sum[channel] += latency;
+    if (latency > view->latency_max[channel]) view->latency_max[channel] = latency;
+    view->count[channel]++;
+
+    if (channel != CH_STATE) {
+        if (msg.counter != view->expected[channel]) view->out_of_order++;
+        view->expected[channel] = msg.counter + 1;
+    }
+}
+
+void client_on_message(void* ctx, int channel, const unsigned char* data, size_t len) {
+    (void)ctx; (void)channel; (void)data; (void)len;
+}
+
+int bind_loopback(struct sockaddr_in* addr) {
+    int fd = (int)socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket failed");
+        return -1;
+    }
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr->sin_port = 0;
+
+    if (bind(fd, (struct sockaddr*)addr, sizeof(*addr)) < 0) {
+        perror("bind failed");
+        CLOSE_SOCKET(fd);
+        return -1;
+    }
+    socklen_t len = sizeof(*addr);
+    getsockname(fd, (struct sockaddr*)addr, &len);
+
+    #ifdef _WIN32
+    u_long mode = 1;
+    ioctlsocket(fd, FIONBIO, &mode);
+    #else
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    #endif
+    return fd;
+}
+
+void print_channel(const char* name, ServerView* view, int channel, unsigned int sent) {
+    unsigned long long n = view->count[channel];
+    printf("  %-22s sent %5u  delivered %5llu  avg %6.2f ms  max %6.2f ms\n",
+           name, sent, n,
+           n ? view->latency_sum[channel] / n * 1000 : 0.0,
+           view->latency_max[channel] * 1000);
+}
+
+int main(int argc, char* argv[]) {
+    // Initialize Winsock (Windows)
+    #ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        printf("WSAStartup failed\n");
+        return 1;
+    }
+    #endif
+
+    int loss = argc >= 2 ? atoi(argv[1]) : 10;
+    double latency_ms = argc >= 3 ? atof(argv[2]) : 20;
+    double seconds = argc >= 4 ? atof(argv[3]) : 3;
+
+    printf("=== Reliable UDP ===\n");
+    printf("Link: %d%% loss, %.0f ms one-way latency, %.0f s at %d ticks/s\n\n",
+           loss, latency_ms, seconds, TICK_RATE);
+
+    srand(1234);
+
+    struct sockaddr_in client_addr, server_addr;
+    int client_fd = bind_loopback(&client_addr);
+    int server_fd = bind_loopback(&server_addr);
+    if (client_fd < 0 || server_fd < 0) return 1;
+
+    ChannelType types[NUM_CHANNELS] = {
+        CHANNEL_UNRELIABLE, CHANNEL_RELIABLE_ORDERED, CHANNEL_RELIABLE_ORDERED
+    };
+    Endpoint* client = endpoint_create(client_fd, &server_addr, types);
+    Endpoint* server = endpoint_create(server_fd, &client_addr, types);
+    if (client == NULL || server == NULL) {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    ServerView view = {0};
+    client->on_message = client_on_message;
+    server->on_message = server_on_message;
+    server->ctx = &view;
+
+    // Loss and delay in both directions - ACKs get lost too
+    client->loss_percent = server->loss_percent = loss;
+    client->latency = server->latency = latency_ms / 1000.0;
+
+    unsigned char* blob = (unsigned char*)malloc(BLOB_SIZE);
+    for (size_t i = 0; i < BLOB_SIZE; i++) blob[i] = (unsigned char)(i * 31);
+
+    unsigned int sent[NUM_CHANNELS] = {0};
+    int blob_sent = 0;
+    double start = now_seconds();
+    double next_tick = start;
+    double end = start + seconds;
+
+    // The event loop: sleep in select() until a socket or timer needs us
+    while (1) {
+        double now = now_seconds();
+        if (now >= end && client->queue_count == 0) break;
+        if (now >= end + 5.0) break;  // Give up on a hopeless link
+
+        if (now >= next_tick && now < end) {
+            next_tick += 1.0 / TICK_RATE;
+
+            GameMessage msg;
+            msg.sent_at = now;
+
+            unsigned char state[64] = {0};
+            msg.counter = sent[CH_STATE]++;
+            memcpy(state, &msg, sizeof(msg));
+            rudp_send(client, CH_STATE, state, sizeof(state), now);
+
+            msg.counter = sent[CH_EVENTS];
+            if (rudp_send(client, CH_EVENTS, &msg, sizeof(msg), now) == 0) sent[CH_EVENTS]++;
+
+            if (sent[CH_STATE] % 15 == 0) {
+                msg.counter = sent[CH_CHAT];
+                if (rudp_send(client, CH_CHAT, &msg, sizeof(msg), now) == 0) sent[CH_CHAT]++;
+            }
+
+            if (!blob_sent && sent[CH_STATE] == 30) {
+                msg.counter = sent[CH_EVENTS];
+                memcpy(blob, &msg, sizeof(msg));
+                if (rudp_send(client, CH_EVENTS, blob, BLOB_SIZE, now) == 0) {
+                    sent[CH_EVENTS]++;
+                    blob_sent = 1;
+                }
+            }
+
+            // Server answers with its own state, which carries the ACKs
+            unsigned char reply[32] = {0};
+            rudp_send(server, CH_STATE, reply, sizeof(reply), now);
+        }
+
+        rudp_update(client, now);
+        rudp_update(server, now);
+
+        double wait = rudp_next_timeout(client, now);
+        double w2 = rudp_next_timeout(server, now);
+        if (w2 < wait) wait = w2;
+        if (now < end && next_tick - now < wait) wait = next_tick - now;
+        if (wait < 0) wait = 0;
+
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(client_fd, &readfds);
+        FD_SET(server_fd, &readfds);
+        int max_fd = client_fd > server_fd ? client_fd : server_fd;
+
+        struct timeval tv;
+        tv.tv_sec = (long)wait;
+        tv.tv_usec = (long)((wait - (long)wait) * 1e6);
+        select(max_fd + 1, &readfds, NULL, NULL, &tv);
+    }
+
+    printf("Server received:\n");
+    print_channel("state (unreliable)", &view, CH_STATE, sent[CH_STATE]);
+    print_channel("events (reliable)", &view, CH_EVENTS, sent[CH_EVENTS]);
+    print_channel("chat (reliable)", &view, CH_CHAT, sent[CH_CHAT]);
+    printf("  Out-of-order deliveries: %u\n", view.out_of_order);
+    printf("  %d KB blob (%d fragments): %s\n", BLOB_SIZE / 1024,
+           BLOB_SIZE / FRAGMENT_SIZE, view.blob_ok ? "intact" : "MISSING/CORRUPT");
+
+    printf("\nClient transport:\n");
+    printf("  Packets sent: %llu (dropped by link %llu)\n",
+           client->stats.packets_sent, client->stats.dropped_by_link);
+    printf("  Losses detected: %llu, retransmits: %llu\n",
+           client->stats.losses, client->stats.retransmits);
+    printf("  RTT %.2f ms (var %.2f ms), RTO %.2f ms\n",
+           client->srtt * 1000, client->rttvar * 1000, client->rto * 1000);
+    printf("  Congestion window: %.1f packets (ssthresh %.1f)\n",
+           client->cwnd, client->ssthresh);
+    printf("Server transport:\n");
+    printf("  Packets sent: %llu (%llu bare ACKs), duplicates received: %llu\n",
+           server->stats.packets_sent, server->stats.acks_only, server->stats.duplicates);
+
+    free(blob);
+    endpoint_destroy(client);
+    endpoint_destroy(server);
+    CLOSE_SOCKET(client_fd);
+    CLOSE_SOCKET(server_fd);
+
+    #ifdef _WIN32
+    WSACleanup();
+    #endif
+
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * How the pieces fit:
+ *
+ * Every packet carries ACKs for the other direction:
+ *   ack      = newest seq we received
+ *   ack_bits = which of the 32 before it we also received
+ * One lost ACK packet costs nothing - the next 32 packets repeat it.
+ *
+ *   ack=100 ack_bits=...1101
+ *            -> 100, 99, 97, 96 received; 98 missing
+ *
+ * Reliability lives in messages, not packets:
+ * - A lost fragment is resent in a NEW packet with a new seq
+ * - Loss = RTO expired, or 3 newer packets already ACKed
+ * - Karn's rule: no RTT sample from resent fragments
+ *
+ * Channels:
+ * - Unreliable: sent once, stale messages dropped, never waits
+ * - Reliable ordered: buffered until the gap is filled
+ * - Each reliable channel orders independently, so a lost chat
+ *   message doesn't hold up gameplay events
+ *
+ * Congestion window (packets in flight, reliable traffic only):
+ * - Slow start: +1 per ACK until ssthresh
+ * - Congestion avoidance: +1 per round trip
+ * - Loss: multiply by 0.7, at most once per round trip, never below 16
+ * Unreliable state updates bypass the window - they are small,
+ * rate-limited by the tick, and late data is worthless anyway.
+ *
+ * Test:
+ * 1. 10_reliable_udp            (10% loss, 20 ms)
+ * 2. 10_reliable_udp 0 0        (clean link, sub-ms latency)
+ * 3. 10_reliable_udp 30 50      (terrible link - still in order)
+ *
+ * Try:
+ * - Send several small messages per packet (message packing)
+ * - Add a connection handshake and timeouts
+ * - Split client/server into two programs using 05/06 addresses
+ * - Pace packets instead of bursting a whole window
+ */
@@ -0,0 +1,690 @@
+/*
+ * 11_chat_fanout.c
+ *
+ * Broadcast fan-out without per-client copies.
+ * 04_chat_server calls send() for every client with the same buffer:
+ * one slow client blocks the whole server, and nothing is queued.
+ *
+ * Here each broadcast becomes ONE reference-counted, immutable message.
+ * Every client gets a pointer to it in its own output queue. Queues are
+ * flushed with writev() (many messages per syscall) on non-blocking
+ * sockets, and clients that fall too far behind are evicted or skipped.
+ *
+ * Usage:
+ *   11_chat_fanout [evict|drop]                      (chat server on 8080)
+ *   11_chat_fanout bench [clients] [messages] [slow] [evict|drop]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <windows.h>
+    #pragma comment(lib, "ws2_32.lib")
+    #define CLOSE_SOCKET closesocket
+    #define poll WSAPoll
+    typedef int socklen_t;
+#else
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <sys/resource.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <signal.h>
+    #include <time.h>
+    #include <unistd.h>
+    #define CLOSE_SOCKET close
+#endif
+
+#define PORT 8080
+#define MAX_CLIENTS 10240          // select() tops out at FD_SETSIZE, so poll()
+#define BUFFER_SIZE 1024
+#define QUEUE_CAPACITY 128         // Messages queued per client
+#define MAX_QUEUED_BYTES (64 * 1024)
+#define WRITEV_BATCH 64            // Messages per writev() call
+#define SOCKET_SNDBUF (32 * 1024)  // Bounded kernel buffer, so backpressure reaches us
+
+typedef enum {
+    POLICY_EVICT,   // Disconnect clients that can't keep up
+    POLICY_DROP     // Keep them, but skip messages while they're behind
+} SlowPolicy;
+
+// ===== Timing =====
+
+double now_seconds(void) {
+    #ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+    #else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+    #endif
+}
+
+// ===== Shared Message Buffers =====
+//
+// One malloc holds the refcount, length and bytes. Once created the
+// bytes never change, so any number of queues can point at it.
+// The server is single-threaded, so a plain int refcount is enough.
+
+typedef struct {
+    int refcount;
+    size_t len;
+    char data[];
+} SharedMsg;
+
+unsigned long long msg_allocations = 0;
+unsigned long long msg_live = 0;
+
+SharedMsg* msg_create(const char* data, size_t len) {
+    SharedMsg* m = (SharedMsg*)malloc(sizeof(SharedMsg) + len);
+    if (m == NULL) return NULL;
+    m->refcount = 1;  // Creator's reference
+    m->len = len;
+    memcpy(m->data, data, len);
+    msg_allocations++;
+    msg_live++;
+    return m;
+}
+
+SharedMsg* msg_ref(SharedMsg* m) {
+    m->refcount++;
+    return m;
+}
+
+void msg_unref(SharedMsg* m) {
+    if (--m->refcount == 0) {
+        free(m);
+        msg_live--;
+    }
+}
+
+// ===== Clients =====
+
+typedef struct {
+    int fd;
+    int id;
+    SharedMsg* queue[QUEUE_CAPACITY];   // Ring of shared messages
+    int q_head, q_count;
+    size_t head_offset;                 // Bytes of queue[q_head] already sent
+    size_t queued_bytes;
+    int dropping;                       // POLICY_DROP: skipping until drained
+    char inbuf[BUFFER_SIZE];            // Partial line from this client
+    size_t in_len;
+    unsigned long long dropped;
+} Client;
+
+typedef struct {
+    int listen_fd;
+    SlowPolicy policy;
+    Client* clients[MAX_CLIENTS];
+    int client_count;
+    int next_id;
+    SharedMsg* welcome;                 // Same buffer for every new client
+    struct pollfd* pfds;
+    int* pfd_client;                    // pollfd index -> client slot
+
+    // Stats
+    unsigned long long broadcasts;
+    unsigned long long deliveries;      // Message references queued
+    unsigned long long writev_calls;
+    unsigned long long evictions;
+    unsigned long long drops;
+    size_t peak_queued_bytes;
+    int verbose;
+} FanoutServer;
+
+void set_nonblocking(int fd) {
+    #ifdef _WIN32
+    u_long mode = 1;
+    ioctlsocket(fd, FIONBIO, &mode);
+    #else
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    #endif
+}
+
+int would_block(void) {
+    #ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+    #else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+    #endif
+}
+
+void client_close(FanoutServer* srv, int slot) {
+    Client* c = srv->clients[slot];
+
+    // Drop our references - the buffers live on in other queues
+    while (c->q_count > 0) {
+        msg_unref(c->queue[c->q_head]);
+        c->q_head = (c->q_head + 1) % QUEUE_CAPACITY;
+        c->q_count--;
+    }
+
+    CLOSE_SOCKET(c->fd);
+    free(c);
+    srv->clients[slot] = NULL;
+    srv->client_count--;
+}
+
+// Add one reference to this client's queue, applying the slow-consumer policy.
+// Returns 0 if queued, -1 if the client was evicted.
+int client_enqueue(FanoutServer* srv, int slot, SharedMsg* m) {
+    Client* c = srv->clients[slot];
+
+    int full = c->q_count == QUEUE_CAPACITY ||
+               c->queued_bytes + m->len > MAX_QUEUED_BYTES;
+
+    if (full && srv->policy == POLICY_EVICT) {
+        if (srv->verbose) {
+            printf("[Server] Evicting slow client %d (%zu bytes queued)\n",
+                   c->id, c->queued_bytes);
+        }
+        srv->evictions++;
+        client_close(srv, slot);
+        return -1;
+    }
+
+    // POLICY_DROP: once full, skip messages until the queue has half drained,
+    // so the client sees one gap instead of every other message
+    if (full) c->dropping = 1;
+    if (full || (c->dropping && c->queued_bytes > MAX_QUEUED_BYTES / 2)) {
+        c->dropped++;
+        srv->drops++;
+        return 0;
+    }
+    c->dropping = 0;
+
+    int tail = (c->q_head + c->q_count) % QUEUE_CAPACITY;
+    c->queue[tail] = msg_ref(m);
+    c->q_count++;
+    c->queued_bytes += m->len;
+    srv->deliveries++;
+
+    if (c->queued_bytes > srv->peak_queued_bytes) {
+        srv->peak_queued_bytes = c->queued_bytes;
+    }
+    return 0;
+}
+
+// Write as much of the queue as the socket accepts, many messages per call.
+// Returns -1 if the connection failed.
+int client_flush(FanoutServer* srv, int slot) {
+    Client* c = srv->clients[slot];
+
+    while (c->q_count > 0) {
+        int n = c->q_count < WRITEV_BATCH ? c->q_count : WRITEV_BATCH;
+        long written;
+
+        #ifdef _WIN32
+        WSABUF bufs[WRITEV_BATCH];
+        for (int i = 0; i < n; i++) {
+            SharedMsg* m = c->queue[(c->q_head + i) % QUEUE_CAPACITY];
+            size_t skip = i == 0 ? c->head_offset : 0;
+            bufs[i].buf = m->data + skip;
+            bufs[i].len = (ULONG)(m->len - skip);
+        }
+        DWORD sent = 0;
+        if (WSASend(c->fd, bufs, n, &sent, 0, NULL, NULL) != 0) {
+            written = -1;
+        } else {
+            written = (long)sent;
+        }
+        #else
+        struct iovec iov[WRITEV_BATCH];
+        for (int i = 0; i < n; i++) {
+            SharedMsg* m = c->queue[(c->q_head + i) % QUEUE_CAPACITY];
+            size_t skip = i == 0 ? c->head_offset : 0;
+            iov[i].iov_base = m->data + skip;
+            iov[i].iov_len = m->len - skip;
+        }
+        written = writev(c->fd, iov, n);
+        #endif
+        srv->writev_calls++;
+
+        if (written < 0) {
+            if (would_block()) return 0;  // Socket full, wait for POLLOUT
+            return -1;
+        }
+
+        // Retire every message that went out completely
+        size_t left = (size_t)written;
+        c->queued_bytes -= left;
+        while (left > 0) {
+            SharedMsg* m = c->queue[c->q_head];
+            size_t remaining = m->len - c->head_offset;
+            if (left < remaining) {
+                c->head_offset += left;
+                break;
+            }
+            left -= remaining;
+            c->head_offset = 0;
+            msg_unref(m);
+            c->q_head = (c->q_head + 1) % QUEUE_CAPACITY;
+            c->q_count--;
+        }
+    }
+    return 0;
+}
+
+// One allocation per broadcast, no matter how many clients
+void broadcast(FanoutServer* srv, int from_slot, const char* text, size_t len) {
+    SharedMsg* m = msg_create(text, len);
+    if (m == NULL) return;
+    srv->broadcasts++;
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (srv->clients[i] != NULL && i != from_slot) {
+            client_enqueue(srv, i, m);
+        }
+    }
+
+    msg_unref(m);  // Queues hold their own references now
+}
+
+// Split received bytes into lines - one recv() is NOT one message
+void client_read(FanoutServer* srv, int slot) {
+    Client* c = srv->clients[slot];
+
+    while (1) {
+        int bytes = recv(c->fd, c->inbuf + c->in_len, (int)(BUFFER_SIZE - c->in_len), 0);
+        if (bytes == 0 || (bytes < 0 && !would_block())) {
+            if (srv->verbose) printf("[Server] Client %d disconnected\n", c->id);
+            client_close(srv, slot);
+            return;
+        }
+        if (bytes < 0) return;  // Drained
+
+        c->in_len += bytes;
+
+        size_t start = 0;
+        for (size_t i = 0; i < c->in_len; i++) {
+            if (c->inbuf[i] != '\n') continue;
+
+            char line[BUFFER_SIZE + 32];
+            int n = snprintf(line, sizeof(line), "[Client %d]: %.*s\n",
+                             c->id, (int)(i - start), c->inbuf + start);
+            if (n > (int)sizeof(line) - 1) n = (int)sizeof(line) - 1;
+            if (srv->verbose > 1) printf("%s", line);
+            broadcast(srv, slot, line, (size_t)n);
+
+            // broadcast() may have evicted... but never the sender
+            start = i + 1;
+        }
+
+        // Keep the partial line; an overlong line is cut off
+        if (start > 0) {
+            memmove(c->inbuf, c->inbuf + start, c->in_len - start);
+            c->in_len -= start;
+        } else if (c->in_len == BUFFER_SIZE) {
+            c->in_len = 0;
+        }
+    }
+}
+
+void server_accept(FanoutServer* srv) {
+    while (1) {
+        struct sockaddr_in addr;
+        socklen_t addrlen = sizeof(addr);
+        int fd = (int)accept(srv->listen_fd, (struct sockaddr*)&addr, &addrlen);
+        if (fd < 0) return;
+
+        int slot = -1;
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (srv->clients[i] == NULL) { slot = i; break; }
+        }
+
+        Client* c = slot >= 0 ? (Client*)calloc(1, sizeof(Client)) : NULL;
+        if (c == NULL) {
+            const char* msg = "Server full. Try again later.\n";
+            send(fd, msg, (int)strlen(msg), 0);
+            CLOSE_SOCKET(fd);
+            continue;
+        }
+
+        // Without a cap the kernel would silently buffer megabytes
+        // for a client that never reads
+        int sndbuf = SOCKET_SNDBUF;
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, (const char*)&sndbuf, sizeof(sndbuf));
+
+        set_nonblocking(fd);
+        c->fd = fd;
+        c->id = srv->next_id++;
+        srv->clients[slot] = c;
+        srv->client_count++;
+
+        if (srv->verbose) {
+            printf("[Server] Client %d connected from %s:%d (%d online)\n",
+                   c->id, inet_ntoa(addr.sin_addr), ntohs(addr.sin_port),
+                   srv->client_count);
+        }
+        client_enqueue(srv, slot, srv->welcome);
+    }
+}
+
+FanoutServer* server_create(int port, SlowPolicy policy) {
+    FanoutServer* srv = (FanoutServer*)calloc(1, sizeof(FanoutServer));
+    if (srv == NULL) return NULL;
+
+    srv->policy = policy;
+    srv->pfds = (struct pollfd*)calloc(MAX_CLIENTS + 1, sizeof(struct pollfd));
+    srv->pfd_client = (int*)calloc(MAX_CLIENTS + 1, sizeof(int));
+    const char* text = "Welcome to the chat! Type your messages.\n";
+    srv->welcome = msg_create(text, strlen(text));
+
+    srv->listen_fd = (int)socket(AF_INET, SOCK_STREAM, 0);
+    if (srv->pfds == NULL || srv->pfd_client == NULL || srv->welcome == NULL ||
+        srv->listen_fd < 0) {
+        perror("server setup failed");
+        free(srv->pfds);
+        free(srv->pfd_client);
+        free(srv);
+        return NULL;
+    }
+
+    int opt = 1;
+    setsockopt(srv->listen_fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&opt, sizeof(opt));
+
+    struct sockaddr_in address = {0};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(port);
+
+    if (bind(srv->listen_fd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+        listen(srv->listen_fd, 1024) < 0) {
+        perror("bind/listen failed");
+        CLOSE_SOCKET(srv->listen_fd);
+        free(srv->pfds);
+        free(srv->pfd_client);
+        free(srv);
+        return NULL;
+    }
+
+    set_nonblocking(srv->listen_fd);
+    return srv;
+}
+
+void server_destroy(FanoutServer* srv) {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (srv->clients[i] != NULL) client_close(srv, i);
+    }
+    msg_unref(srv->welcome);
+    CLOSE_SOCKET(srv->listen_fd);
+    free(srv->pfds);
+    free(srv->pfd_client);
+    free(srv);
+}
+
+int server_port(FanoutServer* srv) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    getsockname(srv->listen_fd, (struct sockaddr*)&addr, &len);
+    return ntohs(addr.sin_port);
+}
+
+// One turn of the event loop: wait, accept, read, flush
+void server_poll(FanoutServer* srv, int timeout_ms) {
+    int n = 0;
+    srv->pfds[n].fd = srv->listen_fd;
+    srv->pfds[n].events = POLLIN;
+    srv->pfd_client[n++] = -1;
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        Client* c = srv->clients[i];
+        if (c == NULL) continue;
+        srv->pfds[n].fd = c->fd;
+        // Only ask for POLLOUT while something is queued
+        srv->pfds[n].events = POLLIN | (c->q_count > 0 ? POLLOUT : 0);
+        srv->pfd_client[n++] = i;
+    }
+
+    if (poll(srv->pfds, n, timeout_ms) < 0) {
+        if (errno != EINTR) perror("poll failed");
+        return;
+    }
+
+    if (srv->pfds[0].revents & POLLIN) {
+        server_accept(srv);
+    }
+
+    for (int k = 1; k < n; k++) {
+        int slot = srv->pfd_client[k];
+        if (srv->clients[slot] == NULL) continue;  // Evicted this turn
+        if (srv->pfds[k].revents & (POLLIN | POLLHUP | POLLERR)) {
+            client_read(srv, slot);
+        }
+    }
+
+    // Flush everyone with pending output right away - most sockets have
+    // room, so this avoids an extra poll() round trip per broadcast
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (srv->clients[i] != NULL && srv->clients[i]->q_count > 0) {
+            if (client_flush(srv, i) < 0) client_close(srv, i);
+        }
+    }
+}
+
+void print_server_stats(FanoutServer* srv) {
+    printf("  Broadcasts:          %llu\n", srv->broadcasts);
+    printf("  Message allocations: %llu (%.2f per broadcast)\n", msg_allocations,
+           srv->broadcasts ? (double)(msg_allocations - 1) / srv->broadcasts : 0.0);
+    printf("  Queued deliveries:   %llu\n", srv->deliveries);
+    printf("  writev() calls:      %llu (%.1f messages per call)\n", srv->writev_calls,
+           srv->writev_calls ? (double)srv->deliveries / srv->writev_calls : 0.0);
+    printf("  Peak client queue:   %zu bytes\n", srv->peak_queued_bytes);
+    printf("  Evicted clients:     %llu\n", srv->evictions);
+    printf("  Dropped deliveries:  %llu\n", srv->drops);
+    printf("  Live messages:       %llu\n", msg_live);
+}
+
+// ===== Benchmark: server plus N in-process clients =====
+
+int connect_loopback(int port, int rcvbuf) {
+    int fd = (int)socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    if (rcvbuf > 0) {
+        // Must be set before connect() to shrink the TCP window
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const char*)&rcvbuf, sizeof(rcvbuf));
+    }
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        CLOSE_SOCKET(fd);
+        return -1;
+    }
+    set_nonblocking(fd);
+    return fd;
+}
+
+void raise_fd_limit(void) {
+    #ifndef _WIN32
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    #endif
+}
+
+void run_bench(int num_clients, int num_messages, int num_slow, SlowPolicy policy) {
+    printf("=== Fan-out Benchmark ===\n");
+    printf("%d clients (%d never read), %d broadcasts, policy: %s\n\n",
+           num_clients, num_slow, num_messages, policy == POLICY_EVICT ? "evict" : "drop");
+
+    raise_fd_limit();
+
+    FanoutServer* srv = server_create(0, policy);
+    if (srv == NULL) return;
+    int port = server_port(srv);
+
+    int* fds = (int*)malloc(num_clients * sizeof(int));
+    unsigned long long* lines = (unsigned long long*)calloc(num_clients, sizeof(unsigned long long));
+
+    // Connect everyone; client 0 is the speaker
+    for (int i = 0; i < num_clients; i++) {
+        int slow = i > 0 && i <= num_slow;
+        fds[i] = connect_loopback(port, slow ? 4096 : 0);
+        if (fds[i] < 0) {
+            printf("Could only open %d connections (raise ulimit -n)\n", i);
+            num_clients = i;
+            break;
+        }
+        if (i % 64 == 63) server_poll(srv, 0);  // Keep the accept backlog short
+    }
+    while (srv->client_count < num_clients) server_poll(srv, 10);
+
+    printf("Connected %d clients\n", srv->client_count);
+
+    char line[64];
+    char rbuf[65536];
+    int sent = 0;
+    unsigned long long expected = (unsigned long long)num_messages + 1;  // + welcome
+    double start = now_seconds();
+
+    while (1) {
+        // The speaker writes a few lines per turn
+        for (int k = 0; k < 8 && sent < num_messages; k++) {
+            int n = snprintf(line, sizeof(line), "tick %d: player moved\n", sent);
+            if (send(fds[0], line, n, 0) != n) break;
+            sent++;
+        }
+
+        server_poll(srv, 1);
+
+        // Fast clients read everything available
+        int done = 1;
+        for (int i = num_slow + 1; i < num_clients; i++) {
+            int r;
+            while ((r = recv(fds[i], rbuf, sizeof(rbuf), 0)) > 0) {
+                for (int b = 0; b < r; b++) {
+                    if (rbuf[b] == '\n') lines[i]++;
+                }
+            }
+            if (lines[i] < expected) done = 0;
+        }
+
+        if (done && sent == num_messages) break;
+        if (now_seconds() - start > 30) {
+            printf("Timed out waiting for delivery\n");
+            break;
+        }
+    }
+
+    double elapsed = now_seconds() - start;
+    int fast = num_clients - num_slow - 1;
+    unsigned long long fast_lines = 0;
+    for (int i = num_slow + 1; i < num_clients; i++) fast_lines += lines[i];
+
+    printf("\nResults (%.3f s):\n", elapsed);
+    printf("  Fast clients got %llu of %llu lines\n",
+           fast_lines, expected * (unsigned long long)fast);
+    printf("  Deliveries/sec:      %.0f\n", fast_lines / elapsed);
+    print_server_stats(srv);
+
+    for (int i = 0; i < num_clients; i++) CLOSE_SOCKET(fds[i]);
+    free(fds);
+    free(lines);
+    server_destroy(srv);
+    printf("  Live messages after shutdown: %llu\n", msg_live);
+}
+
+// ===== Interactive chat server =====
+
+void run_server(SlowPolicy policy) {
+    printf("=== Fan-out Chat Server ===\n");
+
+    FanoutServer* srv = server_create(PORT, policy);
+    if (srv == NULL) return;
+    srv->verbose = 2;
+
+    printf("Chat server listening on port %d (slow clients: %s)\n", PORT,
+           policy == POLICY_EVICT ? "evicted" : "messages dropped");
+    printf("Waiting for clients... (Ctrl+C to stop)\n\n");
+
+    while (1) {
+        server_poll(srv, -1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Initialize Winsock (Windows)
+    #ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        printf("WSAStartup failed\n");
+        return 1;
+    }
+    #else
+    signal(SIGPIPE, SIG_IGN);  // Writing to a dead client must not kill us
+    #endif
+
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        int clients = argc >= 3 ? atoi(argv[2]) : 1000;
+        int messages = argc >= 4 ? atoi(argv[3]) : 5000;
+        int slow = argc >= 5 ? atoi(argv[4]) : 10;
+        SlowPolicy policy = argc >= 6 && strcmp(argv[5], "drop") == 0 ? POLICY_DROP : POLICY_EVICT;
+        if (clients > MAX_CLIENTS) clients = MAX_CLIENTS;
+        if (slow > clients - 2) slow = clients - 2;
+        if (slow < 0) slow = 0;
+        run_bench(clients, messages, slow, policy);
+    } else {
+        SlowPolicy policy = argc >= 2 && strcmp(argv[1], "drop") == 0 ? POLICY_DROP : POLICY_EVICT;
+        run_server(policy);
+    }
+
+    #ifdef _WIN32
+    WSACleanup();
+    #endif
+
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Copy-per-client vs shared buffers:
+ *
+ * 04_chat_server:                     this example:
+ *   for each client:                    m = msg_create(text)   <- 1 malloc
+ *       send(client, text)  <- blocks     for each client:
+ *                                            queue[client] += ref(m)
+ *                                        unref(m)
+ *
+ *   client A queue: [m1][m2][m3]
+ *   client B queue:     [m2][m3]         m2 refcount = 3 (A, B, C)
+ *   client C queue:     [m2][m3]         freed when the last queue sends it
+ *
+ * Flushing:
+ * - writev() sends up to 64 queued messages in one syscall
+ * - A short write leaves head_offset pointing into the first message
+ * - Sockets are non-blocking: a full socket just waits for POLLOUT,
+ *   it never stalls the loop
+ *
+ * Backpressure:
+ * - Each client may queue QUEUE_CAPACITY messages / MAX_QUEUED_BYTES
+ * - evict: disconnect anyone over the limit (protects server memory)
+ * - drop:  skip messages until the queue drains to half, then resume
+ *
+ * Test:
+ * 1. 11_chat_fanout bench                 (1000 clients, 10 slow)
+ * 2. 11_chat_fanout bench 5000 2000 50 drop
+ * 3. 11_chat_fanout, then connect several 02_simple_client
+ *
+ * Try:
+ * - Replace poll() with epoll (Linux) so idle clients cost nothing
+ * - Send to slow clients only the newest state (conflation)
+ * - Move broadcasts to a worker thread and use atomic refcounts
+ */
@@ -0,0 +1,739 @@
+/*
+ * 12_framing_codec.c
+ *
+ * Message framing over a TCP byte stream.
+ * TCP has no message boundaries: one recv() may return half a message,
+ * or three messages glued together. The earlier examples assume one
+ * recv() == one message, which only works by luck on localhost.
+ *
+ * This codec:
+ * - Frames messages with a varint length prefix, or by newlines
+ * - Reads from the socket straight into a ring buffer (readv)
+ * - Hands out frames as views into the ring - no copying, even when a
+ *   frame wraps around the end (you get two pieces)
+ * - Takes ring storage from a pool of reusable blocks, growing on demand
+ * - Serializes frames as iovecs, so writev() sends header + payload
+ *   without building a combined buffer
+ *
+ * Usage: 12_framing_codec [megabytes]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <windows.h>
+    #pragma comment(lib, "ws2_32.lib")
+    #define CLOSE_SOCKET closesocket
+    typedef int socklen_t;
+    // Same layout idea as struct iovec, built on WSABUF below
+    struct iovec { void* iov_base; size_t iov_len; };
+#else
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+    #define CLOSE_SOCKET close
+#endif
+
+#define MIN_BLOCK (4 * 1024)             // Smallest pooled ring buffer
+#define MAX_BLOCK (16 * 1024 * 1024)     // Largest (so largest frame)
+#define POOL_CLASSES 13                  // 4KB, 8KB, ... 16MB
+#define POOL_KEEP 8                      // Free blocks kept per size class
+#define MAX_FRAME_SIZE (MAX_BLOCK - 16)
+#define WRITE_BATCH 64                   // Frames per writev()
+
+// ===== Timing =====
+
+double now_seconds(void) {
+    #ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+    #else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+    #endif
+}
+
+// ===== Buffer Pool =====
+//
+// Power-of-two blocks, one free list per size. Connections come and go
+// constantly; their buffers go back to the pool instead of to free().
+
+typedef struct PoolBlock {
+    struct PoolBlock* next;
+} PoolBlock;
+
+typedef struct {
+    PoolBlock* free_list[POOL_CLASSES];
+    int free_count[POOL_CLASSES];
+    unsigned long long mallocs;   // Blocks that had to come from malloc
+    unsigned long long reuses;    // Blocks served from a free list
+} BufferPool;
+
+int pool_class(size_t size, size_t* block_size) {
+    size_t s = MIN_BLOCK;
+    int c = 0;
+    while (s < size && c < POOL_CLASSES - 1) {
+        s <<= 1;
+        c++;
+    }
+    *block_size = s;
+    return s >= size ? c : -1;
+}
+
+void* pool_acquire(BufferPool* pool, size_t min_size, size_t* got) {
+    int c = pool_class(min_size, got);
+    if (c < 0) return NULL;
+
+    if (pool->free_list[c] != NULL) {
+        PoolBlock* b = pool->free_list[c];
+        pool->free_list[c] = b->next;
+        pool->free_count[c]--;
+        pool->reuses++;
+        return b;
+    }
+
+    pool->mallocs++;
+    return malloc(*got);
+}
+
+void pool_release(BufferPool* pool, void* block, size_t size) {
+    size_t dummy;
+    int c = pool_class(size, &dummy);
+    if (c < 0 || pool->free_count[c] >= POOL_KEEP) {
+        free(block);
+        return;
+    }
+    PoolBlock* b = (PoolBlock*)block;
+    b->next = pool->free_list[c];
+    pool->free_list[c] = b;
+    pool->free_count[c]++;
+}
+
+void pool_destroy(BufferPool* pool) {
+    for (int c = 0; c < POOL_CLASSES; c++) {
+        while (pool->free_list[c] != NULL) {
+            PoolBlock* b = pool->free_list[c];
+            pool->free_list[c] = b->next;
+            free(b);
+        }
+        pool->free_count[c] = 0;
+    }
+}
+
+// ===== Ring Buffer =====
+//
+// head and tail only ever grow; position = counter & (capacity - 1).
+// Capacity is a power of two, so that's a mask, not a modulo.
+//
+//   data: [....HHHHHHHHHH.......]     readable = tail - head
+//              ^head     ^tail
+
+typedef struct {
+    BufferPool* pool;
+    unsigned char* data;
+    size_t capacity;
+    size_t head;   // Next byte to read
+    size_t tail;   // Next byte to write
+} RingBuffer;
+
+void ring_init(RingBuffer* rb, BufferPool* pool) {
+    memset(rb, 0, sizeof(*rb));
+    rb->pool = pool;
+}
+
+void ring_free(RingBuffer* rb) {
+    if (rb->data != NULL) pool_release(rb->pool, rb->data, rb->capacity);
+    rb->data = NULL;
+    rb->capacity = 0;
+}
+
+size_t ring_readable(const RingBuffer* rb) {
+    return rb->tail - rb->head;
+}
+
+unsigned char ring_byte(const RingBuffer* rb, size_t offset) {
+    return rb->data[(rb->head + offset) & (rb->capacity - 1)];
+}
+
+// Make sure at least 'need' bytes fit in total (readable + free).
+// Growing is the only time bytes get copied.
+int ring_reserve(RingBuffer* rb, size_t need) {
+    if (need <= rb->capacity) return 0;
+
+    size_t new_cap;
+    unsigned char* block = (unsigned char*)pool_acquire(rb->pool, need, &new_cap);
+    if (block == NULL) return -1;
+
+    // Linearize the unread bytes at the start of the new block
+    size_t used = ring_readable(rb);
+    for (size_t i = 0; i < used; i++) {
+        block[i] = ring_byte(rb, i);
+    }
+
+    ring_free(rb);
+    rb->data = block;
+    rb->capacity = new_cap;
+    rb->head = 0;
+    rb->tail = used;
+    return 0;
+}
+
+// Free space as up to two regions - pass straight to readv()
+int ring_write_regions(RingBuffer* rb, struct iovec iov[2]) {
+    size_t free_bytes = rb->capacity - ring_readable(rb);
+    if (free_bytes == 0) return 0;
+
+    size_t pos = rb->tail & (rb->capacity - 1);
+    size_t first = rb->capacity - pos;
+    if (first > free_bytes) first = free_bytes;
+
+    iov[0].iov_base = rb->data + pos;
+    iov[0].iov_len = first;
+    if (first == free_bytes) return 1;
+
+    iov[1].iov_base = rb->data;
+    iov[1].iov_len = free_bytes - first;
+    return 2;
+}
+
+void ring_commit(RingBuffer* rb, size_t n) {
+    rb->tail += n;
+}
+
+void ring_consume(RingBuffer* rb, size_t n) {
+    rb->head += n;
+    // Empty ring: restart at position 0 so frames rarely wrap
+    if (rb->head == rb->tail) rb->head = rb->tail = 0;
+}
+
+void ring_append(RingBuffer* rb, const void* src, size_t len) {
+    const unsigned char* p = (const unsigned char*)src;
+    for (size_t i = 0; i < len; i++) {
+        rb->data[(rb->tail + i) & (rb->capacity - 1)] = p[i];
+    }
+    rb->tail += len;
+}
+
+// ===== Frames =====
+
+// A frame payload inside the ring: one piece, or two if it wraps
+typedef struct {
+    struct iovec parts[2];
+    int count;
+    size_t len;
+    size_t total;    // Prefix + payload (+ newline): bytes to consume
+} FrameView;
+
+void ring_view(RingBuffer* rb, size_t offset, size_t len, FrameView* view) {
+    size_t pos = (rb->head + offset) & (rb->capacity - 1);
+    size_t first = rb->capacity - pos;
+    if (first > len) first = len;
+
+    view->parts[0].iov_base = rb->data + pos;
+    view->parts[0].iov_len = first;
+    view->count = 1;
+    view->len = len;
+
+    if (first < len) {
+        view->parts[1].iov_base = rb->data;
+        view->parts[1].iov_len = len - first;
+        view->count = 2;
+    }
+}
+
+// Copy a view out - only for when the caller really needs flat bytes
+void frame_copy(const FrameView* f, unsigned char* dst) {
+    memcpy(dst, f->parts[0].iov_base, f->parts[0].iov_len);
+    if (f->count == 2) {
+        memcpy(dst + f->parts[0].iov_len, f->parts[1].iov_base, f->parts[1].iov_len);
+    }
+}
+
+// ===== Varint (LEB128: 7 bits per byte, high bit = more) =====
+
+int varint_encode(unsigned long long v, unsigned char* out) {
+    int n = 0;
+    while (v >= 0x80) {
+        out[n++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (unsigned char)v;
+    return n;
+}
+
+typedef enum {
+    FRAME_OK,
+    FRAME_NEED_MORE,   // Partial frame - read more from the socket
+    FRAME_ERROR        // Garbage or oversize - drop the connection
+} FrameStatus;
+
+typedef enum {
+    FRAMING_VARINT,
+    FRAMING_NEWLINE
+} FramingMode;
+
+typedef struct {
+    FramingMode mode;
+    size_t max_frame;
+    size_t scanned;    // Newline mode: bytes already searched, don't rescan
+} Decoder;
+
+void decoder_init(Decoder* d, FramingMode mode, size_t max_frame) {
+    d->mode = mode;
+    d->max_frame = max_frame;
+    d->scanned = 0;
+}
+
+// Find the next complete frame. Does not consume it: the view stays
+// valid until decoder_consume(), so the app can read it in place.
+FrameStatus decoder_next(Decoder* d, RingBuffer* rb, FrameView* out) {
+    size_t avail = ring_readable(rb);
+
+    if (d->mode == FRAMING_VARINT) {
+        unsigned long long len = 0;
+        int shift = 0;
+        size_t i = 0;
+
+        while (1) {
+            if (i == avail) return FRAME_NEED_MORE;  // Prefix itself is split
+            if (i == 10) return FRAME_ERROR;         // More than 64 bits
+            unsigned char b = ring_byte(rb, i++);
+            len |= (unsigned long long)(b & 0x7F) << shift;
+            if (!(b & 0x80)) break;
+            shift += 7;
+        }
+
+        if (len > d->max_frame) return FRAME_ERROR;
+        if (avail - i < len) {
+            // Tell the caller how big the buffer must get
+            if (ring_reserve(rb, i + len) < 0) return FRAME_ERROR;
+            return FRAME_NEED_MORE;
+        }
+
+        ring_view(rb, i, (size_t)len, out);
+        out->total = i + (size_t)len;
+        return FRAME_OK;
+    }
+
+    // Newline mode: search each contiguous piece with memchr
+    FrameView all;
+    if (avail == 0) return FRAME_NEED_MORE;
+    ring_view(rb, 0, avail, &all);
+
+    size_t base = 0;
+    for (int p = 0; p < all.count; p++) {
+        size_t plen = all.parts[p].iov_len;
+        if (d->scanned < base + plen) {
+            size_t from = d->scanned > base ? d->scanned - base : 0;
+            unsigned char* start = (unsigned char*)all.parts[p].iov_base;
+            unsigned char* nl = (unsigned char*)memchr(start + from, '\n', plen - from);
+            if (nl != NULL) {
+                size_t line = base + (size_t)(nl - start);
+                ring_view(rb, 0, line, out);
+                out->total = line + 1;
+                d->scanned = 0;
+                return FRAME_OK;
+            }
+        }
+        base += plen;
+    }
+
+    d->scanned = avail;
+    if (avail > d->max_frame) return FRAME_ERROR;
+    if (avail == rb->capacity && ring_reserve(rb, rb->capacity * 2) < 0) return FRAME_ERROR;
+    return FRAME_NEED_MORE;
+}
+
+void decoder_consume(Decoder* d, RingBuffer* rb, const FrameView* f) {
+    ring_consume(rb, f->total);
+    d->scanned = 0;
+}
+
+// ===== Encoder: frames straight into iovecs =====
+//
+// The payload is never copied: the iovec points at the caller's bytes.
+// Only the small prefix lives in the writer's header area.
+
+typedef struct {
+    FramingMode mode;
+    struct iovec iov[WRITE_BATCH * 2];
+    int iov_count;
+    unsigned char headers[WRITE_BATCH][10];
+    int frames;
+    size_t bytes;
+} FrameWriter;
+
+void writer_init(FrameWriter* w, FramingMode mode) {
+    memset(w, 0, sizeof(*w));
+    w->mode = mode;
+}
+
+// Returns 0, or -1 if the batch is full (flush first)
+int writer_add(FrameWriter* w, const void* payload, size_t len) {
+    static const char newline = '\n';
+    if (w->frames == WRITE_BATCH) return -1;
+
+    if (w->mode == FRAMING_VARINT) {
+        unsigned char* h = w->headers[w->frames];
+        int hn = varint_encode(len, h);
+        w->iov[w->iov_count].iov_base = h;
+        w->iov[w->iov_count++].iov_len = hn;
+        w->bytes += hn;
+    }
+
+    w->iov[w->iov_count].iov_base = (void*)payload;
+    w->iov[w->iov_count++].iov_len = len;
+    w->bytes += len;
+
+    if (w->mode == FRAMING_NEWLINE) {
+        // Newline frames: payload then '\n' (payload must not contain one)
+        w->iov[w->iov_count].iov_base = (void*)&newline;
+        w->iov[w->iov_count++].iov_len = 1;
+        w->bytes += 1;
+    }
+
+    w->frames++;
+    return 0;
+}
+
+// ===== Socket helpers (readv/writev, WSARecv/WSASend on Windows) =====
+
+long sock_readv(int fd, struct iovec* iov, int count) {
+    #ifdef _WIN32
+    WSABUF bufs[2];
+    for (int i = 0; i < count; i++) {
+        bufs[i].buf = (char*)iov[i].iov_base;
+        bufs[i].len = (ULONG)iov[i].iov_len;
+    }
+    DWORD got = 0, flags = 0;
+    if (WSARecv(fd, bufs, count, &got, &flags, NULL, NULL) != 0) return -1;
+    return (long)got;
+    #else
+    return (long)readv(fd, iov, count);
+    #endif
+}
+
+// Send every iovec completely, resuming after short writes
+int sock_writev_all(int fd, struct iovec* iov, int count) {
+    int i = 0;
+    while (i < count) {
+        long n;
+        #ifdef _WIN32
+        WSABUF bufs[WRITE_BATCH * 2];
+        for (int k = i; k < count; k++) {
+            bufs[k - i].buf = (char*)iov[k].iov_base;
+            bufs[k - i].len = (ULONG)iov[k].iov_len;
+        }
+        DWORD sent = 0;
+        n = WSASend(fd, bufs, count - i, &sent, 0, NULL, NULL) == 0 ? (long)sent : -1;
+        #else
+        n = (long)writev(fd, iov + i, count - i);
+        #endif
+        if (n < 0) return -1;
+
+        while (i < count && (size_t)n >= iov[i].iov_len) {
+            n -= (long)iov[i].iov_len;
+            i++;
+        }
+        if (i < count) {
+            iov[i].iov_base = (char*)iov[i].iov_base + n;
+            iov[i].iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+int writer_flush(FrameWriter* w, int fd) {
+    int r = 0;
+    if (w->iov_count > 0) r = sock_writev_all(fd, w->iov, w->iov_count);
+    w->iov_count = 0;
+    w->frames = 0;
+    w->bytes = 0;
+    return r;
+}
+
+// ===== Self-test: random chunking must not change the frames =====
+
+unsigned int rng_state = 12345;
+unsigned int rng(void) {
+    rng_state = rng_state * 1103515245 + 12345;
+    return (rng_state >> 8) & 0xFFFFFF;
+}
+
+// Deterministic frame content so the decoder side can verify it
+size_t make_frame(int index, unsigned char* buf, FramingMode mode) {
+    // Mostly small messages, sometimes a big one that forces growth
+    size_t len = (index % 97 == 0) ? 20000 + rng() % 50000 : rng() % 200;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)(index * 7 + i * 13);
+        if (mode == FRAMING_NEWLINE && c == '\n') c = ' ';
+        buf[i] = c;
+    }
+    return len;
+}
+
+int check_frame(int index, const FrameView* f, FramingMode mode, unsigned char* scratch) {
+    frame_copy(f, scratch);
+    for (size_t i = 0; i < f->len; i++) {
+        unsigned char c = (unsigned char)(index * 7 + i * 13);
+        if (mode == FRAMING_NEWLINE && c == '\n') c = ' ';
+        if (scratch[i] != c) return 0;
+    }
+    return 1;
+}
+
+void self_test(FramingMode mode, BufferPool* pool) {
+    const int frames = 5000;
+    unsigned char* payload = (unsigned char*)malloc(80000);
+    unsigned char* scratch = (unsigned char*)malloc(80000);
+
+    // 1. Encode everything into one flat stream
+    size_t stream_cap = 8 * 1024 * 1024, stream_len = 0;
+    unsigned char* stream = (unsigned char*)malloc(stream_cap);
+    size_t* lengths = (size_t*)malloc(frames * sizeof(size_t));
+
+    rng_state = 777;
+    for (int i = 0; i < frames; i++) {
+        size_t len = make_frame(i, payload, mode);
+        lengths[i] = len;
+        FrameWriter w;
+        writer_init(&w, mode);
+        writer_add(&w, payload, len);
+        for (int k = 0; k < w.iov_count; k++) {
+            memcpy(stream + stream_len, w.iov[k].iov_base, w.iov[k].iov_len);
+            stream_len += w.iov[k].iov_len;
+        }
+    }
+
+    // 2. Feed it in random chunk sizes (1 byte .. 4KB) - partial reads,
+    //    split prefixes, many frames in one read, frames across the wrap
+    RingBuffer rb;
+    ring_init(&rb, pool);
+    ring_reserve(&rb, MIN_BLOCK);
+    Decoder d;
+    decoder_init(&d, mode, MAX_FRAME_SIZE);
+
+    int decoded = 0, bad = 0, wrapped = 0;
+    size_t fed = 0;
+    while (decoded < frames) {
+        if (fed < stream_len) {
+            size_t chunk = 1 + rng() % 4096;
+            if (chunk > stream_len - fed) chunk = stream_len - fed;
+            if (ring_readable(&rb) + chunk > rb.capacity) {
+                chunk = rb.capacity - ring_readable(&rb);
+            }
+            ring_append(&rb, stream + fed, chunk);
+            fed += chunk;
+        }
+
+        FrameView f;
+        FrameStatus st;
+        while ((st = decoder_next(&d, &rb, &f)) == FRAME_OK) {
+            if (f.count == 2) wrapped++;
+            if (f.len != lengths[decoded] || !check_frame(decoded, &f, mode, scratch)) bad++;
+            decoder_consume(&d, &rb, &f);
+            decoded++;
+        }
+        if (st == FRAME_ERROR) {
+            printf("  Decoder error at frame %d\n", decoded);
+            break;
+        }
+        if (fed == stream_len && decoded < frames) {
+            printf("  Stream ended inside frame %d\n", decoded);
+            break;
+        }
+    }
+
+    printf("  %-8s %d/%d frames decoded, %d corrupt, %d wrapped (2-piece views), ring grew to %zu KB\n",
+           mode == FRAMING_VARINT ? "varint:" : "newline:",
+           decoded, frames, bad, wrapped, rb.capacity / 1024);
+
+    ring_free(&rb);
+    free(stream);
+    free(lengths);
+    free(payload);
+    free(scratch);
+}
+
+// ===== Throughput over a real TCP connection =====
+
+int tcp_pair(int fds[2]) {
+    int listener = (int)socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+
+    if (listener < 0 || bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listener, 1) < 0 ||
+        getsockname(listener, (struct sockaddr*)&addr, &len) < 0) {
+        perror("listener failed");
+        return -1;
+    }
+
+    fds[0] = (int)socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(fds[0], (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect failed");
+        return -1;
+    }
+    fds[1] = (int)accept(listener, NULL, NULL);
+    CLOSE_SOCKET(listener);
+    return fds[1] < 0 ? -1 : 0;
+}
+
+// Ping-pong in one thread: write a batch, read and decode it all back
+void throughput_test(FramingMode mode, BufferPool* pool, size_t total_bytes, size_t msg_size) {
+    int fds[2];
+    if (tcp_pair(fds) < 0) return;
+
+    unsigned char* payload = (unsigned char*)malloc(msg_size);
+    memset(payload, 'a', msg_size);
+
+    RingBuffer rb;
+    ring_init(&rb, pool);
+    ring_reserve(&rb, 64 * 1024);
+    Decoder d;
+    decoder_init(&d, mode, MAX_FRAME_SIZE);
+    FrameWriter w;
+    writer_init(&w, mode);
+
+    // Keep each batch well under the socket buffers - we write and read
+    // from the same thread, so a batch that doesn't fit would deadlock
+    int per_batch = (int)((256 * 1024) / (msg_size + 10));
+    if (per_batch > WRITE_BATCH) per_batch = WRITE_BATCH;
+    if (per_batch < 1) per_batch = 1;
+
+    unsigned long long frames = 0, reads = 0, writes = 0;
+    size_t bytes = 0;
+    double start = now_seconds();
+
+    while (bytes < total_bytes) {
+        // Write one batch (header and payload iovecs, payload not copied)
+        for (int i = 0; i < per_batch; i++) writer_add(&w, payload, msg_size);
+        size_t batch_bytes = w.bytes;
+        writer_flush(&w, fds[0]);
+        writes++;
+
+        // Read until the whole batch is decoded
+        int got = 0;
+        while (got < per_batch) {
+            struct iovec iov[2];
+            int n = ring_write_regions(&rb, iov);
+            long r = sock_readv(fds[1], iov, n);
+            if (r <= 0) {
+                printf("  read failed\n");
+                bytes = total_bytes;
+                break;
+            }
+            ring_commit(&rb, (size_t)r);
+            reads++;
+
+            FrameView f;
+            while (decoder_next(&d, &rb, &f) == FRAME_OK) {
+                decoder_consume(&d, &rb, &f);
+                got++;
+            }
+        }
+        frames += got;
+        bytes += batch_bytes;
+    }
+
+    double elapsed = now_seconds() - start;
+    printf("  %-8s %5zu B msgs: %8.0f frames/s  %7.1f MB/s  %5.1f frames/read  %.0f frames/write\n",
+           mode == FRAMING_VARINT ? "varint" : "newline", msg_size,
+           frames / elapsed, bytes / elapsed / 1e6,
+           reads ? (double)frames / reads : 0.0,
+           writes ? (double)frames / writes : 0.0);
+
+    ring_free(&rb);
+    free(payload);
+    CLOSE_SOCKET(fds[0]);
+    CLOSE_SOCKET(fds[1]);
+}
+
+int main(int argc, char* argv[]) {
+    // Initialize Winsock (Windows)
+    #ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        printf("WSAStartup failed\n");
+        return 1;
+    }
+    #endif
+
+    size_t megabytes = argc >= 2 ? (size_t)atoi(argv[1]) : 64;
+
+    printf("=== Framing Codec ===\n\n");
+
+    BufferPool pool = {0};
+
+    printf("Self-test (random chunk sizes, partial prefixes, coalesced frames):\n");
+    self_test(FRAMING_VARINT, &pool);
+    self_test(FRAMING_NEWLINE, &pool);
+
+    printf("\nThroughput over loopback TCP (%zu MB per run):\n", megabytes);
+    size_t sizes[] = { 16, 128, 1024, 16384 };
+    for (int i = 0; i < 4; i++) {
+        throughput_test(FRAMING_VARINT, &pool, megabytes << 20, sizes[i]);
+    }
+    throughput_test(FRAMING_NEWLINE, &pool, megabytes << 20, 128);
+
+    printf("\nBuffer pool: %llu blocks from malloc, %llu reused\n",
+           pool.mallocs, pool.reuses);
+    pool_destroy(&pool);
+
+    #ifdef _WIN32
+    WSACleanup();
+    #endif
+
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Why framing:
+ *
+ *   sender:   send("HELLO")  send("WORLD")
+ *   receiver: recv() -> "HEL"   recv() -> "LOWORLD"    <- totally legal TCP
+ *
+ * Length prefix (varint):
+ *   [0x05]HELLO[0x05]WORLD
+ *   Small lengths cost 1 byte, up to 16383 cost 2, any 64-bit length fits.
+ *   Payload can contain any bytes.
+ *
+ * Newline:
+ *   HELLO\nWORLD\n
+ *   Human readable (telnet works), payload can't contain '\n'.
+ *
+ * Zero-copy path:
+ *   socket --readv--> ring buffer --view--> your handler --consume-->
+ *   No intermediate "message buffer": the frame you process IS the
+ *   bytes the kernel wrote. Views wrapping the ring end come in two
+ *   parts; frame_copy() exists for code that needs one flat buffer.
+ *
+ *   payload --iovec--> writev --> socket
+ *   The varint header sits in a tiny side buffer; payload pointers go
+ *   straight into the iovec list. 64 frames = 1 syscall.
+ *
+ * Buffer pool:
+ *   Rings come from power-of-two free lists. A ring only grows (and
+ *   copies) when a single frame doesn't fit; the old block goes back
+ *   to the pool for the next connection.
+ *
+ * Try:
+ * - Use this codec in 04_chat_server and 08_file_transfer
+ * - Add a maximum-frame check per connection (DoS protection)
+ * - Map the ring twice with mmap so frames never wrap
+ * - Make the pool thread-safe (see Multithreading)
+ */
@@ -0,0 +1,721 @@
+/*
+ * 13_load_generator.c
+ *
+ * Load generator with a latency histogram - for measuring servers
+ * instead of guessing. Opens many connections to a localhost server,
+ * drives them closed-loop or open-loop, and reports throughput and
+ * p50/p99/p99.9 latency from an HDR-style histogram.
+ *
+ * Protocols:
+ *   echo - send N bytes, expect the same N bytes back (01/03, built-in server)
+ *   http - "GET / HTTP/1.1" with keep-alive, reads Content-Length bodies
+ *   chat - lines with a timestamp; latency = time until OTHER clients
+ *          see the line (04_chat_server, 11_chat_fanout)
+ *
+ * Usage:
+ *   13_load_generator demo                  (forks a built-in echo server)
+ *   13_load_generator server [port]         (built-in poll() echo server)
+ *   13_load_generator [--port 8080] [--proto echo|http|chat]
+ *                     [--mode closed|open] [--conns 16] [--rate 20000]
+ *                     [--size 64] [--duration 5] [--warmup 1]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <windows.h>
+    #pragma comment(lib, "ws2_32.lib")
+    #define CLOSE_SOCKET closesocket
+    #define poll WSAPoll
+    typedef int socklen_t;
+#else
+    #include <sys/socket.h>
+    #include <sys/wait.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <signal.h>
+    #include <time.h>
+    #include <unistd.h>
+    #define CLOSE_SOCKET close
+#endif
+
+#define SERVER_IP "127.0.0.1"   // Localhost only - never aim this at someone else
+#define PORT 8080
+#define MAX_CONNS 4096
+#define OUTBUF_SIZE (64 * 1024)
+#define INBUF_SIZE (64 * 1024)
+#define MAX_PIPELINE 1024       // Outstanding requests per connection (open loop)
+
+// ===== Timing (nanoseconds) =====
+
+typedef unsigned long long u64;
+
+u64 now_ns(void) {
+    #ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (u64)((double)count.QuadPart * 1e9 / (double)freq.QuadPart);
+    #else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ULL + (u64)ts.tv_nsec;
+    #endif
+}
+
+// ===== HDR-style Histogram =====
+//
+// Log-linear buckets: every power of two is split into 128 linear
+// sub-buckets, so any recorded value is off by less than 1%, from
+// 1 ns to hours, in a few thousand counters. Recording is O(1).
+
+#define HIST_SUB_BITS 7
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_MAX_BITS 42                       // ~73 minutes in ns
+#define HIST_BUCKETS ((HIST_MAX_BITS - HIST_SUB_BITS + 1) * HIST_SUB + HIST_SUB)
+
+typedef struct {
+    u64 counts[HIST_BUCKETS];
+    u64 total;
+    u64 min, max;
+    double sum;
+} Histogram;
+
+void hist_reset(Histogram* h) {
+    memset(h, 0, sizeof(*h));
+    h->min = ~0ULL;
+}
+
+int msb_index(u64 v) {
+    int m = 0;
+    while (v >>= 1) m++;
+    return m;
+}
+
+int hist_index(u64 v) {
+    if (v < 2 * HIST_SUB) return (int)v;       // Small values are exact
+    int shift = msb_index(v) - HIST_SUB_BITS;
+    int idx = (shift << HIST_SUB_BITS) + (int)(v >> shift);
+    return idx < HIST_BUCKETS ? idx : HIST_BUCKETS - 1;
+}
+
+// Highest value that lands in this bucket
+u64 hist_value(int idx) {
+    if (idx < 2 * HIST_SUB) return (u64)idx;
+    int shift = idx / HIST_SUB - 1;
+    u64 mantissa = (u64)(idx - shift * HIST_SUB);
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void hist_record(Histogram* h, u64 v) {
+    h->counts[hist_index(v)]++;
+    h->total++;
+    h->sum += (double)v;
+    if (v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+}
+
+u64 hist_percentile(const Histogram* h, double p) {
+    if (h->total == 0) return 0;
+    u64 target = (u64)(p / 100.0 * h->total + 0.5);
+    if (target < 1) target = 1;
+
+    u64 seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= target) {
+            u64 v = hist_value(i);
+            return v < h->max ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+void hist_print(const Histogram* h) {
+    if (h->total == 0) {
+        printf("  (no samples)\n");
+        return;
+    }
+    printf("  min     %10.1f us\n", h->min / 1e3);
+    printf("  mean    %10.1f us\n", h->sum / h->total / 1e3);
+    printf("  p50     %10.1f us\n", hist_percentile(h, 50) / 1e3);
+    printf("  p90     %10.1f us\n", hist_percentile(h, 90) / 1e3);
+    printf("  p99     %10.1f us\n", hist_percentile(h, 99) / 1e3);
+    printf("  p99.9   %10.1f us\n", hist_percentile(h, 99.9) / 1e3);
+    printf("  p99.99  %10.1f us\n", hist_percentile(h, 99.99) / 1e3);
+    printf("  max     %10.1f us\n", h->max / 1e3);
+}
+
+// ===== Configuration =====
+
+typedef enum { PROTO_ECHO, PROTO_HTTP, PROTO_CHAT } Protocol;
+typedef enum { LOOP_CLOSED, LOOP_OPEN } LoopMode;
+
+typedef struct {
+    int port;
+    Protocol proto;
+    LoopMode mode;
+    int conns;
+    double rate;          // Requests/s across all connections (open loop)
+    int size;             // Request bytes (echo) or line length (chat)
+    double duration;      // Seconds measured
+    double warmup;        // Seconds discarded first
+} Config;
+
+// ===== Connections =====
+
+typedef struct {
+    int fd;
+    char out[OUTBUF_SIZE];
+    size_t out_len, out_off;
+    char in[INBUF_SIZE];
+    size_t in_len;
+    u64 start_times[MAX_PIPELINE];   // FIFO of request start times
+    int q_head, q_count;
+    size_t echo_pending;             // Echo: bytes of current reply seen
+    int closed;
+} Conn;
+
+typedef struct {
+    Config cfg;
+    Conn* conns;
+    Histogram hist;
+    int recording;
+    u64 completed, errors, backlog_drops;
+    u64 bytes_sent, bytes_received;
+    char* request;                   // Prebuilt echo/http request
+    size_t request_len;
+} LoadGen;
+
+void set_nonblocking(int fd) {
+    #ifdef _WIN32
+    u_long mode = 1;
+    ioctlsocket(fd, FIONBIO, &mode);
+    #else
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    #endif
+}
+
+int would_block(void) {
+    #ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+    #else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+    #endif
+}
+
+int connect_to(int port) {
+    int fd = (int)socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr(SERVER_IP);
+
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        CLOSE_SOCKET(fd);
+        return -1;
+    }
+
+    // Small requests must not wait for Nagle's algorithm
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+    set_nonblocking(fd);
+    return fd;
+}
+
+// Queue one request on a connection; start = when it SHOULD have been sent
+int issue_request(LoadGen* lg, Conn* c, u64 start) {
+    if (c->closed || c->q_count == MAX_PIPELINE) return -1;
+
+    char line[INBUF_SIZE];
+    const char* data = lg->request;
+    size_t len = lg->request_len;
+
+    if (lg->cfg.proto == PROTO_CHAT) {
+        // Padding first, timestamp last: the server prefixes "[Client N]: "
+        // and the receiver takes the last number on the line
+        int pad = lg->cfg.size - 22;
+        if (pad < 0) pad = 0;
+        memset(line, '.', pad);
+        int n = pad + snprintf(line + pad, sizeof(line) - pad, " %llu", start);
+        line[n++] = '\n';
+        data = line;
+        len = (size_t)n;
+    }
+
+    if (c->out_len + len > OUTBUF_SIZE) return -1;  // Connection is backed up
+
+    memcpy(c->out + c->out_len, data, len);
+    c->out_len += len;
+
+    if (lg->cfg.proto != PROTO_CHAT) {
+        c->start_times[(c->q_head + c->q_count) % MAX_PIPELINE] = start;
+        c->q_count++;
+    }
+    return 0;
+}
+
+void complete_request(LoadGen* lg, Conn* c, u64 now) {
+    if (c->q_count == 0) return;
+    u64 start = c->start_times[c->q_head];
+    c->q_head = (c->q_head + 1) % MAX_PIPELINE;
+    c->q_count--;
+
+    if (lg->recording) {
+        hist_record(&lg->hist, now > start ? now - start : 0);
+        lg->completed++;
+    }
+}
+
+void conn_flush(LoadGen* lg, Conn* c) {
+    while (c->out_off < c->out_len) {
+        int n = send(c->fd, c->out + c->out_off, (int)(c->out_len - c->out_off), 0);
+        if (n < 0) {
+            if (!would_block()) {
+                c->closed = 1;
+                lg->errors++;
+            }
+            break;
+        }
+        c->out_off += n;
+        if (lg->recording) lg->bytes_sent += n;
+    }
+    if (c->out_off == c->out_len) c->out_off = c->out_len = 0;
+}
+
+// Parse complete responses out of the input buffer
+void parse_responses(LoadGen* lg, Conn* c, u64 now) {
+    if (lg->cfg.proto == PROTO_ECHO) {
+        // Reply = same size as request, back in order
+        c->echo_pending += c->in_len;
+        c->in_len = 0;
+        while (c->echo_pending >= lg->request_len && c->q_count > 0) {
+            c->echo_pending -= lg->request_len;
+            complete_request(lg, c, now);
+        }
+        return;
+    }
+
+    size_t pos = 0;
+    while (pos < c->in_len) {
+        char* start = c->in + pos;
+        size_t avail = c->in_len - pos;
+
+        if (lg->cfg.proto == PROTO_CHAT) {
+            char* nl = (char*)memchr(start, '\n', avail);
+            if (nl == NULL) break;
+            *nl = '\0';
+            // The timestamp is the last number on the line
+            char* p = nl;
+            while (p > start && p[-1] == ' ') p--;
+            char* end = p;
+            while (p > start && p[-1] >= '0' && p[-1] <= '9') p--;
+            if (p < end && lg->recording) {
+                u64 sent = strtoull(p, NULL, 10);
+                hist_record(&lg->hist, now > sent ? now - sent : 0);
+                lg->completed++;
+            }
+            pos += (size_t)(nl - start) + 1;
+            continue;
+        }
+
+        // HTTP: headers end at a blank line, body length from Content-Length
+        char* end = NULL;
+        for (size_t i = 3; i < avail; i++) {
+            if (start[i - 3] == '\r' && start[i - 2] == '\n' &&
+                start[i - 1] == '\r' && start[i] == '\n') {
+                end = start + i + 1;
+                break;
+            }
+        }
+        if (end == NULL) break;
+
+        size_t body = 0;
+        for (char* h = start; h < end - 16; h++) {
+            if ((*h == 'C' || *h == 'c') && strncmp(h + 1, "ontent-Length:", 14) == 0) {
+                body = (size_t)strtoul(h + 15, NULL, 10);
+                break;
+            }
+        }
+        size_t total = (size_t)(end - start) + body;
+        if (avail < total) break;
+
+        complete_request(lg, c, now);
+        pos += total;
+    }
+
+    // Keep the partial response
+    if (pos > 0) {
+        memmove(c->in, c->in + pos, c->in_len - pos);
+        c->in_len -= pos;
+    } else if (c->in_len == INBUF_SIZE) {
+        c->in_len = 0;  // Garbage we can't parse; don't wedge
+        lg->errors++;
+    }
+}
+
+void conn_read(LoadGen* lg, Conn* c, u64 now) {
+    while (!c->closed) {
+        int n = recv(c->fd, c->in + c->in_len, (int)(INBUF_SIZE - c->in_len), 0);
+        if (n == 0 || (n < 0 && !would_block())) {
+            c->closed = 1;
+            lg->errors++;
+            return;
+        }
+        if (n < 0) return;
+        c->in_len += n;
+        if (lg->recording) lg->bytes_received += n;
+        parse_responses(lg, c, now);
+    }
+}
+
+// ===== The measurement loop =====
+
+void build_request(LoadGen* lg) {
+    Config* cfg = &lg->cfg;
+    if (cfg->proto == PROTO_HTTP) {
+        const char* req = "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n";
+        lg->request_len = strlen(req);
+        lg->request = (char*)malloc(lg->request_len);
+        memcpy(lg->request, req, lg->request_len);
+    } else {
+        lg->request_len = (size_t)cfg->size;
+        lg->request = (char*)malloc(lg->request_len);
+        memset(lg->request, 'x', lg->request_len);
+        lg->request[lg->request_len - 1] = '\n';  // Line-based servers work too
+    }
+}
+
+void run_load(Config cfg) {
+    LoadGen* lg = (LoadGen*)calloc(1, sizeof(LoadGen));
+    lg->cfg = cfg;
+    lg->conns = (Conn*)calloc(cfg.conns, sizeof(Conn));
+    struct pollfd* pfds = (struct pollfd*)calloc(cfg.conns, sizeof(struct pollfd));
+    if (lg->conns == NULL || pfds == NULL) {
+        printf("Out of memory\n");
+        return;
+    }
+    hist_reset(&lg->hist);
+    build_request(lg);
+
+    const char* proto_names[] = { "echo", "http", "chat" };
+    printf("Target %s:%d, protocol %s, %s loop\n", SERVER_IP, cfg.port,
+           proto_names[cfg.proto], cfg.mode == LOOP_CLOSED ? "closed" : "open");
+    printf("%d connections, %d byte requests, %.1f s (+%.1f s warmup)",
+           cfg.conns, cfg.proto == PROTO_HTTP ? (int)lg->request_len : cfg.size,
+           cfg.duration, cfg.warmup);
+    if (cfg.mode == LOOP_OPEN) printf(", %.0f req/s", cfg.rate);
+    printf("\n\n");
+
+    for (int i = 0; i < cfg.conns; i++) {
+        lg->conns[i].fd = connect_to(cfg.port);
+        if (lg->conns[i].fd < 0) {
+            printf("Connection %d failed - is the server running on port %d?\n", i, cfg.port);
+            for (int k = 0; k < i; k++) CLOSE_SOCKET(lg->conns[k].fd);
+            free(lg->request);
+            free(lg->conns);
+            free(pfds);
+            free(lg);
+            return;
+        }
+    }
+
+    // Chat servers send a welcome line first - let it arrive and drop it
+    if (cfg.proto == PROTO_CHAT) {
+        #ifdef _WIN32
+        Sleep(100);
+        #else
+        usleep(100000);
+        #endif
+        for (int i = 0; i < cfg.conns; i++) conn_read(lg, &lg->conns[i], now_ns());
+        for (int i = 0; i < cfg.conns; i++) lg->conns[i].in_len = 0;
+    }
+
+    u64 t0 = now_ns();
+    u64 measure_start = t0 + (u64)(cfg.warmup * 1e9);
+    u64 t_end = measure_start + (u64)(cfg.duration * 1e9);
+    u64 interval = cfg.rate > 0 ? (u64)(1e9 / cfg.rate) : 0;
+    u64 next_send = t0;
+    int rr = 0;
+
+    // Closed loop: everyone starts with one request in flight
+    if (cfg.mode == LOOP_CLOSED && cfg.proto != PROTO_CHAT) {
+        for (int i = 0; i < cfg.conns; i++) issue_request(lg, &lg->conns[i], t0);
+    }
+
+    while (1) {
+        u64 now = now_ns();
+        if (now >= t_end) break;
+
+        if (!lg->recording && now >= measure_start) {
+            lg->recording = 1;
+            hist_reset(&lg->hist);
+        }
+
+        // Open loop: send on schedule no matter how the server is doing.
+        // Latency counts from the SCHEDULED time, so a stalled server
+        // shows up as latency instead of silently lowering the rate
+        // (avoids "coordinated omission").
+        if (cfg.mode == LOOP_OPEN || cfg.proto == PROTO_CHAT) {
+            if (interval == 0) interval = 1000000;  // Chat default: 1000/s
+            while (next_send <= now) {
+                Conn* c = &lg->conns[rr];
+                rr = (rr + 1) % cfg.conns;
+                if (issue_request(lg, c, next_send) < 0 && lg->recording) lg->backlog_drops++;
+                next_send += interval;
+            }
+        }
+
+        for (int i = 0; i < cfg.conns; i++) {
+            Conn* c = &lg->conns[i];
+            if (c->out_len > 0) conn_flush(lg, c);
+            pfds[i].fd = c->closed ? -1 : c->fd;
+            pfds[i].events = POLLIN | (c->out_len > 0 ? POLLOUT : 0);
+            pfds[i].revents = 0;
+        }
+
+        // poll() sleeps in whole ms; when the next send is sooner, spin so
+        // the generator's own lateness doesn't land in the histogram
+        int timeout = 1;
+        if (cfg.mode == LOOP_OPEN || cfg.proto == PROTO_CHAT) {
+            timeout = next_send > now + 1000000 ? (int)((next_send - now) / 1000000) : 0;
+        }
+        if (poll(pfds, cfg.conns, timeout) < 0 && errno != EINTR) {
+            perror("poll failed");
+            break;
+        }
+
+        now = now_ns();
+        for (int i = 0; i < cfg.conns; i++) {
+            Conn* c = &lg->conns[i];
+            if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                int before = c->q_count;
+                conn_read(lg, c, now);
+
+                // Closed loop: a finished request immediately starts the next
+                if (cfg.mode == LOOP_CLOSED && cfg.proto != PROTO_CHAT) {
+                    for (int k = c->q_count; k < before; k++) {
+                        issue_request(lg, c, now);
+                    }
+                    if (c->q_count == 0) issue_request(lg, c, now);
+                }
+            }
+            if (pfds[i].revents & POLLOUT) conn_flush(lg, c);
+        }
+    }
+
+    double seconds = cfg.duration;
+    printf("Results:\n");
+    const char* unit = cfg.proto == PROTO_CHAT ? "deliveries" : "requests";
+    printf("  Completed     %llu %s\n", lg->completed, unit);
+    printf("  Throughput    %.0f %s/s\n", lg->completed / seconds, unit);
+    printf("  Bandwidth     %.2f MB/s out, %.2f MB/s in\n",
+           lg->bytes_sent / seconds / 1e6, lg->bytes_received / seconds / 1e6);
+    printf("  Errors        %llu\n", lg->errors);
+    if (cfg.mode == LOOP_OPEN || cfg.proto == PROTO_CHAT) {
+        printf("  Not sent      %llu (connection send buffer full)\n", lg->backlog_drops);
+    }
+    printf("\nLatency (%s):\n",
+           cfg.proto == PROTO_CHAT ? "send -> other clients receive" : "request -> full response");
+    hist_print(&lg->hist);
+
+    for (int i = 0; i < cfg.conns; i++) CLOSE_SOCKET(lg->conns[i].fd);
+    free(lg->request);
+    free(lg->conns);
+    free(pfds);
+    free(lg);
+}
+
+// ===== Built-in echo server (poll, many clients) =====
+
+void run_echo_server(int port, int quiet) {
+    int listen_fd = (int)socket(AF_INET, SOCK_STREAM, 0);
+    int opt = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&opt, sizeof(opt));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listen_fd, 1024) < 0) {
+        perror("bind/listen failed");
+        return;
+    }
+    set_nonblocking(listen_fd);
+    if (!quiet) printf("Echo server on %s:%d (Ctrl+C to stop)\n", SERVER_IP, port);
+
+    struct pollfd* pfds = (struct pollfd*)calloc(MAX_CONNS + 1, sizeof(struct pollfd));
+    int count = 1;
+    pfds[0].fd = listen_fd;
+    pfds[0].events = POLLIN;
+    char buf[65536];
+
+    while (1) {
+        if (poll(pfds, count, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            int fd;
+            while (count <= MAX_CONNS && (fd = (int)accept(listen_fd, NULL, NULL)) >= 0) {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+                pfds[count].fd = fd;
+                pfds[count].events = POLLIN;
+                pfds[count].revents = 0;
+                count++;
+            }
+        }
+
+        for (int i = 1; i < count; i++) {
+            if (!(pfds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+            // Blocking send keeps this tiny: echo clients always read
+            int n = recv(pfds[i].fd, buf, sizeof(buf), 0);
+            if (n <= 0 || send(pfds[i].fd, buf, n, 0) != n) {
+                CLOSE_SOCKET(pfds[i].fd);
+                pfds[i] = pfds[--count];
+                i--;
+            }
+        }
+    }
+    free(pfds);
+}
+
+// ===== Demo: fork a server, run both loop modes against it =====
+
+void run_demo(void) {
+    #ifdef _WIN32
+    printf("demo needs fork(); start '13_load_generator server' in another window\n");
+    #else
+    int port = PORT + 100;
+    pid_t pid = fork();
+    if (pid == 0) {
+        run_echo_server(port, 1);
+        _exit(0);
+    }
+    usleep(200000);  // Let it bind
+
+    Config cfg = { port, PROTO_ECHO, LOOP_CLOSED, 16, 0, 64, 2.0, 0.5 };
+    printf("=== Closed loop: as fast as the server answers ===\n");
+    run_load(cfg);
+
+    printf("\n=== Open loop: fixed 20000 req/s schedule ===\n");
+    cfg.mode = LOOP_OPEN;
+    cfg.rate = 20000;
+    run_load(cfg);
+
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+    #endif
+}
+
+int main(int argc, char* argv[]) {
+    // Initialize Winsock (Windows)
+    #ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        printf("WSAStartup failed\n");
+        return 1;
+    }
+    #else
+    signal(SIGPIPE, SIG_IGN);
+    #endif
+
+    printf("=== Load Generator ===\n\n");
+
+    if (argc >= 2 && strcmp(argv[1], "demo") == 0) {
+        run_demo();
+    } else if (argc >= 2 && strcmp(argv[1], "server") == 0) {
+        run_echo_server(argc >= 3 ? atoi(argv[2]) : PORT, 0);
+    } else if (argc >= 2 && (strcmp(argv[1], "help") == 0 || strcmp(argv[1], "-h") == 0)) {
+        printf("Usage:\n");
+        printf("  %s demo\n", argv[0]);
+        printf("  %s server [port]\n", argv[0]);
+        printf("  %s [--port P] [--proto echo|http|chat] [--mode closed|open]\n", argv[0]);
+        printf("     [--conns N] [--rate R] [--size BYTES] [--duration S] [--warmup S]\n");
+    } else {
+        Config cfg = { PORT, PROTO_ECHO, LOOP_CLOSED, 16, 20000, 64, 5.0, 1.0 };
+
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const char* k = argv[i];
+            const char* v = argv[i + 1];
+            if (strcmp(k, "--port") == 0) cfg.port = atoi(v);
+            else if (strcmp(k, "--conns") == 0) cfg.conns = atoi(v);
+            else if (strcmp(k, "--rate") == 0) cfg.rate = atof(v);
+            else if (strcmp(k, "--size") == 0) cfg.size = atoi(v);
+            else if (strcmp(k, "--duration") == 0) cfg.duration = atof(v);
+            else if (strcmp(k, "--warmup") == 0) cfg.warmup = atof(v);
+            else if (strcmp(k, "--mode") == 0) cfg.mode = strcmp(v, "open") == 0 ? LOOP_OPEN : LOOP_CLOSED;
+            else if (strcmp(k, "--proto") == 0) {
+                cfg.proto = strcmp(v, "http") == 0 ? PROTO_HTTP :
+                            strcmp(v, "chat") == 0 ? PROTO_CHAT : PROTO_ECHO;
+            } else {
+                printf("Unknown option %s (try 'help')\n", k);
+                return 1;
+            }
+        }
+
+        if (cfg.conns < 1) cfg.conns = 1;
+        if (cfg.conns > MAX_CONNS) cfg.conns = MAX_CONNS;
+        if (cfg.size < 24) cfg.size = 24;
+        if (cfg.size > 16384) cfg.size = 16384;
+        if (cfg.duration <= 0) cfg.duration = 1;
+        run_load(cfg);
+    }
+
+    #ifdef _WIN32
+    WSACleanup();
+    #endif
+
+    printf("\nPress Enter to exit...");
+    getchar();
+    return 0;
+}
+
+/*
+ * Closed vs open loop:
+ *
+ * Closed loop (N connections, each: send -> wait -> send...)
+ * - Throughput = N / latency. A slow server automatically gets fewer
+ *   requests, so the tool measures "how fast can it go".
+ * - Hides queueing: if the server stalls 100 ms, we just don't send,
+ *   and that stall appears as ONE slow sample instead of hundreds.
+ *
+ * Open loop (requests on a fixed schedule)
+ * - Models real users: they don't wait for each other.
+ * - Latency is measured from the scheduled send time, so a stall
+ *   shows up in every request that should have gone out during it.
+ *   This is the "coordinated omission" fix.
+ *
+ * Histogram:
+ *   value 1,000,000 ns -> power-of-two range [2^19, 2^20)
+ *                      -> 128 equal sub-buckets in that range
+ *   Error < 1/128, memory ~4.6K counters, record = a few shifts.
+ *   Averages lie; always look at p99 and p99.9.
+ *
+ * Test:
+ * 1. 13_load_generator demo
+ * 2. 11_chat_fanout, then: 13_load_generator --proto chat --conns 50 --rate 2000
+ * 3. 13_load_generator server 9000, then try --mode open --rate 50000 --port 9000
+ *    and raise the rate until p99 explodes - that's the saturation point
+ *
+ * Only point this at servers you run yourself on localhost.
+ *
+ * Try:
+ * - Run one generator per core (it is single-threaded)
+ * - Print the full histogram and plot it
+ * - Add a warmup-free "ramp" mode that steps the rate up
+ */
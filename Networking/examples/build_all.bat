@@ -37,6 +37,26 @@ echo Building 08_file_transfer...
 gcc 08_file_transfer.c -o bin\08_file_transfer.exe -lws2_32
 if %ERRORLEVEL% NEQ 0 goto error
 
+echo Building 09_udp_batch...
+gcc 09_udp_batch.c -o bin\09_udp_batch.exe -lws2_32
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 10_reliable_udp...
+gcc 10_reliable_udp.c -o bin\10_reliable_udp.exe -lws2_32
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 11_chat_fanout...
+gcc 11_chat_fanout.c -o bin\11_chat_fanout.exe -lws2_32
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 12_framing_codec...
+gcc 12_framing_codec.c -o bin\12_framing_codec.exe -lws2_32
+if %ERRORLEVEL% NEQ 0 goto error
+
+echo Building 13_load_generator...
+gcc 13_load_generator.c -o bin\13_load_generator.exe -lws2_32
+if %ERRORLEVEL% NEQ 0 goto error
+
 echo.
 echo All examples built successfully!
 echo Run them from bin\
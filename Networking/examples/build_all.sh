@@ -30,6 +30,21 @@ gcc 07_http_client.c -o bin/07_http_client || exit 1
 echo "Building 08_file_transfer..."
 gcc 08_file_transfer.c -o bin/08_file_transfer || exit 1
 
+echo "Building 09_udp_batch..."
+gcc 09_udp_batch.c -o bin/09_udp_batch || exit 1
+
+echo "Building 10_reliable_udp..."
+gcc 10_reliable_udp.c -o bin/10_reliable_udp || exit 1
+
+echo "Building 11_chat_fanout..."
+gcc 11_chat_fanout.c -o bin/11_chat_fanout || exit 1
+
+echo "Building 12_framing_codec..."
+gcc 12_framing_codec.c -o bin/12_framing_codec || exit 1
+
+echo "Building 13_load_generator..."
+gcc 13_load_generator.c -o bin/13_load_generator || exit 1
+
 echo
 echo "All examples built successfully!"
 echo "Run them from bin/"